@@ -56,6 +56,7 @@ enum access_query_e
     ACCESS_GET_CONTENT_TYPE,/* arg1=char **ppsz_content_type res=can fail */
 
     ACCESS_GET_SIGNAL,      /* arg1=double *pf_quality, arg2=double *pf_strength   res=can fail */
+    ACCESS_GET_RECV_STATS,  /* arg1=uint64_t *pi_packets, arg2=uint64_t *pi_syscalls   res=can fail */
 
     /* */
     ACCESS_SET_PAUSE_STATE = 0x200, /* arg1= bool           can fail */
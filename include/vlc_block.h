@@ -134,10 +134,15 @@ struct block_t
  *      with preheader and or body (increase
  *      and decrease are supported). Use it as it is optimised.
  * - block_Duplicate : create a copy of a block.
+ * - block_Share : make a block shared, so that views of it can be taken.
+ * - block_View : create a block referring to a part of a shared block
+ *      payload, without copy.
  ****************************************************************************/
 VLC_API void block_Init( block_t *, void *, size_t );
 VLC_API block_t *block_Alloc( size_t ) VLC_USED VLC_MALLOC;
 VLC_API block_t *block_Realloc( block_t *, ssize_t i_pre, size_t i_body ) VLC_USED;
+VLC_API block_t *block_Share( block_t * ) VLC_USED;
+VLC_API block_t *block_View( block_t *, size_t i_offset, size_t i_length ) VLC_USED;
 
 static inline void block_CopyProperties( block_t *dst, block_t *src )
 {
@@ -166,6 +171,18 @@ static inline void block_Release( block_t *p_block )
     p_block->pf_release( p_block );
 }
 
+/**
+ * Block allocator cache statistics (see block_CacheGetStats()).
+ */
+typedef struct
+{
+    uint64_t i_hits; /**< Allocations served from the cache */
+    uint64_t i_misses; /**< Cacheable allocations served by the heap */
+    size_t   i_resident; /**< Bytes of idle memory held by the cache */
+} block_cache_stats_t;
+
+VLC_API void block_CacheGetStats( block_cache_stats_t * );
+
 VLC_API block_t *block_heap_Alloc(void *, size_t) VLC_USED VLC_MALLOC;
 VLC_API block_t *block_mmap_Alloc(void *addr, size_t length) VLC_USED VLC_MALLOC;
 VLC_API block_t * block_shm_Alloc(void *addr, size_t length) VLC_USED VLC_MALLOC;
@@ -189,6 +206,11 @@ static inline void block_Cleanup (void *block)
  * - block_ChainRelease : release a chain of block
  * - block_ChainExtract : extract data from a chain, return real bytes counts
  * - block_ChainGather : gather a chain, free it and return one block.
+ * - block_ChainGatherExt : same, or with b_scatter, only give the chain
+ *      properties to its first block and return the chain as is. This is for
+ *      consumers that accept data split anywhere, such as the packetizers of
+ *      elementary streams that are not packetized yet. A corrupted chain is
+ *      still gathered, so that it is dropped as a whole.
  ****************************************************************************/
 static inline void block_ChainAppend( block_t **pp_list, block_t *p_block )
 {
@@ -290,10 +312,28 @@ static inline block_t *block_ChainGather( block_t *p_list )
     return g;
 }
 
+static inline block_t *block_ChainGatherExt( block_t *p_list, bool b_scatter )
+{
+    if( !b_scatter || (p_list->i_flags & BLOCK_FLAG_CORRUPTED) )
+        return block_ChainGather( p_list );
+
+    /* The blocks after the first one only carry data */
+    for( block_t *p = p_list->p_next; p != NULL; p = p->p_next )
+    {
+        p_list->i_length += p->i_length;
+        p->i_flags = 0;
+        p->i_pts = p->i_dts = VLC_TS_INVALID;
+        p->i_length = 0;
+    }
+    return p_list;
+}
+
 /****************************************************************************
  * Fifos of blocks.
  ****************************************************************************
  * - block_FifoNew : create and init a new fifo
+ * - block_FifoNewExt : create a new fifo, block_FifoNewExt( BLOCK_FIFO_SPSC )
+ *      creates a lock-less fifo with only one producer and one consumer thread
  * - block_FifoRelease : destroy a fifo and free all blocks in it.
  * - block_FifoPace : wait for a fifo to drain to a specified number of packets or total data size
  * - block_FifoEmpty : free all blocks in a fifo
@@ -307,7 +347,11 @@ static inline block_t *block_ChainGather( block_t *p_list )
  * block_FifoGet and block_FifoShow are cancellation points.
  ****************************************************************************/
 
+/** Lock-less queue with a single producer and a single consumer thread */
+#define BLOCK_FIFO_SPSC 0x1
+
 VLC_API block_fifo_t *block_FifoNew( void ) VLC_USED VLC_MALLOC;
+VLC_API block_fifo_t *block_FifoNewExt( unsigned i_flags ) VLC_USED VLC_MALLOC;
 VLC_API void block_FifoRelease( block_fifo_t * );
 VLC_API void block_FifoPace( block_fifo_t *fifo, size_t max_depth, size_t max_size );
 VLC_API void block_FifoEmpty( block_fifo_t * );
@@ -444,9 +444,18 @@ static inline int block_PeekOffsetBytes( block_bytestream_t *p_bytestream,
     return VLC_SUCCESS;
 }
 
+/**
+ * Optional fast scanner for block_FindStartcodeFromOffset(): returns the
+ * first start code in [p, end[, or NULL. It is only used within a block,
+ * start codes straddling two blocks are still found byte per byte.
+ */
+typedef const uint8_t * (*block_startcode_helper_t)( const uint8_t *p,
+                                                     const uint8_t *end );
+
 static inline int block_FindStartcodeFromOffset(
     block_bytestream_t *p_bytestream, size_t *pi_offset,
-    const uint8_t *p_startcode, int i_startcode_length )
+    const uint8_t *p_startcode, int i_startcode_length,
+    block_startcode_helper_t pf_startcode_helper )
 {
     block_t *p_block, *p_block_backup = 0;
     int i_size = 0;
@@ -478,6 +487,22 @@ static inline int block_FindStartcodeFromOffset(
     {
         for( i_offset = i_size; i_offset < p_block->i_buffer; i_offset++ )
         {
+            /* Use the fast scanner for the bulk of the block, and leave only
+             * the last bytes, which may begin a start code, to the loop */
+            if( pf_startcode_helper && !i_match &&
+                p_block->i_buffer - i_offset >= (size_t)i_startcode_length )
+            {
+                const uint8_t *p_res = pf_startcode_helper(
+                    &p_block->p_buffer[i_offset],
+                    &p_block->p_buffer[p_block->i_buffer] );
+                if( p_res )
+                {
+                    *pi_offset += p_res - p_block->p_buffer;
+                    return VLC_SUCCESS;
+                }
+                i_offset = p_block->i_buffer - (i_startcode_length - 1);
+            }
+
             if( p_block->p_buffer[i_offset] == p_startcode[i_match] )
             {
                 if( !i_match )
@@ -73,8 +73,14 @@ VLC_API unsigned vlc_CPU(void);
 
 # ifdef __SSE2__
 #  define vlc_CPU_SSE2() (1)
+#  define VLC_SSE2
 # else
 #  define vlc_CPU_SSE2() ((vlc_CPU() & VLC_CPU_SSE2) != 0)
+#  if VLC_GCC_VERSION(4, 4) || defined(__clang__)
+#   define VLC_SSE2 __attribute__ ((__target__ ("sse2")))
+#  else
+#   define VLC_SSE2 VLC_SSE2_is_not_implemented_on_this_compiler
+#  endif
 # endif
 
 # ifdef __SSE3__
@@ -115,8 +121,14 @@ VLC_API unsigned vlc_CPU(void);
 
 # ifdef __AVX2__
 #  define vlc_CPU_AVX2() (1)
+#  define VLC_AVX2
 # else
 #  define vlc_CPU_AVX2() ((vlc_CPU() & VLC_CPU_AVX2) != 0)
+#  if VLC_GCC_VERSION(4, 7) || defined(__clang__)
+#   define VLC_AVX2 __attribute__ ((__target__ ("avx2")))
+#  else
+#   define VLC_AVX2 VLC_AVX2_is_not_implemented_on_this_compiler
+#  endif
 # endif
 
 # ifdef __3dNOW__
@@ -82,6 +82,7 @@ struct demux_t
 #define INPUT_UPDATE_SEEKPOINT  0x0020
 #define INPUT_UPDATE_META       0x0040
 #define INPUT_UPDATE_TITLE_LIST 0x0100
+#define INPUT_UPDATE_INDEX      0x0200 /**< DEMUX_GET_INDEX_PROGRESS changed */
 
 /* demux_meta_t is returned by "meta reader" module to the demuxer */
 typedef struct demux_meta_t
@@ -147,6 +148,10 @@ enum demux_query_e
     DEMUX_GET_SIGNAL, /* arg1=double *pf_quality, arg2=double *pf_strength
                          res=can fail */
 
+    /* Progress of an index built while playing, from 0.0 to 1.0. Only
+     * polled after the demux sets INPUT_UPDATE_INDEX */
+    DEMUX_GET_INDEX_PROGRESS, /* arg1=double *pf_progress res=can fail */
+
     /* II. Specific access_demux queries */
     /* PAUSE you are ensured that it is never called twice with the same state */
     DEMUX_CAN_PAUSE = 0x1000,   /* arg1= bool*    can fail (assume false)*/
@@ -241,6 +246,91 @@ VLC_API void demux_PacketizerDestroy( decoder_t *p_packetizer );
  */
 VLC_API input_thread_t * demux_GetParentInput( demux_t *p_demux ) VLC_USED;
 
+/**
+ * \defgroup demux_seek_index Seek index
+ * Time to byte offset index of a demuxed file, kept in the cache directory
+ * across sessions.
+ *
+ * The times are in a unit chosen by each demuxer. The points of a track
+ * are sorted by byte offset, and their times are expected to increase with
+ * their offsets for demux_SeekIndexFind() to be meaningful. Named values can
+ * also be kept along, such as the duration, as well as named blocks of data
+ * for demuxers with a richer index of their own.
+ * @{
+ */
+typedef struct demux_seek_index_t demux_seek_index_t;
+
+typedef struct
+{
+    int64_t  i_time;
+    uint64_t i_pos;
+} demux_seek_point_t;
+
+/**
+ * Opens the seek index of the file being demuxed, and loads it if it was
+ * kept by an earlier session.
+ *
+ * \param psz_name name of the demuxer, part of the index identity
+ * \param i_interval minimum time between two points of a track
+ * \return an index, or NULL if the index is disabled or the stream cannot
+ * be indexed (not seekable or unknown size)
+ */
+VLC_API demux_seek_index_t *demux_SeekIndexOpen( demux_t *, const char *psz_name, int64_t i_interval ) VLC_USED;
+
+/**
+ * Closes a seek index, and saves it if it was changed.
+ */
+VLC_API void demux_SeekIndexClose( demux_seek_index_t * );
+
+/**
+ * Adds a point to a track, unless one closer than the index interval
+ * already surrounds it.
+ */
+VLC_API void demux_SeekIndexAdd( demux_seek_index_t *, unsigned i_track, int64_t i_time, uint64_t i_pos );
+
+/**
+ * Finds the last point at or before a time, and the first one after it.
+ * Each of them is left untouched if there is none.
+ *
+ * \return true if a point at or before the time was found
+ */
+VLC_API bool demux_SeekIndexFind( demux_seek_index_t *, unsigned i_track, int64_t i_time, demux_seek_point_t *p_before, demux_seek_point_t *p_after );
+
+/**
+ * Returns all the points of a track, by increasing byte offset.
+ * The array is valid until the next change of the index.
+ */
+VLC_API const demux_seek_point_t *demux_SeekIndexGetPoints( demux_seek_index_t *, unsigned i_track, size_t *pi_count );
+
+/**
+ * Sets a named value.
+ */
+VLC_API void demux_SeekIndexSetValue( demux_seek_index_t *, const char *psz_name, int64_t i_value );
+
+/**
+ * Gets a named value.
+ * \return VLC_SUCCESS, or VLC_EGENERIC if the index has no such value
+ */
+VLC_API int demux_SeekIndexGetValue( demux_seek_index_t *, const char *psz_name, int64_t *pi_value );
+
+/**
+ * Sets a named block of data, replacing any other of the same name.
+ * The data is copied and saved as is, in host order.
+ * \return VLC_SUCCESS or an error
+ */
+VLC_API int demux_SeekIndexSetData( demux_seek_index_t *, const char *psz_name, const void *p_data, size_t i_size );
+
+/**
+ * Gets a named block of data.
+ * \return the data, valid until the next change of the index, or NULL if the
+ * index has no such data
+ */
+VLC_API const void *demux_SeekIndexGetData( demux_seek_index_t *, const char *psz_name, size_t *pi_size );
+
+/**
+ * @}
+ */
+
 /* */
 #define DEMUX_INIT_COMMON() do {            \
     p_demux->pf_control = Control;          \
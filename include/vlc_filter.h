@@ -250,6 +250,45 @@ VLC_API int filter_Blend( filter_t *, picture_t *p_dst, int i_dst_x, int i_dst_y
  */
 VLC_API void filter_DeleteBlend( filter_t * );
 
+/**
+ * Band of lines of a picture, processed by a filter_Slice() callback.
+ */
+typedef struct
+{
+    unsigned i_start; /**< First line to read, overlap included */
+    unsigned i_first; /**< First line to write */
+    unsigned i_end;   /**< Line after the last line to write */
+} filter_slice_t;
+
+typedef void (*filter_slice_cb_t)( filter_t *, void *, const filter_slice_t * );
+
+/**
+ * It runs a callback on horizontal bands of a picture, in parallel on the
+ * shared slice threads and on the calling thread, and returns once all the
+ * bands are done.
+ *
+ * The band limits are multiples of 16 lines, so that they can be scaled
+ * exactly to subsampled planes with filter_SliceLine(). The callbacks must
+ * only write their own lines.
+ *
+ * \param i_lines number of lines to split
+ * \param i_overlap number of lines before each band that the callback must
+ * go through first, for recursive filters (0 if the lines are independent)
+ * \param pf_slice callback
+ * \param opaque data given to the callback
+ */
+VLC_API void filter_Slice( filter_t *, unsigned i_lines, unsigned i_overlap, filter_slice_cb_t pf_slice, void *opaque );
+
+/**
+ * It scales a line of a band to a plane of i_plane_lines lines out of a
+ * picture of i_lines lines.
+ */
+static inline unsigned filter_SliceLine( unsigned i_line, unsigned i_lines,
+                                         unsigned i_plane_lines )
+{
+    return (uint64_t)i_line * i_plane_lines / i_lines;
+}
+
 /**
  * Create a picture_t *(*)( filter_t *, picture_t * ) compatible wrapper
  * using a void (*)( filter_t *, picture_t *, picture_t * ) function
@@ -367,11 +406,39 @@ VLC_API const es_format_t * filter_chain_GetFmtOut( filter_chain_t * );
  */
 VLC_API picture_t * filter_chain_VideoFilter( filter_chain_t *, picture_t * );
 
+/**
+ * Get the next picture left in a video filter chain.
+ *
+ * Unlike filter_chain_VideoFilter() with NULL, this waits for the pictures
+ * being filtered by the threads of the chain, if any. Call it until it
+ * returns NULL to get all the pictures out of the chain, at the end of the
+ * stream for instance.
+ *
+ * \param p_chain pointer to filter chain
+ * \return the next filtered picture, or NULL if none is left
+ */
+VLC_API picture_t * filter_chain_VideoDrain( filter_chain_t * );
+
 /**
  * Flush a video filter chain.
  */
 VLC_API void filter_chain_VideoFlush( filter_chain_t * );
 
+/**
+ * Set the number of threads running the video filters of a chain.
+ *
+ * With threads, the filters are split in groups running on their own
+ * threads, so that several pictures are filtered at once. The last filter
+ * still runs on the calling thread. The pictures keep their order, but
+ * filter_chain_VideoFilter() returns them later: call it with NULL to get
+ * the pictures filtered meanwhile, or filter_chain_VideoDrain() to wait
+ * for them.
+ *
+ * \param p_chain pointer to filter chain
+ * \param i_threads number of threads, 0 to filter on the calling thread
+ */
+VLC_API void filter_chain_SetThreads( filter_chain_t *, unsigned );
+
 /**
  * Apply the filter chain to a audio block.
  *
@@ -266,6 +266,8 @@
 #define VLC_CODEC_NV24            VLC_FOURCC('N','V','2','4')
 /* 2 planes Y/VU 4:4:4 */
 #define VLC_CODEC_NV42            VLC_FOURCC('N','V','4','2')
+/* 2 planes Y/UV 4:2:0 10-bit MSB aligned on 16 bits */
+#define VLC_CODEC_P010            VLC_FOURCC('P','0','1','0')
 
 /* VDPAU video surface YCbCr 4:2:0 */
 #define VLC_CODEC_VDPAU_VIDEO_420 VLC_FOURCC('V','D','V','0')
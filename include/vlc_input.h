@@ -394,6 +394,9 @@ typedef enum input_event_type_e
     /* A vout_thread_t object has been created/deleted by *the input* */
     INPUT_EVENT_VOUT,
 
+    /* "index-progress" has changed */
+    INPUT_EVENT_INDEX,
+
 } input_event_type_e;
 
 /**
@@ -309,6 +309,10 @@ struct input_stats_t
     int64_t i_read_bytes;
     float f_input_bitrate;
     float f_average_input_bitrate;
+    int64_t i_cache_hits;   /* Reads served by the stream cache */
+    int64_t i_cache_misses; /* Reads that needed the access */
+    float f_recv_packet_rate;  /* Packets received by the access */
+    float f_recv_syscall_rate; /* System calls made to receive them */
 
     /* Demux */
     int64_t i_demux_read_packets;
@@ -237,6 +237,28 @@ VLC_API int picture_Export( vlc_object_t *p_obj, block_t **pp_image, video_forma
  */
 VLC_API int picture_Setup( picture_t *, const video_format_t * );
 
+/**
+ * Statistics of the process-wide cache of picture buffers.
+ */
+typedef struct
+{
+    uint64_t i_hits;     /**< allocations served from the cache */
+    uint64_t i_misses;   /**< allocations served from the heap */
+    size_t   i_resident; /**< bytes currently held by the cache */
+    unsigned i_count;    /**< buffers currently held by the cache */
+} picture_cache_stats_t;
+
+/**
+ * This function will return the statistics of the picture buffer cache.
+ */
+VLC_API void picture_CacheGetStats( picture_cache_stats_t * );
+
+/**
+ * This function will free the cached picture buffers until at most
+ * the given number of bytes remain in the cache (0 empties it).
+ */
+VLC_API void picture_CacheTrim( size_t );
+
 
 /**
  * This function will blend a given subpicture onto a picture.
@@ -103,6 +103,10 @@ enum stream_query_e
      * FIXME find a way to avoid it */
     STREAM_UPDATE_SIZE,
 
+    /* Size of the cache in bytes */
+    STREAM_GET_CACHE_SIZE,  /**< arg1= uint64_t *     res=cannot fail */
+    STREAM_SET_CACHE_SIZE,  /**< arg1= uint64_t       res=can fail */
+
     /* */
     STREAM_GET_PTS_DELAY = 0x101,/**< arg1= int64_t* res=cannot fail */
     STREAM_GET_TITLE_INFO, /**< arg1=input_title_t*** arg2=int* res=can fail */
@@ -749,6 +749,81 @@ VLC_API int var_InheritURational( vlc_object_t *, unsigned *num, unsigned *den,
 VLC_API int var_LocationParse(vlc_object_t *, const char *mrl, const char *prefix);
 #define var_LocationParse(o, m, p) var_LocationParse(VLC_OBJECT(o), m, p)
 
+/*****************************************************************************
+ * Variable handles
+ *****************************************************************************
+ * A handle refers to a variable without looking its name up, for variables
+ * that are read or written very often, e.g. for every picture or audio block.
+ *****************************************************************************/
+
+/** Variable handle, see var_Hold() */
+typedef struct variable_t vlc_var_t;
+
+VLC_API vlc_var_t *var_Hold( vlc_object_t *, const char * ) VLC_USED;
+#define var_Hold(a,b) var_Hold( VLC_OBJECT(a), b )
+VLC_API void var_Release( vlc_object_t *, vlc_var_t * );
+#define var_Release(a,b) var_Release( VLC_OBJECT(a), b )
+
+VLC_API int var_HandleSet( vlc_object_t *, vlc_var_t *, int, vlc_value_t );
+#define var_HandleSet(o,h,t,v) var_HandleSet(VLC_OBJECT(o),h,t,v)
+VLC_API void var_HandleGet( vlc_object_t *, vlc_var_t *, int, vlc_value_t * );
+#define var_HandleGet(o,h,t,v) var_HandleGet(VLC_OBJECT(o),h,t,v)
+
+static inline int var_HandleSetInteger( vlc_object_t *obj, vlc_var_t *var,
+                                        int64_t i )
+{
+    vlc_value_t val;
+    val.i_int = i;
+    return var_HandleSet( obj, var, VLC_VAR_INTEGER, val );
+}
+
+static inline int var_HandleSetBool( vlc_object_t *obj, vlc_var_t *var,
+                                     bool b )
+{
+    vlc_value_t val;
+    val.b_bool = b;
+    return var_HandleSet( obj, var, VLC_VAR_BOOL, val );
+}
+
+static inline int var_HandleSetFloat( vlc_object_t *obj, vlc_var_t *var,
+                                      float f )
+{
+    vlc_value_t val;
+    val.f_float = f;
+    return var_HandleSet( obj, var, VLC_VAR_FLOAT, val );
+}
+
+VLC_USED
+static inline int64_t var_HandleGetInteger( vlc_object_t *obj, vlc_var_t *var )
+{
+    vlc_value_t val;
+    var_HandleGet( obj, var, VLC_VAR_INTEGER, &val );
+    return val.i_int;
+}
+
+VLC_USED
+static inline bool var_HandleGetBool( vlc_object_t *obj, vlc_var_t *var )
+{
+    vlc_value_t val;
+    var_HandleGet( obj, var, VLC_VAR_BOOL, &val );
+    return val.b_bool;
+}
+
+VLC_USED
+static inline float var_HandleGetFloat( vlc_object_t *obj, vlc_var_t *var )
+{
+    vlc_value_t val;
+    var_HandleGet( obj, var, VLC_VAR_FLOAT, &val );
+    return val.f_float;
+}
+
+#define var_HandleSetInteger(o,h,i) var_HandleSetInteger(VLC_OBJECT(o),h,i)
+#define var_HandleSetBool(o,h,b)    var_HandleSetBool(VLC_OBJECT(o),h,b)
+#define var_HandleSetFloat(o,h,f)   var_HandleSetFloat(VLC_OBJECT(o),h,f)
+#define var_HandleGetInteger(o,h)   var_HandleGetInteger(VLC_OBJECT(o),h)
+#define var_HandleGetBool(o,h)      var_HandleGetBool(VLC_OBJECT(o),h)
+#define var_HandleGetFloat(o,h)     var_HandleGetFloat(VLC_OBJECT(o),h)
+
 /**
  * @}
  */
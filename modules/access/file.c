@@ -52,6 +52,12 @@
 #   include <unistd.h>
 #endif
 #include <dirent.h>
+#ifdef HAVE_MMAP
+#   include <sys/mman.h>
+#   ifndef MAP_ANONYMOUS
+#       define MAP_ANONYMOUS MAP_ANON
+#   endif
+#endif
 
 #include <vlc_common.h>
 #include "fs.h"
@@ -63,6 +69,11 @@
 #endif
 #include <vlc_fs.h>
 #include <vlc_url.h>
+#include <vlc_block.h>
+
+/* Size of the memory mappings returned by FileBlock(). Their start is
+ * aligned on this size, except after a seek. */
+#define FILE_MMAP_SIZE (1 << 20)
 
 struct access_sys_t
 {
@@ -70,6 +81,7 @@ struct access_sys_t
 
     bool b_pace_control;
     uint64_t size;
+    size_t page_mask;
 };
 
 #if !defined (_WIN32) && !defined (__OS2__)
@@ -127,8 +139,14 @@ static bool IsRemote (const char *path)
 #ifndef HAVE_POSIX_FADVISE
 # define posix_fadvise(fd, off, len, adv)
 #endif
+#ifndef HAVE_POSIX_MADVISE
+# define posix_madvise(addr, len, adv)
+#endif
 
 static ssize_t FileRead (access_t *, uint8_t *, size_t);
+#ifdef HAVE_MMAP
+static block_t *FileBlock (access_t *);
+#endif
 static int FileSeek (access_t *, uint64_t);
 static ssize_t StreamRead (access_t *, uint8_t *, size_t);
 static int NoSeek (access_t *, uint64_t);
@@ -226,7 +244,23 @@ int FileOpen( vlc_object_t *p_this )
 
     if (S_ISREG (st.st_mode) || S_ISBLK (st.st_mode))
     {
-        p_access->pf_read = FileRead;
+#ifdef HAVE_MMAP
+        /* Local regular files can be memory mapped, so that the stream layer
+         * can peek at the page cache without any copy. This is not the
+         * default, and never done for remote files, as mapped pages of a
+         * truncated file cause SIGBUS. */
+        if (S_ISREG (st.st_mode)
+         && var_InheritBool (p_access, "file-mmap")
+         && !IsRemote(fd, p_access->psz_filepath))
+        {
+            p_access->pf_read = NULL;
+            p_access->pf_block = FileBlock;
+            p_sys->page_mask = sysconf (_SC_PAGESIZE) - 1;
+            msg_Dbg (p_access, "using memory mapping");
+        }
+        else
+#endif
+            p_access->pf_read = FileRead;
         p_access->pf_seek = FileSeek;
         p_sys->b_pace_control = true;
         p_sys->size = st.st_size;
@@ -267,7 +301,7 @@ void FileClose (vlc_object_t * p_this)
 {
     access_t     *p_access = (access_t*)p_this;
 
-    if (p_access->pf_read == NULL)
+    if (p_access->pf_read == NULL && p_access->pf_block == NULL)
     {
         DirClose (p_this);
         return;
@@ -320,6 +354,90 @@ static ssize_t FileRead (access_t *p_access, uint8_t *p_buffer, size_t i_len)
 }
 
 
+#ifdef HAVE_MMAP
+/**
+ * Maps the next part of a regular file.
+ */
+static block_t *FileBlock (access_t *p_access)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+    uint64_t pos = p_access->info.i_pos;
+
+    if (pos >= p_sys->size)
+    {   /* The file may still be growing */
+        struct stat st;
+
+        if (fstat (p_sys->fd, &st) == 0)
+            p_sys->size = st.st_size;
+        if (pos >= p_sys->size)
+        {
+            p_access->info.b_eof = true;
+            return NULL;
+        }
+    }
+
+    /* mmap() offsets must be page-aligned */
+    uint64_t offset = pos & ~(uint64_t)p_sys->page_mask;
+    uint64_t end = (offset + FILE_MMAP_SIZE) & ~(uint64_t)(FILE_MMAP_SIZE - 1);
+    if (end > p_sys->size)
+        end = p_sys->size;
+    size_t length = end - offset;
+
+    /* One more anonymous page follows the data, as block padding: readers
+     * may read past the end of a block. */
+    size_t total = ((length + p_sys->page_mask) & ~p_sys->page_mask)
+                 + p_sys->page_mask + 1;
+    /* The mapping is private, so that blocks can be modified in place */
+    void *addr = mmap (NULL, total, PROT_READ|PROT_WRITE,
+                       MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    if (addr != MAP_FAILED
+     && mmap (addr, length, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_FIXED,
+              p_sys->fd, offset) == MAP_FAILED)
+    {
+        munmap (addr, total);
+        addr = MAP_FAILED;
+    }
+    block_t *block;
+
+    if (addr != MAP_FAILED)
+    {
+        posix_madvise (addr, length, POSIX_MADV_WILLNEED);
+        /* Read ahead the next mapping */
+        posix_fadvise (p_sys->fd, end, FILE_MMAP_SIZE, POSIX_FADV_WILLNEED);
+
+        block = block_mmap_Alloc (addr, total);
+        if (block == NULL)
+            return NULL;
+        block->p_buffer += pos - offset;
+        block->i_buffer = end - pos;
+    }
+    else
+    {   /* Some file systems do not support mmap() */
+        msg_Dbg (p_access, "memory mapping error: %s", vlc_strerror_c(errno));
+
+        block = block_Alloc (end - pos);
+        if (block == NULL)
+            return NULL;
+
+        ssize_t val = pread (p_sys->fd, block->p_buffer, block->i_buffer, pos);
+        if (val <= 0)
+        {
+            block_Release (block);
+            if (val == 0 || (errno != EINTR && errno != EAGAIN))
+            {
+                msg_Err (p_access, "read error: %s", vlc_strerror_c(errno));
+                p_access->info.b_eof = true;
+            }
+            return NULL;
+        }
+        block->i_buffer = val;
+    }
+
+    p_access->info.i_pos += block->i_buffer;
+    return block;
+}
+#endif
+
 /*****************************************************************************
  * Seek: seek to a specific location in a file
  *****************************************************************************/
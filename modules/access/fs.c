@@ -54,6 +54,12 @@ static const char *const psz_sort_list_text[] = {
     N_("Sort items in a natural order (for example: 1.ogg 2.ogg 10.ogg). This method does not take the current language's collation rules into account."),
     N_("Do not sort the items.") };
 
+#define MMAP_TEXT N_("Use memory mapping")
+#define MMAP_LONGTEXT N_( \
+    "Map local files in memory instead of reading them. This avoids " \
+    "copying the data, but VLC crashes if a file is truncated while it is " \
+    "read." )
+
 #define SORT_TEXT N_("Directory sort order")
 #define SORT_LONGTEXT N_( \
     "Define the sort algorithm used when adding items from a directory." )
@@ -66,6 +72,7 @@ vlc_module_begin ()
     add_obsolete_string( "file-cat" )
     set_capability( "access", 50 )
     add_shortcut( "file", "fd", "stream" )
+    add_bool( "file-mmap", false, MMAP_TEXT, MMAP_LONGTEXT, true )
     set_callbacks( FileOpen, FileClose )
 
     add_submodule()
@@ -37,13 +37,18 @@
 #endif
 
 #include <errno.h>
+#ifdef HAVE_RECVMMSG
+# include <sys/socket.h>
+#endif
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_access.h>
 #include <vlc_network.h>
 #include <vlc_block.h>
+#include <vlc_atomic.h>
 
 #define MTU 65535
+#define UDP_BATCH_MAX 1024
 
 /*****************************************************************************
  * Module descriptor
@@ -53,6 +58,10 @@ static void Close( vlc_object_t * );
 
 #define BUFFER_TEXT N_("Receive buffer")
 #define BUFFER_LONGTEXT N_("UDP receive buffer size (bytes)" )
+#define BATCH_TEXT N_("Receive batch")
+#define BATCH_LONGTEXT N_( \
+    "Maximum number of datagrams received with a single system call. " \
+    "Use 1 to receive datagrams one by one." )
 
 vlc_module_begin ()
     set_shortname( N_("UDP" ) )
@@ -62,6 +71,10 @@ vlc_module_begin ()
 
     add_obsolete_integer( "server-port" ) /* since 2.0.0 */
     add_integer( "udp-buffer", 0x400000, BUFFER_TEXT, BUFFER_LONGTEXT, true )
+#ifdef HAVE_RECVMMSG
+    add_integer( "udp-batch", 32, BATCH_TEXT, BATCH_LONGTEXT, true )
+        change_integer_range( 1, UDP_BATCH_MAX )
+#endif
 
     set_capability( "access", 0 )
     add_shortcut( "udp", "udpstream", "udp4", "udp6" )
@@ -75,6 +88,14 @@ struct access_sys_t
     size_t fifo_size;
     block_fifo_t *fifo;
     vlc_thread_t thread;
+    unsigned batch;
+
+    /* Receive statistics, updated by the thread */
+    struct
+    {
+        atomic_uint_least64_t packets;
+        atomic_uint_least64_t syscalls;
+    } stats;
 };
 
 /*****************************************************************************
@@ -83,6 +104,11 @@ struct access_sys_t
 static block_t *BlockUDP( access_t * );
 static int Control( access_t *, int, va_list );
 static void* ThreadRead( void *data );
+#ifdef HAVE_RECVMMSG
+static void* ThreadReadBatch( void *data );
+#else
+# define ThreadReadBatch ThreadRead
+#endif
 
 /*****************************************************************************
  * Open: open the socket
@@ -157,7 +183,8 @@ static int Open( vlc_object_t *p_this )
         goto error;
     }
 
-    sys->fifo = block_FifoNew();
+    /* Only ThreadRead() puts blocks in the FIFO */
+    sys->fifo = block_FifoNewExt( BLOCK_FIFO_SPSC );
     if( unlikely( sys->fifo == NULL ) )
     {
         net_Close( sys->fd );
@@ -165,8 +192,18 @@ static int Open( vlc_object_t *p_this )
     }
 
     sys->fifo_size = var_InheritInteger( p_access, "udp-buffer");
+#ifdef HAVE_RECVMMSG
+    sys->batch = var_InheritInteger( p_access, "udp-batch" );
+    if( sys->batch > UDP_BATCH_MAX )
+        sys->batch = UDP_BATCH_MAX;
+#else
+    sys->batch = 1;
+#endif
+    atomic_init( &sys->stats.packets, 0 );
+    atomic_init( &sys->stats.syscalls, 0 );
 
-    if( vlc_clone( &sys->thread, ThreadRead, p_access,
+    if( vlc_clone( &sys->thread, sys->batch > 1 ? ThreadReadBatch : ThreadRead,
+                   p_access,
                    VLC_THREAD_PRIORITY_INPUT ) )
     {
         block_FifoRelease( sys->fifo );
@@ -218,6 +255,13 @@ static int Control( access_t *p_access, int i_query, va_list args )
                    * var_InheritInteger(p_access, "network-caching");
             break;
 
+        case ACCESS_GET_RECV_STATS:
+            *va_arg( args, uint64_t * ) =
+                atomic_load( &p_access->p_sys->stats.packets );
+            *va_arg( args, uint64_t * ) =
+                atomic_load( &p_access->p_sys->stats.syscalls );
+            break;
+
         default:
             return VLC_EGENERIC;
     }
@@ -234,6 +278,22 @@ static block_t *BlockUDP( access_t *p_access )
     return block_FifoGet( sys->fifo );
 }
 
+/*****************************************************************************
+ * UpdateStats: account for received packets and the system calls made
+ *****************************************************************************/
+/* net_Read() is accounted as a poll() and a receive. It receives once more
+ * when the socket was already empty, which is not visible from here. */
+#define NET_READ_SYSCALLS 2
+
+static void UpdateStats( access_t *access, unsigned packets,
+                         unsigned syscalls )
+{
+    access_sys_t *sys = access->p_sys;
+
+    atomic_fetch_add( &sys->stats.packets, packets );
+    atomic_fetch_add( &sys->stats.syscalls, syscalls );
+}
+
 /*****************************************************************************
  * ThreadRead: Pull packets from socket as soon as possible.
  *****************************************************************************/
@@ -263,13 +323,140 @@ static void* ThreadRead( void *data )
 
             if( errno == EINTR )
                 break;
+            UpdateStats( access, 0, NET_READ_SYSCALLS );
             continue;
         }
 
         pkt = block_Realloc( pkt, 0, len );
         block_FifoPut( sys->fifo, pkt );
+        UpdateStats( access, 1, NET_READ_SYSCALLS );
     }
 
     block_FifoWake( sys->fifo );
     return NULL;
 }
+
+#ifdef HAVE_RECVMMSG
+typedef struct
+{
+    unsigned count;
+    block_t *pkts[UDP_BATCH_MAX];
+    struct iovec iov[UDP_BATCH_MAX];
+    struct mmsghdr msgs[UDP_BATCH_MAX];
+} udp_batch_t;
+
+static void BatchCleanup( void *data )
+{
+    udp_batch_t *batch = data;
+
+    for( unsigned i = 0; i < batch->count; i++ )
+        if( batch->pkts[i] != NULL )
+            block_Release( batch->pkts[i] );
+    free( batch );
+}
+
+/*****************************************************************************
+ * ThreadReadBatch: Pull many packets at once with recvmmsg().
+ *****************************************************************************/
+static void* ThreadReadBatch( void *data )
+{
+    access_t *access = data;
+    access_sys_t *sys = access->p_sys;
+    udp_batch_t *batch = malloc( sizeof( *batch ) );
+
+    if( unlikely(batch == NULL) )
+        goto out;
+
+    batch->count = sys->batch;
+    for( unsigned i = 0; i < batch->count; i++ )
+        batch->pkts[i] = NULL;
+
+    vlc_cleanup_push( BatchCleanup, batch );
+    for( ;; )
+    {
+        unsigned ready;
+        int n;
+
+        block_FifoPace( sys->fifo, SIZE_MAX, sys->fifo_size );
+
+        /* Refill the buffers consumed by the previous call */
+        for( ready = 0; ready < batch->count; ready++ )
+        {
+            unsigned i = ready;
+
+            if( batch->pkts[i] == NULL )
+            {
+                batch->pkts[i] = block_Alloc( MTU );
+                if( unlikely(batch->pkts[i] == NULL) )
+                    break;
+            }
+            batch->iov[i].iov_base = batch->pkts[i]->p_buffer;
+            batch->iov[i].iov_len = MTU;
+            memset( &batch->msgs[i].msg_hdr, 0,
+                    sizeof( batch->msgs[i].msg_hdr ) );
+            batch->msgs[i].msg_hdr.msg_iov = &batch->iov[i];
+            batch->msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        if( unlikely(ready == 0) )
+            break;
+
+        /* Wait for the first packet like the single packet thread does:
+         * net_Read() is a cancellation point, and also wakes up when the
+         * access is killed, recvmmsg() is neither. */
+        ssize_t len = net_Read( access, sys->fd, NULL, batch->iov[0].iov_base,
+                                MTU, false );
+        if( len == -1 )
+        {
+            if( errno == EINTR )
+                break;
+            UpdateStats( access, 0, NET_READ_SYSCALLS );
+            continue;
+        }
+        batch->msgs[0].msg_len = len;
+
+        /* Then take whatever else is already queued */
+        unsigned syscalls = NET_READ_SYSCALLS;
+        n = 1;
+        if( ready > 1 )
+        {
+            int val = recvmmsg( sys->fd, batch->msgs + 1, ready - 1,
+                                MSG_DONTWAIT, NULL );
+            syscalls++;
+            if( val > 0 )
+                n += val;
+            else
+            if( val < 0 && errno != EAGAIN && errno != EINTR )
+                msg_Err( access, "receive error: %s",
+                         vlc_strerror_c(errno) );
+        }
+
+        block_t *chain = NULL, **pp = &chain;
+        for( int i = 0; i < n; i++ )
+        {
+            block_t *pkt = block_Realloc( batch->pkts[i], 0,
+                                          batch->msgs[i].msg_len );
+            batch->pkts[i] = NULL;
+            if( pkt == NULL )
+                continue;
+            *pp = pkt;
+            pp = &pkt->p_next;
+        }
+        /* Move the unused buffers to the front of the batch */
+        if( (unsigned)n < batch->count )
+        {
+            memmove( batch->pkts, batch->pkts + n,
+                     (batch->count - n) * sizeof( batch->pkts[0] ) );
+            for( unsigned i = batch->count - n; i < batch->count; i++ )
+                batch->pkts[i] = NULL;
+        }
+
+        if( chain != NULL )
+            block_FifoPut( sys->fifo, chain );
+        UpdateStats( access, n, syscalls );
+    }
+    vlc_cleanup_run();
+out:
+    block_FifoWake( sys->fifo );
+    return NULL;
+}
+#endif
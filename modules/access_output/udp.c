@@ -51,6 +51,12 @@
 
 #define MAX_EMPTY_BLOCKS 200
 
+/* Maximum number of packets sent with one system call */
+#define UDP_BATCH_MAX 64
+
+/* Interval between two reports of the sending statistics */
+#define UDP_STATS_PERIOD (10 * CLOCK_FREQ)
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -71,6 +77,13 @@ static void Close( vlc_object_t * );
                           "helps reducing the scheduling load on " \
                           "heavily-loaded systems." )
 
+#define BATCH_TEXT N_("Batching window (us)")
+#define BATCH_LONGTEXT N_("Packets due within this many microseconds " \
+                          "after a packet are sent together with it, " \
+                          "using a single system call. Packets carrying a " \
+                          "PCR are always sent at their own date. " \
+                          "0 disables batching." )
+
 vlc_module_begin ()
     set_description( N_("UDP stream output") )
     set_shortname( "UDP" )
@@ -79,6 +92,11 @@ vlc_module_begin ()
     add_integer( SOUT_CFG_PREFIX "caching", DEFAULT_PTS_DELAY / 1000, CACHING_TEXT, CACHING_LONGTEXT, true )
     add_integer( SOUT_CFG_PREFIX "group", 1, GROUP_TEXT, GROUP_LONGTEXT,
                                  true )
+#ifdef HAVE_SENDMMSG
+    add_integer( SOUT_CFG_PREFIX "batch", 0, BATCH_TEXT, BATCH_LONGTEXT,
+                                 true )
+        change_integer_range( 0, 100000 )
+#endif
 
     set_capability( "sout access", 0 )
     add_shortcut( "udp" )
@@ -92,6 +110,9 @@ vlc_module_end ()
 static const char *const ppsz_sout_options[] = {
     "caching",
     "group",
+#ifdef HAVE_SENDMMSG
+    "batch",
+#endif
     NULL
 };
 
@@ -108,11 +129,15 @@ static int  Seek    ( sout_access_out_t *, off_t  );
 static int Control( sout_access_out_t *, int, va_list );
 
 static void* ThreadWrite( void * );
+#ifdef HAVE_SENDMMSG
+static void* ThreadWriteBatch( void * );
+#endif
 static block_t *NewUDPPacket( sout_access_out_t *, mtime_t );
 
 struct sout_access_out_sys_t
 {
     mtime_t       i_caching;
+    mtime_t       i_batch_window;
     int           i_handle;
     bool          b_mtu_warning;
     size_t        i_mtu;
@@ -214,7 +239,16 @@ static int Open( vlc_object_t *p_this )
     p_sys->p_empty_blocks = block_FifoNew();
     p_sys->p_buffer = NULL;
 
-    if( vlc_clone( &p_sys->thread, ThreadWrite, p_access,
+    void *(*pf_thread)( void * ) = ThreadWrite;
+#ifdef HAVE_SENDMMSG
+    p_sys->i_batch_window = var_GetInteger( p_access, SOUT_CFG_PREFIX "batch" );
+    if( p_sys->i_batch_window > 0 )
+        pf_thread = ThreadWriteBatch;
+#else
+    p_sys->i_batch_window = 0;
+#endif
+
+    if( vlc_clone( &p_sys->thread, pf_thread, p_access,
                            VLC_THREAD_PRIORITY_HIGHEST ) )
     {
         msg_Err( p_access, "cannot spawn sout access thread" );
@@ -392,6 +426,96 @@ static block_t *NewUDPPacket( sout_access_out_t *p_access, mtime_t i_dts)
     return p_buffer;
 }
 
+/*****************************************************************************
+ * Sending statistics: offset of the actual sending dates from the schedule
+ *****************************************************************************/
+typedef struct
+{
+    mtime_t  i_since;
+    unsigned i_packets;
+    unsigned i_calls;
+    mtime_t  i_offset_sum;   /* sum of the absolute offsets */
+    mtime_t  i_late_max;
+    mtime_t  i_early_max;
+} udp_stats_t;
+
+static void StatsReset( udp_stats_t *p_stats, mtime_t now )
+{
+    p_stats->i_since = now;
+    p_stats->i_packets = 0;
+    p_stats->i_calls = 0;
+    p_stats->i_offset_sum = 0;
+    p_stats->i_late_max = 0;
+    p_stats->i_early_max = 0;
+}
+
+static void StatsUpdate( udp_stats_t *p_stats, mtime_t i_offset )
+{
+    p_stats->i_packets++;
+    if( i_offset >= 0 )
+    {
+        p_stats->i_offset_sum += i_offset;
+        if( i_offset > p_stats->i_late_max )
+            p_stats->i_late_max = i_offset;
+    }
+    else
+    {
+        p_stats->i_offset_sum -= i_offset;
+        if( -i_offset > p_stats->i_early_max )
+            p_stats->i_early_max = -i_offset;
+    }
+}
+
+static void StatsReport( sout_access_out_t *p_access, udp_stats_t *p_stats,
+                         mtime_t now )
+{
+    if( now - p_stats->i_since < UDP_STATS_PERIOD || !p_stats->i_packets )
+        return;
+
+    msg_Dbg( p_access, "sent %u packets in %u calls, jitter: mean %"PRId64
+             " us, max late %"PRId64" us, max early %"PRId64" us",
+             p_stats->i_packets, p_stats->i_calls,
+             p_stats->i_offset_sum / p_stats->i_packets,
+             p_stats->i_late_max, p_stats->i_early_max );
+    StatsReset( p_stats, now );
+}
+
+/*****************************************************************************
+ * CheckDate: detect holes in the packet dates
+ *****************************************************************************
+ * Returns true if the packet must be dropped.
+ *****************************************************************************/
+static bool CheckDate( sout_access_out_t *p_access, mtime_t i_date,
+                       mtime_t *pi_date_last, unsigned *pi_dropped_packets )
+{
+    if( *pi_date_last > 0 )
+    {
+        if( i_date - *pi_date_last > 2000000 )
+        {
+            if( !*pi_dropped_packets )
+                msg_Dbg( p_access, "mmh, hole (%"PRId64" > 2s) -> drop",
+                         i_date - *pi_date_last );
+
+            *pi_date_last = i_date;
+            (*pi_dropped_packets)++;
+            return true;
+        }
+        else if( i_date - *pi_date_last < -1000 )
+        {
+            if( !*pi_dropped_packets )
+                msg_Dbg( p_access, "mmh, packets in the past (%"PRId64")",
+                         *pi_date_last - i_date );
+        }
+    }
+
+    if( *pi_dropped_packets )
+    {
+        msg_Dbg( p_access, "dropped %i packets", *pi_dropped_packets );
+        *pi_dropped_packets = 0;
+    }
+    return false;
+}
+
 /*****************************************************************************
  * ThreadWrite: Write a packet on the network at the good time.
  *****************************************************************************/
@@ -404,6 +528,9 @@ static void* ThreadWrite( void *data )
                                              SOUT_CFG_PREFIX "group" );
     mtime_t i_to_send = i_group;
     unsigned i_dropped_packets = 0;
+    udp_stats_t stats;
+
+    StatsReset( &stats, mdate() );
 
     for (;;)
     {
@@ -411,26 +538,10 @@ static void* ThreadWrite( void *data )
         mtime_t       i_date, i_sent;
 
         i_date = p_sys->i_caching + p_pk->i_dts;
-        if( i_date_last > 0 )
+        if( CheckDate( p_access, i_date, &i_date_last, &i_dropped_packets ) )
         {
-            if( i_date - i_date_last > 2000000 )
-            {
-                if( !i_dropped_packets )
-                    msg_Dbg( p_access, "mmh, hole (%"PRId64" > 2s) -> drop",
-                             i_date - i_date_last );
-
-                block_FifoPut( p_sys->p_empty_blocks, p_pk );
-
-                i_date_last = i_date;
-                i_dropped_packets++;
-                continue;
-            }
-            else if( i_date - i_date_last < -1000 )
-            {
-                if( !i_dropped_packets )
-                    msg_Dbg( p_access, "mmh, packets in the past (%"PRId64")",
-                             i_date_last - i_date );
-            }
+            block_FifoPut( p_sys->p_empty_blocks, p_pk );
+            continue;
         }
 
         block_cleanup_push( p_pk );
@@ -444,12 +555,6 @@ static void* ThreadWrite( void *data )
             msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
         vlc_cleanup_pop();
 
-        if( i_dropped_packets )
-        {
-            msg_Dbg( p_access, "dropped %i packets", i_dropped_packets );
-            i_dropped_packets = 0;
-        }
-
 #if 1
         i_sent = mdate();
         if ( i_sent > i_date + 20000 )
@@ -458,6 +563,9 @@ static void* ThreadWrite( void *data )
                      i_sent - i_date );
         }
 #endif
+        stats.i_calls++;
+        StatsUpdate( &stats, i_sent - i_date );
+        StatsReport( p_access, &stats, i_sent );
 
         block_FifoPut( p_sys->p_empty_blocks, p_pk );
 
@@ -465,3 +573,109 @@ static void* ThreadWrite( void *data )
     }
     return NULL;
 }
+
+#ifdef HAVE_SENDMMSG
+typedef struct
+{
+    unsigned count;
+    block_t *pkts[UDP_BATCH_MAX];
+    struct iovec iov[UDP_BATCH_MAX];
+    struct mmsghdr msgs[UDP_BATCH_MAX];
+} udp_batch_t;
+
+static void BatchCleanup( void *data )
+{
+    udp_batch_t *batch = data;
+
+    for( unsigned i = 0; i < batch->count; i++ )
+        block_Release( batch->pkts[i] );
+}
+
+/*****************************************************************************
+ * ThreadWriteBatch: Write the packets due within the batching window with
+ * a single system call.
+ *****************************************************************************/
+static void* ThreadWriteBatch( void *data )
+{
+    sout_access_out_t *p_access = data;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    mtime_t i_date_last = -1;
+    unsigned i_dropped_packets = 0;
+    udp_stats_t stats;
+    udp_batch_t batch;
+
+    StatsReset( &stats, mdate() );
+    batch.count = 0;
+
+    vlc_cleanup_push( BatchCleanup, &batch );
+    for (;;)
+    {
+        block_t *p_pk = block_FifoGet( p_sys->p_fifo );
+        mtime_t i_date = p_sys->i_caching + p_pk->i_dts;
+
+        if( CheckDate( p_access, i_date, &i_date_last, &i_dropped_packets ) )
+        {
+            block_FifoPut( p_sys->p_empty_blocks, p_pk );
+            continue;
+        }
+
+        /* The first packet of a batch, and thus every PCR, is sent on time */
+        batch.pkts[0] = p_pk;
+        batch.count = 1;
+        mwait( i_date );
+
+        /* Add the queued packets due within the window, up to the next PCR */
+        const mtime_t i_window_end = i_date + p_sys->i_batch_window;
+        while( batch.count < UDP_BATCH_MAX
+            && block_FifoCount( p_sys->p_fifo ) > 0 )
+        {
+            block_t *p_next = block_FifoShow( p_sys->p_fifo );
+
+            if( (p_next->i_flags & BLOCK_FLAG_CLOCK)
+             || p_sys->i_caching + p_next->i_dts > i_window_end )
+                break;
+            p_next = block_FifoGet( p_sys->p_fifo );
+            batch.pkts[batch.count++] = p_next;
+        }
+
+        for( unsigned i = 0; i < batch.count; i++ )
+        {
+            batch.iov[i].iov_base = batch.pkts[i]->p_buffer;
+            batch.iov[i].iov_len = batch.pkts[i]->i_buffer;
+            memset( &batch.msgs[i].msg_hdr, 0,
+                    sizeof( batch.msgs[i].msg_hdr ) );
+            batch.msgs[i].msg_hdr.msg_iov = &batch.iov[i];
+            batch.msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        for( unsigned i_done = 0; i_done < batch.count; )
+        {
+            int val = sendmmsg( p_sys->i_handle, batch.msgs + i_done,
+                                batch.count - i_done, 0 );
+            stats.i_calls++;
+            if( val == -1 )
+            {
+                msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+                break;
+            }
+            i_done += val;
+        }
+
+        const mtime_t i_sent = mdate();
+        if ( i_sent > i_date + 20000 )
+            msg_Dbg( p_access, "packet has been sent too late (%"PRId64 ")",
+                     i_sent - i_date );
+
+        for( unsigned i = 0; i < batch.count; i++ )
+        {
+            i_date_last = p_sys->i_caching + batch.pkts[i]->i_dts;
+            StatsUpdate( &stats, i_sent - i_date_last );
+            block_FifoPut( p_sys->p_empty_blocks, batch.pkts[i] );
+        }
+        batch.count = 0;
+        StatsReport( p_access, &stats, i_sent );
+    }
+    vlc_cleanup_pop();
+    return NULL;
+}
+#endif
@@ -1748,6 +1748,14 @@ static int updateStatistics( intf_thread_t *p_intf, input_item_t *p_item )
             (float)(p_item->p_stats->i_read_bytes)/1024 );
     msg_rc(_("| input bitrate    :   %6.0f kb/s"),
             (float)(p_item->p_stats->f_input_bitrate)*8000 );
+    msg_rc(_("| cache hits       :    %5"PRIi64),
+            p_item->p_stats->i_cache_hits );
+    msg_rc(_("| cache misses     :    %5"PRIi64),
+            p_item->p_stats->i_cache_misses );
+    msg_rc(_("| packets received :   %6.0f /s"),
+            (float)(p_item->p_stats->f_recv_packet_rate)*1000000 );
+    msg_rc(_("| receive syscalls :   %6.0f /s"),
+            (float)(p_item->p_stats->f_recv_syscall_rate)*1000000 );
     msg_rc(_("| demux bytes read : %8.0f KiB"),
             (float)(p_item->p_stats->i_demux_read_bytes)/1024 );
     msg_rc(_("| demux bitrate    :   %6.0f kb/s"),
@@ -193,6 +193,22 @@ struct demux_sys_t
 
     unsigned int       i_attachment;
     input_attachment_t **attachment;
+
+    /* Index rebuilt by a thread while playing, see AVI_IndexCreate */
+    bool               b_index_rebuild;
+    bool               b_index_thread;
+    vlc_thread_t       index_thread;
+    vlc_mutex_t        index_lock;
+    bool               b_index_abort;    /* protected by index_lock */
+    bool               b_index_done;     /* protected by index_lock */
+    double             f_index_progress; /* protected by index_lock */
+    double             f_index_reported;
+    bool               b_index_scanned;
+    avi_index_t        *p_index_rebuilt; /* one per track */
+    off_t              i_index_lastchunk_pos;
+
+    /* Rebuilt index kept across sessions */
+    demux_seek_index_t *p_index_cache;
 };
 
 static inline off_t __EVEN( off_t i )
@@ -215,13 +231,16 @@ static int AVI_StreamBytesSet ( demux_t *,
 vlc_fourcc_t AVI_FourccGetCodec( unsigned int i_cat, vlc_fourcc_t );
 static int   AVI_GetKeyFlag    ( vlc_fourcc_t , uint8_t * );
 
-static int AVI_PacketGetHeader( demux_t *, avi_packet_t *p_pk );
-static int AVI_PacketNext     ( demux_t * );
+static int AVI_PacketGetHeader( stream_t *, avi_packet_t *p_pk );
+static int AVI_PacketNext     ( stream_t * );
 static int AVI_PacketRead     ( demux_t *, avi_packet_t *, block_t **);
-static int AVI_PacketSearch   ( demux_t * );
+static int AVI_PacketSearch   ( demux_t *, stream_t * );
 
 static void AVI_IndexLoad    ( demux_t * );
 static void AVI_IndexCreate  ( demux_t * );
+static void AVI_IndexRebuildCheck( demux_t * );
+static void AVI_IndexRebuildStop ( demux_t * );
+static int  AVI_IndexCacheLoad   ( demux_t * );
 
 static void AVI_ExtractSubtitle( demux_t *, unsigned int i_stream, avi_chunk_list_t *, avi_chunk_STRING_t * );
 
@@ -684,7 +703,7 @@ aviindex:
             AVI_IndexLoad( p_demux );
         }
     }
-    else
+    else if( AVI_IndexCacheLoad( p_demux ) )
     {
         AVI_IndexLoad( p_demux );
     }
@@ -797,6 +816,10 @@ aviindex:
     return VLC_SUCCESS;
 
 error:
+    AVI_IndexRebuildStop( p_demux );
+    if( p_sys->p_index_cache )
+        demux_SeekIndexClose( p_sys->p_index_cache );
+
     for( unsigned i = 0; i < p_sys->i_attachment; i++)
         vlc_input_attachment_Delete(p_sys->attachment[i]);
     free(p_sys->attachment);
@@ -817,6 +840,10 @@ static void Close ( vlc_object_t * p_this )
     demux_t *    p_demux = (demux_t *)p_this;
     demux_sys_t *p_sys = p_demux->p_sys  ;
 
+    AVI_IndexRebuildStop( p_demux );
+    if( p_sys->p_index_cache )
+        demux_SeekIndexClose( p_sys->p_index_cache );
+
     for( unsigned int i = 0; i < p_sys->i_track; i++ )
     {
         if( p_sys->track[i] )
@@ -943,6 +970,7 @@ static int Demux_Seekable( demux_t *p_demux )
     /* cannot be more than 100 stream (dcXX or wbXX) */
     avi_track_toread_t toread[100];
 
+    AVI_IndexRebuildCheck( p_demux );
 
     /* detect new selected/unselected streams */
     for( i_track = 0; i_track < p_sys->i_track; i_track++ )
@@ -1084,7 +1112,7 @@ static int Demux_Seekable( demux_t *p_demux )
             if( p_sys->i_movi_lastchunk_pos >= p_sys->i_movi_begin + 12 )
             {
                 stream_Seek( p_demux->s, p_sys->i_movi_lastchunk_pos );
-                if( AVI_PacketNext( p_demux ) )
+                if( AVI_PacketNext( p_demux->s ) )
                 {
                     return( AVI_TrackStopFinishedStreams( p_demux ) ? 0 : 1 );
                 }
@@ -1098,7 +1126,7 @@ static int Demux_Seekable( demux_t *p_demux )
             {
                 avi_packet_t avi_pk;
 
-                if( AVI_PacketGetHeader( p_demux, &avi_pk ) )
+                if( AVI_PacketGetHeader( p_demux->s, &avi_pk ) )
                 {
                     msg_Warn( p_demux,
                              "cannot get packet header, track disabled" );
@@ -1107,7 +1135,7 @@ static int Demux_Seekable( demux_t *p_demux )
                 if( avi_pk.i_stream >= p_sys->i_track ||
                     ( avi_pk.i_cat != AUDIO_ES && avi_pk.i_cat != VIDEO_ES ) )
                 {
-                    if( AVI_PacketNext( p_demux ) )
+                    if( AVI_PacketNext( p_demux->s ) )
                     {
                         msg_Warn( p_demux,
                                   "cannot skip packet, track disabled" );
@@ -1149,7 +1177,7 @@ static int Demux_Seekable( demux_t *p_demux )
                     }
                     else
                     {
-                        if( AVI_PacketNext( p_demux ) )
+                        if( AVI_PacketNext( p_demux->s ) )
                         {
                             msg_Warn( p_demux,
                                       "cannot skip packet, track disabled" );
@@ -1329,7 +1357,7 @@ static int Demux_UnSeekable( demux_t *p_demux )
 
         avi_packet_t    avi_pk;
 
-        if( AVI_PacketGetHeader( p_demux, &avi_pk ) )
+        if( AVI_PacketGetHeader( p_demux->s, &avi_pk ) )
         {
             return( 0 );
         }
@@ -1346,17 +1374,17 @@ static int Demux_UnSeekable( demux_t *p_demux )
                 case AVIFOURCC_JUNK:
                 case AVIFOURCC_LIST:
                 case AVIFOURCC_RIFF:
-                    return( !AVI_PacketNext( p_demux ) ? 1 : 0 );
+                    return( !AVI_PacketNext( p_demux->s ) ? 1 : 0 );
                 case AVIFOURCC_idx1:
                     if( p_sys->b_odml )
                     {
-                        return( !AVI_PacketNext( p_demux ) ? 1 : 0 );
+                        return( !AVI_PacketNext( p_demux->s ) ? 1 : 0 );
                     }
                     return( 0 );    /* eof */
                 default:
                     msg_Warn( p_demux,
                               "seems to have lost position, resync" );
-                    if( AVI_PacketSearch( p_demux ) )
+                    if( AVI_PacketSearch( p_demux, p_demux->s ) )
                     {
                         msg_Err( p_demux, "resync failed" );
                         return( -1 );
@@ -1391,7 +1419,7 @@ static int Demux_UnSeekable( demux_t *p_demux )
             }
             else
             {
-                if( AVI_PacketNext( p_demux ) )
+                if( AVI_PacketNext( p_demux->s ) )
                 {
                     return( 0 );
                 }
@@ -1424,6 +1452,8 @@ static int Demux_UnSeekable( demux_t *p_demux )
 static int Seek( demux_t *p_demux, mtime_t i_date, int i_percent )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
+
+    AVI_IndexRebuildCheck( p_demux );
     msg_Dbg( p_demux, "seek requested: %"PRId64" seconds %d%%",
              i_date / 1000000, i_percent );
 
@@ -1654,6 +1684,20 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             return VLC_SUCCESS;
         }
 
+        case DEMUX_GET_INDEX_PROGRESS:
+            if( !p_sys->b_index_rebuild )
+                return VLC_EGENERIC;
+            pf = (double*)va_arg( args, double * );
+            if( p_sys->b_index_thread )
+            {
+                vlc_mutex_lock( &p_sys->index_lock );
+                *pf = p_sys->f_index_progress;
+                vlc_mutex_unlock( &p_sys->index_lock );
+            }
+            else
+                *pf = 1.0;
+            return VLC_SUCCESS;
+
         default:
             return VLC_EGENERIC;
     }
@@ -1750,7 +1794,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
     if( p_sys->i_movi_lastchunk_pos >= p_sys->i_movi_begin + 12 )
     {
         stream_Seek( p_demux->s, p_sys->i_movi_lastchunk_pos );
-        if( AVI_PacketNext( p_demux ) )
+        if( AVI_PacketNext( p_demux->s ) )
         {
             return VLC_EGENERIC;
         }
@@ -1764,7 +1808,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
     {
         if( !vlc_object_alive (p_demux) ) return VLC_EGENERIC;
 
-        if( AVI_PacketGetHeader( p_demux, &avi_pk ) )
+        if( AVI_PacketGetHeader( p_demux->s, &avi_pk ) )
         {
             msg_Warn( p_demux, "cannot get packet header" );
             return VLC_EGENERIC;
@@ -1772,7 +1816,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
         if( avi_pk.i_stream >= p_sys->i_track ||
             ( avi_pk.i_cat != AUDIO_ES && avi_pk.i_cat != VIDEO_ES ) )
         {
-            if( AVI_PacketNext( p_demux ) )
+            if( AVI_PacketNext( p_demux->s ) )
             {
                 return VLC_EGENERIC;
             }
@@ -1807,7 +1851,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, unsigned int i_stream )
                 return VLC_SUCCESS;
             }
 
-            if( AVI_PacketNext( p_demux ) )
+            if( AVI_PacketNext( p_demux->s ) )
             {
                 return VLC_EGENERIC;
             }
@@ -1906,6 +1950,25 @@ static int AVI_StreamBytesSet( demux_t    *p_demux,
     }
 }
 
+/* Number of VBR audio blocks before the current chunk */
+static unsigned int AVI_GetBlockNumber( const avi_track_t *tk )
+{
+    unsigned int i_blockno = 0;
+
+    for( unsigned int i = 0; i < tk->i_idxposc; i++ )
+    {
+        if( tk->i_blocksize > 0 )
+        {
+            i_blockno += ( tk->idx.p_entry[i].i_length + tk->i_blocksize - 1 ) / tk->i_blocksize;
+        }
+        else
+        {
+            i_blockno++;
+        }
+    }
+    return i_blockno;
+}
+
 static int AVI_TrackSeek( demux_t *p_demux,
                            int i_stream,
                            mtime_t i_date )
@@ -1928,21 +1991,7 @@ static int AVI_TrackSeek( demux_t *p_demux,
         }
 
         if( p_stream->i_cat == AUDIO_ES )
-        {
-            unsigned int i;
-            tk->i_blockno = 0;
-            for( i = 0; i < tk->i_idxposc; i++ )
-            {
-                if( tk->i_blocksize > 0 )
-                {
-                    tk->i_blockno += ( tk->idx.p_entry[i].i_length + tk->i_blocksize - 1 ) / tk->i_blocksize;
-                }
-                else
-                {
-                    tk->i_blockno++;
-                }
-            }
-        }
+            tk->i_blockno = AVI_GetBlockNumber( tk );
 
         msg_Dbg( p_demux,
                  "old:%"PRId64" %s new %"PRId64,
@@ -2105,17 +2154,17 @@ static void AVI_ParseStreamHeader( vlc_fourcc_t i_id,
 /****************************************************************************
  *
  ****************************************************************************/
-static int AVI_PacketGetHeader( demux_t *p_demux, avi_packet_t *p_pk )
+static int AVI_PacketGetHeader( stream_t *s, avi_packet_t *p_pk )
 {
     const uint8_t *p_peek;
 
-    if( stream_Peek( p_demux->s, &p_peek, 16 ) < 16 )
+    if( stream_Peek( s, &p_peek, 16 ) < 16 )
     {
         return VLC_EGENERIC;
     }
     p_pk->i_fourcc  = VLC_FOURCC( p_peek[0], p_peek[1], p_peek[2], p_peek[3] );
     p_pk->i_size    = GetDWLE( p_peek + 4 );
-    p_pk->i_pos     = stream_Tell( p_demux->s );
+    p_pk->i_pos     = stream_Tell( s );
     if( p_pk->i_fourcc == AVIFOURCC_LIST || p_pk->i_fourcc == AVIFOURCC_RIFF )
     {
         p_pk->i_type = VLC_FOURCC( p_peek[8],  p_peek[9],
@@ -2132,12 +2181,12 @@ static int AVI_PacketGetHeader( demux_t *p_demux, avi_packet_t *p_pk )
     return VLC_SUCCESS;
 }
 
-static int AVI_PacketNext( demux_t *p_demux )
+static int AVI_PacketNext( stream_t *s )
 {
     avi_packet_t    avi_ck;
     int             i_skip = 0;
 
-    if( AVI_PacketGetHeader( p_demux, &avi_ck ) )
+    if( AVI_PacketGetHeader( s, &avi_ck ) )
     {
         return VLC_EGENERIC;
     }
@@ -2157,7 +2206,7 @@ static int AVI_PacketNext( demux_t *p_demux )
         i_skip = __EVEN( avi_ck.i_size ) + 8;
     }
 
-    if( stream_Read( p_demux->s, NULL, i_skip ) != i_skip )
+    if( stream_Read( s, NULL, i_skip ) != i_skip )
     {
         return VLC_EGENERIC;
     }
@@ -2187,7 +2236,7 @@ static int AVI_PacketRead( demux_t   *p_demux,
     return VLC_SUCCESS;
 }
 
-static int AVI_PacketSearch( demux_t *p_demux )
+static int AVI_PacketSearch( demux_t *p_demux, stream_t *s )
 {
     demux_sys_t     *p_sys = p_demux->p_sys;
     avi_packet_t    avi_pk;
@@ -2195,11 +2244,11 @@ static int AVI_PacketSearch( demux_t *p_demux )
 
     for( ;; )
     {
-        if( stream_Read( p_demux->s, NULL, 1 ) != 1 )
+        if( stream_Read( s, NULL, 1 ) != 1 )
         {
             return VLC_EGENERIC;
         }
-        AVI_PacketGetHeader( p_demux, &avi_pk );
+        AVI_PacketGetHeader( s, &avi_pk );
         if( avi_pk.i_stream < p_sys->i_track &&
             ( avi_pk.i_cat == AUDIO_ES || avi_pk.i_cat == VIDEO_ES ) )
         {
@@ -2517,18 +2566,111 @@ static void AVI_IndexLoad( demux_t *p_demux )
     }
 }
 
-static void AVI_IndexCreate( demux_t *p_demux )
+/* Entry of the rebuilt index kept in the seek index cache */
+typedef struct
+{
+    uint64_t i_pos;
+    uint32_t i_length;
+    uint32_t i_flags;
+} avi_cache_entry_t;
+
+static int AVI_IndexCacheLoad( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
+    int64_t i_tracks;
+
+    if( !p_sys->p_index_cache )
+        p_sys->p_index_cache = demux_SeekIndexOpen( p_demux, "avi", 0 );
+    if( !p_sys->p_index_cache ||
+        demux_SeekIndexGetValue( p_sys->p_index_cache, "tracks", &i_tracks ) ||
+        i_tracks != p_sys->i_track )
+        return VLC_EGENERIC;
+
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+    {
+        char psz_name[16];
+        size_t i_size;
+
+        snprintf( psz_name, sizeof(psz_name), "track%u", i );
+        if( !demux_SeekIndexGetData( p_sys->p_index_cache, psz_name, &i_size ) ||
+            i_size % sizeof(avi_cache_entry_t) )
+            return VLC_EGENERIC;
+    }
+
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+    {
+        avi_index_t *p_index = &p_sys->track[i]->idx;
+        const avi_cache_entry_t *p_entries;
+        char psz_name[16];
+        size_t i_size;
+
+        snprintf( psz_name, sizeof(psz_name), "track%u", i );
+        p_entries = demux_SeekIndexGetData( p_sys->p_index_cache, psz_name,
+                                            &i_size );
+
+        avi_index_Clean( p_index );
+        avi_index_Init( p_index );
+        for( size_t j = 0; j < i_size / sizeof(*p_entries); j++ )
+        {
+            avi_entry_t index;
+            index.i_id      = 0;
+            index.i_flags   = p_entries[j].i_flags;
+            index.i_pos     = p_entries[j].i_pos;
+            index.i_length  = p_entries[j].i_length;
+            avi_index_Append( p_index, &p_sys->i_movi_lastchunk_pos, &index );
+        }
+        msg_Dbg( p_demux, "stream[%u] loaded %u rebuilt index entries",
+                 i, p_index->i_size );
+    }
+    return VLC_SUCCESS;
+}
+
+static void AVI_IndexCacheSave( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->p_index_cache )
+        return;
+
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+    {
+        const avi_index_t *p_index = &p_sys->track[i]->idx;
+        avi_cache_entry_t *p_entries;
+        char psz_name[16];
+
+        p_entries = malloc( __MAX( p_index->i_size, 1 ) * sizeof(*p_entries) );
+        if( !p_entries )
+            return;
+        for( unsigned j = 0; j < p_index->i_size; j++ )
+        {
+            p_entries[j].i_pos    = p_index->p_entry[j].i_pos;
+            p_entries[j].i_length = p_index->p_entry[j].i_length;
+            p_entries[j].i_flags  = p_index->p_entry[j].i_flags;
+        }
+        snprintf( psz_name, sizeof(psz_name), "track%u", i );
+        int i_ret = demux_SeekIndexSetData( p_sys->p_index_cache, psz_name,
+                        p_entries, p_index->i_size * sizeof(*p_entries) );
+        free( p_entries );
+        if( i_ret )
+            return;
+    }
+    demux_SeekIndexSetValue( p_sys->p_index_cache, "tracks", p_sys->i_track );
+}
+
+/* Scans the movi chunks of the file on a stream of its own */
+static void *AVI_IndexThread( void *data )
+{
+    demux_t     *p_demux = data;
+    demux_sys_t *p_sys = p_demux->p_sys;
+    avi_index_t *p_idx = p_sys->p_index_rebuilt;
 
     avi_chunk_list_t *p_riff;
     avi_chunk_list_t *p_movi;
 
-    unsigned int i_stream;
+    stream_t *s;
+    char *psz_url;
     off_t i_movi_end;
-
-    mtime_t i_dialog_update;
-    dialog_progress_bar_t *p_dialog = NULL;
+    mtime_t i_progress_update;
 
     p_riff = AVI_ChunkFind( &p_sys->ck_root, AVIFOURCC_RIFF, 0);
     p_movi = AVI_ChunkFind( p_riff, AVIFOURCC_movi, 0);
@@ -2536,47 +2678,48 @@ static void AVI_IndexCreate( demux_t *p_demux )
     if( !p_movi )
     {
         msg_Err( p_demux, "cannot find p_movi" );
-        return;
+        goto done;
     }
 
-    for( i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
-        avi_index_Init( &p_sys->track[i_stream]->idx );
+    if( asprintf( &psz_url, "%s://%s", p_demux->psz_access,
+                  p_demux->psz_location ) == -1 )
+        goto done;
+    s = stream_UrlNew( p_demux, psz_url );
+    free( psz_url );
+    if( !s )
+    {
+        msg_Err( p_demux, "cannot reopen the file to create the index" );
+        goto done;
+    }
+    p_sys->b_index_scanned = true;
 
     i_movi_end = __MIN( (off_t)(p_movi->i_chunk_pos + p_movi->i_chunk_size),
-                        stream_Size( p_demux->s ) );
+                        stream_Size( s ) );
 
-    stream_Seek( p_demux->s, p_movi->i_chunk_pos + 12 );
+    stream_Seek( s, p_movi->i_chunk_pos + 12 );
     msg_Warn( p_demux, "creating index from LIST-movi, will take time !" );
 
-
-    /* Only show dialog if AVI is > 10MB */
-    i_dialog_update = mdate();
-    if( stream_Size( p_demux->s ) > 10000000 )
-        p_dialog = dialog_ProgressCreate( p_demux, _("Fixing AVI Index..."),
-                                       NULL, _("Cancel") );
-
+    i_progress_update = mdate();
     for( ;; )
     {
         avi_packet_t pk;
 
-        if( !vlc_object_alive (p_demux) )
-            break;
-
-        /* Don't update/check dialog too often */
-        if( p_dialog && mdate() - i_dialog_update > 100000 )
+        vlc_mutex_lock( &p_sys->index_lock );
+        bool b_abort = p_sys->b_index_abort;
+        /* Don't update the progress too often */
+        if( mdate() - i_progress_update > 100000 && stream_Size( s ) > 0 )
         {
-            if( dialog_ProgressCancelled( p_dialog ) )
-                break;
-
-            double f_current = stream_Tell( p_demux->s );
-            double f_size    = stream_Size( p_demux->s );
-            double f_pos     = f_current / f_size;
-            dialog_ProgressSet( p_dialog, NULL, f_pos );
-
-            i_dialog_update = mdate();
+            double f_current = stream_Tell( s );
+            double f_size    = stream_Size( s );
+            p_sys->f_index_progress = f_current / f_size;
+            i_progress_update = mdate();
         }
+        vlc_mutex_unlock( &p_sys->index_lock );
+
+        if( b_abort )
+            break;
 
-        if( AVI_PacketGetHeader( p_demux, &pk ) )
+        if( AVI_PacketGetHeader( s, &pk ) )
             break;
 
         if( pk.i_stream < p_sys->i_track &&
@@ -2590,7 +2733,8 @@ static void AVI_IndexCreate( demux_t *p_demux )
             index.i_pos     = pk.i_pos;
             index.i_length  = pk.i_size;
             index.i_lengthtotal = pk.i_size;
-            avi_index_Append( &tk->idx, &p_sys->i_movi_lastchunk_pos, &index );
+            avi_index_Append( &p_idx[pk.i_stream],
+                              &p_sys->i_index_lastchunk_pos, &index );
         }
         else
         {
@@ -2604,7 +2748,7 @@ static void AVI_IndexCreate( demux_t *p_demux )
                                             AVIFOURCC_RIFF, 1 );
 
                     msg_Dbg( p_demux, "looking for new RIFF chunk" );
-                    if( stream_Seek( p_demux->s, p_sysx->i_chunk_pos + 24 ) )
+                    if( stream_Seek( s, p_sysx->i_chunk_pos + 24 ) )
                         goto print_stat;
                     break;
                 }
@@ -2620,7 +2764,7 @@ static void AVI_IndexCreate( demux_t *p_demux )
 
             default:
                 msg_Warn( p_demux, "need resync, probably broken avi" );
-                if( AVI_PacketSearch( p_demux ) )
+                if( AVI_PacketSearch( p_demux, s ) )
                 {
                     msg_Warn( p_demux, "lost sync, abord index creation" );
                     goto print_stat;
@@ -2629,21 +2773,178 @@ static void AVI_IndexCreate( demux_t *p_demux )
         }
 
         if( ( !p_sys->b_odml && pk.i_pos + pk.i_size >= i_movi_end ) ||
-            AVI_PacketNext( p_demux ) )
+            AVI_PacketNext( s ) )
         {
             break;
         }
     }
 
 print_stat:
-    if( p_dialog != NULL )
-        dialog_ProgressDestroy( p_dialog );
+    stream_Delete( s );
 
-    for( i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
+    for( unsigned i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
     {
         msg_Dbg( p_demux, "stream[%d] creating %d index entries",
-                i_stream, p_sys->track[i_stream]->idx.i_size );
+                i_stream, p_idx[i_stream].i_size );
+    }
+
+done:
+    vlc_mutex_lock( &p_sys->index_lock );
+    p_sys->b_index_done = true;
+    p_sys->f_index_progress = 1.0;
+    vlc_mutex_unlock( &p_sys->index_lock );
+    return NULL;
+}
+
+/* Rebuilds the index from the movi chunks. An index rebuilt by an earlier
+ * session is used as is. Otherwise the index of the file is loaded so that
+ * playback can start right away, and a thread scans the file meanwhile.
+ * The rebuilt index replaces the loaded one once complete, see
+ * AVI_IndexRebuildCheck(). */
+static void AVI_IndexCreate( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( p_sys->b_index_rebuild )
+        return;
+
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+    {
+        avi_index_Clean( &p_sys->track[i]->idx );
+        avi_index_Init( &p_sys->track[i]->idx );
+    }
+    if( !AVI_IndexCacheLoad( p_demux ) )
+        return;
+
+    AVI_IndexLoad( p_demux );
+
+    p_sys->p_index_rebuilt = malloc( p_sys->i_track * sizeof(avi_index_t) );
+    if( !p_sys->p_index_rebuilt )
+        return;
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+        avi_index_Init( &p_sys->p_index_rebuilt[i] );
+    p_sys->i_index_lastchunk_pos = 0;
+    p_sys->b_index_abort = false;
+    p_sys->b_index_done = false;
+    p_sys->b_index_scanned = false;
+    p_sys->f_index_progress = 0.0;
+    p_sys->f_index_reported = -1.0;
+
+    vlc_mutex_init( &p_sys->index_lock );
+    if( vlc_clone( &p_sys->index_thread, AVI_IndexThread, p_demux,
+                   VLC_THREAD_PRIORITY_LOW ) )
+    {
+        vlc_mutex_destroy( &p_sys->index_lock );
+        free( p_sys->p_index_rebuilt );
+        p_sys->p_index_rebuilt = NULL;
+        return;
     }
+    p_sys->b_index_thread = true;
+    p_sys->b_index_rebuild = true;
+}
+
+static void AVI_IndexRebuildStop( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->b_index_thread )
+        return;
+
+    vlc_mutex_lock( &p_sys->index_lock );
+    p_sys->b_index_abort = true;
+    vlc_mutex_unlock( &p_sys->index_lock );
+    vlc_join( p_sys->index_thread, NULL );
+    vlc_mutex_destroy( &p_sys->index_lock );
+    p_sys->b_index_thread = false;
+
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+        avi_index_Clean( &p_sys->p_index_rebuilt[i] );
+    free( p_sys->p_index_rebuilt );
+    p_sys->p_index_rebuilt = NULL;
+}
+
+/* Returns the first entry at or after a file position */
+static unsigned int avi_index_Find( const avi_index_t *p_index, off_t i_pos )
+{
+    unsigned int i_low = 0, i_high = p_index->i_size;
+
+    while( i_low < i_high )
+    {
+        unsigned int i_mid = ( i_low + i_high ) / 2;
+        if( p_index->p_entry[i_mid].i_pos < i_pos )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    return i_low;
+}
+
+/* Replaces the index with the rebuilt one once the thread is done, keeping
+ * each track at the same chunk of the file */
+static void AVI_IndexRebuildCheck( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->b_index_thread )
+        return;
+
+    vlc_mutex_lock( &p_sys->index_lock );
+    bool b_done = p_sys->b_index_done;
+    double f_progress = p_sys->f_index_progress;
+    vlc_mutex_unlock( &p_sys->index_lock );
+
+    /* Let the input poll the progress */
+    if( f_progress != p_sys->f_index_reported )
+    {
+        p_sys->f_index_reported = f_progress;
+        p_demux->info.i_update |= INPUT_UPDATE_INDEX;
+    }
+    if( !b_done )
+        return;
+
+    vlc_join( p_sys->index_thread, NULL );
+    vlc_mutex_destroy( &p_sys->index_lock );
+    p_sys->b_index_thread = false;
+
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+    {
+        avi_track_t *tk = p_sys->track[i];
+        avi_index_t *p_rebuilt = &p_sys->p_index_rebuilt[i];
+        off_t i_pos;
+
+        if( p_rebuilt->i_size <= tk->idx.i_size )
+        {
+            avi_index_Clean( p_rebuilt );
+            continue;
+        }
+
+        if( tk->i_idxposc < tk->idx.i_size )
+            i_pos = tk->idx.p_entry[tk->i_idxposc].i_pos;
+        else if( tk->idx.i_size > 0 )
+            i_pos = tk->idx.p_entry[tk->idx.i_size - 1].i_pos + 1;
+        else
+            i_pos = stream_Tell( p_demux->s );
+
+        avi_index_Clean( &tk->idx );
+        tk->idx = *p_rebuilt;
+        tk->i_idxposc = avi_index_Find( &tk->idx, i_pos );
+        if( tk->i_idxposc >= tk->idx.i_size ||
+            tk->idx.p_entry[tk->i_idxposc].i_pos != i_pos )
+            tk->i_idxposb = 0;
+        if( tk->i_cat == AUDIO_ES && !tk->i_samplesize )
+            tk->i_blockno = AVI_GetBlockNumber( tk );
+
+        msg_Dbg( p_demux, "stream[%u] using %u rebuilt index entries",
+                 i, tk->idx.i_size );
+    }
+    free( p_sys->p_index_rebuilt );
+    p_sys->p_index_rebuilt = NULL;
+
+    p_sys->i_movi_lastchunk_pos = __MAX( p_sys->i_movi_lastchunk_pos,
+                                         p_sys->i_index_lastchunk_pos );
+    p_sys->i_length = AVI_MovieGetLength( p_demux );
+    if( p_sys->b_index_scanned )
+        AVI_IndexCacheSave( p_demux );
 }
 
 /* */
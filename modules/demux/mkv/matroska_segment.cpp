@@ -27,6 +27,7 @@
 #include "demux.hpp"
 #include "util.hpp"
 #include "Ebml_parser.hpp"
+#include "stream_io_callback.hpp"
 
 matroska_segment_c::matroska_segment_c( demux_sys_t & demuxer, EbmlStream & estream )
     :segment(NULL)
@@ -52,6 +53,8 @@ matroska_segment_c::matroska_segment_c( demux_sys_t & demuxer, EbmlStream & estr
     ,b_cues(false)
     ,i_index(0)
     ,i_index_max(1024)
+    ,b_index_thread(false)
+    ,b_index_abort(false)
     ,psz_muxing_application(NULL)
     ,psz_writing_application(NULL)
     ,psz_segment_filename(NULL)
@@ -64,10 +67,14 @@ matroska_segment_c::matroska_segment_c( demux_sys_t & demuxer, EbmlStream & estr
     ,b_ref_external_segments(false)
 {
     p_indexes = (mkv_index_t*)malloc( sizeof( mkv_index_t ) * i_index_max );
+    vlc_mutex_init( &index_lock );
 }
 
 matroska_segment_c::~matroska_segment_c()
 {
+    IndexStop();
+    vlc_mutex_destroy( &index_lock );
+
     for( size_t i_track = 0; i_track < tracks.size(); i_track++ )
     {
         delete tracks[i_track]->p_compression_data;
@@ -587,12 +594,27 @@ void matroska_segment_c::InformationCreate( )
 
 void matroska_segment_c::IndexAppendCluster( KaxCluster *cluster )
 {
-#define idx p_indexes[i_index]
+    IndexAppend( cluster->GetElementPosition(),
+                 cluster->GlobalTimecode() / (mtime_t) 1000 );
+}
+
+/* Inserts a cluster in the index, unless its position is already known */
+void matroska_segment_c::IndexAppend( int64_t i_position, mtime_t i_time )
+{
+    int i_idx = IndexFindPosition( i_position );
+
+    if( i_idx < i_index && p_indexes[i_idx].i_position == i_position )
+        return;
+
+    memmove( &p_indexes[i_idx + 1], &p_indexes[i_idx],
+             sizeof( mkv_index_t ) * ( i_index - i_idx ) );
+#define idx p_indexes[i_idx]
     idx.i_track       = -1;
     idx.i_block_number= -1;
-    idx.i_position    = cluster->GetElementPosition();
-    idx.i_time        = cluster->GlobalTimecode()/ (mtime_t) 1000;
+    idx.i_position    = i_position;
+    idx.i_time        = i_time;
     idx.b_key         = true;
+#undef idx
 
     i_index++;
     if( i_index >= i_index_max )
@@ -601,7 +623,178 @@ void matroska_segment_c::IndexAppendCluster( KaxCluster *cluster )
         p_indexes = (mkv_index_t*)xrealloc( p_indexes,
                                         sizeof( mkv_index_t ) * i_index_max );
     }
-#undef idx
+}
+
+/* Returns the last index entry not after i_time, or 0 if there is none.
+ * If i_track is not -1, the entry is preferably one of that track. */
+int matroska_segment_c::IndexFind( mtime_t i_time, int i_track ) const
+{
+    int i_low = 0, i_high = i_index;
+
+    while( i_low < i_high )
+    {
+        int i_mid = ( i_low + i_high ) / 2;
+        if( p_indexes[i_mid].i_time <= i_time )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    if( i_low == 0 )
+        return 0;
+
+    if( i_track != -1 )
+        for( int i_idx = i_low - 1; i_idx >= 0; i_idx-- )
+            if( p_indexes[i_idx].i_track == i_track ||
+                p_indexes[i_idx].i_track == -1 )
+                return i_idx;
+    return i_low - 1;
+}
+
+/* Returns the first index entry at or after i_position, or i_index */
+int matroska_segment_c::IndexFindPosition( int64_t i_position ) const
+{
+    int i_low = 0, i_high = i_index;
+
+    while( i_low < i_high )
+    {
+        int i_mid = ( i_low + i_high ) / 2;
+        if( p_indexes[i_mid].i_position < i_position )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    return i_low;
+}
+
+/* Adds the clusters found by the index thread so far */
+void matroska_segment_c::IndexMerge()
+{
+    if( !b_index_thread )
+        return;
+
+    vlc_mutex_locker l( &index_lock );
+    for( size_t i = 0; i < index_pending.size(); i++ )
+        IndexAppend( index_pending[i].i_position, index_pending[i].i_time );
+    index_pending.clear();
+}
+
+/*****************************************************************************
+ * Index thread: without cues, seeking has to read every cluster up to the
+ * requested position. This thread walks the cluster headers on a stream of
+ * its own, skipping their content, so the index fills up while playing.
+ *****************************************************************************/
+void matroska_segment_c::IndexStart()
+{
+    bool b_seekable;
+
+    /* Only the input itself can be reopened, not the linked files */
+    if( b_index_thread || b_cues || !sys.demuxer.psz_access ||
+        sys.streams.empty() || &es != sys.streams[0]->p_estream ||
+        stream_Control( sys.demuxer.s, STREAM_CAN_FASTSEEK, &b_seekable ) ||
+        !b_seekable )
+        return;
+
+    b_index_abort = false;
+    if( vlc_clone( &index_thread, IndexThread, this, VLC_THREAD_PRIORITY_LOW ) )
+        return;
+    b_index_thread = true;
+}
+
+void matroska_segment_c::IndexStop()
+{
+    if( !b_index_thread )
+        return;
+
+    vlc_mutex_lock( &index_lock );
+    b_index_abort = true;
+    vlc_mutex_unlock( &index_lock );
+    vlc_join( index_thread, NULL );
+
+    IndexMerge();
+    b_index_thread = false;
+}
+
+void *matroska_segment_c::IndexThread( void *data )
+{
+    matroska_segment_c *p_segment = static_cast<matroska_segment_c *>( data );
+
+    p_segment->IndexScan();
+    return NULL;
+}
+
+void matroska_segment_c::IndexScan()
+{
+    demux_t *p_demux = &sys.demuxer;
+    char *psz_url;
+    int i_clusters = 0;
+
+    if( asprintf( &psz_url, "%s://%s", p_demux->psz_access,
+                  p_demux->psz_location ) == -1 )
+        return;
+    stream_t *p_stream = stream_UrlNew( p_demux, psz_url );
+    free( psz_url );
+    if( !p_stream )
+        return;
+
+    vlc_stream_io_callback io( p_stream, true );
+    EbmlStream estream( io );
+
+    try
+    {
+        io.setFilePointer( i_start_pos, seek_beginning );
+        for( ;; )
+        {
+            vlc_mutex_lock( &index_lock );
+            bool b_abort = b_index_abort;
+            vlc_mutex_unlock( &index_lock );
+            if( b_abort )
+                break;
+
+            int i_ulev = 0;
+            EbmlElement *el = estream.FindNextElement( EBML_CONTEXT(segment),
+                                                       i_ulev, UINT64_MAX,
+                                                       true, 1 );
+            if( el == NULL || i_ulev > 0 || !el->IsFiniteSize() )
+            {
+                delete el;
+                break;
+            }
+
+            if( MKV_IS_ID( el, KaxCluster ) )
+            {
+                /* The cluster timecode comes first, read only that */
+                EbmlElement *child = estream.FindNextElement( EBML_CONTEXT(el),
+                                                              i_ulev, UINT64_MAX,
+                                                              false, 1 );
+                if( MKV_IS_ID( child, KaxClusterTimecode ) && i_ulev == 0 )
+                {
+                    KaxClusterTimecode &ctc = *(KaxClusterTimecode*)child;
+                    mkv_index_t idx;
+
+                    ctc.ReadData( io, SCOPE_ALL_DATA );
+                    idx.i_track        = -1;
+                    idx.i_block_number = -1;
+                    idx.i_position     = el->GetElementPosition();
+                    idx.i_time         = uint64( ctc ) * i_timescale / 1000;
+                    idx.b_key          = true;
+
+                    vlc_mutex_lock( &index_lock );
+                    index_pending.push_back( idx );
+                    vlc_mutex_unlock( &index_lock );
+                    i_clusters++;
+                }
+                delete child;
+            }
+
+            io.setFilePointer( el->GetEndPosition(), seek_beginning );
+            delete el;
+        }
+    }
+    catch(...)
+    {
+        msg_Warn( p_demux, "cluster index scan failed" );
+    }
+    msg_Dbg( p_demux, "cluster index scan found %d clusters", i_clusters );
 }
 
 bool matroska_segment_c::PreloadFamily( const matroska_segment_c & of_segment )
@@ -861,16 +1054,20 @@ void matroska_segment_c::Seek( mtime_t i_date, mtime_t i_time_offset, int64_t i_
     for( size_t i = 0; i < tracks.size(); i++)
         tracks[i]->i_last_dts = VLC_TS_INVALID;
 
+    IndexMerge();
+
     if( i_global_position >= 0 )
     {
         /* Special case for seeking in files with no cues */
         EbmlElement *el = NULL;
+        int i_known = IndexFindPosition( i_global_position );
 
-        /* Start from the last known index instead of the beginning eachtime */
-        if( i_index == 0)
+        /* Start from the last known cluster before the position instead of
+         * the beginning each time */
+        if( i_known == 0 )
             es.I_O().setFilePointer( i_start_pos, seek_beginning );
         else
-            es.I_O().setFilePointer( p_indexes[ i_index - 1 ].i_position,
+            es.I_O().setFilePointer( p_indexes[ i_known - 1 ].i_position,
                                      seek_beginning );
         delete ep;
         ep = new EbmlParser( &es, segment, &sys.demuxer );
@@ -882,9 +1079,9 @@ void matroska_segment_c::Seek( mtime_t i_date, mtime_t i_time_offset, int64_t i_
             {
                 cluster = (KaxCluster *)el;
                 i_cluster_pos = cluster->GetElementPosition();
-                if( i_index == 0 ||
-                    ( i_index > 0 &&
-                      p_indexes[i_index - 1].i_position < (int64_t)cluster->GetElementPosition() ) )
+                i_known = IndexFindPosition( i_cluster_pos );
+                if( i_known == i_index ||
+                    p_indexes[i_known].i_position != (int64_t)i_cluster_pos )
                 {
                     ParseCluster(false);
                     IndexAppendCluster( cluster );
@@ -915,13 +1112,16 @@ void matroska_segment_c::Seek( mtime_t i_date, mtime_t i_time_offset, int64_t i_
     int i_idx = 0;
     if ( i_index > 0 )
     {
-
-        for( ; i_idx < i_index; i_idx++ )
-            if( p_indexes[i_idx].i_time + i_time_offset > i_date )
+        /* Prefer the cues of the video track, they point at key frames */
+        int i_seek_track = -1;
+        for( i_track = 0; i_track < tracks.size(); i_track++ )
+            if( tracks[i_track]->fmt.i_cat == VIDEO_ES )
+            {
+                i_seek_track = tracks[i_track]->i_number;
                 break;
+            }
 
-        if( i_idx > 0 )
-            i_idx--;
+        i_idx = IndexFind( i_date - i_time_offset, i_seek_track );
 
         i_seek_position = p_indexes[i_idx].i_position;
         i_seek_time = p_indexes[i_idx].i_time;
@@ -1203,6 +1403,9 @@ bool matroska_segment_c::Select( mtime_t i_start_time )
     delete ep;
     ep = new EbmlParser( &es, segment, &sys.demuxer );
 
+    if( !b_cues )
+        IndexStart();
+
     return true;
 }
 
@@ -1364,10 +1567,7 @@ int matroska_segment_c::BlockGet( KaxBlock * & pp_block, KaxSimpleBlock * & pp_s
                         cluster->InitTimecode( uint64( ctc ), i_timescale );
 
                         /* add it to the index */
-                        if( i_index == 0 ||
-                            ( i_index > 0 &&
-                              p_indexes[i_index - 1].i_position < (int64_t)cluster->GetElementPosition() ) )
-                            IndexAppendCluster( cluster );
+                        IndexAppendCluster( cluster );
                     }
                     else if( MKV_IS_ID( el, KaxClusterSilentTracks ) )
                     {
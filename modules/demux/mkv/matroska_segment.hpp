@@ -109,7 +109,14 @@ public:
     bool                    b_cues;
     int                     i_index;
     int                     i_index_max;
-    mkv_index_t             *p_indexes;
+    mkv_index_t             *p_indexes; /* sorted by position */
+
+    /* clusters found by the index thread when there are no cues */
+    vlc_thread_t            index_thread;
+    vlc_mutex_t             index_lock;
+    bool                    b_index_thread;
+    bool                    b_index_abort;
+    std::vector<mkv_index_t> index_pending;
 
     /* info */
     char                    *psz_muxing_application;
@@ -145,6 +152,10 @@ public:
     bool Select( mtime_t i_start_time );
     void UnSelect();
 
+    int IndexFind( mtime_t i_time, int i_track = -1 ) const;
+    int IndexFindPosition( int64_t i_position ) const;
+    void IndexMerge();
+
     static bool CompareSegmentUIDs( const matroska_segment_c * item_a, const matroska_segment_c * item_b );
 
 private:
@@ -161,6 +172,11 @@ private:
     void ParseCluster( bool b_update_start_time = true );
     SimpleTag * ParseSimpleTags( KaxTagSimple *tag, int level = 50 );
     void IndexAppendCluster( KaxCluster *cluster );
+    void IndexAppend( int64_t i_position, mtime_t i_time );
+    void IndexStart();
+    void IndexStop();
+    void IndexScan();
+    static void *IndexThread( void * );
     int32_t TrackInit( mkv_track_t * p_tk );
     void ComputeTrackPriority();
 };
@@ -461,16 +461,17 @@ static void Seek( demux_t *p_demux, mtime_t i_date, double f_percent, virtual_ch
             int64_t i_pos = int64_t( f_percent * stream_Size( p_demux->s ) );
 
             msg_Dbg( p_demux, "lengthy way of seeking for pos:%"PRId64, i_pos );
-            for( i_index = 0; i_index < p_segment->i_index; i_index++ )
+            p_segment->IndexMerge();
+            for( i_index = p_segment->IndexFindPosition( i_pos );
+                 i_index < p_segment->i_index; i_index++ )
             {
-                if( p_segment->p_indexes[i_index].i_position >= i_pos &&
-                    p_segment->p_indexes[i_index].i_time > 0 )
+                if( p_segment->p_indexes[i_index].i_time > 0 )
                     break;
             }
             if( i_index == p_segment->i_index )
                 i_index--;
 
-            if( p_segment->p_indexes[i_index].i_position < i_pos )
+            if( i_index < 0 || p_segment->p_indexes[i_index].i_position < i_pos )
             {
                 msg_Dbg( p_demux, "no cues, seek request to global pos: %"PRId64, i_pos );
                 i_global_position = i_pos;
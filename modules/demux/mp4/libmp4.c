@@ -96,6 +96,7 @@ int MP4_ReadBoxCommon( stream_t *p_stream, MP4_Box_t *p_box )
     p_box->p_first  = NULL;
     p_box->p_last  = NULL;
     p_box->p_next   = NULL;
+    p_box->p_stream = NULL;
 
     MP4_GET4BYTES( p_box->i_shortsize );
     MP4_GETFOURCC( p_box->i_type );
@@ -3517,6 +3518,38 @@ static const struct
 };
 
 
+/*****************************************************************************
+ * MP4_BoxCanDefer : check if the payload of a box can be read later
+ *****************************************************************************
+ * The sample tables are the bulk of the moov box of long files, while they
+ * are only needed once a track is played.
+ *****************************************************************************/
+static bool MP4_BoxCanDefer( const MP4_Box_t *p_box )
+{
+    const MP4_Box_t *p_root;
+
+    switch( p_box->i_type )
+    {
+        case ATOM_stts:
+        case ATOM_ctts:
+        case ATOM_stss:
+        case ATOM_stsh:
+        case ATOM_stsc:
+        case ATOM_stco:
+        case ATOM_co64:
+        case ATOM_sdtp:
+            break;
+        default:
+            return false;
+    }
+
+    if( !p_box->p_father || p_box->p_father->i_type != ATOM_stbl )
+        return false;
+
+    for( p_root = p_box->p_father; p_root->p_father; p_root = p_root->p_father );
+    return p_root->i_type == ATOM_root && p_root->p_stream != NULL;
+}
+
 /*****************************************************************************
  * MP4_ReadBox : parse the actual box and the children
  *  XXX : Do not go to the next box
@@ -3543,6 +3576,13 @@ static MP4_Box_t *MP4_ReadBox( stream_t *p_stream, MP4_Box_t *p_father )
     }
     p_box->p_father = p_father;
 
+    if( MP4_BoxCanDefer( p_box ) )
+    {
+        /* Only keep the position, MP4_BoxGet will read the payload */
+        p_box->p_stream = p_stream;
+        return p_box;
+    }
+
     /* Now search function to call */
     for( i_index = 0; ; i_index++ )
     {
@@ -3721,6 +3761,13 @@ MP4_Box_t *MP4_BoxGetRoot( stream_t *s )
     p_root->p_last      = NULL;
     p_root->p_next      = NULL;
 
+    /* Reading a deferred box costs a seek */
+    bool b_fastseek;
+    if( stream_Control( s, STREAM_CAN_FASTSEEK, &b_fastseek ) || !b_fastseek )
+        p_root->p_stream = NULL;
+    else
+        p_root->p_stream = s;
+
     p_stream = s;
 
     /* First get the moov */
@@ -4000,6 +4047,50 @@ error_box:
     return;
 }
 
+/*****************************************************************************
+ * MP4_BoxLoad : read the payload of a deferred box
+ *****************************************************************************
+ * The stream position is left unchanged
+ *
+ * RETURN : 0 if it fail, 1 otherwise
+ *****************************************************************************/
+static int MP4_BoxLoad( MP4_Box_t *p_box )
+{
+    stream_t *p_stream = p_box->p_stream;
+    const int64_t i_pos = stream_Tell( p_stream );
+    unsigned int i_index;
+    int i_ret = 0;
+
+    for( i_index = 0; ; i_index++ )
+    {
+        if( ( MP4_Box_Function[i_index].i_type == p_box->i_type )||
+            ( MP4_Box_Function[i_index].i_type == 0 ) )
+        {
+            break;
+        }
+    }
+
+    if( !stream_Seek( p_stream, p_box->i_pos ) )
+        i_ret = (MP4_Box_Function[i_index].MP4_ReadBox_function)( p_stream, p_box );
+
+    if( i_ret )
+    {
+        p_box->p_stream = NULL;
+    }
+    else
+    {
+        msg_Warn( p_stream, "cannot load box %4.4s", (char*)&p_box->i_type );
+        if( p_box->data.p_payload )
+        {
+            MP4_Box_Function[i_index].MP4_FreeBox_function( p_box );
+            FREENULL( p_box->data.p_payload );
+        }
+    }
+
+    stream_Seek( p_stream, i_pos );
+    return i_ret;
+}
+
 /*****************************************************************************
  * MP4_BoxGet: find a box given a path relative to p_box
  *****************************************************************************
@@ -4018,6 +4109,11 @@ MP4_Box_t *MP4_BoxGet( MP4_Box_t *p_box, const char *psz_fmt, ... )
     MP4_BoxGet_Internal( &p_result, p_box, psz_fmt, args );
     va_end( args );
 
+    /* Load a deferred box */
+    if( p_result && p_result->p_stream && p_result->i_type != ATOM_root &&
+        !MP4_BoxLoad( p_result ) )
+        return NULL;
+
     return( p_result );
 }
 
@@ -1296,6 +1296,9 @@ typedef struct MP4_Box_s
 
     struct MP4_Box_s *p_next;   /* pointer on the next boxes at the same level */
 
+    stream_t     *p_stream;  /* root: stream to load deferred boxes from,
+                                other boxes: set until the payload is loaded */
+
 } MP4_Box_t;
 
 static inline size_t mp4_box_headersize( MP4_Box_t *p_box )
@@ -1437,6 +1440,9 @@ MP4_Box_t *MP4_BoxGetNextChunk( stream_t * );
  *****************************************************************************
  *  The first box is a virtual box "root" and is the father for all first
  *  level boxes
+ *  If the stream can seek fast, the sample tables are not read: only their
+ *  position is kept, and they are loaded by MP4_BoxGet on first access. The
+ *  stream must then outlive the boxes.
  *****************************************************************************/
 MP4_Box_t *MP4_BoxGetRoot( stream_t * );
 
@@ -1463,6 +1469,8 @@ void MP4_BoxDumpStructure( stream_t *p_input, MP4_Box_t *p_box );
  *
  * ex: /moov/trak[12]
  *     ../mdia
+ *
+ * A deferred box is loaded first, NULL is returned if that fails.
  *****************************************************************************/
 MP4_Box_t *MP4_BoxGet( MP4_Box_t *p_box, const char *psz_fmt, ... );
 
@@ -112,6 +112,7 @@ struct demux_sys_t
 static void MP4_TrackCreate ( demux_t *, mp4_track_t *, MP4_Box_t  *, bool b_force_enable );
 static int MP4_frg_TrackCreate( demux_t *, mp4_track_t *, MP4_Box_t *);
 static void MP4_TrackDestroy(  mp4_track_t * );
+static int  TrackCreateIndex( demux_t *, mp4_track_t * );
 
 static int  MP4_TrackSelect ( demux_t *, mp4_track_t *, mtime_t );
 static void MP4_TrackUnselect(demux_t *, mp4_track_t * );
@@ -199,35 +200,42 @@ static MP4_Box_t * MP4_GetTrakByTrackID( MP4_Box_t *p_moov, const uint32_t i_id
     return p_trak;
 }
 
-/* Return time in microsecond of a track */
-static inline int64_t MP4_TrackGetDTS( demux_t *p_demux, mp4_track_t *p_track )
+/* Return the decoding time of a sample of a chunk, relative to the first
+ * sample of the chunk, in track time scale */
+static inline int64_t MP4_ChunkGetDTSDelta( const mp4_chunk_t *ck,
+                                            uint32_t i_sample )
 {
-    demux_sys_t *p_sys = p_demux->p_sys;
-    mp4_chunk_t chunk;
-    if( p_sys->b_fragmented )
-        chunk = *p_track->cchunk;
-    else
-        chunk = p_track->chunk[p_track->i_chunk];
-
-    unsigned int i_index = 0;
-    unsigned int i_sample = p_track->i_sample - chunk.i_sample_first;
-    int64_t i_dts = chunk.i_first_dts;
+    uint32_t i_skip = ck->i_sample_skip_dts;
+    int64_t i_dts = 0;
 
-    while( i_sample > 0 )
+    for( unsigned i_index = 0; i_sample > 0; i_index++ )
     {
-        if( i_sample > chunk.p_sample_count_dts[i_index] )
-        {
-            i_dts += chunk.p_sample_count_dts[i_index] *
-                chunk.p_sample_delta_dts[i_index];
-            i_sample -= chunk.p_sample_count_dts[i_index];
-            i_index++;
-        }
-        else
+        uint32_t i_count = ck->p_sample_count_dts[i_index] - i_skip;
+
+        i_skip = 0;
+        if( i_sample <= i_count )
         {
-            i_dts += i_sample * chunk.p_sample_delta_dts[i_index];
+            i_dts += (int64_t)i_sample * ck->p_sample_delta_dts[i_index];
             break;
         }
+        i_dts += (int64_t)i_count * ck->p_sample_delta_dts[i_index];
+        i_sample -= i_count;
     }
+    return i_dts;
+}
+
+/* Return time in microsecond of a track */
+static inline int64_t MP4_TrackGetDTS( demux_t *p_demux, mp4_track_t *p_track )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const mp4_chunk_t *ck;
+    if( p_sys->b_fragmented )
+        ck = p_track->cchunk;
+    else
+        ck = &p_track->chunk[p_track->i_chunk];
+
+    int64_t i_dts = ck->i_first_dts +
+        MP4_ChunkGetDTSDelta( ck, p_track->i_sample - ck->i_sample_first );
 
     /* now handle elst */
     if( p_track->p_elst )
@@ -264,17 +272,21 @@ static inline int64_t MP4_TrackGetPTSDelta( demux_t *p_demux, mp4_track_t *p_tra
 
     unsigned int i_index = 0;
     unsigned int i_sample = p_track->i_sample - ck->i_sample_first;
+    uint32_t i_skip = ck->i_sample_skip_pts;
 
     if( ck->p_sample_count_pts == NULL || ck->p_sample_offset_pts == NULL )
         return -1;
 
     for( i_index = 0;; i_index++ )
     {
-        if( i_sample < ck->p_sample_count_pts[i_index] )
+        uint32_t i_count = ck->p_sample_count_pts[i_index] - i_skip;
+
+        i_skip = 0;
+        if( i_sample < i_count )
             return ck->p_sample_offset_pts[i_index] * CLOCK_FREQ /
                    (int64_t)p_track->i_timescale;
 
-        i_sample -= ck->p_sample_count_pts[i_index];
+        i_sample -= i_count;
     }
 }
 
@@ -976,7 +988,9 @@ static int Seek( demux_t *p_demux, mtime_t i_date )
     for( i_track = 0; i_track < p_sys->i_tracks; i_track++ )
     {
         mp4_track_t *tk = &p_sys->track[i_track];
-        MP4_TrackSeek( p_demux, tk, i_date );
+        /* tracks never selected are sought when they are */
+        if( tk->b_indexed )
+            MP4_TrackSeek( p_demux, tk, i_date );
     }
     MP4_UpdateSeekpoint( p_demux );
 
@@ -1560,6 +1574,9 @@ static void LoadChapterApple( demux_t  *p_demux, mp4_track_t *tk )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    if( TrackCreateIndex( p_demux, tk ) )
+        return;
+
     for( tk->i_sample = 0; tk->i_sample < tk->i_sample_count; tk->i_sample++ )
     {
         const int64_t i_dts = MP4_TrackGetDTS( p_demux, tk );
@@ -1674,8 +1691,10 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
         ck->i_first_dts = 0;
         ck->p_sample_count_dts = NULL;
         ck->p_sample_delta_dts = NULL;
+        ck->i_sample_skip_dts = 0;
         ck->p_sample_count_pts = NULL;
         ck->p_sample_offset_pts = NULL;
+        ck->i_sample_skip_pts = 0;
     }
 
     /* now we read index for SampleEntry( soun vide mp4a mp4v ...)
@@ -1723,63 +1742,12 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
     return VLC_SUCCESS;
 }
 
-static int xTTS_CountEntries( demux_t *p_demux, uint32_t *pi_entry /* out */,
-                              const uint32_t i_index,
-                              uint32_t i_index_samples_left,
-                              uint32_t i_sample_count,
-                              const uint32_t *pi_index_sample_count,
-                              const uint32_t i_table_count )
-{
-    uint32_t i_array_offset;
-    while( i_sample_count > 0 )
-    {
-        if ( likely((UINT32_MAX - i_index) >= *pi_entry) )
-            i_array_offset = i_index + *pi_entry;
-        else
-            return VLC_EGENERIC;
-
-        if ( i_array_offset >= i_table_count )
-        {
-            msg_Err( p_demux, "invalid index counting total samples %u %u", i_array_offset,  i_table_count );
-            return VLC_EGENERIC;
-        }
-
-        if ( i_index_samples_left )
-        {
-            if ( i_index_samples_left > i_sample_count )
-            {
-                i_index_samples_left -= i_sample_count;
-                i_sample_count = 0;
-                *pi_entry +=1; /* No samples left, go copy */
-                break;
-            }
-            else
-            {
-                i_sample_count -= i_index_samples_left;
-                i_index_samples_left = 0;
-                *pi_entry += 1;
-                continue;
-            }
-        }
-        else
-        {
-            i_sample_count -= __MIN( i_sample_count, pi_index_sample_count[i_array_offset] );
-            *pi_entry += 1;
-        }
-    }
-
-    return VLC_SUCCESS;
-}
-
-static int TrackCreateSamplesIndex( demux_t *p_demux,
-                                    mp4_track_t *p_demux_track )
+/* the sample sizes are needed to create the es, before the other indexes */
+static int TrackCreateSizesIndex( demux_t *p_demux,
+                                  mp4_track_t *p_demux_track )
 {
-    demux_sys_t *p_sys = p_demux->p_sys;
-
     MP4_Box_t *p_box;
     MP4_Box_data_stsz_t *stsz;
-    /* TODO use also stss and stsh table for seeking */
-    /* FIXME use edit table */
 
     /* Find stsz
      *  Gives the sample size for each samples. There is also a stz2 table
@@ -1793,7 +1761,7 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
     stsz = p_box->data.p_stsz;
 
-    /* Use stsz table to create a sample number -> sample size table */
+    /* Use stsz table as sample number -> sample size table */
     p_demux_track->i_sample_count = stsz->i_sample_count;
     if( stsz->i_sample_size )
     {
@@ -1805,43 +1773,47 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     {
         /* 2: each sample can have a different size */
         p_demux_track->i_sample_size = 0;
-        p_demux_track->p_sample_size =
-            calloc( p_demux_track->i_sample_count, sizeof( uint32_t ) );
-        if( p_demux_track->p_sample_size == NULL )
-            return VLC_ENOMEM;
-
-        for( uint32_t i_sample = 0; i_sample < p_demux_track->i_sample_count; i_sample++ )
-        {
-            p_demux_track->p_sample_size[i_sample] =
-                    stsz->i_entry_size[i_sample];
-        }
+        p_demux_track->p_sample_size = stsz->i_entry_size;
     }
 
-    if ( p_demux_track->i_chunk_count )
+    return VLC_SUCCESS;
+}
+
+static int TrackCreateSamplesIndex( demux_t *p_demux,
+                                    mp4_track_t *p_demux_track )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    MP4_Box_t *p_box;
+    /* TODO use also stss and stsh table for seeking */
+    /* FIXME use edit table */
+
+    /* The es may have changed i_sample_size since, use the stsz values */
+    p_box = MP4_BoxGet( p_demux_track->p_stbl, "stsz" );
+    if ( p_box && p_demux_track->i_chunk_count )
     {
+        MP4_Box_data_stsz_t *stsz = p_box->data.p_stsz;
         mp4_chunk_t *lastchunk = &p_demux_track->chunk[p_demux_track->i_chunk_count - 1];
         uint64_t i_total_size = lastchunk->i_offset;
         for( uint32_t i=0; i<lastchunk->i_sample_count; i++)
         {
-            if( p_demux_track->i_sample_size == 0 )
+            if( stsz->i_sample_size == 0 )
                 i_total_size += stsz->i_entry_size[i];
             else
-                i_total_size += p_demux_track->i_sample_size;
+                i_total_size += stsz->i_sample_size;
         }
 
         if ( i_total_size > p_sys->moovfragment.i_chunk_range_max_offset )
             p_sys->moovfragment.i_chunk_range_max_offset = i_total_size;
     }
 
-    /* Use stts table to create a sample number -> dts table.
+    /* Use stts table as sample number -> dts table.
      * XXX: if we don't want to waste too much memory, we can't expand
-     *  the box! so each chunk will contain an "extract" of this table
-     *  for fast research (problem with raw stream where a sample is sometime
+     *  the box! so each chunk only remembers where its samples start in
+     *  this run-length table, and times are decoded from there on demand
+     *  (problem with raw stream where a sample is sometime
      *  just channels*bits_per_sample/8 */
 
-     /* FIXME: refactor STTS & CTTS, STTS having now only few extra lines and
-      *        differing in 2/2 fields and 1 signedness */
-
     mtime_t i_next_dts = 0;
     /* Find stts
      *  Gives mapping between sample and decoding time
@@ -1858,93 +1830,44 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
 
         msg_Warn( p_demux, "STTS table of %"PRIu32" entries", stts->i_entry_count );
 
-        /* Create sample -> dts table per chunk */
+        /* Locate each chunk in the table */
         uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        uint32_t i_index_samples_used = 0; /* by the previous chunks */
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_entry, i_sample_count;
+            uint32_t i_sample_count = ck->i_sample_count;
 
             /* save first dts */
             ck->i_first_dts = i_next_dts;
             ck->i_last_dts  = i_next_dts;
 
-            /* count how many entries are needed for this chunk
-             * for p_sample_delta_dts and p_sample_count_dts */
-            i_entry = 0;
-
-            int i_ret = xTTS_CountEntries( p_demux, &i_entry, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           stts->pi_sample_count,
-                                           stts->i_entry_count );
-            if ( i_ret != VLC_SUCCESS )
-                return i_ret;
-
-            /* allocate them */
-            ck->p_sample_count_dts = calloc( i_entry, sizeof( uint32_t ) );
-            ck->p_sample_delta_dts = calloc( i_entry, sizeof( uint32_t ) );
-            if( !ck->p_sample_count_dts || !ck->p_sample_delta_dts )
-            {
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, i_entry );
-                return VLC_ENOMEM;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
+            ck->p_sample_count_dts = &stts->pi_sample_count[i_index];
+            ck->p_sample_delta_dts = (uint32_t *)&stts->pi_sample_delta[i_index];
+            ck->i_sample_skip_dts = i_index_samples_used;
 
-            for( uint32_t i = 0; i < i_entry; i++ )
+            while( i_sample_count > 0 )
             {
-                if ( i_current_index_samples_left )
+                if( i_index >= stts->i_entry_count )
                 {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        if ( i_sample_count ) ck->i_last_dts = i_next_dts;
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == i_entry - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        if ( i_current_index_samples_left ) ck->i_last_dts = i_next_dts;
-                        ck->p_sample_count_dts[i] = i_current_index_samples_left;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
+                    msg_Err( p_demux, "invalid index counting total samples %u %u",
+                             i_index, stts->i_entry_count );
+                    return VLC_EGENERIC;
                 }
-                else
+
+                uint32_t i_count = __MIN( stts->pi_sample_count[i_index] -
+                                          i_index_samples_used, i_sample_count );
+                if( i_count )
+                    ck->i_last_dts = i_next_dts;
+                i_next_dts += (mtime_t)i_count * stts->pi_sample_delta[i_index];
+                i_sample_count -= i_count;
+                i_index_samples_used += i_count;
+                if( i_index_samples_used == stts->pi_sample_count[i_index] )
                 {
-                    if ( stts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        if ( i_sample_count ) ck->i_last_dts = i_next_dts;
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        i_current_index_samples_left = stts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == i_entry - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        if ( stts->pi_sample_count[i_index] ) ck->i_last_dts = i_next_dts;
-                        ck->p_sample_count_dts[i] = stts->pi_sample_count[i_index];
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        i_sample_count -= stts->pi_sample_count[i_index];
-                        i_index++;
-                    }
+                    i_index++;
+                    i_index_samples_used = 0;
                 }
-
             }
         }
     }
@@ -1960,81 +1883,37 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
 
         msg_Warn( p_demux, "CTTS table of %"PRIu32" entries", ctts->i_entry_count );
 
-        /* Create pts-dts table per chunk */
+        /* Locate each chunk in the table */
         uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        uint32_t i_index_samples_used = 0; /* by the previous chunks */
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_entry, i_sample_count;
-
-            /* count how many entries are needed for this chunk
-             * for p_sample_offset_pts and p_sample_count_pts */
-            i_entry = 0;
-            int i_ret = xTTS_CountEntries( p_demux, &i_entry, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           ctts->pi_sample_count,
-                                           ctts->i_entry_count );
-            if ( i_ret != VLC_SUCCESS )
-                return i_ret;
-
-            /* allocate them */
-            ck->p_sample_count_pts = calloc( i_entry, sizeof( uint32_t ) );
-            ck->p_sample_offset_pts = calloc( i_entry, sizeof( int32_t ) );
-            if( !ck->p_sample_count_pts || !ck->p_sample_offset_pts )
-            {
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, i_entry );
-                return VLC_ENOMEM;
-            }
+            uint32_t i_sample_count = ck->i_sample_count;
 
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
+            ck->p_sample_count_pts = &ctts->pi_sample_count[i_index];
+            ck->p_sample_offset_pts = &ctts->pi_sample_offset[i_index];
+            ck->i_sample_skip_pts = i_index_samples_used;
 
-            for( uint32_t i = 0; i < i_entry; i++ )
+            while( i_sample_count > 0 )
             {
-                if ( i_current_index_samples_left )
+                if( i_index >= ctts->i_entry_count )
                 {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index];
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == i_entry - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = i_current_index_samples_left;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index];
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
+                    msg_Err( p_demux, "invalid index counting total samples %u %u",
+                             i_index, ctts->i_entry_count );
+                    return VLC_EGENERIC;
                 }
-                else
+
+                uint32_t i_count = __MIN( ctts->pi_sample_count[i_index] -
+                                          i_index_samples_used, i_sample_count );
+                i_sample_count -= i_count;
+                i_index_samples_used += i_count;
+                if( i_index_samples_used == ctts->pi_sample_count[i_index] )
                 {
-                    if ( ctts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index];
-                        i_current_index_samples_left = ctts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == i_entry - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = ctts->pi_sample_count[i_index];
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index];
-                        i_sample_count -= ctts->pi_sample_count[i_index];
-                        i_index++;
-                    }
+                    i_index++;
+                    i_index_samples_used = 0;
                 }
-
-
             }
         }
     }
@@ -2114,9 +1993,18 @@ static int TrackCreateES( demux_t *p_demux, mp4_track_t *p_track,
 
     if( p_sys->b_fragmented )
         i_sample_description_index = 1; /* XXX */
-    else
+    else if( p_track->b_indexed )
         i_sample_description_index =
                 p_track->chunk[i_chunk].i_sample_description_index;
+    else
+    {
+        /* no chunk index yet, the first chunk uses the first stsc entry */
+        MP4_Box_t *p_stsc = MP4_BoxGet( p_track->p_stbl, "stsc" );
+        if( !p_stsc || BOXDATA(p_stsc)->i_entry_count == 0 )
+            return VLC_EGENERIC;
+        i_sample_description_index =
+                BOXDATA(p_stsc)->i_sample_description_index[0];
+    }
 
     MP4_Box_t   *p_sample;
     MP4_Box_t   *p_esds;
@@ -2787,10 +2675,8 @@ static int TrackTimeToSampleChunk( demux_t *p_demux, mp4_track_t *p_track,
 {
     demux_sys_t *p_sys = p_demux->p_sys;
     MP4_Box_t   *p_box_stss;
-    uint64_t     i_dts;
     unsigned int i_sample;
     unsigned int i_chunk;
-    int          i_index;
 
     /* FIXME see if it's needed to check p_track->i_chunk_count */
     if( p_track->i_chunk_count == 0 )
@@ -2834,52 +2720,40 @@ static int TrackTimeToSampleChunk( demux_t *p_demux, mp4_track_t *p_track,
         i_start = i_start * p_track->i_timescale / CLOCK_FREQ;
     }
 
-    /* we start from sample 0/chunk 0, hope it won't take too much time */
-    /* *** find good chunk *** */
-    for( i_chunk = 0; ; i_chunk++ )
+    /* *** find good chunk *** (the last one starting before i_start) */
+    uint32_t i_lo = 0, i_hi = p_track->i_chunk_count - 1;
+    while( i_lo < i_hi )
     {
-        if( i_chunk + 1 >= p_track->i_chunk_count )
-        {
-            /* at the end and can't check if i_start in this chunk,
-               it will be check while searching i_sample */
-            i_chunk = p_track->i_chunk_count - 1;
-            break;
-        }
-
-        if( (uint64_t)i_start >= p_track->chunk[i_chunk].i_first_dts &&
-            (uint64_t)i_start <  p_track->chunk[i_chunk + 1].i_first_dts )
-        {
-            break;
-        }
+        uint32_t i_mid = i_hi - (i_hi - i_lo) / 2;
+        if( p_track->chunk[i_mid].i_first_dts <= (uint64_t)i_start )
+            i_lo = i_mid;
+        else
+            i_hi = i_mid - 1;
     }
+    i_chunk = i_lo;
 
     /* *** find sample in the chunk *** */
-    i_sample = p_track->chunk[i_chunk].i_sample_first;
-    i_dts    = p_track->chunk[i_chunk].i_first_dts;
-    for( i_index = 0; i_sample < p_track->chunk[i_chunk].i_sample_count; )
+    const mp4_chunk_t *ck = &p_track->chunk[i_chunk];
+    uint64_t i_dts = i_start - ck->i_first_dts;
+    uint32_t i_skip = ck->i_sample_skip_dts;
+
+    i_sample = 0;
+    for( unsigned i_index = 0; i_sample < ck->i_sample_count; i_index++ )
     {
-        if( i_dts +
-            p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-            p_track->chunk[i_chunk].p_sample_delta_dts[i_index] < (uint64_t)i_start )
-        {
-            i_dts    +=
-                p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
+        uint32_t i_count = __MIN( ck->p_sample_count_dts[i_index] - i_skip,
+                                  ck->i_sample_count - i_sample );
+        uint64_t i_run = (uint64_t)i_count * ck->p_sample_delta_dts[i_index];
 
-            i_sample += p_track->chunk[i_chunk].p_sample_count_dts[i_index];
-            i_index++;
-        }
-        else
+        i_skip = 0;
+        if( i_dts < i_run )
         {
-            if( p_track->chunk[i_chunk].p_sample_delta_dts[i_index] <= 0 )
-            {
-                break;
-            }
-            i_sample += ( i_start - i_dts ) /
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
+            i_sample += i_dts / ck->p_sample_delta_dts[i_index];
             break;
         }
+        i_dts -= i_run;
+        i_sample += i_count;
     }
+    i_sample += ck->i_sample_first;
 
     if( i_sample >= p_track->i_sample_count )
     {
@@ -2896,31 +2770,37 @@ static int TrackTimeToSampleChunk( demux_t *p_demux, mp4_track_t *p_track,
         MP4_Box_data_stss_t *p_stss = p_box_stss->data.p_stss;
         msg_Dbg( p_demux, "track[Id 0x%x] using Sync Sample Box (stss)",
                  p_track->i_track_ID );
-        for( unsigned i_index = 0; i_index < p_stss->i_entry_count; i_index++ )
+        if( p_stss->i_entry_count > 0 )
         {
-            if( i_index >= p_stss->i_entry_count - 1 ||
-                i_sample < p_stss->i_sample_number[i_index+1] )
+            /* the last sync sample not after i_sample, or the first one */
+            i_lo = 0;
+            i_hi = p_stss->i_entry_count - 1;
+            while( i_lo < i_hi )
             {
-                unsigned i_sync_sample = p_stss->i_sample_number[i_index];
-                msg_Dbg( p_demux, "stss gives %d --> %d (sample number)",
-                         i_sample, i_sync_sample );
+                uint32_t i_mid = i_hi - (i_hi - i_lo) / 2;
+                if( p_stss->i_sample_number[i_mid] <= i_sample )
+                    i_lo = i_mid;
+                else
+                    i_hi = i_mid - 1;
+            }
 
-                if( i_sync_sample <= i_sample )
-                {
-                    while( i_chunk > 0 &&
-                           i_sync_sample < p_track->chunk[i_chunk].i_sample_first )
-                        i_chunk--;
-                }
+            unsigned i_sync_sample = p_stss->i_sample_number[i_lo];
+            msg_Dbg( p_demux, "stss gives %d --> %d (sample number)",
+                     i_sample, i_sync_sample );
+
+            /* the chunk holding it */
+            i_lo = 0;
+            i_hi = p_track->i_chunk_count - 1;
+            while( i_lo < i_hi )
+            {
+                uint32_t i_mid = i_hi - (i_hi - i_lo) / 2;
+                if( p_track->chunk[i_mid].i_sample_first <= i_sync_sample )
+                    i_lo = i_mid;
                 else
-                {
-                    while( i_chunk < p_track->i_chunk_count - 1 &&
-                           i_sync_sample >= p_track->chunk[i_chunk].i_sample_first +
-                                            p_track->chunk[i_chunk].i_sample_count )
-                        i_chunk++;
-                }
-                i_sample = i_sync_sample;
-                break;
+                    i_hi = i_mid - 1;
             }
+            i_chunk = i_lo;
+            i_sample = i_sync_sample;
         }
     }
     else
@@ -2978,6 +2858,28 @@ static int TrackGotoChunkSample( demux_t *p_demux, mp4_track_t *p_track,
     return p_track->b_selected ? VLC_SUCCESS : VLC_EGENERIC;
 }
 
+/* Create the chunk and sample indexes of a track, the first time it is
+ * needed, loading its sample tables */
+static int TrackCreateIndex( demux_t *p_demux, mp4_track_t *p_track )
+{
+    if( p_track->b_indexed )
+        return VLC_SUCCESS;
+
+    if( TrackCreateChunksIndex( p_demux, p_track ) ||
+        TrackCreateSamplesIndex( p_demux, p_track ) )
+    {
+        msg_Err( p_demux, "cannot create chunks index for track[Id 0x%x]",
+                 p_track->i_track_ID );
+        FREENULL( p_track->chunk );
+        p_track->i_chunk_count = 0;
+        p_track->b_ok = false;
+        return VLC_EGENERIC;
+    }
+
+    p_track->b_indexed = true;
+    return VLC_SUCCESS;
+}
+
 /****************************************************************************
  * MP4_TrackCreate:
  ****************************************************************************
@@ -3151,9 +3053,11 @@ static void MP4_TrackCreate( demux_t *p_demux, mp4_track_t *p_track,
         }
     }
 
-    /* Create chunk index table and sample index table */
-    if( TrackCreateChunksIndex( p_demux,p_track  ) ||
-        TrackCreateSamplesIndex( p_demux, p_track ) )
+    /* Create sample size table, chunk index table and sample index table.
+     * The two last ones are only created when the track is first selected,
+     * except when playing as leaf, where all tracks map the mdat */
+    if( TrackCreateSizesIndex( p_demux, p_track ) ||
+        ( p_sys->b_fragmented && TrackCreateIndex( p_demux, p_track ) ) )
     {
         msg_Err( p_demux, "cannot create chunks index" );
         return; /* cannot create chunks index */
@@ -3234,35 +3138,20 @@ static void FreeAndResetChunk( mp4_chunk_t *ck )
  ****************************************************************************/
 static void MP4_TrackDestroy( mp4_track_t *p_track )
 {
-    unsigned int i_chunk;
-
     p_track->b_ok = false;
     p_track->b_enable   = false;
     p_track->b_selected = false;
 
     es_format_Clean( &p_track->fmt );
 
-    for( i_chunk = 0; i_chunk < p_track->i_chunk_count; i_chunk++ )
-    {
-        if( p_track->chunk )
-        {
-           FREENULL(p_track->chunk[i_chunk].p_sample_count_dts);
-           FREENULL(p_track->chunk[i_chunk].p_sample_delta_dts );
-
-           FREENULL(p_track->chunk[i_chunk].p_sample_count_pts);
-           FREENULL(p_track->chunk[i_chunk].p_sample_offset_pts );
-        }
-    }
+    /* the chunks sample tables belong to the stbl boxes */
     FREENULL( p_track->chunk );
+    p_track->b_indexed = false;
     if( p_track->cchunk ) {
         FreeAndResetChunk( p_track->cchunk );
         FREENULL( p_track->cchunk );
     }
-
-    if( !p_track->i_sample_size )
-    {
-        FREENULL( p_track->p_sample_size );
-    }
+    p_track->p_sample_size = NULL;
 }
 
 static int MP4_TrackSelect( demux_t *p_demux, mp4_track_t *p_track,
@@ -3311,7 +3200,8 @@ static int MP4_TrackSeek( demux_t *p_demux, mp4_track_t *p_track,
     uint32_t i_chunk;
     uint32_t i_sample;
 
-    if( !p_track->b_ok || p_track->b_chapter )
+    if( !p_track->b_ok || p_track->b_chapter ||
+        TrackCreateIndex( p_demux, p_track ) )
         return VLC_EGENERIC;
 
     p_track->b_selected = false;
@@ -4922,30 +4812,6 @@ static int LeafMOOVGetSamplesSize( const mp4_track_t *p_track, const uint32_t i_
     return VLC_SUCCESS;
 }
 
-static inline mtime_t LeafGetMOOVTimeInChunk( const mp4_chunk_t *p_chunk, uint32_t i_sample )
-{
-    mtime_t i_time = 0;
-    uint32_t i_index = 0;
-
-    while( i_sample > 0 )
-    {
-        if( i_sample > p_chunk->p_sample_count_dts[i_index] )
-        {
-            i_time += p_chunk->p_sample_count_dts[i_index] *
-                p_chunk->p_sample_delta_dts[i_index];
-            i_sample -= p_chunk->p_sample_count_dts[i_index];
-            i_index++;
-        }
-        else
-        {
-            i_time += i_sample * p_chunk->p_sample_delta_dts[i_index];
-            break;
-        }
-    }
-
-    return i_time;
-}
-
 static int LeafParseMDATwithMOOV( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -5048,7 +4914,7 @@ static int LeafParseMDATwithMOOV( demux_t *p_demux )
                 p_sys->context.i_mdatbytesleft -= i_samplessize;
 
                 /* dts */
-                mtime_t i_time = LeafGetMOOVTimeInChunk( p_chunk, i_nb_samples );
+                mtime_t i_time = MP4_ChunkGetDTSDelta( p_chunk, i_nb_samples );
                 i_time += p_chunk->i_first_dts;
                 p_track->i_time = i_time;
                 p_block->i_dts = VLC_TS_0 + CLOCK_FREQ * i_time / p_track->i_timescale;
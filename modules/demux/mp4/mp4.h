@@ -44,7 +44,11 @@ typedef struct
     /* now provide way to calculate pts, dts, and offset without too
         much memory and with fast access */
 
-    /* with this we can calculate dts/pts without waste memory */
+    /* with this we can calculate dts/pts without waste memory:
+     * the run-length tables start at the entry of the first sample of the
+     * chunk, the first i_sample_skip_* samples of that entry belonging to
+     * the previous chunks. Fragments own their tables, otherwise they point
+     * into the stts and ctts boxes, and are shared by all the chunks. */
     uint64_t     i_first_dts;   /* DTS of the first sample */
     uint64_t     i_last_dts;    /* DTS of the last sample */
     uint32_t     *p_sample_count_dts;
@@ -53,6 +57,9 @@ typedef struct
     uint32_t     *p_sample_count_pts;
     int32_t      *p_sample_offset_pts;  /* pts-dts */
 
+    uint32_t     i_sample_skip_dts;
+    uint32_t     i_sample_skip_pts;
+
     uint8_t      **p_sample_data;     /* set when b_fragmented is true */
     uint32_t     *p_sample_size;
     /* TODO if needed add pts
@@ -99,12 +106,14 @@ typedef struct
 
     mp4_chunk_t    *chunk; /* always defined  for each chunk */
     mp4_chunk_t    *cchunk; /* current chunk if b_fragmented is true */
+    bool            b_indexed; /* chunk is only created on first selection */
 
     /* sample size, p_sample_size defined only if i_sample_size == 0
         else i_sample_size is size for all sample */
     uint32_t         i_sample_size;
-    uint32_t         *p_sample_size; /* XXX perhaps add file offset if take
-                                    too much time to do sumations each time*/
+    const uint32_t   *p_sample_size; /* the stsz table, XXX perhaps add file
+                                offset if take too much time to do sumations
+                                each time */
 
     uint32_t     i_sample_first; /* i_sample_first value
                                                    of the next chunk */
@@ -226,6 +226,7 @@ static int Open( vlc_object_t * p_this )
 
     p_sys->i_length = -1;
     p_sys->b_preparsing_done = false;
+    p_sys->p_index = demux_SeekIndexOpen( p_demux, "ogg", CLOCK_FREQ );
 
     stream_Control( p_demux->s, ACCESS_GET_PTS_DELAY, & p_sys->i_access_delay );
 
@@ -262,6 +263,8 @@ static void Close( vlc_object_t *p_this )
     if( p_sys->p_old_stream )
         Ogg_LogicalStreamDelete( p_demux, p_sys->p_old_stream );
 
+    if( p_sys->p_index )
+        demux_SeekIndexClose( p_sys->p_index );
     free( p_sys );
 }
 
@@ -309,9 +312,18 @@ static int Demux( demux_t * p_demux )
         if ( !p_sys->b_chained_boundary )
         {
             /* Find the real duration */
+            int64_t i_length;
             stream_Control( p_demux->s, STREAM_CAN_SEEK, &b_canseek );
-            if ( b_canseek )
+            if ( p_sys->p_index &&
+                 !demux_SeekIndexGetValue( p_sys->p_index, "length", &i_length ) )
+                p_sys->i_length = i_length;
+            else if ( b_canseek )
+            {
                 Oggseek_ProbeEnd( p_demux );
+                if ( p_sys->p_index && p_sys->i_length > 0 )
+                    demux_SeekIndexSetValue( p_sys->p_index, "length",
+                                             p_sys->i_length );
+            }
         }
         else
         {
@@ -1493,6 +1505,18 @@ static int Ogg_FindLogicalStreams( demux_t *p_demux )
                 p_stream->i_serial_no = ogg_page_serialno( &p_ogg->current_page );
                 ogg_stream_init( &p_stream->os, p_stream->i_serial_no );
 
+                /* Reuse the seek results of earlier sessions */
+                if( p_ogg->p_index )
+                {
+                    size_t i_count;
+                    const demux_seek_point_t *p_points =
+                        demux_SeekIndexGetPoints( p_ogg->p_index,
+                                                  p_stream->i_serial_no, &i_count );
+                    for( size_t i = 0; i < i_count; i++ )
+                        OggSeek_IndexAdd( p_stream, p_points[i].i_time,
+                                          p_points[i].i_pos );
+                }
+
                 /* Extract the initial header from the first page and verify
                  * the codec type of this Ogg bitstream */
                 if( ogg_stream_pagein( &p_stream->os, &p_ogg->current_page ) < 0 )
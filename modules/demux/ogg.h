@@ -224,6 +224,9 @@ struct demux_sys_t
     /* Length, if available. */
     int64_t i_length;
 
+    /* Keyframe positions found by seeks, and length, across sessions */
+    demux_seek_index_t *p_index;
+
 };
 
 
@@ -1016,6 +1016,9 @@ int Oggseek_SeektoAbsolutetime( demux_t *p_demux, logical_stream_t *p_stream,
     if ( i_pagepos >= p_stream->i_data_start )
         OggSeek_IndexAdd( p_stream, i_time, i_pagepos )
     );
+    if ( p_sys->p_index && i_pagepos >= p_stream->i_data_start )
+        demux_SeekIndexAdd( p_sys->p_index, p_stream->i_serial_no,
+                            i_time, i_pagepos );
 
     OggDebug( msg_Dbg( p_demux, "=================== Seeked To %"PRId64" time %"PRId64, i_pagepos, i_time ) );
     return i_pagepos;
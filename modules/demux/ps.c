@@ -93,8 +93,14 @@ struct demux_sys_t
     bool  b_lost_sync;
     bool  b_have_pack;
     bool  b_seekable;
+
+    /* Offsets of the packs by time of the time track */
+    demux_seek_index_t *p_index;
+    int64_t     i_pack_pos;
 };
 
+#define PS_INDEX_INTERVAL CLOCK_FREQ
+
 static int Demux  ( demux_t *p_demux );
 static int Control( demux_t *p_demux, int i_query, va_list args );
 
@@ -150,6 +156,23 @@ static int OpenCommon( vlc_object_t *p_this, bool b_force )
     ps_psm_init( &p_sys->psm );
     ps_track_init( p_sys->tk );
 
+    p_sys->i_pack_pos = -1;
+    p_sys->p_index = demux_SeekIndexOpen( p_demux, "ps", PS_INDEX_INTERVAL );
+    if( p_sys->p_index && var_CreateGetBool( p_demux, "ps-trust-timestamps" ) )
+    {
+        /* Reuse the length found by an earlier session */
+        int64_t i_length, i_track, i_first_pts;
+        if( !demux_SeekIndexGetValue( p_sys->p_index, "length", &i_length ) &&
+            !demux_SeekIndexGetValue( p_sys->p_index, "time-track", &i_track ) &&
+            !demux_SeekIndexGetValue( p_sys->p_index, "first-pts", &i_first_pts ) &&
+            i_length > 0 && i_track >= 0 && i_track < PS_TK_COUNT )
+        {
+            p_sys->i_length = i_length;
+            p_sys->i_time_track = i_track;
+            p_sys->tk[i_track].i_first_pts = i_first_pts;
+        }
+    }
+
     /* TODO prescanning of ES */
 
     return VLC_SUCCESS;
@@ -186,6 +209,8 @@ static void Close( vlc_object_t *p_this )
 
     ps_psm_destroy( &p_sys->psm );
 
+    if( p_sys->p_index )
+        demux_SeekIndexClose( p_sys->p_index );
     free( p_sys );
 }
 
@@ -278,6 +303,14 @@ static void FindLength( demux_t *p_demux )
             }
         }
     }
+
+    if( p_sys->p_index && p_sys->i_length > 0 )
+    {
+        demux_SeekIndexSetValue( p_sys->p_index, "length", p_sys->i_length );
+        demux_SeekIndexSetValue( p_sys->p_index, "time-track", p_sys->i_time_track );
+        demux_SeekIndexSetValue( p_sys->p_index, "first-pts",
+                                 p_sys->tk[p_sys->i_time_track].i_first_pts );
+    }
 }
 
 /*****************************************************************************
@@ -310,6 +343,9 @@ static int Demux( demux_t *p_demux )
     if( p_sys->i_length < 0 && p_sys->b_seekable )
         FindLength( p_demux );
 
+    if( i_code == 0x1ba && p_sys->p_index )
+        p_sys->i_pack_pos = stream_Tell( p_demux->s );
+
     if( ( p_pkt = ps_pkt_read( p_demux->s, i_code ) ) == NULL )
     {
         return 0;
@@ -430,6 +466,15 @@ static int Demux( demux_t *p_demux )
                     p_sys->i_current_pts = (int64_t)p_pkt->i_pts;
                 }
 
+                if( p_sys->p_index && p_sys->i_pack_pos >= 0 &&
+                    p_sys->i_time_track >= 0 && p_pkt->i_pts > VLC_TS_INVALID &&
+                    tk == &p_sys->tk[p_sys->i_time_track] )
+                {
+                    demux_SeekIndexAdd( p_sys->p_index, 0,
+                                        p_pkt->i_pts - tk->i_first_pts,
+                                        p_sys->i_pack_pos );
+                }
+
                 es_out_Send( p_demux->out, tk->es, p_pkt );
             }
             else
@@ -514,7 +559,26 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             return VLC_EGENERIC;
 
         case DEMUX_SET_TIME:
+        {
+            demux_seek_point_t before, after = { .i_time = INT64_MIN };
+
             i64 = (int64_t)va_arg( args, int64_t );
+            if( p_sys->p_index && p_sys->i_time_track >= 0 &&
+                demux_SeekIndexFind( p_sys->p_index, 0, i64, &before, &after ) )
+            {
+                /* Seek to the pack before, or between the nearest packs
+                 * if that part of the file was not indexed */
+                int64_t i_pos = before.i_pos;
+                if( after.i_time > before.i_time + PS_INDEX_INTERVAL &&
+                    after.i_pos > before.i_pos )
+                    i_pos += (after.i_pos - before.i_pos) *
+                             (double)(i64 - before.i_time) /
+                             (after.i_time - before.i_time);
+
+                p_sys->i_current_pts = 0;
+                p_sys->i_last_scr = -1;
+                return stream_Seek( p_demux->s, i_pos );
+            }
             if( p_sys->i_time_track >= 0 && p_sys->i_current_pts > 0 )
             {
                 int64_t i_now = p_sys->i_current_pts - p_sys->tk[p_sys->i_time_track].i_first_pts;
@@ -530,6 +594,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
                 return VLC_SUCCESS;
             }
             return VLC_EGENERIC;
+        }
 
         case DEMUX_GET_TITLE_INFO:
         {
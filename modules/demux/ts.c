@@ -133,6 +133,12 @@ static void Close ( vlc_object_t * );
 #define PCR_TEXT N_("Trust in-stream PCR")
 #define PCR_LONGTEXT N_("Use the stream PCR as a reference.")
 
+#define PRG_THREADS_TEXT N_("Demux programs in parallel")
+#define PRG_THREADS_LONGTEXT N_( \
+    "Reassemble the elementary streams of each program on its own thread. " \
+    "This helps with multi-program streams, such as a whole DVB multiplex " \
+    "sent to the stream output." )
+
 vlc_module_begin ()
     set_description( N_("MPEG Transport Stream demuxer") )
     set_shortname ( "MPEG-TS" )
@@ -155,6 +161,7 @@ vlc_module_begin ()
 
     add_bool( "ts-split-es", true, SPLIT_ES_TEXT, SPLIT_ES_LONGTEXT, false )
     add_bool( "ts-seek-percent", false, SEEK_PERCENT_TEXT, SEEK_PERCENT_LONGTEXT, true )
+    add_bool( "ts-program-threads", false, PRG_THREADS_TEXT, PRG_THREADS_LONGTEXT, true )
 
     add_obsolete_bool( "ts-silent" );
 
@@ -253,6 +260,7 @@ typedef struct
     int         i_data_gathered;
     block_t     *p_data;
     block_t     **pp_last;
+    block_t     **pp_shared; /* first packet still viewing its batch */
 
     es_mpeg4_descriptor_t *p_mpeg4desc;
 
@@ -279,8 +287,33 @@ typedef struct
     ts_es_t     **extra_es;
     int         i_extra_es;
 
+    /* Batch of the last packet viewed, for the demux thread only */
+    unsigned    i_batch;
+
 } ts_pid_t;
 
+/* Thread demuxing the ES of one program */
+typedef struct
+{
+    demux_t     *p_demux;
+    int         i_number;   /* program number */
+    vlc_thread_t thread;
+
+    vlc_mutex_t lock;
+    vlc_cond_t  wait;       /* packets queued or exit requested */
+    vlc_cond_t  wait_done;  /* queued packets processed */
+    block_t     *p_queue;
+    block_t     **pp_queue_last;
+    int         i_queued;   /* packets queued or being processed */
+    bool        b_exit;
+
+    /* Packets dispatched by the demux thread, not queued yet */
+    block_t     *p_batch;
+    block_t     **pp_batch_last;
+    int         i_batch;
+
+} ts_worker_t;
+
 struct demux_sys_t
 {
     vlc_mutex_t     csa_lock;
@@ -294,6 +327,10 @@ struct demux_sys_t
     /* how many TS packet we read at once */
     int         i_ts_read;
 
+    /* TS packets read in bulk and not demuxed yet */
+    block_t     *p_packets;
+    unsigned    i_batch; /* number of bulk reads */
+
     /* to determine length and time */
     int         i_pid_ref_pcr;
     mtime_t     i_first_pcr;
@@ -303,6 +340,7 @@ struct demux_sys_t
     int         i_pcrs_num;
     mtime_t     *p_pcrs;
     int64_t     *p_pos;
+    demux_seek_index_t *p_index;
 
     /* All pid */
     ts_pid_t    pid[8192];
@@ -337,6 +375,11 @@ struct demux_sys_t
 
     /* */
     bool        b_start_record;
+
+    /* Programs demuxed in parallel */
+    bool        b_prg_threads;
+    int         i_workers;
+    ts_worker_t **workers;
 };
 
 static int Demux    ( demux_t *p_demux );
@@ -366,11 +409,25 @@ static inline int PIDGet( block_t *p )
 static bool GatherData( demux_t *p_demux, ts_pid_t *pid, block_t *p_bk );
 
 static block_t* ReadTSPacket( demux_t *p_demux );
+static int ReadTSPackets( demux_t *p_demux );
+static block_t *PacketView( demux_sys_t *p_sys, ts_pid_t *pid );
+static void FlushTSPackets( demux_t *p_demux, bool b_rewind );
+static int64_t TellTS( demux_t *p_demux );
+static mtime_t AdjustPCRWrapAround( demux_t *p_demux, mtime_t i_pcr );
+static mtime_t GetPCR( block_t *p_pkt );
 static int Seek( demux_t *p_demux, double f_percent );
 static void GetFirstPCR( demux_t *p_demux );
 static void GetLastPCR( demux_t *p_demux );
 static void CheckPCR( demux_t *p_demux );
-static void PCRHandle( demux_t *p_demux, ts_pid_t *, block_t * );
+static int IndexLoadPCR( demux_t *p_demux );
+static void IndexSavePCR( demux_t *p_demux );
+static void PCRHandle( demux_t *p_demux, ts_pid_t *, block_t *, int i_number );
+static void PCRDispatch( demux_t *p_demux, ts_pid_t *, block_t *, int i_number );
+
+static void WorkerDispatch( demux_t *p_demux, int i_number, block_t * );
+static void WorkersQueue( demux_t *p_demux );
+static void WorkersDrain( demux_t *p_demux );
+static void WorkersDelete( demux_t *p_demux );
 
 static void              IODFree( iod_descriptor_t * );
 
@@ -386,6 +443,12 @@ static void SetPrgFilter( demux_t *, int i_prg, bool b_selected );
 #define TS_PACKET_SIZE_MAX 204
 #define TS_TOPFIELD_HEADER 1320
 
+/* First packet of its PID in a bulk read (see PacketView()) */
+#define BLOCK_FLAG_PRIVATE_BATCH_START (1 << BLOCK_FLAG_PRIVATE_SHIFT)
+
+/* Batches of i_ts_read packets queued to a program thread at most */
+#define TS_WORKER_BATCHES 20
+
 static int DetectPacketSize( demux_t *p_demux, int *pi_header_size )
 {
     const uint8_t *p_peek;
@@ -603,6 +666,7 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_packet_size = i_packet_size;
     p_sys->i_packet_header_size = i_packet_header_size;
     p_sys->i_ts_read = 50;
+    p_sys->p_packets = NULL;
     p_sys->csa = NULL;
     p_sys->b_start_record = false;
 
@@ -757,6 +821,7 @@ static int Open( vlc_object_t *p_this )
     free( psz_string );
 
     p_sys->b_split_es = var_InheritBool( p_demux, "ts-split-es" );
+    p_sys->b_prg_threads = var_InheritBool( p_demux, "ts-program-threads" );
 
     p_sys->i_pid_ref_pcr = -1;
     p_sys->i_first_pcr = -1;
@@ -773,13 +838,20 @@ static int Open( vlc_object_t *p_this )
         return VLC_ENOMEM;
     }
 
-    bool can_seek = false;
-    stream_Control( p_demux->s, STREAM_CAN_FASTSEEK, &can_seek );
-    if( can_seek  )
+    /* The seek index keeps the reference PCR positions, in 90kHz units */
+    p_sys->p_index = demux_SeekIndexOpen( p_demux, "ts", 90000 );
+    if( !p_sys->p_index || IndexLoadPCR( p_demux ) )
     {
-        GetFirstPCR( p_demux );
-        CheckPCR( p_demux );
-        GetLastPCR( p_demux );
+        bool can_seek = false;
+        stream_Control( p_demux->s, STREAM_CAN_FASTSEEK, &can_seek );
+        if( can_seek  )
+        {
+            GetFirstPCR( p_demux );
+            CheckPCR( p_demux );
+            GetLastPCR( p_demux );
+            if( p_sys->p_index )
+                IndexSavePCR( p_demux );
+        }
     }
     if( p_sys->i_first_pcr < 0 || p_sys->i_last_pcr < 0 )
     {
@@ -803,6 +875,8 @@ static void Close( vlc_object_t *p_this )
     demux_t     *p_demux = (demux_t*)p_this;
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    WorkersDelete( p_demux );
+
     msg_Dbg( p_demux, "pid list:" );
     for( int i = 0; i < 8192; i++ )
     {
@@ -859,6 +933,8 @@ static void Close( vlc_object_t *p_this )
             SetPIDFilter( p_demux, pid->i_pid, false );
     }
 
+    FlushTSPackets( p_demux, false );
+
     vlc_mutex_lock( &p_sys->csa_lock );
     if( p_sys->csa )
     {
@@ -874,6 +950,8 @@ static void Close( vlc_object_t *p_this )
 
     free( p_sys->p_pcrs );
     free( p_sys->p_pos );
+    if( p_sys->p_index )
+        demux_SeekIndexClose( p_sys->p_index );
 
     vlc_mutex_destroy( &p_sys->csa_lock );
     free( p_sys );
@@ -909,16 +987,25 @@ static int Demux( demux_t *p_demux )
     demux_sys_t *p_sys = p_demux->p_sys;
     bool b_wait_es = p_sys->i_pmt_es <= 0;
 
-    /* We read at most 100 TS packet or until a frame is completed */
+    /* We read at most 100 TS packet or until a frame is completed.
+     * With program threads, the packets are queued to the threads when
+     * returning. */
     for( int i_pkt = 0; i_pkt < p_sys->i_ts_read; i_pkt++ )
     {
         bool         b_frame = false;
-        block_t     *p_pkt;
-        if( !(p_pkt = ReadTSPacket( p_demux )) )
+        block_t      pkt;
+        block_t     *p_pkt = &pkt;
+        if( ReadTSPackets( p_demux ) )
         {
+            WorkersDrain( p_demux );
             return 0;
         }
 
+        /* The packet is only looked at inside the bulk buffer, which it
+         * shares when its payload has to be gathered (see PacketView()) */
+        block_Init( &pkt, p_sys->p_packets->p_buffer + p_sys->i_packet_header_size,
+                    p_sys->i_packet_size - p_sys->i_packet_header_size );
+
         if( p_sys->b_start_record )
         {
             /* Enable recording once synchronized */
@@ -927,7 +1014,21 @@ static int Demux( demux_t *p_demux )
         }
 
         /* Parse the TS packet */
-        ts_pid_t *p_pid = &p_sys->pid[PIDGet( p_pkt )];
+        ts_pid_t *p_pid = &p_sys->pid[PIDGet( &pkt )];
+
+        /* The reference PCR is followed here, as the stream position is
+         * only known to this thread */
+        if( p_sys->i_pid_ref_pcr == p_pid->i_pid && p_sys->i_pmt_es > 0 )
+        {
+            mtime_t i_pcr = GetPCR( &pkt );
+            if( i_pcr >= 0 )
+            {
+                p_sys->i_current_pcr = AdjustPCRWrapAround( p_demux, i_pcr );
+                if( p_sys->p_index )
+                    demux_SeekIndexAdd( p_sys->p_index, 0, p_sys->i_current_pcr,
+                                        TellTS( p_demux ) );
+            }
+        }
 
         if( p_pid->b_valid )
         {
@@ -945,11 +1046,18 @@ static int Demux( demux_t *p_demux )
                                            p_pkt->p_buffer );
                     }
                 }
-                block_Release( p_pkt );
+            }
+            else if( p_sys->b_prg_threads )
+            {
+                WorkerDispatch( p_demux, p_pid->i_owner_number,
+                                PacketView( p_sys, p_pid ) );
+                PCRDispatch( p_demux, p_pid, &pkt, p_pid->i_owner_number );
             }
             else
             {
-                b_frame = GatherData( p_demux, p_pid, p_pkt );
+                p_pkt = PacketView( p_sys, p_pid );
+                if( p_pkt )
+                    b_frame = GatherData( p_demux, p_pid, p_pkt );
             }
         }
         else
@@ -959,15 +1067,21 @@ static int Demux( demux_t *p_demux )
                 msg_Dbg( p_demux, "pid[%d] unknown", p_pid->i_pid );
             }
             /* We have to handle PCR if present */
-            PCRHandle( p_demux, p_pid, p_pkt );
-            block_Release( p_pkt );
+            if( p_sys->b_prg_threads )
+                PCRDispatch( p_demux, p_pid, &pkt, -1 );
+            else
+                PCRHandle( p_demux, p_pid, p_pkt, -1 );
         }
         p_pid->b_seen = true;
 
+        p_sys->p_packets->p_buffer += p_sys->i_packet_size;
+        p_sys->p_packets->i_buffer -= p_sys->i_packet_size;
+
         if( b_frame || ( b_wait_es && p_sys->i_pmt_es > 0 ) )
             break;
     }
 
+    WorkersQueue( p_demux );
     demux_UpdateTitleFromStream( p_demux );
     return 1;
 }
@@ -1023,7 +1137,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
                 *pf = (double)i_time/(double)i_length;
             else if( (i64 = stream_Size( p_demux->s) ) > 0 )
             {
-                int64_t offset = stream_Tell( p_demux->s );
+                int64_t offset = TellTS( p_demux );
 
                 *pf = (double)offset / (double)i64;
             }
@@ -1039,6 +1153,8 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
     case DEMUX_SET_POSITION:
         f = (double) va_arg( args, double );
 
+        FlushTSPackets( p_demux, true );
+
         if( p_sys->b_force_seek_per_percent ||
             (p_sys->b_dvb_meta && p_sys->b_access_control) ||
             p_sys->i_last_pcr - p_sys->i_first_pcr <= 0 )
@@ -1154,9 +1270,11 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
     }
 
     case DEMUX_SET_TITLE:
+        FlushTSPackets( p_demux, false );
         return stream_vaControl( p_demux->s, STREAM_SET_TITLE, args );
 
     case DEMUX_SET_SEEKPOINT:
+        FlushTSPackets( p_demux, false );
         return stream_vaControl( p_demux->s, STREAM_SET_SEEKPOINT, args );
 
     case DEMUX_GET_META:
@@ -1441,6 +1559,7 @@ static void PIDInit( ts_pid_t *pid, bool b_psi, ts_psi_t *p_owner )
         es_format_Init( &pid->es->fmt, UNKNOWN_ES, 0 );
         pid->es->data_type = TS_ES_DATA_PES;
         pid->es->pp_last = &pid->es->p_data;
+        pid->es->pp_shared = &pid->es->p_data;
     }
 }
 
@@ -1694,7 +1813,17 @@ static void ParsePES( demux_t *p_demux, ts_pid_t *pid, block_t *p_pes )
 
         p_pes->i_length = i_length * 100 / 9;
 
-        p_block = block_ChainGather( p_pes );
+        /* The video packetizers take the payload as is, in TS packets */
+        const vlc_fourcc_t i_codec = pid->es->fmt.i_codec;
+        const bool b_scatter = !pid->es->fmt.b_packetized &&
+                               pid->i_extra_es == 0 &&
+                               ( i_codec == VLC_CODEC_H264 ||
+                                 i_codec == VLC_CODEC_HEVC ||
+                                 i_codec == VLC_CODEC_MPGV ||
+                                 i_codec == VLC_CODEC_MP4V ||
+                                 i_codec == VLC_CODEC_VC1 );
+
+        p_block = block_ChainGatherExt( p_pes, b_scatter );
         if( pid->es->fmt.i_codec == VLC_CODEC_SUBT )
         {
             if( i_pes_size > 0 && p_block->i_buffer > i_pes_size )
@@ -1800,6 +1929,7 @@ static void ParseData( demux_t *p_demux, ts_pid_t *pid )
     pid->es->i_data_size = 0;
     pid->es->i_data_gathered = 0;
     pid->es->pp_last = &pid->es->p_data;
+    pid->es->pp_shared = &pid->es->p_data;
 
     if( pid->es->data_type == TS_ES_DATA_PES )
     {
@@ -1879,6 +2009,133 @@ static block_t* ReadTSPacket( demux_t *p_demux )
     return p_pkt;
 }
 
+static int ReadTSPackets( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const int i_size = p_sys->i_packet_size;
+
+    if( p_sys->p_packets )
+    {
+        if( p_sys->p_packets->i_buffer >= (size_t)i_size )
+            return VLC_SUCCESS;
+        block_Release( p_sys->p_packets );
+        p_sys->p_packets = NULL;
+    }
+
+    while( vlc_object_alive( p_demux ) )
+    {
+        const uint8_t *p_peek;
+        const int i_peek = stream_Peek( p_demux->s, &p_peek,
+                                        i_size * p_sys->i_ts_read );
+        if( i_peek < i_size )
+        {
+            msg_Dbg( p_demux, "eof ?" );
+            return VLC_EGENERIC;
+        }
+
+        /* Check the sync bytes of the whole batch before reading it, so
+         * that only the packets in sync are consumed */
+        const uint8_t *p_sync = &p_peek[p_sys->i_packet_header_size];
+        int i_count = 0;
+        while( i_count < i_peek / i_size && p_sync[i_count * i_size] == 0x47 )
+            i_count++;
+
+        if( i_count > 0 )
+        {
+            p_sys->p_packets = stream_Block( p_demux->s, i_count * i_size );
+            /* Shared, so that the packets to gather are not copied */
+            if( p_sys->p_packets )
+                p_sys->p_packets = block_Share( p_sys->p_packets );
+            if( !p_sys->p_packets ||
+                p_sys->p_packets->i_buffer < (size_t)i_size )
+            {
+                msg_Dbg( p_demux, "eof ?" );
+                FlushTSPackets( p_demux, false );
+                return VLC_EGENERIC;
+            }
+            p_sys->p_packets->i_buffer -= p_sys->p_packets->i_buffer % i_size;
+            p_sys->i_batch++;
+            return VLC_SUCCESS;
+        }
+
+        /* Re-sync on two sync bytes one packet apart. Candidates are found
+         * with memchr() rather than testing every byte */
+        msg_Warn( p_demux, "lost synchro" );
+        if( i_peek <= i_size )
+        {
+            msg_Dbg( p_demux, "eof ?" );
+            return VLC_EGENERIC;
+        }
+
+        const uint8_t *p_end = &p_peek[i_peek - i_size];
+        int i_skip = i_peek - i_size;
+        for( const uint8_t *p = &p_sync[1]; p < p_end; p++ )
+        {
+            p = memchr( p, 0x47, p_end - p );
+            if( !p )
+                break;
+            if( p[i_size] == 0x47 )
+            {
+                i_skip = p - p_sync;
+                break;
+            }
+        }
+        if( i_skip == 0 )
+        {   /* No progress possible */
+            msg_Dbg( p_demux, "eof ?" );
+            return VLC_EGENERIC;
+        }
+        msg_Dbg( p_demux, "skipping %d bytes of garbage", i_skip );
+        stream_Read( p_demux->s, NULL, i_skip );
+    }
+    return VLC_EGENERIC;
+}
+
+/* Returns the packet being demuxed, sharing the bulk buffer. The first
+ * packet of the PID in this batch is flagged: the PES it continues was
+ * gathered from older batches, and stops sharing them (see UnsharePES()),
+ * so that a batch is only kept alive by the PES of its own packets. */
+static block_t *PacketView( demux_sys_t *p_sys, ts_pid_t *pid )
+{
+    block_t *p_bk = block_View( p_sys->p_packets, p_sys->i_packet_header_size,
+                                p_sys->i_packet_size - p_sys->i_packet_header_size );
+
+    if( p_bk && pid && pid->i_batch != p_sys->i_batch )
+    {
+        pid->i_batch = p_sys->i_batch;
+        p_bk->i_flags |= BLOCK_FLAG_PRIVATE_BATCH_START;
+    }
+    return p_bk;
+}
+
+static void FlushTSPackets( demux_t *p_demux, bool b_rewind )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    /* Let the program threads finish with the packets already read */
+    WorkersDrain( p_demux );
+
+    if( !p_sys->p_packets )
+        return;
+
+    /* Give back the packets not demuxed yet, so that positions are exact */
+    if( b_rewind && p_sys->p_packets->i_buffer > 0 )
+        stream_Seek( p_demux->s, TellTS( p_demux ) );
+
+    block_Release( p_sys->p_packets );
+    p_sys->p_packets = NULL;
+}
+
+static int64_t TellTS( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    int64_t i_pos = stream_Tell( p_demux->s );
+
+    if( p_sys->p_packets )
+        i_pos -= p_sys->p_packets->i_buffer;
+    return i_pos;
+}
+
 static mtime_t AdjustPCRWrapAround( demux_t *p_demux, mtime_t i_pcr )
 {
     demux_sys_t   *p_sys = p_demux->p_sys;
@@ -1887,7 +2144,7 @@ static mtime_t AdjustPCRWrapAround( demux_t *p_demux, mtime_t i_pcr )
      * So, need to add 0x1FFFFFFFF, for calculating duration or current position.
      */
     mtime_t i_adjust = 0;
-    int64_t i_pos = stream_Tell( p_demux->s );
+    int64_t i_pos = TellTS( p_demux );
     int i;
     for( i = 1; i < p_sys->i_pcrs_num && p_sys->p_pos[i] <= i_pos; ++i )
     {
@@ -1993,6 +2250,22 @@ static int Seek( demux_t *p_demux, double f_percent )
         i_head_pos = p_sys->p_pos[i-1];
         i_tail_pos = ( i < p_sys->i_pcrs_num ) ?  p_sys->p_pos[i] : stream_Size( p_demux->s );
     }
+
+    /* Narrow the search with the PCR positions met before, and go straight
+     * to the one before the target if it is close enough */
+    demux_seek_point_t before, after;
+    if( p_sys->p_index &&
+        demux_SeekIndexFind( p_sys->p_index, 0, i_target_pcr, &before, &after ) )
+    {
+        if( i_target_pcr - before.i_time <= 45000 /* 500 ms */ )
+            i_head_pos = i_tail_pos = before.i_pos;
+        else
+        {
+            i_head_pos = __MAX( i_head_pos, (int64_t)before.i_pos );
+            if( after.i_time > i_target_pcr )
+                i_tail_pos = __MIN( i_tail_pos, (int64_t)after.i_pos );
+        }
+    }
     msg_Dbg( p_demux, "Seek():i_head_pos:%"PRId64", i_tail_pos:%"PRId64, i_head_pos, i_tail_pos);
 
     bool b_found = false;
@@ -2153,7 +2426,73 @@ static void CheckPCR( demux_t *p_demux )
     p_sys->i_current_pcr = i_initial_pcr;
 }
 
-static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, block_t *p_bk )
+static int IndexLoadPCR( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    int64_t i_pid, i_first, i_last;
+    char psz_name[16];
+
+    if( demux_SeekIndexGetValue( p_sys->p_index, "pcr-pid", &i_pid ) ||
+        demux_SeekIndexGetValue( p_sys->p_index, "first-pcr", &i_first ) ||
+        demux_SeekIndexGetValue( p_sys->p_index, "last-pcr", &i_last ) ||
+        i_pid < 0 || i_pid >= 8192 )
+        return VLC_EGENERIC;
+
+    for( int i = 0; i < p_sys->i_pcrs_num; i++ )
+    {
+        snprintf( psz_name, sizeof(psz_name), "pcr-%d", i );
+        if( demux_SeekIndexGetValue( p_sys->p_index, psz_name, &p_sys->p_pcrs[i] ) )
+            return VLC_EGENERIC;
+        snprintf( psz_name, sizeof(psz_name), "pos-%d", i );
+        if( demux_SeekIndexGetValue( p_sys->p_index, psz_name, &p_sys->p_pos[i] ) )
+            return VLC_EGENERIC;
+    }
+
+    p_sys->i_pid_ref_pcr = i_pid;
+    p_sys->i_first_pcr = i_first;
+    p_sys->i_current_pcr = i_first;
+    p_sys->i_last_pcr = i_last;
+    msg_Dbg( p_demux, "PCR positions loaded from the seek index" );
+    return VLC_SUCCESS;
+}
+
+static void IndexSavePCR( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    char psz_name[16];
+
+    /* Only keep a complete scan */
+    if( p_sys->i_first_pcr < 0 || p_sys->i_last_pcr < 0 ||
+        p_sys->b_force_seek_per_percent )
+        return;
+
+    demux_SeekIndexSetValue( p_sys->p_index, "pcr-pid", p_sys->i_pid_ref_pcr );
+    demux_SeekIndexSetValue( p_sys->p_index, "first-pcr", p_sys->i_first_pcr );
+    demux_SeekIndexSetValue( p_sys->p_index, "last-pcr", p_sys->i_last_pcr );
+    for( int i = 0; i < p_sys->i_pcrs_num; i++ )
+    {
+        snprintf( psz_name, sizeof(psz_name), "pcr-%d", i );
+        demux_SeekIndexSetValue( p_sys->p_index, psz_name, p_sys->p_pcrs[i] );
+        snprintf( psz_name, sizeof(psz_name), "pos-%d", i );
+        demux_SeekIndexSetValue( p_sys->p_index, psz_name, p_sys->p_pos[i] );
+    }
+}
+
+static bool PMTHasES( demux_sys_t *p_sys, const ts_psi_t *psi )
+{
+    for( int i = 0; i < 8192; i++ )
+    {
+        const ts_pid_t *pid = &p_sys->pid[i];
+        if( pid->b_valid && pid->p_owner == psi && pid->es )
+            return true;
+    }
+    return false;
+}
+
+/* Sets the PCR of every program using the PID as PCR PID, or only of the
+ * program i_number: a program thread only touches its own program. */
+static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, block_t *p_bk,
+                       int i_number )
 {
     demux_sys_t   *p_sys = p_demux->p_sys;
 
@@ -2164,40 +2503,73 @@ static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, block_t *p_bk )
     if( i_pcr < 0 )
         return;
 
-    if( p_sys->i_pid_ref_pcr == pid->i_pid )
-        p_sys->i_current_pcr = AdjustPCRWrapAround( p_demux, i_pcr );
-
-    /* Search program and set the PCR */
-    int i_group = -1;
-    for( int i = 0; i < p_sys->i_pmt && i_group < 0 ; i++ )
+    for( int i = 0; i < p_sys->i_pmt; i++ )
     {
-        bool b_pmt_has_es = false;
+        ts_psi_t *psi = p_sys->pmt[i]->psi;
 
-        for( int i_prg = 0; i_prg < p_sys->pmt[i]->psi->i_prg; i_prg++ )
+        for( int i_prg = 0; i_prg < psi->i_prg; i_prg++ )
         {
-            if( pid->i_pid == p_sys->pmt[i]->psi->prg[i_prg]->i_pid_pcr )
-            {
-                /* We've found our target group */
-                p_sys->pmt[i]->psi->prg[i_prg]->i_pcr_value = i_pcr;
-                i_group = p_sys->pmt[i]->psi->prg[i_prg]->i_number;
-                for( int j = 0; j < 8192; j++ )
-                {
-                    const ts_pid_t *pid = &p_sys->pid[j];
-                    if( pid->b_valid && pid->p_owner == p_sys->pmt[i]->psi && pid->es )
-                    {
-                        b_pmt_has_es = true;
-                        break;
-                    }
-                }
-            }
+            ts_prg_psi_t *prg = psi->prg[i_prg];
+
+            if( pid->i_pid != prg->i_pid_pcr ||
+                ( i_number >= 0 && prg->i_number != i_number ) )
+                continue;
+
+            prg->i_pcr_value = i_pcr;
+            if( p_sys->b_trust_pcr && prg->i_number > 0 &&
+                PMTHasES( p_sys, psi ) )
+                es_out_Control( p_demux->out, ES_OUT_SET_GROUP_PCR,
+                                prg->i_number, VLC_TS_0 + i_pcr * 100 / 9 );
         }
+    }
+}
+
+/* Hands a PCR over to the thread of every program using the PID as PCR
+ * PID, but program i_number which gets the packet already */
+static void PCRDispatch( demux_t *p_demux, ts_pid_t *pid, block_t *p_bk,
+                         int i_number )
+{
+    demux_sys_t   *p_sys = p_demux->p_sys;
+
+    if( p_sys->i_pmt_es <= 0 || GetPCR( p_bk ) < 0 )
+        return;
+
+    for( int i = 0; i < p_sys->i_pmt; i++ )
+    {
+        ts_psi_t *psi = p_sys->pmt[i]->psi;
+
+        for( int i_prg = 0; i_prg < psi->i_prg; i_prg++ )
+        {
+            ts_prg_psi_t *prg = psi->prg[i_prg];
 
-        if ( p_sys->b_trust_pcr && i_group > 0 && b_pmt_has_es )
-            es_out_Control( p_demux->out, ES_OUT_SET_GROUP_PCR,
-              i_group, VLC_TS_0 + i_pcr * 100 / 9 );
+            if( pid->i_pid == prg->i_pid_pcr && prg->i_number != i_number )
+                WorkerDispatch( p_demux, prg->i_number,
+                                PacketView( p_sys, NULL ) );
+        }
     }
 }
 
+/* Copies the packets of the PES gathered from an older batch */
+static void UnsharePES( ts_es_t *es )
+{
+    block_t *p_shared = *es->pp_shared;
+    size_t i_size;
+
+    if( p_shared == NULL )
+        return;
+
+    block_ChainProperties( p_shared, NULL, &i_size, NULL );
+    block_t *p_copy = block_Alloc( i_size );
+    if( unlikely(p_copy == NULL) )
+        return; /* keep sharing */
+    block_ChainExtract( p_shared, p_copy->p_buffer, i_size );
+    block_CopyProperties( p_copy, p_shared );
+    block_ChainRelease( p_shared );
+
+    *es->pp_shared = p_copy;
+    es->pp_shared = es->pp_last = &p_copy->p_next;
+}
+
 static bool GatherData( demux_t *p_demux, ts_pid_t *pid, block_t *p_bk )
 {
     const uint8_t *p = p_bk->p_buffer;
@@ -2212,6 +2584,13 @@ static bool GatherData( demux_t *p_demux, ts_pid_t *pid, block_t *p_bk )
     int         i_skip = 0;
     bool        i_ret  = false;
 
+    if( p_bk->i_flags & BLOCK_FLAG_PRIVATE_BATCH_START )
+    {
+        p_bk->i_flags &= ~BLOCK_FLAG_PRIVATE_BATCH_START;
+        if( !b_unit_start )
+            UnsharePES( pid->es );
+    }
+
 #if 0
     msg_Dbg( p_demux, "pid=%d unit_start=%d adaptation=%d payload=%d "
              "cc=0x%x", pid->i_pid, b_unit_start, b_adaptation,
@@ -2299,7 +2678,8 @@ static bool GatherData( demux_t *p_demux, ts_pid_t *pid, block_t *p_bk )
         }
     }
 
-    PCRHandle( p_demux, pid, p_bk );
+    PCRHandle( p_demux, pid, p_bk,
+               p_demux->p_sys->b_prg_threads ? pid->i_owner_number : -1 );
 
     if( i_skip >= 188 || pid->es->id == NULL )
     {
@@ -2400,6 +2780,198 @@ static bool GatherData( demux_t *p_demux, ts_pid_t *pid, block_t *p_bk )
     return i_ret;
 }
 
+/*****************************************************************************
+ * Program threads:
+ *****************************************************************************
+ * The demux thread reads the packets and handles the PSI, and dispatches the
+ * ES packets of each program to the thread of that program, where the PES
+ * are gathered and sent. A PCR goes to the thread of every program using
+ * its PID, so that each thread only updates its own program, in order with
+ * its data. The queues are bounded, so that the demux thread waits for
+ * slower threads. The threads are waited for when the packets read are
+ * flushed (seek, end of stream), and by the PAT/PMT callbacks before they
+ * change the PID table.
+ *****************************************************************************/
+/* Demuxes a packet for the program i_number: the packet of one of its ES,
+ * or a PCR of another PID */
+static void WorkerHandle( demux_t *p_demux, int i_number, ts_pid_t *pid,
+                          block_t *p_pkt )
+{
+    if( pid->b_valid && !pid->psi && pid->i_owner_number == i_number )
+        GatherData( p_demux, pid, p_pkt );
+    else
+    {
+        PCRHandle( p_demux, pid, p_pkt, i_number );
+        block_Release( p_pkt );
+    }
+}
+
+static void *WorkerThread( void *data )
+{
+    ts_worker_t *p_worker = data;
+    demux_t     *p_demux = p_worker->p_demux;
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    vlc_mutex_lock( &p_worker->lock );
+    for( ;; )
+    {
+        while( p_worker->p_queue == NULL && !p_worker->b_exit )
+            vlc_cond_wait( &p_worker->wait, &p_worker->lock );
+        if( p_worker->b_exit )
+            break;
+
+        block_t *p_pkt = p_worker->p_queue;
+        p_worker->p_queue = NULL;
+        p_worker->pp_queue_last = &p_worker->p_queue;
+        vlc_mutex_unlock( &p_worker->lock );
+
+        int i_done = 0;
+        while( p_pkt )
+        {
+            block_t *p_next = p_pkt->p_next;
+            ts_pid_t *pid = &p_sys->pid[PIDGet( p_pkt )];
+
+            p_pkt->p_next = NULL;
+            WorkerHandle( p_demux, p_worker->i_number, pid, p_pkt );
+            p_pkt = p_next;
+            i_done++;
+        }
+
+        vlc_mutex_lock( &p_worker->lock );
+        p_worker->i_queued -= i_done;
+        vlc_cond_signal( &p_worker->wait_done );
+    }
+    vlc_mutex_unlock( &p_worker->lock );
+    return NULL;
+}
+
+static ts_worker_t *WorkerGet( demux_t *p_demux, int i_number )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    for( int i = 0; i < p_sys->i_workers; i++ )
+        if( p_sys->workers[i]->i_number == i_number )
+            return p_sys->workers[i];
+
+    ts_worker_t *p_worker = malloc( sizeof(*p_worker) );
+    if( !p_worker )
+        return NULL;
+
+    p_worker->p_demux = p_demux;
+    p_worker->i_number = i_number;
+    vlc_mutex_init( &p_worker->lock );
+    vlc_cond_init( &p_worker->wait );
+    vlc_cond_init( &p_worker->wait_done );
+    p_worker->p_queue = NULL;
+    p_worker->pp_queue_last = &p_worker->p_queue;
+    p_worker->i_queued = 0;
+    p_worker->b_exit = false;
+    p_worker->p_batch = NULL;
+    p_worker->pp_batch_last = &p_worker->p_batch;
+    p_worker->i_batch = 0;
+
+    if( vlc_clone( &p_worker->thread, WorkerThread, p_worker,
+                   VLC_THREAD_PRIORITY_INPUT ) )
+    {
+        vlc_cond_destroy( &p_worker->wait_done );
+        vlc_cond_destroy( &p_worker->wait );
+        vlc_mutex_destroy( &p_worker->lock );
+        free( p_worker );
+        return NULL;
+    }
+
+    msg_Dbg( p_demux, "demuxing program %d on its own thread", i_number );
+    TAB_APPEND( p_sys->i_workers, p_sys->workers, p_worker );
+    return p_worker;
+}
+
+static void WorkerDispatch( demux_t *p_demux, int i_number, block_t *p_pkt )
+{
+    ts_worker_t *p_worker = WorkerGet( p_demux, i_number );
+
+    if( !p_pkt )
+        return;
+
+    if( !p_worker )
+    {
+        /* No thread for that program, demux it here */
+        WorkerHandle( p_demux, i_number,
+                      &p_demux->p_sys->pid[PIDGet( p_pkt )], p_pkt );
+        return;
+    }
+
+    block_ChainLastAppend( &p_worker->pp_batch_last, p_pkt );
+    p_worker->i_batch++;
+}
+
+static void WorkersQueue( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    for( int i = 0; i < p_sys->i_workers; i++ )
+    {
+        ts_worker_t *p_worker = p_sys->workers[i];
+
+        if( !p_worker->p_batch )
+            continue;
+
+        /* Wait for the thread to catch up, rather than queueing without
+         * bound */
+        vlc_mutex_lock( &p_worker->lock );
+        while( p_worker->i_queued >= TS_WORKER_BATCHES * p_sys->i_ts_read )
+            vlc_cond_wait( &p_worker->wait_done, &p_worker->lock );
+        *p_worker->pp_queue_last = p_worker->p_batch;
+        p_worker->pp_queue_last = p_worker->pp_batch_last;
+        p_worker->i_queued += p_worker->i_batch;
+        vlc_cond_signal( &p_worker->wait );
+        vlc_mutex_unlock( &p_worker->lock );
+
+        p_worker->p_batch = NULL;
+        p_worker->pp_batch_last = &p_worker->p_batch;
+        p_worker->i_batch = 0;
+    }
+}
+
+static void WorkersDrain( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    WorkersQueue( p_demux );
+    for( int i = 0; i < p_sys->i_workers; i++ )
+    {
+        ts_worker_t *p_worker = p_sys->workers[i];
+
+        vlc_mutex_lock( &p_worker->lock );
+        while( p_worker->i_queued > 0 )
+            vlc_cond_wait( &p_worker->wait_done, &p_worker->lock );
+        vlc_mutex_unlock( &p_worker->lock );
+    }
+}
+
+static void WorkersDelete( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    for( int i = 0; i < p_sys->i_workers; i++ )
+    {
+        ts_worker_t *p_worker = p_sys->workers[i];
+
+        vlc_mutex_lock( &p_worker->lock );
+        p_worker->b_exit = true;
+        vlc_cond_signal( &p_worker->wait );
+        vlc_mutex_unlock( &p_worker->lock );
+        vlc_join( p_worker->thread, NULL );
+
+        block_ChainRelease( p_worker->p_queue );
+        block_ChainRelease( p_worker->p_batch );
+        vlc_cond_destroy( &p_worker->wait_done );
+        vlc_cond_destroy( &p_worker->wait );
+        vlc_mutex_destroy( &p_worker->lock );
+        free( p_worker );
+    }
+    TAB_CLEAN( p_sys->i_workers, p_sys->workers );
+}
+
 static void PIDFillFormat( es_format_t *fmt, int i_stream_type )
 {
     switch( i_stream_type )
@@ -3521,6 +4093,7 @@ static void PMTSetupEsTeletext( demux_t *p_demux, ts_pid_t *pid,
                 p_es->i_data_size = 0;
                 p_es->i_data_gathered = 0;
                 p_es->pp_last = &p_es->p_data;
+                p_es->pp_shared = &p_es->p_data;
                 p_es->data_type = TS_ES_DATA_PES;
                 p_es->p_mpeg4desc = NULL;
 
@@ -3606,6 +4179,7 @@ static void PMTSetupEsDvbSubtitle( demux_t *p_demux, ts_pid_t *pid,
                 p_es->i_data_size = 0;
                 p_es->i_data_gathered = 0;
                 p_es->pp_last = &p_es->p_data;
+                p_es->pp_shared = &p_es->p_data;
                 p_es->data_type = TS_ES_DATA_PES;
                 p_es->p_mpeg4desc = NULL;
 
@@ -3989,6 +4563,9 @@ static void PMTCallBack( void *data, dvbpsi_pmt_t *p_pmt )
 
     msg_Dbg( p_demux, "PMTCallBack called" );
 
+    /* The program threads must not see the PID table changing */
+    WorkersDrain( p_demux );
+
     /* First find this PMT declared in PAT */
     for( int i = 0; !pmt && i < p_sys->i_pmt; i++ )
         for( int i_prg = 0; !pmt && i_prg < p_sys->pmt[i]->psi->i_prg; i_prg++ )
@@ -4270,6 +4847,9 @@ static void PATCallBack( void *data, dvbpsi_pat_t *p_pat )
 
     msg_Dbg( p_demux, "PATCallBack called" );
 
+    /* The program threads must not see the PID table changing */
+    WorkersDrain( p_demux );
+
     if( ( pat->psi->i_pat_version != -1 &&
             ( !p_pat->b_current_next ||
               p_pat->i_version == pat->psi->i_pat_version ) ) ||
@@ -0,0 +1,159 @@
+/*****************************************************************************
+ * startcode_helper.h: 00 00 01 start code scanning
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_STARTCODE_HELPER_H_
+#define VLC_STARTCODE_HELPER_H_
+
+#include <vlc_cpu.h>
+
+#if defined(HAVE_SSE2_INTRINSICS) && (defined(__i386__) || defined(__x86_64__))
+# include <emmintrin.h>
+# define STARTCODE_SSE2
+# if defined(__AVX2__) || VLC_GCC_VERSION(4, 9) || defined(__clang__)
+#  include <immintrin.h>
+#  define STARTCODE_AVX2
+# endif
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+# include <arm_neon.h>
+# define STARTCODE_NEON
+#endif
+
+/* Skips ahead according to the third byte of the candidate: above 1, it
+ * cannot be part of any start code beginning at the first three positions. */
+static inline const uint8_t *startcode_FindAnnexB_C( const uint8_t *p,
+                                                     const uint8_t *end )
+{
+    while( end - p > 2 )
+    {
+        if( p[2] > 1 )
+            p += 3;
+        else if( p[1] )
+            p += 2;
+        else if( p[0] || p[2] != 1 )
+            p++;
+        else
+            return p;
+    }
+    return NULL;
+}
+
+/* The vector versions test one start code position per byte of the vector,
+ * which needs two more bytes after it. */
+#ifdef STARTCODE_SSE2
+VLC_SSE2
+static inline const uint8_t *startcode_FindAnnexB_SSE2( const uint8_t *p,
+                                                        const uint8_t *end )
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8( 1 );
+
+    while( end - p >= 16 + 2 )
+    {
+        __m128i b0 = _mm_loadu_si128( (const __m128i *)p );
+        __m128i b1 = _mm_loadu_si128( (const __m128i *)(p + 1) );
+        __m128i b2 = _mm_loadu_si128( (const __m128i *)(p + 2) );
+        __m128i m = _mm_and_si128( _mm_cmpeq_epi8( _mm_or_si128( b0, b1 ), zero ),
+                                   _mm_cmpeq_epi8( b2, one ) );
+        unsigned i_mask = _mm_movemask_epi8( m );
+
+        if( i_mask )
+            return p + ctz( i_mask );
+        p += 16;
+    }
+    return startcode_FindAnnexB_C( p, end );
+}
+#endif
+
+#ifdef STARTCODE_AVX2
+VLC_AVX2
+static inline const uint8_t *startcode_FindAnnexB_AVX2( const uint8_t *p,
+                                                        const uint8_t *end )
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi8( 1 );
+
+    while( end - p >= 32 + 2 )
+    {
+        __m256i b0 = _mm256_loadu_si256( (const __m256i *)p );
+        __m256i b1 = _mm256_loadu_si256( (const __m256i *)(p + 1) );
+        __m256i b2 = _mm256_loadu_si256( (const __m256i *)(p + 2) );
+        __m256i m = _mm256_and_si256(
+                        _mm256_cmpeq_epi8( _mm256_or_si256( b0, b1 ), zero ),
+                        _mm256_cmpeq_epi8( b2, one ) );
+        unsigned i_mask = _mm256_movemask_epi8( m );
+
+        if( i_mask )
+            return p + ctz( i_mask );
+        p += 32;
+    }
+    return startcode_FindAnnexB_C( p, end );
+}
+#endif
+
+#ifdef STARTCODE_NEON
+static inline const uint8_t *startcode_FindAnnexB_NEON( const uint8_t *p,
+                                                        const uint8_t *end )
+{
+    const uint8x16_t zero = vdupq_n_u8( 0 );
+    const uint8x16_t one = vdupq_n_u8( 1 );
+
+    while( end - p >= 16 + 2 )
+    {
+        uint8x16_t b0 = vld1q_u8( p );
+        uint8x16_t b1 = vld1q_u8( p + 1 );
+        uint8x16_t b2 = vld1q_u8( p + 2 );
+        uint64x2_t m = vreinterpretq_u64_u8(
+                           vandq_u8( vceqq_u8( vorrq_u8( b0, b1 ), zero ),
+                                     vceqq_u8( b2, one ) ) );
+
+        /* There is no cheap mask extraction, locate the match in C */
+        if( vgetq_lane_u64( m, 0 ) | vgetq_lane_u64( m, 1 ) )
+            return startcode_FindAnnexB_C( p, p + 16 + 2 );
+        p += 16;
+    }
+    return startcode_FindAnnexB_C( p, end );
+}
+#endif
+
+/**
+ * Returns the first 00 00 01 start code in [p, end[, or NULL.
+ * It can be given to block_FindStartcodeFromOffset() as start code helper.
+ */
+static inline const uint8_t *startcode_FindAnnexB( const uint8_t *p,
+                                                   const uint8_t *end )
+{
+#ifdef STARTCODE_AVX2
+    if( vlc_CPU_AVX2() )
+        return startcode_FindAnnexB_AVX2( p, end );
+#endif
+#ifdef STARTCODE_SSE2
+    if( vlc_CPU_SSE2() )
+        return startcode_FindAnnexB_SSE2( p, end );
+#endif
+#ifdef STARTCODE_NEON
+    return startcode_FindAnnexB_NEON( p, end );
+#else
+    return startcode_FindAnnexB_C( p, end );
+#endif
+}
+
+#endif /* VLC_STARTCODE_HELPER_H_ */
@@ -333,6 +333,8 @@ static void transcode_video_filter_init( sout_stream_t *p_stream,
                            transcode_video_filter_allocation_init,
                            transcode_video_filter_allocation_clear,
                            p_stream->p_sys );
+        filter_chain_SetThreads( id->p_uf_chain,
+                    var_InheritInteger( p_stream, "video-filter-threads" ) );
         filter_chain_Reset( id->p_uf_chain, p_fmt_out,
                             &id->p_encoder->fmt_in );
         if( p_fmt_out->video.i_chroma != id->p_encoder->fmt_in.video.i_chroma )
@@ -802,6 +804,18 @@ static void OutputFrame( sout_stream_t *p_stream, picture_t *p_pic, sout_stream_
         picture_Release( p_pic );
 }
 
+/* Outputs the pictures still in the user filter chain */
+static void DrainFilters( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
+                          block_t **out )
+{
+    picture_t *p_pic;
+
+    if( id->p_uf_chain == NULL )
+        return;
+    while( (p_pic = filter_chain_VideoDrain( id->p_uf_chain )) != NULL )
+        OutputFrame( p_stream, p_pic, id, out );
+}
+
 int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                                     block_t *in, block_t **out )
 {
@@ -811,6 +825,9 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
 
     if( unlikely( in == NULL ) )
     {
+        if( id->p_encoder->p_module )
+            DrainFilters( p_stream, id, out );
+
         if( p_sys->i_threads == 0 )
         {
             block_t *p_block;
@@ -852,6 +869,7 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                         id->fmt_input_video.i_sar_num, id->p_decoder->fmt_out.video.i_sar_num,
                         id->fmt_input_video.i_sar_den, id->p_decoder->fmt_out.video.i_sar_den
                     );
+            DrainFilters( p_stream, id, out );
             /* Close filters */
             if( id->p_f_chain )
                 filter_chain_Delete( id->p_f_chain );
@@ -0,0 +1,958 @@
+/*****************************************************************************
+ * convert.c : single pass 4:2:0 YUV and 32-bit RGB conversions
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Every conversion goes through pairs of luma lines and their chroma line:
+ * the source format reads them as 8-bit 4:2:0, directly into the destination
+ * planes whenever it can, and the destination format writes them. The lines
+ * stay in the cache in between, so any pair of the formats below is done in
+ * one pass over the pictures, where the chain filter needs two conversions
+ * and an intermediate picture.
+ */
+
+/*****************************************************************************
+ * Preamble
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <math.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_filter.h>
+#include <vlc_cpu.h>
+
+#if defined(HAVE_SSE2_INTRINSICS) && (defined(__i386__) || defined(__x86_64__))
+# include <emmintrin.h>
+# define CONVERT_SSE2
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+# include <arm_neon.h>
+# define CONVERT_NEON
+#endif
+
+/****************************************************************************
+ * Local prototypes
+ ****************************************************************************/
+static int  Open ( vlc_object_t * );
+static void Close( vlc_object_t * );
+static picture_t *Filter( filter_t *, picture_t * );
+
+/*****************************************************************************
+ * Module descriptor
+ *****************************************************************************/
+/* Above swscale and the specific converters of the same pairs */
+vlc_module_begin ()
+    set_description( N_("YUV 4:2:0 and RGB 32-bit video conversions") )
+    set_capability( "video filter2", 200 )
+    set_callbacks( Open, Close )
+vlc_module_end ()
+
+/*****************************************************************************
+ * Matrices
+ *****************************************************************************
+ * The products are done on 16-bit samples shifted left by 7 bits, keeping
+ * the 16 high bits, so that the SIMD kernels give the very same results.
+ *****************************************************************************/
+typedef struct
+{
+    int16_t i_y_offset;
+    int16_t y;              /* Q13 */
+    int16_t rv, gu, gv, bu; /* Q13 */
+} convert_yuv_rgb_t;
+
+typedef struct
+{
+    int16_t i_y_offset;
+    int16_t yr, yg, yb;     /* Q15 */
+    int16_t ur, ug, ub;     /* Q15 */
+    int16_t vr, vg, vb;     /* Q15 */
+} convert_rgb_yuv_t;
+
+static void MatrixInit( convert_yuv_rgb_t *p_dec, convert_rgb_yuv_t *p_enc,
+                        bool b_bt709, bool b_full_range )
+{
+    const double kr = b_bt709 ? .2126 : .299;
+    const double kb = b_bt709 ? .0722 : .114;
+    const double kg = 1. - kr - kb;
+    const double ys = b_full_range ? 1. : 219. / 255.;
+    const double cs = b_full_range ? 1. : 224. / 255.;
+
+    p_dec->i_y_offset = b_full_range ? 0 : 16;
+    p_dec->y  = lrint( 8192. / ys );
+    p_dec->rv = lrint( 8192. * 2. * (1. - kr) / cs );
+    p_dec->gu = lrint( -8192. * 2. * (1. - kb) * kb / kg / cs );
+    p_dec->gv = lrint( -8192. * 2. * (1. - kr) * kr / kg / cs );
+    p_dec->bu = lrint( 8192. * 2. * (1. - kb) / cs );
+
+    p_enc->i_y_offset = b_full_range ? 0 : 16;
+    p_enc->yr = lrint( 32768. * kr * ys );
+    p_enc->yg = lrint( 32768. * kg * ys );
+    p_enc->yb = lrint( 32768. * kb * ys );
+    p_enc->ur = lrint( -32768. * kr / (2. * (1. - kb)) * cs );
+    p_enc->ug = lrint( -32768. * kg / (2. * (1. - kb)) * cs );
+    p_enc->ub = lrint( 16384. * cs );
+    p_enc->vr = lrint( 16384. * cs );
+    p_enc->vg = lrint( -32768. * kg / (2. * (1. - kr)) * cs );
+    p_enc->vb = lrint( -32768. * kb / (2. * (1. - kr)) * cs );
+}
+
+/*****************************************************************************
+ * Kernels
+ *****************************************************************************/
+typedef struct
+{
+    /* uv -> u, v, for i_count chroma samples */
+    void (*pf_deinterleave)( uint8_t *, uint8_t *, const uint8_t *, unsigned );
+    /* u, v -> uv */
+    void (*pf_interleave)( uint8_t *, const uint8_t *, const uint8_t *,
+                           unsigned );
+    /* Rounded right shift of 16-bit samples into 8-bit ones */
+    void (*pf_narrow)( uint8_t *, const uint16_t *, unsigned, unsigned );
+    /* One line of 4:2:0 to 32-bit RGB, the red at byte 0 if b_swap */
+    void (*pf_yuv_rgb)( uint8_t *, const uint8_t *, const uint8_t *,
+                        const uint8_t *, unsigned, bool,
+                        const convert_yuv_rgb_t * );
+    /* Two lines of 32-bit RGB to 4:2:0 */
+    void (*pf_rgb_yuv)( uint8_t *, uint8_t *, uint8_t *, uint8_t *,
+                        const uint8_t *, const uint8_t *, unsigned, bool,
+                        const convert_rgb_yuv_t * );
+} convert_kernels_t;
+
+static inline int16_t MulHi( int a, int b )
+{
+    return (a * b) >> 16;
+}
+
+static void DeinterleaveC( uint8_t *p_u, uint8_t *p_v, const uint8_t *p_uv,
+                           unsigned i_count )
+{
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        p_u[i] = p_uv[2 * i];
+        p_v[i] = p_uv[2 * i + 1];
+    }
+}
+
+static void InterleaveC( uint8_t *p_uv, const uint8_t *p_u, const uint8_t *p_v,
+                         unsigned i_count )
+{
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        p_uv[2 * i]     = p_u[i];
+        p_uv[2 * i + 1] = p_v[i];
+    }
+}
+
+static void NarrowC( uint8_t *p_dst, const uint16_t *p_src, unsigned i_count,
+                     unsigned i_shift )
+{
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        /* No overflow of the rounding for the MSB aligned samples */
+        const unsigned v = (p_src[i] >> i_shift)
+                         + ((p_src[i] >> (i_shift - 1)) & 1);
+        p_dst[i] = __MIN(v, 255);
+    }
+}
+
+static void YuvRgbC( uint8_t *p_rgb, const uint8_t *p_y, const uint8_t *p_u,
+                     const uint8_t *p_v, unsigned i_width, bool b_swap,
+                     const convert_yuv_rgb_t *m )
+{
+    const unsigned r = b_swap ? 0 : 2, b = b_swap ? 2 : 0;
+
+    for( unsigned x = 0; x < i_width; x++ )
+    {
+        const int u = (p_u[x / 2] - 128) * 128;
+        const int v = (p_v[x / 2] - 128) * 128;
+        const int y = MulHi( (p_y[x] - m->i_y_offset) * 128, m->y );
+        const int16_t cr = MulHi( v, m->rv );
+        const int16_t cg = MulHi( u, m->gu ) + MulHi( v, m->gv );
+        const int16_t cb = MulHi( u, m->bu );
+
+        p_rgb[4 * x + r] = VLC_CLIP( (y + cr + 8) >> 4, 0, 255 );
+        p_rgb[4 * x + 1] = VLC_CLIP( (y + cg + 8) >> 4, 0, 255 );
+        p_rgb[4 * x + b] = VLC_CLIP( (y + cb + 8) >> 4, 0, 255 );
+        p_rgb[4 * x + 3] = 0xff;
+    }
+}
+
+static void RgbYuvC( uint8_t *p_y0, uint8_t *p_y1, uint8_t *p_u, uint8_t *p_v,
+                     const uint8_t *p_rgb0, const uint8_t *p_rgb1,
+                     unsigned i_width, bool b_swap,
+                     const convert_rgb_yuv_t *m )
+{
+    const unsigned r = b_swap ? 0 : 2, b = b_swap ? 2 : 0;
+    const int i_y_offset = (m->i_y_offset << 6) + 32;
+    const int i_c_offset = (128 << 6) + 32;
+
+    for( unsigned x = 0; x < i_width; x += 2 )
+    {
+        const uint8_t *s[4] = {
+            &p_rgb0[4 * x], &p_rgb0[4 * x + 4],
+            &p_rgb1[4 * x], &p_rgb1[4 * x + 4],
+        };
+        uint8_t *d[4] = { &p_y0[x], &p_y0[x + 1], &p_y1[x], &p_y1[x + 1] };
+        int sr = 0, sg = 0, sb = 0;
+
+        for( unsigned i = 0; i < 4; i++ )
+        {
+            const int16_t t = MulHi( s[i][r] << 7, m->yr )
+                            + MulHi( s[i][1] << 7, m->yg )
+                            + MulHi( s[i][b] << 7, m->yb );
+
+            *d[i] = VLC_CLIP( (t + i_y_offset) >> 6, 0, 255 );
+            sr += s[i][r];
+            sg += s[i][1];
+            sb += s[i][b];
+        }
+
+        /* The sums of 4 samples shifted by 5 are the means shifted by 7 */
+        const int16_t u = MulHi( sr << 5, m->ur ) + MulHi( sg << 5, m->ug )
+                        + MulHi( sb << 5, m->ub );
+        const int16_t v = MulHi( sr << 5, m->vr ) + MulHi( sg << 5, m->vg )
+                        + MulHi( sb << 5, m->vb );
+        p_u[x / 2] = VLC_CLIP( (u + i_c_offset) >> 6, 0, 255 );
+        p_v[x / 2] = VLC_CLIP( (v + i_c_offset) >> 6, 0, 255 );
+    }
+}
+
+static const convert_kernels_t kernels_c = {
+    DeinterleaveC, InterleaveC, NarrowC, YuvRgbC, RgbYuvC,
+};
+
+#ifdef CONVERT_SSE2
+VLC_SSE2
+static void DeinterleaveSSE2( uint8_t *p_u, uint8_t *p_v, const uint8_t *p_uv,
+                              unsigned i_count )
+{
+    const __m128i mask = _mm_set1_epi16( 0xff );
+    unsigned i = 0;
+
+    for( ; i + 16 <= i_count; i += 16 )
+    {
+        const __m128i a = _mm_loadu_si128( (const __m128i *)&p_uv[2 * i] );
+        const __m128i b = _mm_loadu_si128( (const __m128i *)&p_uv[2 * i + 16] );
+
+        _mm_storeu_si128( (__m128i *)&p_u[i],
+                          _mm_packus_epi16( _mm_and_si128( a, mask ),
+                                            _mm_and_si128( b, mask ) ) );
+        _mm_storeu_si128( (__m128i *)&p_v[i],
+                          _mm_packus_epi16( _mm_srli_epi16( a, 8 ),
+                                            _mm_srli_epi16( b, 8 ) ) );
+    }
+    DeinterleaveC( &p_u[i], &p_v[i], &p_uv[2 * i], i_count - i );
+}
+
+VLC_SSE2
+static void InterleaveSSE2( uint8_t *p_uv, const uint8_t *p_u,
+                            const uint8_t *p_v, unsigned i_count )
+{
+    unsigned i = 0;
+
+    for( ; i + 16 <= i_count; i += 16 )
+    {
+        const __m128i u = _mm_loadu_si128( (const __m128i *)&p_u[i] );
+        const __m128i v = _mm_loadu_si128( (const __m128i *)&p_v[i] );
+
+        _mm_storeu_si128( (__m128i *)&p_uv[2 * i], _mm_unpacklo_epi8( u, v ) );
+        _mm_storeu_si128( (__m128i *)&p_uv[2 * i + 16],
+                          _mm_unpackhi_epi8( u, v ) );
+    }
+    InterleaveC( &p_uv[2 * i], &p_u[i], &p_v[i], i_count - i );
+}
+
+VLC_SSE2
+static void NarrowSSE2( uint8_t *p_dst, const uint16_t *p_src,
+                        unsigned i_count, unsigned i_shift )
+{
+    const __m128i shift = _mm_cvtsi32_si128( i_shift );
+    const __m128i shift1 = _mm_cvtsi32_si128( i_shift - 1 );
+    const __m128i one = _mm_set1_epi16( 1 );
+    unsigned i = 0;
+
+    for( ; i + 16 <= i_count; i += 16 )
+    {
+        __m128i a = _mm_loadu_si128( (const __m128i *)&p_src[i] );
+        __m128i b = _mm_loadu_si128( (const __m128i *)&p_src[i + 8] );
+
+        a = _mm_add_epi16( _mm_srl_epi16( a, shift ),
+                           _mm_and_si128( _mm_srl_epi16( a, shift1 ), one ) );
+        b = _mm_add_epi16( _mm_srl_epi16( b, shift ),
+                           _mm_and_si128( _mm_srl_epi16( b, shift1 ), one ) );
+        _mm_storeu_si128( (__m128i *)&p_dst[i], _mm_packus_epi16( a, b ) );
+    }
+    NarrowC( &p_dst[i], &p_src[i], i_count - i, i_shift );
+}
+
+/* Rounds, shifts and saturates two vectors of 16-bit sums into bytes */
+VLC_SSE2
+static inline __m128i PackSSE2( __m128i lo, __m128i hi, __m128i round,
+                                int i_shift )
+{
+    return _mm_packus_epi16(
+        _mm_srai_epi16( _mm_add_epi16( lo, round ), i_shift ),
+        _mm_srai_epi16( _mm_add_epi16( hi, round ), i_shift ) );
+}
+
+VLC_SSE2
+static void YuvRgbSSE2( uint8_t *p_rgb, const uint8_t *p_y, const uint8_t *p_u,
+                        const uint8_t *p_v, unsigned i_width, bool b_swap,
+                        const convert_yuv_rgb_t *m )
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi16( 8 );
+    const __m128i c128 = _mm_set1_epi16( 128 );
+    const __m128i yoff = _mm_set1_epi16( m->i_y_offset );
+    const __m128i cy = _mm_set1_epi16( m->y );
+    const __m128i crv = _mm_set1_epi16( m->rv );
+    const __m128i cgu = _mm_set1_epi16( m->gu );
+    const __m128i cgv = _mm_set1_epi16( m->gv );
+    const __m128i cbu = _mm_set1_epi16( m->bu );
+    const __m128i alpha = _mm_set1_epi8( -1 );
+    unsigned x = 0;
+
+    for( ; x + 16 <= i_width; x += 16 )
+    {
+        __m128i u = _mm_loadl_epi64( (const __m128i *)&p_u[x / 2] );
+        __m128i v = _mm_loadl_epi64( (const __m128i *)&p_v[x / 2] );
+        const __m128i y = _mm_loadu_si128( (const __m128i *)&p_y[x] );
+
+        u = _mm_slli_epi16( _mm_sub_epi16( _mm_unpacklo_epi8( u, zero ),
+                                           c128 ), 7 );
+        v = _mm_slli_epi16( _mm_sub_epi16( _mm_unpacklo_epi8( v, zero ),
+                                           c128 ), 7 );
+
+        const __m128i cr = _mm_mulhi_epi16( v, crv );
+        const __m128i cg = _mm_add_epi16( _mm_mulhi_epi16( u, cgu ),
+                                          _mm_mulhi_epi16( v, cgv ) );
+        const __m128i cb = _mm_mulhi_epi16( u, cbu );
+        const __m128i ylo = _mm_mulhi_epi16( _mm_slli_epi16(
+            _mm_sub_epi16( _mm_unpacklo_epi8( y, zero ), yoff ), 7 ), cy );
+        const __m128i yhi = _mm_mulhi_epi16( _mm_slli_epi16(
+            _mm_sub_epi16( _mm_unpackhi_epi8( y, zero ), yoff ), 7 ), cy );
+
+        /* Each chroma sample goes to two pixels */
+#define COMPONENT(c) \
+        PackSSE2( _mm_add_epi16( ylo, _mm_unpacklo_epi16( c, c ) ), \
+                  _mm_add_epi16( yhi, _mm_unpackhi_epi16( c, c ) ), round, 4 )
+        const __m128i r = COMPONENT(cr);
+        const __m128i g = COMPONENT(cg);
+        const __m128i b = COMPONENT(cb);
+#undef COMPONENT
+
+        const __m128i c0 = b_swap ? r : b;
+        const __m128i c2 = b_swap ? b : r;
+        const __m128i lo01 = _mm_unpacklo_epi8( c0, g );
+        const __m128i hi01 = _mm_unpackhi_epi8( c0, g );
+        const __m128i lo23 = _mm_unpacklo_epi8( c2, alpha );
+        const __m128i hi23 = _mm_unpackhi_epi8( c2, alpha );
+        __m128i *p = (__m128i *)&p_rgb[4 * x];
+
+        _mm_storeu_si128( &p[0], _mm_unpacklo_epi16( lo01, lo23 ) );
+        _mm_storeu_si128( &p[1], _mm_unpackhi_epi16( lo01, lo23 ) );
+        _mm_storeu_si128( &p[2], _mm_unpacklo_epi16( hi01, hi23 ) );
+        _mm_storeu_si128( &p[3], _mm_unpackhi_epi16( hi01, hi23 ) );
+    }
+    YuvRgbC( &p_rgb[4 * x], &p_y[x], &p_u[x / 2], &p_v[x / 2], i_width - x,
+             b_swap, m );
+}
+
+/* Splits 8 pixels into the 16-bit samples of their bytes 0, 1 and 2 */
+VLC_SSE2
+static inline void UnpackRgbSSE2( const uint8_t *p_rgb, __m128i *p_c0,
+                                  __m128i *p_c1, __m128i *p_c2 )
+{
+    const __m128i mask = _mm_set1_epi32( 0xff );
+    const __m128i a = _mm_loadu_si128( (const __m128i *)p_rgb );
+    const __m128i b = _mm_loadu_si128( (const __m128i *)&p_rgb[16] );
+
+    *p_c0 = _mm_packs_epi32( _mm_and_si128( a, mask ),
+                             _mm_and_si128( b, mask ) );
+    *p_c1 = _mm_packs_epi32( _mm_and_si128( _mm_srli_epi32( a, 8 ), mask ),
+                             _mm_and_si128( _mm_srli_epi32( b, 8 ), mask ) );
+    *p_c2 = _mm_packs_epi32( _mm_and_si128( _mm_srli_epi32( a, 16 ), mask ),
+                             _mm_and_si128( _mm_srli_epi32( b, 16 ), mask ) );
+}
+
+VLC_SSE2
+static inline __m128i Dot3SSE2( __m128i r, __m128i g, __m128i b,
+                                __m128i cr, __m128i cg, __m128i cb )
+{
+    return _mm_add_epi16( _mm_add_epi16( _mm_mulhi_epi16( r, cr ),
+                                         _mm_mulhi_epi16( g, cg ) ),
+                          _mm_mulhi_epi16( b, cb ) );
+}
+
+VLC_SSE2
+static void RgbYuvSSE2( uint8_t *p_y0, uint8_t *p_y1, uint8_t *p_u,
+                        uint8_t *p_v, const uint8_t *p_rgb0,
+                        const uint8_t *p_rgb1, unsigned i_width, bool b_swap,
+                        const convert_rgb_yuv_t *m )
+{
+    const __m128i one = _mm_set1_epi16( 1 );
+    const __m128i yround = _mm_set1_epi16( (m->i_y_offset << 6) + 32 );
+    const __m128i cround = _mm_set1_epi16( (128 << 6) + 32 );
+    const __m128i yr = _mm_set1_epi16( m->yr );
+    const __m128i yg = _mm_set1_epi16( m->yg );
+    const __m128i yb = _mm_set1_epi16( m->yb );
+    unsigned x = 0;
+
+    for( ; x + 16 <= i_width; x += 16 )
+    {
+        const uint8_t *pp_src[2] = { &p_rgb0[4 * x], &p_rgb1[4 * x] };
+        uint8_t *pp_dst[2] = { &p_y0[x], &p_y1[x] };
+        __m128i sr[2], sg[2], sb[2];
+
+        for( unsigned j = 0; j < 2; j++ )
+        {
+            __m128i r[2], g[2], b[2];
+
+            for( unsigned k = 0; k < 2; k++ )
+            {
+                UnpackRgbSSE2( &pp_src[j][32 * k],
+                               b_swap ? &r[k] : &b[k], &g[k],
+                               b_swap ? &b[k] : &r[k] );
+                /* Sums of the horizontal pairs, for the chroma */
+                const __m128i pr = _mm_madd_epi16( r[k], one );
+                const __m128i pg = _mm_madd_epi16( g[k], one );
+                const __m128i pb = _mm_madd_epi16( b[k], one );
+                if( j == 0 )
+                {
+                    sr[k] = pr; sg[k] = pg; sb[k] = pb;
+                }
+                else
+                {
+                    sr[k] = _mm_add_epi32( sr[k], pr );
+                    sg[k] = _mm_add_epi32( sg[k], pg );
+                    sb[k] = _mm_add_epi32( sb[k], pb );
+                }
+                r[k] = _mm_slli_epi16( r[k], 7 );
+                g[k] = _mm_slli_epi16( g[k], 7 );
+                b[k] = _mm_slli_epi16( b[k], 7 );
+            }
+            _mm_storeu_si128( (__m128i *)pp_dst[j],
+                PackSSE2( Dot3SSE2( r[0], g[0], b[0], yr, yg, yb ),
+                          Dot3SSE2( r[1], g[1], b[1], yr, yg, yb ),
+                          yround, 6 ) );
+        }
+
+        const __m128i r = _mm_slli_epi16( _mm_packs_epi32( sr[0], sr[1] ), 5 );
+        const __m128i g = _mm_slli_epi16( _mm_packs_epi32( sg[0], sg[1] ), 5 );
+        const __m128i b = _mm_slli_epi16( _mm_packs_epi32( sb[0], sb[1] ), 5 );
+        const __m128i u = Dot3SSE2( r, g, b, _mm_set1_epi16( m->ur ),
+                                    _mm_set1_epi16( m->ug ),
+                                    _mm_set1_epi16( m->ub ) );
+        const __m128i v = Dot3SSE2( r, g, b, _mm_set1_epi16( m->vr ),
+                                    _mm_set1_epi16( m->vg ),
+                                    _mm_set1_epi16( m->vb ) );
+        const __m128i uv = PackSSE2( u, v, cround, 6 );
+
+        _mm_storel_epi64( (__m128i *)&p_u[x / 2], uv );
+        _mm_storel_epi64( (__m128i *)&p_v[x / 2], _mm_srli_si128( uv, 8 ) );
+    }
+    RgbYuvC( &p_y0[x], &p_y1[x], &p_u[x / 2], &p_v[x / 2],
+             &p_rgb0[4 * x], &p_rgb1[4 * x], i_width - x, b_swap, m );
+}
+
+static const convert_kernels_t kernels_sse2 = {
+    DeinterleaveSSE2, InterleaveSSE2, NarrowSSE2, YuvRgbSSE2, RgbYuvSSE2,
+};
+#endif
+
+#ifdef CONVERT_NEON
+static void DeinterleaveNEON( uint8_t *p_u, uint8_t *p_v, const uint8_t *p_uv,
+                              unsigned i_count )
+{
+    unsigned i = 0;
+
+    for( ; i + 16 <= i_count; i += 16 )
+    {
+        const uint8x16x2_t uv = vld2q_u8( &p_uv[2 * i] );
+
+        vst1q_u8( &p_u[i], uv.val[0] );
+        vst1q_u8( &p_v[i], uv.val[1] );
+    }
+    DeinterleaveC( &p_u[i], &p_v[i], &p_uv[2 * i], i_count - i );
+}
+
+static void InterleaveNEON( uint8_t *p_uv, const uint8_t *p_u,
+                            const uint8_t *p_v, unsigned i_count )
+{
+    unsigned i = 0;
+
+    for( ; i + 16 <= i_count; i += 16 )
+    {
+        uint8x16x2_t uv;
+
+        uv.val[0] = vld1q_u8( &p_u[i] );
+        uv.val[1] = vld1q_u8( &p_v[i] );
+        vst2q_u8( &p_uv[2 * i], uv );
+    }
+    InterleaveC( &p_uv[2 * i], &p_u[i], &p_v[i], i_count - i );
+}
+
+static void NarrowNEON( uint8_t *p_dst, const uint16_t *p_src,
+                        unsigned i_count, unsigned i_shift )
+{
+    const int16x8_t shift = vdupq_n_s16( -(int)i_shift );
+    unsigned i = 0;
+
+    for( ; i + 16 <= i_count; i += 16 )
+    {
+        const uint16x8_t a = vrshlq_u16( vld1q_u16( &p_src[i] ), shift );
+        const uint16x8_t b = vrshlq_u16( vld1q_u16( &p_src[i + 8] ), shift );
+
+        vst1q_u8( &p_dst[i], vcombine_u8( vqmovn_u16( a ), vqmovn_u16( b ) ) );
+    }
+    NarrowC( &p_dst[i], &p_src[i], i_count - i, i_shift );
+}
+
+static inline int16x8_t MulHiNEON( int16x8_t a, int16_t b )
+{
+    return vcombine_s16( vshrn_n_s32( vmull_n_s16( vget_low_s16( a ), b ), 16 ),
+                         vshrn_n_s32( vmull_n_s16( vget_high_s16( a ), b ), 16 ) );
+}
+
+static void YuvRgbNEON( uint8_t *p_rgb, const uint8_t *p_y, const uint8_t *p_u,
+                        const uint8_t *p_v, unsigned i_width, bool b_swap,
+                        const convert_yuv_rgb_t *m )
+{
+    const int16x8_t c128 = vdupq_n_s16( 128 );
+    const int16x8_t yoff = vdupq_n_s16( m->i_y_offset );
+    unsigned x = 0;
+
+    for( ; x + 16 <= i_width; x += 16 )
+    {
+        const int16x8_t u = vshlq_n_s16( vsubq_s16( vreinterpretq_s16_u16(
+                vmovl_u8( vld1_u8( &p_u[x / 2] ) ) ), c128 ), 7 );
+        const int16x8_t v = vshlq_n_s16( vsubq_s16( vreinterpretq_s16_u16(
+                vmovl_u8( vld1_u8( &p_v[x / 2] ) ) ), c128 ), 7 );
+        const uint8x16_t y = vld1q_u8( &p_y[x] );
+        const int16x8_t ylo = MulHiNEON( vshlq_n_s16( vsubq_s16(
+                vreinterpretq_s16_u16( vmovl_u8( vget_low_u8( y ) ) ), yoff ),
+                7 ), m->y );
+        const int16x8_t yhi = MulHiNEON( vshlq_n_s16( vsubq_s16(
+                vreinterpretq_s16_u16( vmovl_u8( vget_high_u8( y ) ) ), yoff ),
+                7 ), m->y );
+        const int16x8_t cr = MulHiNEON( v, m->rv );
+        const int16x8_t cg = vaddq_s16( MulHiNEON( u, m->gu ),
+                                        MulHiNEON( v, m->gv ) );
+        const int16x8_t cb = MulHiNEON( u, m->bu );
+        uint8x16x4_t rgb;
+
+        /* Each chroma sample goes to two pixels */
+#define COMPONENT(c) \
+        vcombine_u8( \
+            vqmovun_s16( vrshrq_n_s16( vaddq_s16( ylo, vzipq_s16( c, c ).val[0] ), 4 ) ), \
+            vqmovun_s16( vrshrq_n_s16( vaddq_s16( yhi, vzipq_s16( c, c ).val[1] ), 4 ) ) )
+        rgb.val[b_swap ? 0 : 2] = COMPONENT(cr);
+        rgb.val[1] = COMPONENT(cg);
+        rgb.val[b_swap ? 2 : 0] = COMPONENT(cb);
+#undef COMPONENT
+        rgb.val[3] = vdupq_n_u8( 0xff );
+        vst4q_u8( &p_rgb[4 * x], rgb );
+    }
+    YuvRgbC( &p_rgb[4 * x], &p_y[x], &p_u[x / 2], &p_v[x / 2], i_width - x,
+             b_swap, m );
+}
+
+/* No NEON version of the RGB to YUV conversion yet */
+static const convert_kernels_t kernels_neon = {
+    DeinterleaveNEON, InterleaveNEON, NarrowNEON, YuvRgbNEON, RgbYuvC,
+};
+#endif
+
+/*****************************************************************************
+ * Formats
+ *****************************************************************************/
+enum
+{
+    CONVERT_PLANAR,     /* 8-bit 4:2:0 planar YUV */
+    CONVERT_SEMIPLANAR, /* 8-bit 4:2:0 Y and interleaved UV planes */
+    CONVERT_PLANAR_16,  /* 4:2:0 planar YUV on 16 bits, source only */
+    CONVERT_P010,       /* MSB aligned semiplanar on 16 bits, source only */
+    CONVERT_RGB32,
+};
+
+static const struct
+{
+    vlc_fourcc_t i_chroma;
+    uint8_t      i_kind;
+    bool         b_swap;       /* V before U, or red at byte 0 */
+    bool         b_full_range; /* of the YUV formats */
+    uint8_t      i_shift;      /* to 8-bit, for the 16-bit samples */
+} p_formats[] = {
+    { VLC_CODEC_I420,     CONVERT_PLANAR,     false, false, 0 },
+    { VLC_CODEC_YV12,     CONVERT_PLANAR,     true,  false, 0 },
+    { VLC_CODEC_J420,     CONVERT_PLANAR,     false, true,  0 },
+    { VLC_CODEC_NV12,     CONVERT_SEMIPLANAR, false, false, 0 },
+    { VLC_CODEC_NV21,     CONVERT_SEMIPLANAR, true,  false, 0 },
+    /* The 16-bit samples in the CPU byte order only */
+#ifdef WORDS_BIGENDIAN
+    { VLC_CODEC_I420_10B, CONVERT_PLANAR_16,  false, false, 2 },
+    { VLC_CODEC_I420_9B,  CONVERT_PLANAR_16,  false, false, 1 },
+#else
+    { VLC_CODEC_I420_10L, CONVERT_PLANAR_16,  false, false, 2 },
+    { VLC_CODEC_I420_9L,  CONVERT_PLANAR_16,  false, false, 1 },
+    { VLC_CODEC_P010,     CONVERT_P010,       false, false, 8 },
+#endif
+    { VLC_CODEC_RGB32,    CONVERT_RGB32,      false, false, 0 },
+    { VLC_CODEC_RGBA,     CONVERT_RGB32,      true,  false, 0 },
+    { VLC_CODEC_BGRA,     CONVERT_RGB32,      false, false, 0 },
+};
+
+static int FindFormat( vlc_fourcc_t i_chroma )
+{
+    for( size_t i = 0; i < ARRAY_SIZE(p_formats); i++ )
+        if( p_formats[i].i_chroma == i_chroma )
+            return i;
+    return -1;
+}
+
+/* Returns the memory offset of the byte of an RGB32 mask */
+static int MaskByte( uint32_t i_mask )
+{
+    for( int i = 0; i < 4; i++ )
+        if( i_mask == 0xffu << (8 * i) )
+#ifdef WORDS_BIGENDIAN
+            return 3 - i;
+#else
+            return i;
+#endif
+    return -1;
+}
+
+/*****************************************************************************
+ * filter_sys_t
+ *****************************************************************************/
+struct filter_sys_t
+{
+    const convert_kernels_t *p_kernels;
+    unsigned i_src, i_dst;          /* indexes in p_formats */
+    bool b_src_swap, b_dst_swap;
+    bool b_uv_copy;                 /* same interleaved chroma on both sides */
+    convert_yuv_rgb_t yuv_rgb;
+    convert_rgb_yuv_t rgb_yuv;
+};
+
+/*****************************************************************************
+ * Open: probe the conversion and return score
+ *****************************************************************************/
+static int Open( vlc_object_t *p_this )
+{
+    filter_t *p_filter = (filter_t*)p_this;
+    const video_format_t *p_fmt_in = &p_filter->fmt_in.video;
+    const video_format_t *p_fmt_out = &p_filter->fmt_out.video;
+
+    if( p_fmt_in->i_width != p_fmt_out->i_width
+     || p_fmt_in->i_height != p_fmt_out->i_height
+     || p_fmt_in->orientation != p_fmt_out->orientation
+     || (p_fmt_in->i_width & 1) || (p_fmt_in->i_height & 1) )
+        return VLC_EGENERIC;
+
+    const int i_src = FindFormat( p_fmt_in->i_chroma );
+    const int i_dst = FindFormat( p_fmt_out->i_chroma );
+    if( i_src < 0 || i_dst < 0 || i_src == i_dst )
+        return VLC_EGENERIC;
+
+    const unsigned i_src_kind = p_formats[i_src].i_kind;
+    const unsigned i_dst_kind = p_formats[i_dst].i_kind;
+    bool b_src_swap = p_formats[i_src].b_swap;
+    bool b_dst_swap = p_formats[i_dst].b_swap;
+
+    /* The 16-bit formats are only read, and the conversions between YUV
+     * formats do not change the range */
+    if( i_dst_kind == CONVERT_PLANAR_16 || i_dst_kind == CONVERT_P010 )
+        return VLC_EGENERIC;
+    if( i_src_kind == CONVERT_RGB32 && i_dst_kind == CONVERT_RGB32 )
+        return VLC_EGENERIC;
+    if( i_src_kind != CONVERT_RGB32 && i_dst_kind != CONVERT_RGB32
+     && p_formats[i_src].b_full_range != p_formats[i_dst].b_full_range )
+        return VLC_EGENERIC;
+
+    /* Only the RV32 layouts with the padding after blue, green and red */
+    for( unsigned i = 0; i < 2; i++ )
+    {
+        video_format_t fmt = i ? *p_fmt_out : *p_fmt_in;
+
+        if( fmt.i_chroma != VLC_CODEC_RGB32 )
+            continue;
+        video_format_FixRgb( &fmt );
+        const int r = MaskByte( fmt.i_rmask );
+        if( (r != 0 && r != 2) || MaskByte( fmt.i_gmask ) != 1
+         || MaskByte( fmt.i_bmask ) != 2 - r )
+            return VLC_EGENERIC;
+        if( i )
+            b_dst_swap = r == 0;
+        else
+            b_src_swap = r == 0;
+    }
+
+    filter_sys_t *p_sys = malloc( sizeof(*p_sys) );
+    if( unlikely(p_sys == NULL) )
+        return VLC_ENOMEM;
+
+    p_sys->p_kernels = &kernels_c;
+#if defined(CONVERT_SSE2)
+    if( vlc_CPU_SSE2() )
+        p_sys->p_kernels = &kernels_sse2;
+#elif defined(CONVERT_NEON)
+    p_sys->p_kernels = &kernels_neon;
+#endif
+    p_sys->i_src = i_src;
+    p_sys->i_dst = i_dst;
+    p_sys->b_src_swap = b_src_swap;
+    p_sys->b_dst_swap = b_dst_swap;
+    p_sys->b_uv_copy = i_dst_kind == CONVERT_SEMIPLANAR
+                    && (i_src_kind == CONVERT_SEMIPLANAR
+                     || i_src_kind == CONVERT_P010)
+                    && b_src_swap == b_dst_swap;
+
+    /* The formats do not tell the colour space: the HD pictures are taken as
+     * BT.709, and the RGB side is full range */
+    const int i_yuv = i_src_kind == CONVERT_RGB32 ? i_dst : i_src;
+    MatrixInit( &p_sys->yuv_rgb, &p_sys->rgb_yuv, p_fmt_in->i_height > 576,
+                p_formats[i_yuv].b_full_range );
+
+    p_filter->pf_video_filter = Filter;
+    p_filter->p_sys = p_sys;
+
+    msg_Dbg( p_filter, "%4.4s -> %4.4s in one pass",
+             (const char *)&p_fmt_in->i_chroma,
+             (const char *)&p_fmt_out->i_chroma );
+    return VLC_SUCCESS;
+}
+
+static void Close( vlc_object_t *p_this )
+{
+    filter_t *p_filter = (filter_t*)p_this;
+
+    free( p_filter->p_sys );
+}
+
+/****************************************************************************
+ * Filter: the whole thing
+ ****************************************************************************/
+typedef struct
+{
+    picture_t *p_src;
+    picture_t *p_dst;
+    unsigned   i_width;
+    unsigned   i_lines; /**< Chroma lines */
+} convert_slice_t;
+
+static inline uint8_t *Line( const picture_t *p_pic, int i_plane, unsigned y )
+{
+    return &p_pic->p[i_plane].p_pixels[y * p_pic->p[i_plane].i_pitch];
+}
+
+/* Gets the luma lines y[] and the chroma lines u and v (or uv if b_uv) of the
+ * chroma line cy, either pointing into the source, or written to the given
+ * buffers */
+static void Read( filter_sys_t *p_sys, const picture_t *p_src, unsigned cy,
+                  unsigned i_width, uint8_t *y[2], uint8_t **pp_u,
+                  uint8_t **pp_v, uint8_t **pp_uv, uint8_t *p_tmp )
+{
+    const convert_kernels_t *k = p_sys->p_kernels;
+    const unsigned i_cwidth = i_width / 2;
+    const bool b_swap = p_sys->b_src_swap;
+    const unsigned i_shift = p_formats[p_sys->i_src].i_shift;
+
+    switch( p_formats[p_sys->i_src].i_kind )
+    {
+        case CONVERT_PLANAR:
+            for( unsigned i = 0; i < 2; i++ )
+                y[i] = Line( p_src, Y_PLANE, 2 * cy + i );
+            *pp_u = Line( p_src, b_swap ? V_PLANE : U_PLANE, cy );
+            *pp_v = Line( p_src, b_swap ? U_PLANE : V_PLANE, cy );
+            break;
+
+        case CONVERT_SEMIPLANAR:
+            for( unsigned i = 0; i < 2; i++ )
+                y[i] = Line( p_src, Y_PLANE, 2 * cy + i );
+            if( pp_uv != NULL )
+                *pp_uv = Line( p_src, 1, cy );
+            else
+                k->pf_deinterleave( b_swap ? *pp_v : *pp_u,
+                                    b_swap ? *pp_u : *pp_v,
+                                    Line( p_src, 1, cy ), i_cwidth );
+            break;
+
+        case CONVERT_PLANAR_16:
+            for( unsigned i = 0; i < 2; i++ )
+                k->pf_narrow( y[i],
+                              (const uint16_t *)Line( p_src, Y_PLANE, 2 * cy + i ),
+                              i_width, i_shift );
+            k->pf_narrow( *pp_u, (const uint16_t *)Line( p_src, U_PLANE, cy ),
+                          i_cwidth, i_shift );
+            k->pf_narrow( *pp_v, (const uint16_t *)Line( p_src, V_PLANE, cy ),
+                          i_cwidth, i_shift );
+            break;
+
+        case CONVERT_P010:
+            for( unsigned i = 0; i < 2; i++ )
+                k->pf_narrow( y[i],
+                              (const uint16_t *)Line( p_src, Y_PLANE, 2 * cy + i ),
+                              i_width, i_shift );
+            if( pp_uv != NULL )
+                k->pf_narrow( *pp_uv, (const uint16_t *)Line( p_src, 1, cy ),
+                              2 * i_cwidth, i_shift );
+            else
+            {
+                k->pf_narrow( p_tmp, (const uint16_t *)Line( p_src, 1, cy ),
+                              2 * i_cwidth, i_shift );
+                k->pf_deinterleave( *pp_u, *pp_v, p_tmp, i_cwidth );
+            }
+            break;
+
+        case CONVERT_RGB32:
+            k->pf_rgb_yuv( y[0], y[1], *pp_u, *pp_v,
+                           Line( p_src, 0, 2 * cy ), Line( p_src, 0, 2 * cy + 1 ),
+                           i_width, b_swap, &p_sys->rgb_yuv );
+            break;
+
+        default:
+            assert( false );
+    }
+}
+
+static void ConvertSlice( filter_t *p_filter, void *opaque,
+                          const filter_slice_t *p_slice )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const convert_kernels_t *k = p_sys->p_kernels;
+    convert_slice_t *p_ctx = opaque;
+    picture_t *p_dst = p_ctx->p_dst;
+    const unsigned i_width = p_ctx->i_width;
+    const unsigned i_cwidth = i_width / 2;
+    const bool b_swap = p_sys->b_dst_swap;
+    const unsigned i_kind = p_formats[p_sys->i_dst].i_kind;
+
+    /* Two luma lines, two chroma lines and the interleaved 16-bit chroma */
+    const size_t i_stride = (i_width + 15) & ~15;
+    uint8_t *p_buf = vlc_memalign( 16, 5 * i_stride );
+    if( unlikely(p_buf == NULL) )
+        return;
+
+    for( unsigned cy = p_slice->i_first; cy < p_slice->i_end; cy++ )
+    {
+        uint8_t *y[2], *u, *v, *uv = NULL;
+
+        /* The 8-bit planes of the destination are given to the source */
+        if( i_kind == CONVERT_RGB32 )
+        {
+            y[0] = &p_buf[0];
+            y[1] = &p_buf[i_stride];
+        }
+        else
+        {
+            y[0] = Line( p_dst, Y_PLANE, 2 * cy );
+            y[1] = Line( p_dst, Y_PLANE, 2 * cy + 1 );
+        }
+        if( i_kind == CONVERT_PLANAR )
+        {
+            u = Line( p_dst, b_swap ? V_PLANE : U_PLANE, cy );
+            v = Line( p_dst, b_swap ? U_PLANE : V_PLANE, cy );
+        }
+        else
+        {
+            u = &p_buf[2 * i_stride];
+            v = &p_buf[2 * i_stride + i_stride / 2];
+        }
+        if( p_sys->b_uv_copy )
+            uv = Line( p_dst, 1, cy );
+
+        uint8_t *const py[2] = { y[0], y[1] };
+        uint8_t *const pu = u, *const pv = v, *const puv = uv;
+
+        Read( p_sys, p_ctx->p_src, cy, i_width, y, &u, &v,
+              p_sys->b_uv_copy ? &uv : NULL, &p_buf[3 * i_stride] );
+
+        /* The lines the source did not write directly */
+        if( i_kind != CONVERT_RGB32 )
+            for( unsigned i = 0; i < 2; i++ )
+                if( y[i] != py[i] )
+                    memcpy( py[i], y[i], i_width );
+
+        switch( i_kind )
+        {
+            case CONVERT_PLANAR:
+                if( u != pu )
+                    memcpy( pu, u, i_cwidth );
+                if( v != pv )
+                    memcpy( pv, v, i_cwidth );
+                break;
+
+            case CONVERT_SEMIPLANAR:
+                if( p_sys->b_uv_copy )
+                {
+                    if( uv != puv )
+                        memcpy( puv, uv, 2 * i_cwidth );
+                }
+                else
+                    k->pf_interleave( Line( p_dst, 1, cy ), b_swap ? v : u,
+                                      b_swap ? u : v, i_cwidth );
+                break;
+
+            case CONVERT_RGB32:
+                for( unsigned i = 0; i < 2; i++ )
+                    k->pf_yuv_rgb( Line( p_dst, 0, 2 * cy + i ), y[i], u, v,
+                                   i_width, b_swap, &p_sys->yuv_rgb );
+                break;
+
+            default:
+                assert( false );
+        }
+    }
+    vlc_free( p_buf );
+}
+
+static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+{
+    picture_t *p_pic_dst;
+
+    if( !p_pic ) return NULL;
+
+    /* Request output picture */
+    p_pic_dst = filter_NewPicture( p_filter );
+    if( !p_pic_dst )
+    {
+        picture_Release( p_pic );
+        return NULL;
+    }
+
+    convert_slice_t ctx = {
+        .p_src = p_pic,
+        .p_dst = p_pic_dst,
+        .i_width = p_filter->fmt_in.video.i_width,
+        .i_lines = p_filter->fmt_in.video.i_height / 2,
+    };
+    filter_Slice( p_filter, ctx.i_lines, 0, ConvertSlice, &ctx );
+
+    picture_CopyProperties( p_pic_dst, p_pic );
+    picture_Release( p_pic );
+    return p_pic_dst;
+}
@@ -131,6 +131,20 @@ struct filter_sys_t
                                             int, int, int );
 };
 
+/*****************************************************************************
+ * adjust_slice_t: settings of one picture, shared by its slices
+ *****************************************************************************/
+typedef struct
+{
+    picture_t *p_pic;
+    picture_t *p_outpic;
+    int        pi_luma[256];
+    int        i_sin, i_cos, i_sat, i_x, i_y;
+    int        i_y_offset; /* Packed YUV only */
+    int        (* pf_process_sat_hue)( picture_t *, picture_t *, int, int, int,
+                                       int, int );
+} adjust_slice_t;
+
 /*****************************************************************************
  * Create: allocates adjust video filter
  *****************************************************************************/
@@ -220,23 +234,176 @@ static void Destroy( vlc_object_t *p_this )
     free( p_sys );
 }
 
+/*****************************************************************************
+ * SlicePicture: restricts a picture to the lines of a slice
+ *****************************************************************************
+ * The slice lines are those of the first plane, the other planes are scaled.
+ * Only the pixels and the line counts differ from the original picture.
+ *****************************************************************************/
+static void SlicePicture( picture_t *p_band, const picture_t *p_pic,
+                          const filter_slice_t *p_slice )
+{
+    unsigned i_lines = p_pic->p[0].i_visible_lines;
+
+    *p_band = *p_pic;
+    for( int i = 0; i < p_pic->i_planes; i++ )
+    {
+        const plane_t *p_plane = &p_pic->p[i];
+        unsigned i_first = filter_SliceLine( p_slice->i_first, i_lines,
+                                             p_plane->i_visible_lines );
+        unsigned i_end = filter_SliceLine( p_slice->i_end, i_lines,
+                                           p_plane->i_visible_lines );
+
+        p_band->p[i].p_pixels += i_first * p_plane->i_pitch;
+        p_band->p[i].i_lines =
+        p_band->p[i].i_visible_lines = i_end - i_first;
+    }
+}
+
+/*****************************************************************************
+ * Process the lines of a slice of a Planar YUV picture
+ *****************************************************************************/
+static void PlanarSlice( filter_t *p_filter, void *opaque,
+                         const filter_slice_t *p_slice )
+{
+    const adjust_slice_t *p_adj = opaque;
+    const int *pi_luma = p_adj->pi_luma;
+    picture_t pic, outpic;
+    uint8_t *p_in, *p_in_end, *p_line_end;
+    uint8_t *p_out;
+
+    VLC_UNUSED(p_filter);
+    SlicePicture( &pic, p_adj->p_pic, p_slice );
+    SlicePicture( &outpic, p_adj->p_outpic, p_slice );
+
+    /*
+     * Do the Y plane
+     */
+
+    p_in = pic.p[Y_PLANE].p_pixels;
+    p_in_end = p_in + pic.p[Y_PLANE].i_visible_lines
+                      * pic.p[Y_PLANE].i_pitch - 8;
+
+    p_out = outpic.p[Y_PLANE].p_pixels;
+
+    for( ; p_in < p_in_end ; )
+    {
+        p_line_end = p_in + pic.p[Y_PLANE].i_visible_pitch - 8;
+
+        for( ; p_in < p_line_end ; )
+        {
+            /* Do 8 pixels at a time */
+            *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
+            *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
+            *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
+            *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
+        }
+
+        p_line_end += 8;
+
+        for( ; p_in < p_line_end ; )
+        {
+            *p_out++ = pi_luma[ *p_in++ ];
+        }
+
+        p_in += pic.p[Y_PLANE].i_pitch
+              - pic.p[Y_PLANE].i_visible_pitch;
+        p_out += outpic.p[Y_PLANE].i_pitch
+               - outpic.p[Y_PLANE].i_visible_pitch;
+    }
+
+    /*
+     * Do the U and V planes
+     */
+
+    /* Currently no errors are implemented in the function, if any are added
+     * check them here */
+    p_adj->pf_process_sat_hue( &pic, &outpic, p_adj->i_sin, p_adj->i_cos,
+                               p_adj->i_sat, p_adj->i_x, p_adj->i_y );
+}
+
+/*****************************************************************************
+ * Process the lines of a slice of a Packed YUV picture
+ *****************************************************************************/
+static void PackedSlice( filter_t *p_filter, void *opaque,
+                         const filter_slice_t *p_slice )
+{
+    const adjust_slice_t *p_adj = opaque;
+    const int *pi_luma = p_adj->pi_luma;
+    picture_t pic, outpic;
+    uint8_t *p_in, *p_in_end, *p_line_end;
+    uint8_t *p_out;
+    int i_y_offset = p_adj->i_y_offset;
+    int i_pitch, i_visible_pitch;
+
+    VLC_UNUSED(p_filter);
+    SlicePicture( &pic, p_adj->p_pic, p_slice );
+    SlicePicture( &outpic, p_adj->p_outpic, p_slice );
+
+    i_pitch = pic.p->i_pitch;
+    i_visible_pitch = pic.p->i_visible_pitch;
+
+    /*
+     * Do the Y plane
+     */
+
+    p_in = pic.p->p_pixels + i_y_offset;
+    p_in_end = p_in + pic.p->i_visible_lines * pic.p->i_pitch - 8 * 4;
+
+    p_out = outpic.p->p_pixels + i_y_offset;
+
+    for( ; p_in < p_in_end ; )
+    {
+        p_line_end = p_in + i_visible_pitch - 8 * 4;
+
+        for( ; p_in < p_line_end ; )
+        {
+            /* Do 8 pixels at a time */
+            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
+            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
+            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
+            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
+            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
+            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
+            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
+            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
+        }
+
+        p_line_end += 8 * 4;
+
+        for( ; p_in < p_line_end ; )
+        {
+            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
+        }
+
+        p_in += i_pitch - pic.p->i_visible_pitch;
+        p_out += i_pitch - outpic.p->i_visible_pitch;
+    }
+
+    /*
+     * Do the U and V planes
+     */
+
+    p_adj->pf_process_sat_hue( &pic, &outpic, p_adj->i_sin, p_adj->i_cos,
+                               p_adj->i_sat, p_adj->i_x, p_adj->i_y );
+}
+
 /*****************************************************************************
  * Run the filter on a Planar YUV picture
  *****************************************************************************/
 static picture_t *FilterPlanar( filter_t *p_filter, picture_t *p_pic )
 {
-    int pi_luma[256];
+    adjust_slice_t adj;
+    int *pi_luma = adj.pi_luma;
     int pi_gamma[256];
 
     picture_t *p_outpic;
-    uint8_t *p_in, *p_in_end, *p_line_end;
-    uint8_t *p_out;
 
     bool b_thres;
     double  f_hue;
     double  f_gamma;
     int32_t i_cont, i_lum;
-    int i_sat, i_sin, i_cos, i_x, i_y;
+    int i_sat;
     int i;
 
     filter_sys_t *p_sys = p_filter->p_sys;
@@ -300,65 +467,25 @@ static picture_t *FilterPlanar( filter_t *p_filter, picture_t *p_pic )
     }
 
     /*
-     * Do the Y plane
-     */
-
-    p_in = p_pic->p[Y_PLANE].p_pixels;
-    p_in_end = p_in + p_pic->p[Y_PLANE].i_visible_lines
-                      * p_pic->p[Y_PLANE].i_pitch - 8;
-
-    p_out = p_outpic->p[Y_PLANE].p_pixels;
-
-    for( ; p_in < p_in_end ; )
-    {
-        p_line_end = p_in + p_pic->p[Y_PLANE].i_visible_pitch - 8;
-
-        for( ; p_in < p_line_end ; )
-        {
-            /* Do 8 pixels at a time */
-            *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-            *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-            *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-            *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-        }
-
-        p_line_end += 8;
-
-        for( ; p_in < p_line_end ; )
-        {
-            *p_out++ = pi_luma[ *p_in++ ];
-        }
-
-        p_in += p_pic->p[Y_PLANE].i_pitch
-              - p_pic->p[Y_PLANE].i_visible_pitch;
-        p_out += p_outpic->p[Y_PLANE].i_pitch
-               - p_outpic->p[Y_PLANE].i_visible_pitch;
-    }
-
-    /*
-     * Do the U and V planes
+     * Process the Y, U and V planes by slices
      */
 
-    i_sin = sin(f_hue) * 256;
-    i_cos = cos(f_hue) * 256;
+    adj.p_pic = p_pic;
+    adj.p_outpic = p_outpic;
+    adj.i_sin = sin(f_hue) * 256;
+    adj.i_cos = cos(f_hue) * 256;
+    adj.i_sat = i_sat;
 
-    i_x = ( cos(f_hue) + sin(f_hue) ) * 32768;
-    i_y = ( cos(f_hue) - sin(f_hue) ) * 32768;
+    adj.i_x = ( cos(f_hue) + sin(f_hue) ) * 32768;
+    adj.i_y = ( cos(f_hue) - sin(f_hue) ) * 32768;
 
     if ( i_sat > 256 )
-    {
-        /* Currently no errors are implemented in the function, if any are added
-         * check them here */
-        p_sys->pf_process_sat_hue_clip( p_pic, p_outpic, i_sin, i_cos, i_sat,
-                                        i_x, i_y );
-    }
+        adj.pf_process_sat_hue = p_sys->pf_process_sat_hue_clip;
     else
-    {
-        /* Currently no errors are implemented in the function, if any are added
-         * check them here */
-        p_sys->pf_process_sat_hue( p_pic, p_outpic, i_sin, i_cos, i_sat,
-                                        i_x, i_y );
-    }
+        adj.pf_process_sat_hue = p_sys->pf_process_sat_hue;
+
+    filter_Slice( p_filter, p_pic->p[Y_PLANE].i_visible_lines, 0,
+                  PlanarSlice, &adj );
 
     return CopyInfoAndRelease( p_outpic, p_pic );
 }
@@ -368,30 +495,24 @@ static picture_t *FilterPlanar( filter_t *p_filter, picture_t *p_pic )
  *****************************************************************************/
 static picture_t *FilterPacked( filter_t *p_filter, picture_t *p_pic )
 {
-    int pi_luma[256];
+    adjust_slice_t adj;
+    int *pi_luma = adj.pi_luma;
     int pi_gamma[256];
 
     picture_t *p_outpic;
-    uint8_t *p_in, *p_in_end, *p_line_end;
-    uint8_t *p_out;
     int i_y_offset, i_u_offset, i_v_offset;
 
-    int i_pitch, i_visible_pitch;
-
     bool b_thres;
     double  f_hue;
     double  f_gamma;
     int32_t i_cont, i_lum;
-    int i_sat, i_sin, i_cos, i_x, i_y;
+    int i_sat;
     int i;
 
     filter_sys_t *p_sys = p_filter->p_sys;
 
     if( !p_pic ) return NULL;
 
-    i_pitch = p_pic->p->i_pitch;
-    i_visible_pitch = p_pic->p->i_visible_pitch;
-
     if( GetPackedYuvOffsets( p_pic->format.i_chroma, &i_y_offset,
                              &i_u_offset, &i_v_offset ) != VLC_SUCCESS )
     {
@@ -461,78 +582,26 @@ static picture_t *FilterPacked( filter_t *p_filter, picture_t *p_pic )
     }
 
     /*
-     * Do the Y plane
-     */
-
-    p_in = p_pic->p->p_pixels + i_y_offset;
-    p_in_end = p_in + p_pic->p->i_visible_lines * p_pic->p->i_pitch - 8 * 4;
-
-    p_out = p_outpic->p->p_pixels + i_y_offset;
-
-    for( ; p_in < p_in_end ; )
-    {
-        p_line_end = p_in + i_visible_pitch - 8 * 4;
-
-        for( ; p_in < p_line_end ; )
-        {
-            /* Do 8 pixels at a time */
-            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
-            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
-            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
-            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
-            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
-            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
-            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
-            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
-        }
-
-        p_line_end += 8 * 4;
-
-        for( ; p_in < p_line_end ; )
-        {
-            *p_out = pi_luma[ *p_in ]; p_in += 2; p_out += 2;
-        }
-
-        p_in += i_pitch - p_pic->p->i_visible_pitch;
-        p_out += i_pitch - p_outpic->p->i_visible_pitch;
-    }
-
-    /*
-     * Do the U and V planes
+     * Process the Y, U and V planes by slices
      */
 
-    i_sin = sin(f_hue) * 256;
-    i_cos = cos(f_hue) * 256;
+    adj.p_pic = p_pic;
+    adj.p_outpic = p_outpic;
+    adj.i_y_offset = i_y_offset;
+    adj.i_sin = sin(f_hue) * 256;
+    adj.i_cos = cos(f_hue) * 256;
+    adj.i_sat = i_sat;
 
-    i_x = ( cos(f_hue) + sin(f_hue) ) * 32768;
-    i_y = ( cos(f_hue) - sin(f_hue) ) * 32768;
+    adj.i_x = ( cos(f_hue) + sin(f_hue) ) * 32768;
+    adj.i_y = ( cos(f_hue) - sin(f_hue) ) * 32768;
 
     if ( i_sat > 256 )
-    {
-        if ( p_sys->pf_process_sat_hue_clip( p_pic, p_outpic, i_sin, i_cos, i_sat,
-                                             i_x, i_y ) != VLC_SUCCESS )
-        {
-            /* Currently only one error can happen in the function, but if there
-             * will be more of them, this message must go away */
-            msg_Warn( p_filter, "Unsupported input chroma (%4.4s)",
-                      (char*)&(p_pic->format.i_chroma) );
-            picture_Release( p_pic );
-            return NULL;
-        }
-    }
+        adj.pf_process_sat_hue = p_sys->pf_process_sat_hue_clip;
     else
-    {
-        if ( p_sys->pf_process_sat_hue( p_pic, p_outpic, i_sin, i_cos, i_sat,
-                                        i_x, i_y ) != VLC_SUCCESS )
-        {
-            /* Currently only one error can happen in the function, but if there
-             * will be more of them, this message must go away */
-            msg_Warn( p_filter, "Unsupported input chroma (%4.4s)",
-                      (char*)&(p_pic->format.i_chroma) );
-            picture_Release( p_pic );
-            return NULL;
-        }
-    }
+        adj.pf_process_sat_hue = p_sys->pf_process_sat_hue;
+
+    filter_Slice( p_filter, p_pic->p->i_visible_lines, 0,
+                  PackedSlice, &adj );
 
     return CopyInfoAndRelease( p_outpic, p_pic );
 }
@@ -32,8 +32,27 @@
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_filter.h>
+#include <vlc_cpu.h>
 #include "filter_picture.h"
 
+#if defined(HAVE_SSE2_INTRINSICS) && (defined(__i386__) || defined(__x86_64__))
+# include <emmintrin.h>
+# define BLEND_SSE2
+# if defined(__AVX2__) || VLC_GCC_VERSION(4, 9) || defined(__clang__)
+#  include <immintrin.h>
+#  define BLEND_AVX2
+# endif
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+# include <arm_neon.h>
+# define BLEND_NEON
+#endif
+
+#if defined(BLEND_SSE2) || defined(BLEND_NEON)
+# define BLEND_ACCELERATED
+#endif
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -83,6 +102,18 @@ public:
     {
         return true;
     }
+    const picture_t *getPicture() const
+    {
+        return picture;
+    }
+    unsigned getX() const
+    {
+        return x;
+    }
+    unsigned getY() const
+    {
+        return y;
+    }
 
 protected:
     template <unsigned ry>
@@ -544,6 +575,588 @@ void Blend(const CPicture &dst_data, const CPicture &src_data,
 typedef void (*blend_function_t)(const CPicture &dst_data, const CPicture &src_data,
                                  unsigned width, unsigned height, int alpha);
 
+/*
+ * Accelerated blending of the most common cases: YUVA and YUVP onto 4:2:0
+ * pictures, as used by the subtitles and the OSD, and RGBA onto RV32.
+ *
+ * The kernels process a line at a time and give exactly the same results
+ * as the generic Blend() above: merge() with a null alpha leaves the
+ * destination untouched, so there is no need to skip transparent pixels,
+ * and ((v >> 8) + v + 1) >> 8 fits in 16 bits for v <= 255 * 255.
+ */
+#ifdef BLEND_ACCELERATED
+#define BLEND_CHUNK 512 /* Pixels converted at a time from YUVP */
+
+static void BlendAlphaC(uint8_t *a, const uint8_t *s, unsigned n, unsigned alpha)
+{
+    for (unsigned i = 0; i < n; i++)
+        a[i] = div255(alpha * s[i]);
+}
+
+static void BlendMergeC(uint8_t *d, const uint8_t *s, const uint8_t *a, unsigned n)
+{
+    for (unsigned i = 0; i < n; i++)
+        merge(&d[i], s[i], a[i]);
+}
+
+/* Merges every other sample of s, for the subsampled chroma */
+static void BlendMerge2C(uint8_t *d, const uint8_t *s, const uint8_t *a, unsigned n)
+{
+    for (unsigned i = 0; i < n; i++)
+        merge(&d[i], s[2 * i], a[2 * i]);
+}
+
+static void BlendMerge2UVC(uint8_t *d, const uint8_t *u, const uint8_t *v,
+                           const uint8_t *a, unsigned n)
+{
+    for (unsigned i = 0; i < n; i++) {
+        merge(&d[2 * i + 0], u[2 * i], a[2 * i]);
+        merge(&d[2 * i + 1], v[2 * i], a[2 * i]);
+    }
+}
+
+/* RGBA onto RGBX or BGRX, the X byte being left as is */
+template <bool swap>
+static void BlendMergeRGBXC(uint8_t *d, const uint8_t *s, unsigned n, unsigned alpha)
+{
+    for (unsigned i = 0; i < n; i++, d += 4, s += 4) {
+        unsigned a = div255(alpha * s[3]);
+        merge(&d[swap ? 2 : 0], s[0], a);
+        merge(&d[1], s[1], a);
+        merge(&d[swap ? 0 : 2], s[2], a);
+    }
+}
+
+#ifdef BLEND_SSE2
+VLC_SSE2
+static inline __m128i BlendDiv255SSE2(__m128i v)
+{
+    v = _mm_add_epi16(v, _mm_add_epi16(_mm_srli_epi16(v, 8),
+                                       _mm_set1_epi16(1)));
+    return _mm_srli_epi16(v, 8);
+}
+
+/* Merges 16 bits samples */
+VLC_SSE2
+static inline __m128i BlendMerge16SSE2(__m128i d, __m128i s, __m128i a)
+{
+    d = _mm_mullo_epi16(d, _mm_sub_epi16(_mm_set1_epi16(255), a));
+    return BlendDiv255SSE2(_mm_add_epi16(d, _mm_mullo_epi16(s, a)));
+}
+
+VLC_SSE2
+static inline __m128i BlendMerge8SSE2(__m128i d, __m128i s, __m128i a)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = BlendMerge16SSE2(_mm_unpacklo_epi8(d, zero),
+                                  _mm_unpacklo_epi8(s, zero),
+                                  _mm_unpacklo_epi8(a, zero));
+    __m128i hi = BlendMerge16SSE2(_mm_unpackhi_epi8(d, zero),
+                                  _mm_unpackhi_epi8(s, zero),
+                                  _mm_unpackhi_epi8(a, zero));
+    return _mm_packus_epi16(lo, hi);
+}
+
+template <bool swap>
+VLC_SSE2
+static void BlendMergeRGBXSSE2(uint8_t *d, const uint8_t *s, unsigned n,
+                               unsigned alpha)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i va = _mm_set1_epi16(alpha);
+    const __m128i rgb = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+    unsigned i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        __m128i vs = _mm_loadu_si128((const __m128i *)&s[4 * i]);
+        __m128i vd = _mm_loadu_si128((const __m128i *)&d[4 * i]);
+        __m128i a = BlendDiv255SSE2(_mm_mullo_epi16(_mm_srli_epi32(vs, 24), va));
+        a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+
+        __m128i slo = _mm_unpacklo_epi8(vs, zero);
+        __m128i shi = _mm_unpackhi_epi8(vs, zero);
+        if (swap) {
+            slo = _mm_shufflelo_epi16(slo, _MM_SHUFFLE(3, 0, 1, 2));
+            slo = _mm_shufflehi_epi16(slo, _MM_SHUFFLE(3, 0, 1, 2));
+            shi = _mm_shufflelo_epi16(shi, _MM_SHUFFLE(3, 0, 1, 2));
+            shi = _mm_shufflehi_epi16(shi, _MM_SHUFFLE(3, 0, 1, 2));
+        }
+        __m128i lo = BlendMerge16SSE2(_mm_unpacklo_epi8(vd, zero), slo,
+                             _mm_and_si128(_mm_unpacklo_epi32(a, a), rgb));
+        __m128i hi = BlendMerge16SSE2(_mm_unpackhi_epi8(vd, zero), shi,
+                             _mm_and_si128(_mm_unpackhi_epi32(a, a), rgb));
+        _mm_storeu_si128((__m128i *)&d[4 * i], _mm_packus_epi16(lo, hi));
+    }
+    BlendMergeRGBXC<swap>(&d[4 * i], &s[4 * i], n - i, alpha);
+}
+
+struct CBlendSSE2 {
+    VLC_SSE2
+    static void scaleAlpha(uint8_t *a, const uint8_t *s, unsigned n, unsigned alpha)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i va = _mm_set1_epi16(alpha);
+        unsigned i = 0;
+
+        for (; i + 16 <= n; i += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i *)&s[i]);
+            __m128i lo = BlendDiv255SSE2(_mm_mullo_epi16(_mm_unpacklo_epi8(v, zero), va));
+            __m128i hi = BlendDiv255SSE2(_mm_mullo_epi16(_mm_unpackhi_epi8(v, zero), va));
+            _mm_storeu_si128((__m128i *)&a[i], _mm_packus_epi16(lo, hi));
+        }
+        BlendAlphaC(&a[i], &s[i], n - i, alpha);
+    }
+    VLC_SSE2
+    static void merge(uint8_t *d, const uint8_t *s, const uint8_t *a, unsigned n)
+    {
+        unsigned i = 0;
+
+        for (; i + 16 <= n; i += 16) {
+            __m128i v = BlendMerge8SSE2(_mm_loadu_si128((const __m128i *)&d[i]),
+                                        _mm_loadu_si128((const __m128i *)&s[i]),
+                                        _mm_loadu_si128((const __m128i *)&a[i]));
+            _mm_storeu_si128((__m128i *)&d[i], v);
+        }
+        BlendMergeC(&d[i], &s[i], &a[i], n - i);
+    }
+    /* The loops stop early enough not to read past the last even sample */
+    VLC_SSE2
+    static void merge2(uint8_t *d, const uint8_t *s, const uint8_t *a, unsigned n)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i even = _mm_set1_epi16(0xff);
+        unsigned i = 0;
+
+        for (; i + 16 < n; i += 16) {
+            __m128i vd = _mm_loadu_si128((const __m128i *)&d[i]);
+#define LOAD_EVEN(p) _mm_and_si128(_mm_loadu_si128((const __m128i *)(p)), even)
+            __m128i lo = BlendMerge16SSE2(_mm_unpacklo_epi8(vd, zero),
+                                          LOAD_EVEN(&s[2 * i]),
+                                          LOAD_EVEN(&a[2 * i]));
+            __m128i hi = BlendMerge16SSE2(_mm_unpackhi_epi8(vd, zero),
+                                          LOAD_EVEN(&s[2 * i + 16]),
+                                          LOAD_EVEN(&a[2 * i + 16]));
+#undef LOAD_EVEN
+            _mm_storeu_si128((__m128i *)&d[i], _mm_packus_epi16(lo, hi));
+        }
+        BlendMerge2C(&d[i], &s[2 * i], &a[2 * i], n - i);
+    }
+    VLC_SSE2
+    static void merge2UV(uint8_t *d, const uint8_t *u, const uint8_t *v,
+                         const uint8_t *a, unsigned n)
+    {
+        const __m128i even = _mm_set1_epi16(0xff);
+        unsigned i = 0;
+
+        for (; i + 8 < n; i += 8) {
+            __m128i vu = _mm_and_si128(_mm_loadu_si128((const __m128i *)&u[2 * i]), even);
+            __m128i vv = _mm_slli_epi16(_mm_loadu_si128((const __m128i *)&v[2 * i]), 8);
+            __m128i va = _mm_and_si128(_mm_loadu_si128((const __m128i *)&a[2 * i]), even);
+            __m128i vd = BlendMerge8SSE2(_mm_loadu_si128((const __m128i *)&d[2 * i]),
+                                         _mm_or_si128(vu, vv),
+                                         _mm_or_si128(va, _mm_slli_epi16(va, 8)));
+            _mm_storeu_si128((__m128i *)&d[2 * i], vd);
+        }
+        BlendMerge2UVC(&d[2 * i], &u[2 * i], &v[2 * i], &a[2 * i], n - i);
+    }
+    static void mergeRGBX(uint8_t *d, const uint8_t *s, unsigned n,
+                          unsigned alpha, bool swap)
+    {
+        if (swap)
+            BlendMergeRGBXSSE2<true>(d, s, n, alpha);
+        else
+            BlendMergeRGBXSSE2<false>(d, s, n, alpha);
+    }
+};
+#endif
+
+#ifdef BLEND_AVX2
+VLC_AVX2
+static inline __m256i BlendDiv255AVX2(__m256i v)
+{
+    v = _mm256_add_epi16(v, _mm256_add_epi16(_mm256_srli_epi16(v, 8),
+                                             _mm256_set1_epi16(1)));
+    return _mm256_srli_epi16(v, 8);
+}
+
+VLC_AVX2
+static inline __m256i BlendMerge16AVX2(__m256i d, __m256i s, __m256i a)
+{
+    d = _mm256_mullo_epi16(d, _mm256_sub_epi16(_mm256_set1_epi16(255), a));
+    return BlendDiv255AVX2(_mm256_add_epi16(d, _mm256_mullo_epi16(s, a)));
+}
+
+/* The 256 bits unpacking and packing work within each 128 bits lane, so
+ * they give back the samples in order when used together */
+VLC_AVX2
+static inline __m256i BlendMerge8AVX2(__m256i d, __m256i s, __m256i a)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i lo = BlendMerge16AVX2(_mm256_unpacklo_epi8(d, zero),
+                                  _mm256_unpacklo_epi8(s, zero),
+                                  _mm256_unpacklo_epi8(a, zero));
+    __m256i hi = BlendMerge16AVX2(_mm256_unpackhi_epi8(d, zero),
+                                  _mm256_unpackhi_epi8(s, zero),
+                                  _mm256_unpackhi_epi8(a, zero));
+    return _mm256_packus_epi16(lo, hi);
+}
+
+template <bool swap>
+VLC_AVX2
+static void BlendMergeRGBXAVX2(uint8_t *d, const uint8_t *s, unsigned n,
+                               unsigned alpha)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i va = _mm256_set1_epi16(alpha);
+    const __m256i rgb = _mm256_set_epi16(0, -1, -1, -1, 0, -1, -1, -1,
+                                         0, -1, -1, -1, 0, -1, -1, -1);
+    unsigned i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256i vs = _mm256_loadu_si256((const __m256i *)&s[4 * i]);
+        __m256i vd = _mm256_loadu_si256((const __m256i *)&d[4 * i]);
+        __m256i a = BlendDiv255AVX2(_mm256_mullo_epi16(_mm256_srli_epi32(vs, 24), va));
+        a = _mm256_or_si256(a, _mm256_slli_epi32(a, 16));
+
+        __m256i slo = _mm256_unpacklo_epi8(vs, zero);
+        __m256i shi = _mm256_unpackhi_epi8(vs, zero);
+        if (swap) {
+            slo = _mm256_shufflelo_epi16(slo, _MM_SHUFFLE(3, 0, 1, 2));
+            slo = _mm256_shufflehi_epi16(slo, _MM_SHUFFLE(3, 0, 1, 2));
+            shi = _mm256_shufflelo_epi16(shi, _MM_SHUFFLE(3, 0, 1, 2));
+            shi = _mm256_shufflehi_epi16(shi, _MM_SHUFFLE(3, 0, 1, 2));
+        }
+        __m256i lo = BlendMerge16AVX2(_mm256_unpacklo_epi8(vd, zero), slo,
+                             _mm256_and_si256(_mm256_unpacklo_epi32(a, a), rgb));
+        __m256i hi = BlendMerge16AVX2(_mm256_unpackhi_epi8(vd, zero), shi,
+                             _mm256_and_si256(_mm256_unpackhi_epi32(a, a), rgb));
+        _mm256_storeu_si256((__m256i *)&d[4 * i], _mm256_packus_epi16(lo, hi));
+    }
+    BlendMergeRGBXC<swap>(&d[4 * i], &s[4 * i], n - i, alpha);
+}
+
+struct CBlendAVX2 {
+    VLC_AVX2
+    static void scaleAlpha(uint8_t *a, const uint8_t *s, unsigned n, unsigned alpha)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i va = _mm256_set1_epi16(alpha);
+        unsigned i = 0;
+
+        for (; i + 32 <= n; i += 32) {
+            __m256i v = _mm256_loadu_si256((const __m256i *)&s[i]);
+            __m256i lo = BlendDiv255AVX2(_mm256_mullo_epi16(_mm256_unpacklo_epi8(v, zero), va));
+            __m256i hi = BlendDiv255AVX2(_mm256_mullo_epi16(_mm256_unpackhi_epi8(v, zero), va));
+            _mm256_storeu_si256((__m256i *)&a[i], _mm256_packus_epi16(lo, hi));
+        }
+        BlendAlphaC(&a[i], &s[i], n - i, alpha);
+    }
+    VLC_AVX2
+    static void merge(uint8_t *d, const uint8_t *s, const uint8_t *a, unsigned n)
+    {
+        unsigned i = 0;
+
+        for (; i + 32 <= n; i += 32) {
+            __m256i v = BlendMerge8AVX2(_mm256_loadu_si256((const __m256i *)&d[i]),
+                                        _mm256_loadu_si256((const __m256i *)&s[i]),
+                                        _mm256_loadu_si256((const __m256i *)&a[i]));
+            _mm256_storeu_si256((__m256i *)&d[i], v);
+        }
+        BlendMergeC(&d[i], &s[i], &a[i], n - i);
+    }
+    /* The even samples are already in order in the 16 bits lanes, so only
+     * the destination goes through the cross-lane packing */
+    VLC_AVX2
+    static void merge2(uint8_t *d, const uint8_t *s, const uint8_t *a, unsigned n)
+    {
+        const __m256i even = _mm256_set1_epi16(0xff);
+        unsigned i = 0;
+
+        for (; i + 16 < n; i += 16) {
+            __m256i vd = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)&d[i]));
+            __m256i vs = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)&s[2 * i]), even);
+            __m256i va = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)&a[2 * i]), even);
+            __m256i v = BlendMerge16AVX2(vd, vs, va);
+
+            v = _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0x08);
+            _mm_storeu_si128((__m128i *)&d[i], _mm256_castsi256_si128(v));
+        }
+        BlendMerge2C(&d[i], &s[2 * i], &a[2 * i], n - i);
+    }
+    VLC_AVX2
+    static void merge2UV(uint8_t *d, const uint8_t *u, const uint8_t *v,
+                         const uint8_t *a, unsigned n)
+    {
+        const __m256i even = _mm256_set1_epi16(0xff);
+        unsigned i = 0;
+
+        for (; i + 16 < n; i += 16) {
+            __m256i vu = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)&u[2 * i]), even);
+            __m256i vv = _mm256_slli_epi16(_mm256_loadu_si256((const __m256i *)&v[2 * i]), 8);
+            __m256i va = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)&a[2 * i]), even);
+            __m256i vd = BlendMerge8AVX2(_mm256_loadu_si256((const __m256i *)&d[2 * i]),
+                                         _mm256_or_si256(vu, vv),
+                                         _mm256_or_si256(va, _mm256_slli_epi16(va, 8)));
+            _mm256_storeu_si256((__m256i *)&d[2 * i], vd);
+        }
+        BlendMerge2UVC(&d[2 * i], &u[2 * i], &v[2 * i], &a[2 * i], n - i);
+    }
+    static void mergeRGBX(uint8_t *d, const uint8_t *s, unsigned n,
+                          unsigned alpha, bool swap)
+    {
+        if (swap)
+            BlendMergeRGBXAVX2<true>(d, s, n, alpha);
+        else
+            BlendMergeRGBXAVX2<false>(d, s, n, alpha);
+    }
+};
+#endif
+
+#ifdef BLEND_NEON
+static inline uint8x8_t BlendDiv255NEON(uint16x8_t v)
+{
+    return vaddhn_u16(v, vaddq_u16(vshrq_n_u16(v, 8), vdupq_n_u16(1)));
+}
+
+static inline uint8x8_t BlendMergeNEON(uint8x8_t d, uint8x8_t s, uint8x8_t a)
+{
+    return BlendDiv255NEON(vmlal_u8(vmull_u8(d, vmvn_u8(a)), s, a));
+}
+
+template <bool swap>
+static void BlendMergeRGBXNEON(uint8_t *d, const uint8_t *s, unsigned n,
+                               unsigned alpha)
+{
+    const uint8x8_t va = vdup_n_u8(alpha);
+    unsigned i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        uint8x8x4_t vs = vld4_u8(&s[4 * i]);
+        uint8x8x4_t vd = vld4_u8(&d[4 * i]);
+        uint8x8_t a = BlendDiv255NEON(vmull_u8(vs.val[3], va));
+
+        vd.val[swap ? 2 : 0] = BlendMergeNEON(vd.val[swap ? 2 : 0], vs.val[0], a);
+        vd.val[1]            = BlendMergeNEON(vd.val[1],            vs.val[1], a);
+        vd.val[swap ? 0 : 2] = BlendMergeNEON(vd.val[swap ? 0 : 2], vs.val[2], a);
+        vst4_u8(&d[4 * i], vd);
+    }
+    BlendMergeRGBXC<swap>(&d[4 * i], &s[4 * i], n - i, alpha);
+}
+
+struct CBlendNEON {
+    static void scaleAlpha(uint8_t *a, const uint8_t *s, unsigned n, unsigned alpha)
+    {
+        const uint8x8_t va = vdup_n_u8(alpha);
+        unsigned i = 0;
+
+        for (; i + 8 <= n; i += 8)
+            vst1_u8(&a[i], BlendDiv255NEON(vmull_u8(vld1_u8(&s[i]), va)));
+        BlendAlphaC(&a[i], &s[i], n - i, alpha);
+    }
+    static void merge(uint8_t *d, const uint8_t *s, const uint8_t *a, unsigned n)
+    {
+        unsigned i = 0;
+
+        for (; i + 8 <= n; i += 8)
+            vst1_u8(&d[i], BlendMergeNEON(vld1_u8(&d[i]), vld1_u8(&s[i]),
+                                          vld1_u8(&a[i])));
+        BlendMergeC(&d[i], &s[i], &a[i], n - i);
+    }
+    static void merge2(uint8_t *d, const uint8_t *s, const uint8_t *a, unsigned n)
+    {
+        unsigned i = 0;
+
+        for (; i + 8 < n; i += 8)
+            vst1_u8(&d[i], BlendMergeNEON(vld1_u8(&d[i]),
+                                          vld2_u8(&s[2 * i]).val[0],
+                                          vld2_u8(&a[2 * i]).val[0]));
+        BlendMerge2C(&d[i], &s[2 * i], &a[2 * i], n - i);
+    }
+    static void merge2UV(uint8_t *d, const uint8_t *u, const uint8_t *v,
+                         const uint8_t *a, unsigned n)
+    {
+        unsigned i = 0;
+
+        for (; i + 8 < n; i += 8) {
+            uint8x8x2_t vd = vld2_u8(&d[2 * i]);
+            uint8x8_t va = vld2_u8(&a[2 * i]).val[0];
+
+            vd.val[0] = BlendMergeNEON(vd.val[0], vld2_u8(&u[2 * i]).val[0], va);
+            vd.val[1] = BlendMergeNEON(vd.val[1], vld2_u8(&v[2 * i]).val[0], va);
+            vst2_u8(&d[2 * i], vd);
+        }
+        BlendMerge2UVC(&d[2 * i], &u[2 * i], &v[2 * i], &a[2 * i], n - i);
+    }
+    static void mergeRGBX(uint8_t *d, const uint8_t *s, unsigned n,
+                          unsigned alpha, bool swap)
+    {
+        if (swap)
+            BlendMergeRGBXNEON<true>(d, s, n, alpha);
+        else
+            BlendMergeRGBXNEON<false>(d, s, n, alpha);
+    }
+};
+#endif
+
+/* YUVA or YUVP onto I420, YV12, NV12 or NV21 */
+template <class K, class TDst, bool semiplanar, bool swap_uv, bool palette>
+void BlendYUV420(const CPicture &dst_data, const CPicture &src_data,
+                 unsigned width, unsigned height, int alpha)
+{
+    if (alpha > 255) {
+        if (palette)
+            Blend<TDst, CPictureYUVP, compose<convertNone, convertYuvpToYuva8> >(
+                dst_data, src_data, width, height, alpha);
+        else
+            Blend<TDst, CPictureYUVA, compose<convertNone, convertNone> >(
+                dst_data, src_data, width, height, alpha);
+        return;
+    }
+
+    const picture_t *dst = dst_data.getPicture();
+    const picture_t *src = src_data.getPicture();
+    const video_palette_t *pal = src_data.getFormat()->p_palette;
+    const unsigned dx = dst_data.getX(), dy = dst_data.getY();
+    const unsigned sx = src_data.getX(), sy = src_data.getY();
+    /* First destination column with chroma */
+    const unsigned x0 = dx % 2;
+    uint8_t yuva[4][BLEND_CHUNK];
+    uint8_t a[BLEND_CHUNK];
+
+    for (unsigned y = 0; y < height; y++) {
+        const uint8_t *s[4];
+        for (int i = 0; i < (palette ? 1 : 4); i++)
+            s[i] = &src->p[i].p_pixels[(sy + y) * src->p[i].i_pitch + sx];
+
+        const plane_t *dp = dst->p;
+        uint8_t *dy_line = &dp[0].p_pixels[(dy + y) * dp[0].i_pitch + dx];
+        uint8_t *du = NULL, *dv = NULL;
+        if ((dy + y) % 2 == 0) {
+            const unsigned iu = semiplanar ? 1 : (swap_uv ? 2 : 1);
+            const unsigned iv = semiplanar ? 1 : (swap_uv ? 1 : 2);
+            du = &dp[iu].p_pixels[(dy + y) / 2 * dp[iu].i_pitch];
+            dv = &dp[iv].p_pixels[(dy + y) / 2 * dp[iv].i_pitch];
+        }
+
+        for (unsigned x = 0; x < width; x += BLEND_CHUNK) {
+            const unsigned n = __MIN(width - x, BLEND_CHUNK);
+            const uint8_t *sl[4];
+
+            if (palette) {
+                for (unsigned i = 0; i < n; i++) {
+                    const uint8_t *entry = pal->palette[s[0][x + i]];
+                    yuva[0][i] = entry[0];
+                    yuva[1][i] = entry[1];
+                    yuva[2][i] = entry[2];
+                    yuva[3][i] = entry[3];
+                }
+                for (int i = 0; i < 4; i++)
+                    sl[i] = yuva[i];
+            } else {
+                for (int i = 0; i < 4; i++)
+                    sl[i] = &s[i][x];
+            }
+            K::scaleAlpha(a, sl[3], n, alpha);
+            K::merge(&dy_line[x], sl[0], a, n);
+
+            /* The chunks start on even columns */
+            if (du == NULL || n <= x0)
+                continue;
+            const unsigned c = (dx + x + x0) / 2;
+            const unsigned count = (n - x0 + 1) / 2;
+            if (semiplanar)
+                K::merge2UV(&du[2 * c], sl[swap_uv ? 2 : 1] + x0,
+                            sl[swap_uv ? 1 : 2] + x0, &a[x0], count);
+            else {
+                K::merge2(&du[c], sl[1] + x0, &a[x0], count);
+                K::merge2(&dv[c], sl[2] + x0, &a[x0], count);
+            }
+        }
+    }
+}
+
+/* RGBA onto RV32 with its red, green and blue in the first 3 bytes */
+template <class K>
+void BlendRGBA(const CPicture &dst_data, const CPicture &src_data,
+               unsigned width, unsigned height, int alpha)
+{
+    const video_format_t *fmt = dst_data.getFormat();
+#ifdef WORDS_BIGENDIAN
+    const unsigned offset_r = (32 - fmt->i_lrshift) / 8;
+    const unsigned offset_g = (32 - fmt->i_lgshift) / 8;
+    const unsigned offset_b = (32 - fmt->i_lbshift) / 8;
+#else
+    const unsigned offset_r = fmt->i_lrshift / 8;
+    const unsigned offset_g = fmt->i_lgshift / 8;
+    const unsigned offset_b = fmt->i_lbshift / 8;
+#endif
+    const bool rgb = offset_r == 0 && offset_g == 1 && offset_b == 2;
+    const bool bgr = offset_r == 2 && offset_g == 1 && offset_b == 0;
+
+    if (alpha > 255 || (!rgb && !bgr)) {
+        Blend<CPictureRGB32, CPictureRGBA, compose<convertNone, convertNone> >(
+            dst_data, src_data, width, height, alpha);
+        return;
+    }
+
+    const picture_t *dst = dst_data.getPicture();
+    const picture_t *src = src_data.getPicture();
+    for (unsigned y = 0; y < height; y++) {
+        uint8_t *d = &dst->p[0].p_pixels[(dst_data.getY() + y) * dst->p[0].i_pitch
+                                         + dst_data.getX() * 4];
+        const uint8_t *s = &src->p[0].p_pixels[(src_data.getY() + y) * src->p[0].i_pitch
+                                               + src_data.getX() * 4];
+        K::mergeRGBX(d, s, width, alpha, bgr);
+    }
+}
+
+template <class K>
+static blend_function_t GetBlendAccelerated(vlc_fourcc_t dst, vlc_fourcc_t src)
+{
+    static const struct {
+        vlc_fourcc_t     dst;
+        vlc_fourcc_t     src;
+        blend_function_t blend;
+    } blends[] = {
+#define YUV420(csp, picture, semiplanar, swap_uv) \
+    { csp, VLC_CODEC_YUVA, BlendYUV420<K, picture, semiplanar, swap_uv, false> }, \
+    { csp, VLC_CODEC_YUVP, BlendYUV420<K, picture, semiplanar, swap_uv, true> }
+
+        YUV420(VLC_CODEC_I420, CPictureI420_8, false, false),
+        YUV420(VLC_CODEC_J420, CPictureI420_8, false, false),
+        YUV420(VLC_CODEC_YV12, CPictureYV12,   false, true),
+        YUV420(VLC_CODEC_NV12, CPictureNV12,   true,  false),
+        YUV420(VLC_CODEC_NV21, CPictureNV21,   true,  true),
+        { VLC_CODEC_RGB32, VLC_CODEC_RGBA, BlendRGBA<K> },
+#undef YUV420
+    };
+
+    for (size_t i = 0; i < sizeof(blends) / sizeof(*blends); i++) {
+        if (blends[i].src == src && blends[i].dst == dst)
+            return blends[i].blend;
+    }
+    return NULL;
+}
+#endif
+
+static blend_function_t GetBlendAccelerated(vlc_fourcc_t dst, vlc_fourcc_t src)
+{
+#ifdef BLEND_AVX2
+    if (vlc_CPU_AVX2())
+        return GetBlendAccelerated<CBlendAVX2>(dst, src);
+#endif
+#ifdef BLEND_SSE2
+    if (vlc_CPU_SSE2())
+        return GetBlendAccelerated<CBlendSSE2>(dst, src);
+#endif
+#ifdef BLEND_NEON
+    return GetBlendAccelerated<CBlendNEON>(dst, src);
+#else
+    VLC_UNUSED(dst); VLC_UNUSED(src);
+    return NULL;
+#endif
+}
+
 static const struct {
     vlc_fourcc_t     dst;
     vlc_fourcc_t     src;
@@ -668,6 +1281,12 @@ static int Open(vlc_object_t *object)
             sys->blend = blends[i].blend;
     }
 
+    if (sys->blend) {
+        blend_function_t accelerated = GetBlendAccelerated(dst, src);
+        if (accelerated)
+            sys->blend = accelerated;
+    }
+
     if (!sys->blend) {
        msg_Err(filter, "no matching alpha blending routine (chroma: %4.4s -> %4.4s)",
                (char *)&src, (char *)&dst);
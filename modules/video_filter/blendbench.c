@@ -21,6 +21,7 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
 
+
 /*****************************************************************************
  * Preamble
  *****************************************************************************/
@@ -55,18 +56,27 @@ static picture_t *Filter( filter_t *, picture_t * );
 #define ALPHA_TEXT N_("Alpha of the blended image")
 #define ALPHA_LONGTEXT N_("Alpha with which the blend image is blended")
 
+#define WIDTH_TEXT N_("Width of the generated images")
+#define WIDTH_LONGTEXT N_("Width of the images generated when no image " \
+                          "file is given")
+
+#define HEIGHT_TEXT N_("Height of the generated images")
+#define HEIGHT_LONGTEXT N_("Height of the images generated when no image " \
+                           "file is given")
+
 #define BASE_IMAGE_TEXT N_("Image to be blended onto")
 #define BASE_IMAGE_LONGTEXT N_("The image which will be used to blend onto")
 
-#define BASE_CHROMA_TEXT N_("Chroma for the base image")
-#define BASE_CHROMA_LONGTEXT N_("Chroma which the base image will be loaded in")
+#define BASE_CHROMA_TEXT N_("Chromas for the base image")
+#define BASE_CHROMA_LONGTEXT N_("Comma separated chromas which the base " \
+                                "image will be loaded in, in turn")
 
 #define BLEND_IMAGE_TEXT N_("Image which will be blended")
 #define BLEND_IMAGE_LONGTEXT N_("The image blended onto the base image")
 
-#define BLEND_CHROMA_TEXT N_("Chroma for the blend image")
-#define BLEND_CHROMA_LONGTEXT N_("Chroma which the blend image will be loaded" \
-                                 " in")
+#define BLEND_CHROMA_TEXT N_("Chromas for the blend image")
+#define BLEND_CHROMA_LONGTEXT N_("Comma separated chromas which the blend " \
+                                 "image will be loaded in, in turn")
 
 #define CFG_PREFIX "blendbench-"
 
@@ -82,25 +92,29 @@ vlc_module_begin ()
               LOOPS_LONGTEXT, false )
     add_integer_with_range( CFG_PREFIX "alpha", 128, 0, 255, ALPHA_TEXT,
               ALPHA_LONGTEXT, false )
+    add_integer( CFG_PREFIX "width", 1920, WIDTH_TEXT, WIDTH_LONGTEXT,
+                 false )
+    add_integer( CFG_PREFIX "height", 1080, HEIGHT_TEXT, HEIGHT_LONGTEXT,
+                 false )
 
     set_section( N_("Base image"), NULL )
     add_loadfile( CFG_PREFIX "base-image", NULL, BASE_IMAGE_TEXT,
                   BASE_IMAGE_LONGTEXT, false )
-    add_string( CFG_PREFIX "base-chroma", "I420", BASE_CHROMA_TEXT,
-              BASE_CHROMA_LONGTEXT, false )
+    add_string( CFG_PREFIX "base-chroma", "I420,YV12,NV12,RV32",
+                BASE_CHROMA_TEXT, BASE_CHROMA_LONGTEXT, false )
 
     set_section( N_("Blend image"), NULL )
     add_loadfile( CFG_PREFIX "blend-image", NULL, BLEND_IMAGE_TEXT,
                   BLEND_IMAGE_LONGTEXT, false )
-    add_string( CFG_PREFIX "blend-chroma", "YUVA", BLEND_CHROMA_TEXT,
-              BLEND_CHROMA_LONGTEXT, false )
+    add_string( CFG_PREFIX "blend-chroma", "YUVA,YUVP,RGBA",
+                BLEND_CHROMA_TEXT, BLEND_CHROMA_LONGTEXT, false )
 
     set_callbacks( Create, Destroy )
 vlc_module_end ()
 
 static const char *const ppsz_filter_options[] = {
-    "loops", "alpha", "base-image", "base-chroma", "blend-image",
-    "blend-chroma", NULL
+    "loops", "alpha", "width", "height", "base-image", "base-chroma",
+    "blend-image", "blend-chroma", NULL
 };
 
 /*****************************************************************************
@@ -110,39 +124,95 @@ struct filter_sys_t
 {
     bool b_done;
     int i_loops, i_alpha;
+    unsigned i_width, i_height;
 
-    picture_t *p_base_image;
-    picture_t *p_blend_image;
+    char *psz_base_image;
+    char *psz_base_chroma;
+    char *psz_blend_image;
+    char *psz_blend_chroma;
 
-    vlc_fourcc_t i_base_chroma;
-    vlc_fourcc_t i_blend_chroma;
+    video_palette_t palette;
 };
 
-static int blendbench_LoadImage( vlc_object_t *p_this, picture_t **pp_pic,
-                                 vlc_fourcc_t i_chroma, char *psz_file, const char *psz_name )
+static picture_t *blendbench_LoadImage( vlc_object_t *p_this,
+                                        vlc_fourcc_t i_chroma,
+                                        const char *psz_file,
+                                        const char *psz_name )
 {
     image_handler_t *p_image;
     video_format_t fmt_in, fmt_out;
+    picture_t *p_pic;
 
     memset( &fmt_in, 0, sizeof(video_format_t) );
     memset( &fmt_out, 0, sizeof(video_format_t) );
 
     fmt_out.i_chroma = i_chroma;
     p_image = image_HandlerCreate( p_this );
-    *pp_pic = image_ReadUrl( p_image, psz_file, &fmt_in, &fmt_out );
+    p_pic = image_ReadUrl( p_image, psz_file, &fmt_in, &fmt_out );
     image_HandlerDelete( p_image );
 
-    if( *pp_pic == NULL )
+    if( p_pic == NULL )
     {
         msg_Err( p_this, "Unable to load %s image", psz_name );
-        return VLC_EGENERIC;
+        return NULL;
     }
 
     msg_Dbg( p_this, "%s image has dim %d x %d (Y plane)", psz_name,
-             (*pp_pic)->p[Y_PLANE].i_visible_pitch,
-             (*pp_pic)->p[Y_PLANE].i_visible_lines );
+             p_pic->p[Y_PLANE].i_visible_pitch,
+             p_pic->p[Y_PLANE].i_visible_lines );
 
-    return VLC_SUCCESS;
+    return p_pic;
+}
+
+/**
+ * Generates an image made of the same pseudo-random samples on every run,
+ * and on every platform, for the results to be comparable. About a third
+ * of the samples of the alpha plane are transparent and a third opaque, as
+ * in a subtitle.
+ */
+static picture_t *blendbench_GenerateImage( filter_t *p_filter,
+                                            vlc_fourcc_t i_chroma )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    video_format_t fmt;
+    picture_t *p_pic;
+    uint32_t i_seed = 1;
+
+    video_format_Setup( &fmt, i_chroma, p_sys->i_width, p_sys->i_height,
+                        p_sys->i_width, p_sys->i_height, 1, 1 );
+    p_pic = picture_NewFromFormat( &fmt );
+    if( p_pic == NULL )
+        return NULL;
+
+    for( int i = 0; i < p_pic->i_planes; i++ )
+    {
+        plane_t *p = &p_pic->p[i];
+        const bool b_alpha = i == A_PLANE && i_chroma == VLC_CODEC_YUVA;
+
+        for( int y = 0; y < p->i_lines; y++ )
+            for( int x = 0; x < p->i_pitch; x++ )
+            {
+                unsigned v;
+
+                i_seed = i_seed * 1103515245 + 12345;
+                v = i_seed >> 16;
+                if( b_alpha || (i_chroma == VLC_CODEC_RGBA && x % 4 == 3) )
+                    v = v % 3 == 0 ? 0 : v % 3 == 1 ? 255 : v & 0xff;
+                p->p_pixels[y * p->i_pitch + x] = v;
+            }
+    }
+    return p_pic;
+}
+
+static picture_t *blendbench_GetImage( filter_t *p_filter,
+                                       vlc_fourcc_t i_chroma,
+                                       const char *psz_file,
+                                       const char *psz_name )
+{
+    if( psz_file != NULL && *psz_file )
+        return blendbench_LoadImage( VLC_OBJECT(p_filter), i_chroma,
+                                     psz_file, psz_name );
+    return blendbench_GenerateImage( p_filter, i_chroma );
 }
 
 /*****************************************************************************
@@ -152,8 +222,6 @@ static int Create( vlc_object_t *p_this )
 {
     filter_t *p_filter = (filter_t *)p_this;
     filter_sys_t *p_sys;
-    char *psz_temp, *psz_cmd;
-    int i_ret;
 
     /* Allocate structure */
     p_filter->p_sys = malloc( sizeof( filter_sys_t ) );
@@ -174,31 +242,30 @@ static int Create( vlc_object_t *p_this )
                                                   CFG_PREFIX "loops" );
     p_sys->i_alpha = var_CreateGetIntegerCommand( p_filter,
                                                   CFG_PREFIX "alpha" );
-
-    psz_temp = var_CreateGetStringCommand( p_filter, CFG_PREFIX "base-chroma" );
-    p_sys->i_base_chroma = VLC_FOURCC( psz_temp[0], psz_temp[1],
-                                       psz_temp[2], psz_temp[3] );
-    psz_cmd = var_CreateGetStringCommand( p_filter, CFG_PREFIX "base-image" );
-    i_ret = blendbench_LoadImage( p_this, &p_sys->p_base_image,
-                                  p_sys->i_base_chroma, psz_cmd, "Base" );
-    free( psz_temp );
-    free( psz_cmd );
-    if( i_ret != VLC_SUCCESS )
+    p_sys->i_width = __MAX( var_CreateGetIntegerCommand( p_filter,
+                                            CFG_PREFIX "width" ), 16 );
+    p_sys->i_height = __MAX( var_CreateGetIntegerCommand( p_filter,
+                                            CFG_PREFIX "height" ), 16 );
+
+    p_sys->psz_base_image =
+        var_CreateGetStringCommand( p_filter, CFG_PREFIX "base-image" );
+    p_sys->psz_base_chroma =
+        var_CreateGetStringCommand( p_filter, CFG_PREFIX "base-chroma" );
+    p_sys->psz_blend_image =
+        var_CreateGetStringCommand( p_filter, CFG_PREFIX "blend-image" );
+    p_sys->psz_blend_chroma =
+        var_CreateGetStringCommand( p_filter, CFG_PREFIX "blend-chroma" );
+
+    /* Palette for the YUVP blend image: a gray ramp, half transparent */
+    p_sys->palette.i_entries = 256;
+    for( int i = 0; i < 256; i++ )
     {
-        free( p_sys );
-        return i_ret;
+        p_sys->palette.palette[i][0] = i;
+        p_sys->palette.palette[i][1] = 128;
+        p_sys->palette.palette[i][2] = 128;
+        p_sys->palette.palette[i][3] = i % 2 ? 255 : i;
     }
 
-    psz_temp = var_CreateGetStringCommand( p_filter,
-                                           CFG_PREFIX "blend-chroma" );
-    p_sys->i_blend_chroma = VLC_FOURCC( psz_temp[0], psz_temp[1],
-                                        psz_temp[2], psz_temp[3] );
-    psz_cmd = var_CreateGetStringCommand( p_filter, CFG_PREFIX "blend-image" );
-    blendbench_LoadImage( p_this, &p_sys->p_blend_image, p_sys->i_blend_chroma,
-                          psz_cmd, "Blend" );
-    free( psz_temp );
-    free( psz_cmd );
-
     return VLC_SUCCESS;
 }
 
@@ -210,57 +277,126 @@ static void Destroy( vlc_object_t *p_this )
     filter_t *p_filter = (filter_t *)p_this;
     filter_sys_t *p_sys = p_filter->p_sys;
 
-    picture_Release( p_sys->p_base_image );
-    picture_Release( p_sys->p_blend_image );
+    free( p_sys->psz_base_image );
+    free( p_sys->psz_base_chroma );
+    free( p_sys->psz_blend_image );
+    free( p_sys->psz_blend_chroma );
+    free( p_sys );
 }
 
-/*****************************************************************************
- * Render: displays previously rendered output
- *****************************************************************************/
-static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+static vlc_fourcc_t blendbench_GetChroma( const char *psz )
+{
+    if( strlen( psz ) != 4 )
+        return 0;
+    return VLC_FOURCC( psz[0], psz[1], psz[2], psz[3] );
+}
+
+/* Measures the blending of a blend chroma onto a base chroma */
+static void blendbench_Run( filter_t *p_filter, vlc_fourcc_t i_base_chroma,
+                            vlc_fourcc_t i_blend_chroma )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
+    picture_t *p_base_image, *p_blend_image;
     filter_t *p_blend;
 
-    if( p_sys->b_done )
-        return p_pic;
+    p_base_image = blendbench_GetImage( p_filter, i_base_chroma,
+                                        p_sys->psz_base_image, "Base" );
+    p_blend_image = blendbench_GetImage( p_filter, i_blend_chroma,
+                                         p_sys->psz_blend_image, "Blend" );
+    if( p_base_image == NULL || p_blend_image == NULL )
+        goto out;
 
     p_blend = vlc_object_create( p_filter, sizeof(filter_t) );
     if( !p_blend )
-    {
-        picture_Release( p_pic );
-        return NULL;
-    }
-    p_blend->fmt_out.video = p_sys->p_base_image->format;
-    p_blend->fmt_in.video = p_sys->p_blend_image->format;
+        goto out;
+    p_blend->fmt_out.video = p_base_image->format;
+    p_blend->fmt_in.video = p_blend_image->format;
+    if( i_blend_chroma == VLC_CODEC_YUVP )
+        p_blend->fmt_in.video.p_palette = &p_sys->palette;
     p_blend->p_module = module_need( p_blend, "video blending", NULL, false );
     if( !p_blend->p_module )
     {
-        picture_Release( p_pic );
+        msg_Warn( p_filter, "Cannot blend %4.4s onto %4.4s",
+                  (const char *)&i_blend_chroma,
+                  (const char *)&i_base_chroma );
         vlc_object_release( p_blend );
-        return NULL;
+        goto out;
     }
 
     mtime_t time = mdate();
     for( int i_iter = 0; i_iter < p_sys->i_loops; ++i_iter )
     {
         p_blend->pf_video_blend( p_blend,
-                                 p_sys->p_base_image, p_sys->p_blend_image,
+                                 p_base_image, p_blend_image,
                                  0, 0, p_sys->i_alpha );
     }
     time = mdate() - time;
 
-    msg_Info( p_filter, "Blended %d images in %f sec", p_sys->i_loops,
-              time / 1000000.0f );
-    msg_Info( p_filter, "Speed is: %f images/second, %f pixels/second",
+    const unsigned i_pixels =
+        __MIN( p_base_image->format.i_visible_width,
+               p_blend_image->format.i_visible_width ) *
+        __MIN( p_base_image->format.i_visible_height,
+               p_blend_image->format.i_visible_height );
+
+    msg_Info( p_filter, "%4.4s onto %4.4s: blended %d images in %f sec",
+              (const char *)&i_blend_chroma, (const char *)&i_base_chroma,
+              p_sys->i_loops, time / 1000000.0f );
+    msg_Info( p_filter, "%4.4s onto %4.4s: %f images/second, "
+              "%f Mpixels/second",
+              (const char *)&i_blend_chroma, (const char *)&i_base_chroma,
               (float) p_sys->i_loops / time * 1000000,
-              (float) p_sys->i_loops / time * 1000000 *
-                  p_sys->p_blend_image->p[Y_PLANE].i_visible_pitch *
-                  p_sys->p_blend_image->p[Y_PLANE].i_visible_lines );
+              (float) p_sys->i_loops / time * i_pixels );
 
     module_unneed( p_blend, p_blend->p_module );
 
     vlc_object_release( p_blend );
+out:
+    if( p_base_image != NULL )
+        picture_Release( p_base_image );
+    if( p_blend_image != NULL )
+        picture_Release( p_blend_image );
+}
+
+/*****************************************************************************
+ * Render: displays previously rendered output
+ *****************************************************************************/
+static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    if( p_sys->b_done )
+        return p_pic;
+
+    char *psz_bases = strdup( p_sys->psz_base_chroma );
+    char *psz_base, *psz_save_base;
+
+    if( psz_bases == NULL )
+        return p_pic;
+    for( psz_base = strtok_r( psz_bases, ",", &psz_save_base );
+         psz_base != NULL;
+         psz_base = strtok_r( NULL, ",", &psz_save_base ) )
+    {
+        char *psz_blends = strdup( p_sys->psz_blend_chroma );
+        char *psz_blend, *psz_save_blend;
+
+        if( psz_blends == NULL )
+            break;
+        for( psz_blend = strtok_r( psz_blends, ",", &psz_save_blend );
+             psz_blend != NULL;
+             psz_blend = strtok_r( NULL, ",", &psz_save_blend ) )
+        {
+            vlc_fourcc_t i_base = blendbench_GetChroma( psz_base );
+            vlc_fourcc_t i_blend = blendbench_GetChroma( psz_blend );
+
+            if( i_base == 0 || i_blend == 0 )
+                msg_Err( p_filter, "invalid chroma %s onto %s",
+                         psz_blend, psz_base );
+            else
+                blendbench_Run( p_filter, i_base, i_blend );
+        }
+        free( psz_blends );
+    }
+    free( psz_bases );
 
     p_sys->b_done = true;
     return p_pic;
@@ -34,6 +34,7 @@
 #include <vlc_common.h>
 #include <vlc_cpu.h>
 #include <vlc_picture.h>
+#include <vlc_filter.h>
 
 #include "deinterlace.h" /* filter_sys_t */
 
@@ -533,17 +534,27 @@ static inline void XDeintBand8x8MMXEXT( uint8_t *dst, int i_dst,
 }
 #endif
 
-/*****************************************************************************
- * Public functions
- *****************************************************************************/
+typedef struct
+{
+    picture_t *p_outpic;
+    picture_t *p_pic;
+} x_slice_t;
 
-void RenderX( picture_t *p_outpic, picture_t *p_pic )
+/* Renders the 8-line block rows starting in a slice */
+static void XSlice( filter_t *p_filter, void *opaque,
+                    const filter_slice_t *p_slice )
 {
+    const x_slice_t *ctx = opaque;
+    picture_t *p_outpic = ctx->p_outpic;
+    picture_t *p_pic = ctx->p_pic;
+    const int i_lines = p_outpic->p[0].i_visible_lines;
     int i_plane;
 #if defined (CAN_COMPILE_MMXEXT)
     const bool mmxext = vlc_CPU_MMXEXT();
 #endif
 
+    VLC_UNUSED(p_filter);
+
     /* Copy image and skip lines */
     for( i_plane = 0 ; i_plane < p_pic->i_planes ; i_plane++ )
     {
@@ -556,9 +567,16 @@ void RenderX( picture_t *p_outpic, picture_t *p_pic )
         const int i_dst = p_outpic->p[i_plane].i_pitch;
         const int i_src = p_pic->p[i_plane].i_pitch;
 
+        const int i_end = filter_SliceLine( p_slice->i_end, i_lines,
+                                     p_outpic->p[i_plane].i_visible_lines );
+        const int i_last = i_end < p_outpic->p[i_plane].i_visible_lines
+                         ? i_end / 8 : i_mby;
+
         int y, x;
 
-        for( y = 0; y < i_mby; y++ )
+        for( y = filter_SliceLine( p_slice->i_first, i_lines,
+                                   p_outpic->p[i_plane].i_visible_lines ) / 8;
+             y < i_last; y++ )
         {
             uint8_t *dst = &p_outpic->p[i_plane].p_pixels[8*y*i_dst];
             uint8_t *src = &p_pic->p[i_plane].p_pixels[8*y*i_src];
@@ -572,7 +590,7 @@ void RenderX( picture_t *p_outpic, picture_t *p_pic )
         }
 
         /* Last line (C only)*/
-        if( i_mody )
+        if( i_mody && i_end == p_outpic->p[i_plane].i_visible_lines )
         {
             uint8_t *dst = &p_outpic->p[i_plane].p_pixels[8*y*i_dst];
             uint8_t *src = &p_pic->p[i_plane].p_pixels[8*y*i_src];
@@ -595,3 +613,14 @@ void RenderX( picture_t *p_outpic, picture_t *p_pic )
         emms();
 #endif
 }
+
+/*****************************************************************************
+ * Public functions
+ *****************************************************************************/
+
+void RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
+{
+    x_slice_t ctx = { .p_outpic = p_outpic, .p_pic = p_pic };
+
+    filter_Slice( p_filter, p_outpic->p[0].i_visible_lines, 0, XSlice, &ctx );
+}
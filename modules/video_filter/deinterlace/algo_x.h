@@ -25,6 +25,7 @@
 #define VLC_DEINTERLACE_ALGO_X_H 1
 
 /* Forward declarations */
+struct filter_t;
 struct picture_t;
 
 /*****************************************************************************
@@ -46,10 +47,11 @@ struct picture_t;
  *    * otherwise: it recreates the bottom field by an edge oriented
  *      interpolation.
  *
+ * @param p_filter The filter instance, whose slicer runs the rendering.
  * @param[in] p_pic Input frame.
  * @param[out] p_outpic Output frame. Must be allocated by caller.
  * @see Deinterlace()
  */
-void RenderX( picture_t *p_outpic, picture_t *p_pic );
+void RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic );
 
 #endif
@@ -47,6 +47,78 @@
    Necessary preprocessor macros are defined in common.h. */
 #include "yadif.h"
 
+typedef void (*yadif_line_t)(uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                             uint8_t *next, int w, int prefs, int mrefs,
+                             int parity, int mode);
+
+typedef struct
+{
+    picture_t   *p_dst;
+    picture_t   *p_prev, *p_cur, *p_next;
+    yadif_line_t filter;
+    int          i_field;
+    int          i_parity;
+} yadif_slice_t;
+
+/* Renders the lines of a slice, each line only depends on the input frames */
+static void YadifSlice( filter_t *p_filter, void *opaque,
+                        const filter_slice_t *p_slice )
+{
+    const yadif_slice_t *ctx = opaque;
+    picture_t *p_dst = ctx->p_dst;
+    const int i_lines = p_dst->p[0].i_visible_lines;
+
+    VLC_UNUSED(p_filter);
+    for( int n = 0; n < p_dst->i_planes; n++ )
+    {
+        const plane_t *prevp = &ctx->p_prev->p[n];
+        const plane_t *curp  = &ctx->p_cur->p[n];
+        const plane_t *nextp = &ctx->p_next->p[n];
+        plane_t *dstp        = &p_dst->p[n];
+        int i_first = filter_SliceLine( p_slice->i_first, i_lines,
+                                        dstp->i_visible_lines );
+        int i_end = filter_SliceLine( p_slice->i_end, i_lines,
+                                      dstp->i_visible_lines );
+
+        for( int y = __MAX( i_first, 1 );
+             y < __MIN( i_end, dstp->i_visible_lines - 1 ); y++ )
+        {
+            if( (y % 2) == ctx->i_field  ||  ctx->i_parity == 2 )
+            {
+                memcpy( &dstp->p_pixels[y * dstp->i_pitch],
+                            &curp->p_pixels[y * curp->i_pitch], dstp->i_visible_pitch );
+            }
+            else
+            {
+                int mode;
+                /* Spatial checks only when enough data */
+                mode = (y >= 2 && y < dstp->i_visible_lines - 2) ? 0 : 2;
+
+                assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
+                ctx->filter( &dstp->p_pixels[y * dstp->i_pitch],
+                             &prevp->p_pixels[y * prevp->i_pitch],
+                             &curp->p_pixels[y * curp->i_pitch],
+                             &nextp->p_pixels[y * nextp->i_pitch],
+                             dstp->i_visible_pitch,
+                             y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
+                             y  - 1  ?  -curp->i_pitch : curp->i_pitch,
+                             ctx->i_parity,
+                             mode );
+            }
+
+            /* We duplicate the first and last lines */
+            if( y == 1 )
+                memcpy(&dstp->p_pixels[(y-1) * dstp->i_pitch],
+                           &dstp->p_pixels[ y    * dstp->i_pitch],
+                           dstp->i_pitch);
+            else if( y == dstp->i_visible_lines - 2 )
+                memcpy(&dstp->p_pixels[(y+1) * dstp->i_pitch],
+                           &dstp->p_pixels[ y    * dstp->i_pitch],
+                           dstp->i_pitch);
+        }
+    }
+}
+
 int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
                  int i_order, int i_field )
 {
@@ -105,8 +177,7 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
     if( p_prev && p_cur && p_next )
     {
         /* */
-        void (*filter)(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next,
-                       int w, int prefs, int mrefs, int parity, int mode);
+        yadif_line_t filter;
 
 #if defined(HAVE_YADIF_SSSE3)
         if( vlc_CPU_SSSE3() )
@@ -128,49 +199,12 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
         if( p_sys->chroma->pixel_size == 2 )
             filter = yadif_filter_line_c_16bit;
 
-        for( int n = 0; n < p_dst->i_planes; n++ )
-        {
-            const plane_t *prevp = &p_prev->p[n];
-            const plane_t *curp  = &p_cur->p[n];
-            const plane_t *nextp = &p_next->p[n];
-            plane_t *dstp        = &p_dst->p[n];
-
-            for( int y = 1; y < dstp->i_visible_lines - 1; y++ )
-            {
-                if( (y % 2) == i_field  ||  yadif_parity == 2 )
-                {
-                    memcpy( &dstp->p_pixels[y * dstp->i_pitch],
-                                &curp->p_pixels[y * curp->i_pitch], dstp->i_visible_pitch );
-                }
-                else
-                {
-                    int mode;
-                    /* Spatial checks only when enough data */
-                    mode = (y >= 2 && y < dstp->i_visible_lines - 2) ? 0 : 2;
-
-                    assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
-                    filter( &dstp->p_pixels[y * dstp->i_pitch],
-                            &prevp->p_pixels[y * prevp->i_pitch],
-                            &curp->p_pixels[y * curp->i_pitch],
-                            &nextp->p_pixels[y * nextp->i_pitch],
-                            dstp->i_visible_pitch,
-                            y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
-                            y  - 1  ?  -curp->i_pitch : curp->i_pitch,
-                            yadif_parity,
-                            mode );
-                }
-
-                /* We duplicate the first and last lines */
-                if( y == 1 )
-                    memcpy(&dstp->p_pixels[(y-1) * dstp->i_pitch],
-                               &dstp->p_pixels[ y    * dstp->i_pitch],
-                               dstp->i_pitch);
-                else if( y == dstp->i_visible_lines - 2 )
-                    memcpy(&dstp->p_pixels[(y+1) * dstp->i_pitch],
-                               &dstp->p_pixels[ y    * dstp->i_pitch],
-                               dstp->i_pitch);
-            }
-        }
+        yadif_slice_t ctx = {
+            .p_dst = p_dst, .p_prev = p_prev, .p_cur = p_cur, .p_next = p_next,
+            .filter = filter, .i_field = i_field, .i_parity = yadif_parity,
+        };
+        filter_Slice( p_filter, p_dst->p[0].i_visible_lines, 0,
+                      YadifSlice, &ctx );
 
         p_sys->i_frame_offset = 1; /* p_cur will be rendered at next frame, too */
 
@@ -182,7 +216,7 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
                  as set by Open() or SetFilterMethod(). It is always 0. */
 
         /* FIXME not good as it does not use i_order/i_field */
-        RenderX( p_dst, p_next );
+        RenderX( p_filter, p_dst, p_next );
         return VLC_SUCCESS;
     }
     else
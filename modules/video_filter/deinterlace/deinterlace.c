@@ -469,7 +469,7 @@ picture_t *Deinterlace( filter_t *p_filter, picture_t *p_pic )
             break;
 
         case DEINTERLACE_X:
-            RenderX( p_dst[0], p_pic );
+            RenderX( p_filter, p_dst[0], p_pic );
             break;
 
         case DEINTERLACE_YADIF:
@@ -129,12 +129,10 @@ static int Open(vlc_object_t *object)
     sys->radius   = var_CreateGetIntegerCommand(filter, CFG_PREFIX "radius");
     var_AddCallback(filter, CFG_PREFIX "strength", Callback, NULL);
     var_AddCallback(filter, CFG_PREFIX "radius",   Callback, NULL);
-    sys->cfg.buf = NULL;
 
     struct vf_priv_s *cfg = &sys->cfg;
     cfg->thresh      = 0.0;
     cfg->radius      = 0;
-    cfg->buf         = NULL;
 
 #if HAVE_SSE2 && HAVE_6REGS
     if (vlc_CPU_SSE2())
@@ -166,11 +164,54 @@ static void Close(vlc_object_t *object)
 
     var_DelCallback(filter, CFG_PREFIX "radius",   Callback, NULL);
     var_DelCallback(filter, CFG_PREFIX "strength", Callback, NULL);
-    vlc_free(sys->cfg.buf);
     vlc_mutex_destroy(&sys->lock);
     free(sys);
 }
 
+typedef struct {
+    picture_t *src;
+    picture_t *dst;
+    int       w[PICTURE_PLANE_MAX];
+    int       h[PICTURE_PLANE_MAX];
+    int       r[PICTURE_PLANE_MAX]; /* 0 if the plane is copied */
+} gradfun_slice_t;
+
+static void FilterSlice(filter_t *filter, void *opaque,
+                        const filter_slice_t *slice)
+{
+    filter_sys_t    *sys = filter->p_sys;
+    gradfun_slice_t *ctx = opaque;
+    unsigned        lines = ctx->h[0];
+
+    for (int i = 0; i < ctx->dst->i_planes; i++) {
+        const plane_t *srcp = &ctx->src->p[i];
+        plane_t       *dstp = &ctx->dst->p[i];
+        int w = ctx->w[i], h = ctx->h[i], r = ctx->r[i];
+        int first = filter_SliceLine(slice->i_first, lines, h);
+        int end   = filter_SliceLine(slice->i_end,   lines, h);
+
+        if (r == 0)
+            continue;
+        /* The blur works on pairs of lines */
+        first &= ~1;
+        if (end < h)
+            end &= ~1;
+
+        /* Each slice needs its own blur buffer */
+        struct vf_priv_s cfg = sys->cfg;
+        cfg.buf = vlc_memalign(16, (((w + 15) & ~15) * (r + 1) / 2 + 32) * sizeof(*cfg.buf));
+        if (cfg.buf) {
+            filter_plane(&cfg, dstp->p_pixels, srcp->p_pixels,
+                         w, h, dstp->i_pitch, srcp->i_pitch, r, first, end);
+            vlc_free(cfg.buf);
+        } else {
+            for (int y = first; y < end; y++)
+                memcpy(&dstp->p_pixels[y * dstp->i_pitch],
+                       &srcp->p_pixels[y * srcp->i_pitch], w);
+        }
+    }
+}
+
 static picture_t *Filter(filter_t *filter, picture_t *src)
 {
     filter_sys_t *sys = filter->p_sys;
@@ -188,13 +229,10 @@ static picture_t *Filter(filter_t *filter, picture_t *src)
 
     const video_format_t *fmt = &filter->fmt_in.video;
     struct vf_priv_s *cfg = &sys->cfg;
+    gradfun_slice_t ctx = { .src = src, .dst = dst };
 
     cfg->thresh = (1 << 15) / strength;
-    if (cfg->radius != radius) {
-        cfg->radius = radius;
-        cfg->buf    = vlc_memalign(16,
-                                   (((fmt->i_width + 15) & ~15) * (cfg->radius + 1) / 2 + 32) * sizeof(*cfg->buf));
-    }
+    cfg->radius = radius;
 
     for (int i = 0; i < dst->i_planes; i++) {
         const plane_t *srcp = &src->p[i];
@@ -206,13 +244,16 @@ static picture_t *Filter(filter_t *filter, picture_t *src)
         int r = (cfg->radius  * chroma->p[i].w.num / chroma->p[i].w.den +
                  cfg->radius  * chroma->p[i].h.num / chroma->p[i].h.den) / 2;
         r = VLC_CLIP((r + 1) & ~1, RADIUS_MIN, RADIUS_MAX);
-        if (__MIN(w, h) > 2 * r && cfg->buf) {
-            filter_plane(cfg, dstp->p_pixels, srcp->p_pixels,
-                         w, h, dstp->i_pitch, srcp->i_pitch, r);
+        ctx.w[i] = w;
+        ctx.h[i] = h;
+        if (__MIN(w, h) > 2 * r) {
+            ctx.r[i] = r;
         } else {
+            ctx.r[i] = 0;
             plane_CopyPixels(dstp, srcp);
         }
     }
+    filter_Slice(filter, ctx.h[0], 0, FilterSlice, &ctx);
 
     picture_CopyProperties(dst, src);
     picture_Release(src);
@@ -223,20 +223,30 @@ static void blur_line_sse2(uint16_t *dc, uint16_t *buf, uint16_t *buf1,
 }
 #endif // HAVE_6REGS && HAVE_SSE2
 
+/* Filters the lines [first, end[ of a plane. The box blur sums are primed
+ * from the row pairs above the first step, which gives the same output as
+ * filtering the whole plane at once. first must be even. */
 static void filter_plane(struct vf_priv_s *ctx, uint8_t *dst, uint8_t *src,
-                         int width, int height, int dstride, int sstride, int r)
+                         int width, int height, int dstride, int sstride, int r,
+                         int first, int end)
 {
     int bstride = ((width+15)&~15)/2;
-    int y;
+    int y, y0, i;
     uint32_t dc_factor = (1<<21)/(r*r);
     uint16_t *dc = ctx->buf+16;
     uint16_t *buf = ctx->buf+bstride+32;
     int thresh = ctx->thresh;
 
+    /* The first step whose blurred values are used by the slice */
+    y0 = VLC_CLIP(first, r, (height-r-1)&~1);
+
     memset(dc, 0, (bstride+16)*sizeof(*buf));
-    for (y=0; y<r; y++)
-        ctx->blur_line(dc, buf+y*bstride, buf+(y-1)*bstride, src+2*y*sstride, sstride, width/2);
-    for (;;) {
+    memset(buf+((y0-r)/2+r-1)%r*bstride, 0, bstride*sizeof(*buf));
+    for (y=y0-r; y<y0+r; y+=2) {
+        int mod = (y/2)%r;
+        ctx->blur_line(dc, buf+mod*bstride, buf+(mod?mod-1:r-1)*bstride, src+y*sstride, sstride, width/2);
+    }
+    for (y=y0;; y+=2) {
         if (y < height-r) {
             int mod = ((y+r)/2)%r;
             uint16_t *buf0 = buf+mod*bstride;
@@ -254,14 +264,12 @@ static void filter_plane(struct vf_priv_s *ctx, uint8_t *dst, uint8_t *src,
             for (x=-r/2; x<0; x++)
                 dc[x] = dc[0];
         }
-        if (y == r) {
-            for (y=0; y<r; y++)
-                ctx->filter_line(dst+y*dstride, src+y*sstride, dc-r/2, width, thresh, dither[y&7]);
+        if (y == y0) {
+            for (i=first; i<__MIN(y0, end); i++)
+                ctx->filter_line(dst+i*dstride, src+i*sstride, dc-r/2, width, thresh, dither[i&7]);
         }
-        ctx->filter_line(dst+y*dstride, src+y*sstride, dc-r/2, width, thresh, dither[y&7]);
-        if (++y >= height) break;
-        ctx->filter_line(dst+y*dstride, src+y*sstride, dc-r/2, width, thresh, dither[y&7]);
-        if (++y >= height) break;
+        for (i=__MAX(y, first); i<__MIN(y+2, end); i++)
+            ctx->filter_line(dst+i*dstride, src+i*sstride, dc-r/2, width, thresh, dither[i&7]);
+        if (y+2 >= end) break;
     }
 }
-
@@ -37,6 +37,9 @@
 
 #include "hqdn3d.h"
 
+/* Lines run through the vertical low pass ahead of each slice */
+#define SLICE_OVERLAP 16
+
 /*****************************************************************************
  * Local protypes
  *****************************************************************************/
@@ -57,6 +60,10 @@ static int DenoiseCallback( vlc_object_t *p_this, char const *psz_var,
 #define CHROMA_SPAT_TEXT        N_("Spatial chroma strength (0-254)")
 #define LUMA_TEMP_TEXT          N_("Temporal luma strength (0-254)")
 #define CHROMA_TEMP_TEXT        N_("Temporal chroma strength (0-254)")
+#define SLICES_TEXT             N_("Denoise in slices")
+#define SLICES_LONGTEXT         N_("Spread each picture over the video " \
+    "filter slice threads. The vertical denoising restarts at each slice, " \
+    "so the output then depends on the number of threads.")
 
 vlc_module_begin()
     set_shortname(N_("HQ Denoiser 3D"))
@@ -73,6 +80,8 @@ vlc_module_begin()
             LUMA_TEMP_TEXT, LUMA_TEMP_TEXT, false)
     add_float_with_range(FILTER_PREFIX "chroma-temp", 4.5, 0.0, 254.0,
             CHROMA_TEMP_TEXT, CHROMA_TEMP_TEXT, false)
+    add_bool(FILTER_PREFIX "slices", false,
+            SLICES_TEXT, SLICES_LONGTEXT, true)
 
     add_shortcut("hqdn3d")
 
@@ -80,7 +89,7 @@ vlc_module_begin()
 vlc_module_end()
 
 static const char *const filter_options[] = {
-    "luma-spat", "chroma-spat", "luma-temp", "chroma-temp", NULL
+    "luma-spat", "chroma-spat", "luma-temp", "chroma-temp", "slices", NULL
 };
 
 /*****************************************************************************
@@ -89,7 +98,8 @@ static const char *const filter_options[] = {
 struct filter_sys_t
 {
     const vlc_chroma_description_t *chroma;
-    int w[3], h[3];
+    int w[3], h[3], wmax;
+    bool slices;
 
     struct vf_priv_s cfg;
     bool   b_recalc_coefs;
@@ -104,12 +114,10 @@ static int Open(vlc_object_t *this)
 {
     filter_t *filter = (filter_t *)this;
     filter_sys_t *sys;
-    struct vf_priv_s *cfg;
     const video_format_t *fmt_in  = &filter->fmt_in.video;
     const video_format_t *fmt_out = &filter->fmt_out.video;
     const vlc_fourcc_t fourcc_in  = fmt_in->i_chroma;
     const vlc_fourcc_t fourcc_out = fmt_out->i_chroma;
-    int wmax = 0;
 
     const vlc_chroma_description_t *chroma =
             vlc_fourcc_GetChromaDescription(fourcc_in);
@@ -128,25 +136,20 @@ static int Open(vlc_object_t *this)
     if (!sys) {
         return VLC_ENOMEM;
     }
-    cfg = &sys->cfg;
-
     sys->chroma = chroma;
 
     for (int i = 0; i < 3; ++i) {
         sys->w[i] = fmt_in->i_width  * chroma->p[i].w.num / chroma->p[i].w.den;
-        if (sys->w[i] > wmax) wmax = sys->w[i];
+        if (sys->w[i] > sys->wmax) sys->wmax = sys->w[i];
         sys->h[i] = fmt_out->i_height * chroma->p[i].h.num / chroma->p[i].h.den;
     }
-    cfg->Line = malloc(wmax*sizeof(unsigned int));
-    if (!cfg->Line) {
-        free(sys);
-        return VLC_ENOMEM;
-    }
 
     config_ChainParse(filter, FILTER_PREFIX, filter_options,
                       filter->p_cfg);
 
 
+    sys->slices = var_CreateGetBool(filter, FILTER_PREFIX "slices");
+
     vlc_mutex_init( &sys->coefs_mutex );
     sys->b_recalc_coefs = true;
     sys->luma_spat = var_CreateGetFloatCommand(filter, FILTER_PREFIX "luma-spat");
@@ -184,10 +187,44 @@ static void Close(vlc_object_t *this)
     for (int i = 0; i < 3; ++i) {
         free(cfg->Frame[i]);
     }
-    free(cfg->Line);
     free(sys);
 }
 
+/*****************************************************************************
+ * FilterSlice
+ *****************************************************************************/
+static void FilterSlice(filter_t *filter, void *opaque,
+                        const filter_slice_t *slice)
+{
+    filter_sys_t *sys = filter->p_sys;
+    struct vf_priv_s *cfg = &sys->cfg;
+    picture_t **pics = opaque;
+    picture_t *src = pics[0], *dst = pics[1];
+
+    /* The vertical low pass state is private to each slice */
+    unsigned int *line = malloc(sys->wmax * sizeof(*line));
+
+    for (int i = 0; i < 3; ++i) {
+        int *spat = cfg->Coefs[i ? 2 : 0];
+        int *temp = cfg->Coefs[i ? 3 : 1];
+        int first = filter_SliceLine(slice->i_first, sys->h[0], sys->h[i]);
+        int end = filter_SliceLine(slice->i_end, sys->h[0], sys->h[i]);
+
+        if (unlikely(!line)) {
+            for (int y = first; y < end; y++)
+                memcpy(&dst->p[i].p_pixels[y * dst->p[i].i_pitch],
+                       &src->p[i].p_pixels[y * src->p[i].i_pitch], sys->w[i]);
+            continue;
+        }
+        deNoise(src->p[i].p_pixels, dst->p[i].p_pixels,
+                line, cfg->Frame[i], sys->w[i],
+                filter_SliceLine(slice->i_start, sys->h[0], sys->h[i]),
+                first, end, src->p[i].i_pitch, dst->p[i].i_pitch,
+                spat, spat, temp);
+    }
+    free(line);
+}
+
 /*****************************************************************************
  * Filter
  *****************************************************************************/
@@ -220,24 +257,23 @@ static picture_t *Filter(filter_t *filter, picture_t *src)
     }
     vlc_mutex_unlock( &sys->coefs_mutex );
 
-    deNoise(src->p[0].p_pixels, dst->p[0].p_pixels,
-            cfg->Line, &cfg->Frame[0], sys->w[0], sys->h[0],
-            src->p[0].i_pitch, dst->p[0].i_pitch,
-            cfg->Coefs[0],
-            cfg->Coefs[0],
-            cfg->Coefs[1]);
-    deNoise(src->p[1].p_pixels, dst->p[1].p_pixels,
-            cfg->Line, &cfg->Frame[1], sys->w[1], sys->h[1],
-            src->p[1].i_pitch, dst->p[1].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
-    deNoise(src->p[2].p_pixels, dst->p[2].p_pixels,
-            cfg->Line, &cfg->Frame[2], sys->w[2], sys->h[2],
-            src->p[2].i_pitch, dst->p[2].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
+    for (int i = 0; i < 3; ++i) {
+        if (!cfg->Frame[i]) {
+            cfg->Frame[i] = deNoiseFrameAnt(src->p[i].p_pixels, sys->w[i],
+                                            sys->h[i], src->p[i].i_pitch);
+            if (!cfg->Frame[i]) {
+                picture_Release(dst);
+                picture_Release(src);
+                return NULL;
+            }
+        }
+    }
+
+    picture_t *pics[2] = { src, dst };
+    if (sys->slices)
+        filter_Slice(filter, sys->h[0], SLICE_OVERLAP, FilterSlice, pics);
+    else
+        FilterSlice(filter, pics, &(filter_slice_t){ 0, 0, sys->h[0] });
 
     return CopyInfoAndRelease(dst, src);
 }
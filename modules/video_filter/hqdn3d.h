@@ -32,7 +32,6 @@
 
 struct vf_priv_s {
         int Coefs[4][512*16];
-        unsigned int *Line;
         unsigned short *Frame[3];
 };
 
@@ -50,13 +49,16 @@ static void deNoiseTemporal(
                     unsigned char *Frame,        // mpi->planes[x]
                     unsigned char *FrameDest,    // dmpi->planes[x]
                     unsigned short *FrameAnt,
-                    int W, int H, int sStride, int dStride,
+                    int W, int First, int End, int sStride, int dStride,
                     int *Temporal)
 {
     long X, Y;
     unsigned int PixelDst;
 
-    for (Y = 0; Y < H; Y++){
+    Frame += First*sStride;
+    FrameDest += First*dStride;
+    FrameAnt += First*W;
+    for (Y = First; Y < End; Y++){
         for (X = 0; X < W; X++){
             PixelDst = LowPassMul(FrameAnt[X]<<8, Frame[X]<<16, Temporal);
             FrameAnt[X] = ((PixelDst+0x1000007F)>>8);
@@ -68,31 +70,62 @@ static void deNoiseTemporal(
     }
 }
 
+/* Runs the vertical low pass over the lines [Start, First[ without output,
+ * so that a slice starting at First gets a warmed up LineAnt. */
+static void deNoisePrime(
+                    unsigned char *Frame,        // mpi->planes[x]
+                    unsigned int *LineAnt,       // vf->priv->Line (width bytes)
+                    int W, int Start, int First, int sStride,
+                    int *Horizontal, int *Vertical)
+{
+    long X, Y;
+    long sLineOffs = Start*sStride;
+    unsigned int PixelAnt;
+
+    /* First line has no top neighbor, only left. */
+    LineAnt[0] = PixelAnt = Frame[sLineOffs]<<16;
+    for (X = 1; X < W; X++)
+        LineAnt[X] = PixelAnt = LowPassMul(PixelAnt, Frame[sLineOffs+X]<<16, Horizontal);
+
+    for (Y = Start+1; Y < First; Y++){
+        sLineOffs += sStride;
+        PixelAnt = Frame[sLineOffs]<<16;
+        LineAnt[0] = LowPassMul(LineAnt[0], PixelAnt, Vertical);
+        for (X = 1; X < W; X++){
+            PixelAnt = LowPassMul(PixelAnt, Frame[sLineOffs+X]<<16, Horizontal);
+            LineAnt[X] = LowPassMul(LineAnt[X], PixelAnt, Vertical);
+        }
+    }
+}
+
 static void deNoiseSpacial(
                     unsigned char *Frame,        // mpi->planes[x]
                     unsigned char *FrameDest,    // dmpi->planes[x]
                     unsigned int *LineAnt,       // vf->priv->Line (width bytes)
-                    int W, int H, int sStride, int dStride,
+                    int W, int First, int End, int sStride, int dStride,
                     int *Horizontal, int *Vertical)
 {
-    long X, Y;
-    long sLineOffs = 0, dLineOffs = 0;
+    long X, Y = First;
+    long sLineOffs = First*sStride, dLineOffs = First*dStride;
     unsigned int PixelAnt;
     unsigned int PixelDst;
 
-    /* First pixel has no left nor top neighbor. */
-    PixelDst = LineAnt[0] = PixelAnt = Frame[0]<<16;
-    FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
+    if (Y == 0){
+        /* First pixel has no left nor top neighbor. */
+        PixelDst = LineAnt[0] = PixelAnt = Frame[0]<<16;
+        FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
 
-    /* First line has no top neighbor, only left. */
-    for (X = 1; X < W; X++){
-        PixelDst = LineAnt[X] = LowPassMul(PixelAnt, Frame[X]<<16, Horizontal);
-        FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
+        /* First line has no top neighbor, only left. */
+        for (X = 1; X < W; X++){
+            PixelDst = LineAnt[X] = LowPassMul(PixelAnt, Frame[X]<<16, Horizontal);
+            FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
+        }
+        Y++;
+        sLineOffs += sStride, dLineOffs += dStride;
     }
 
-    for (Y = 1; Y < H; Y++){
+    for (; Y < End; Y++){
         unsigned int PixelAnt;
-        sLineOffs += sStride, dLineOffs += dStride;
         /* First pixel on each line doesn't have previous pixel */
         PixelAnt = Frame[sLineOffs]<<16;
         PixelDst = LineAnt[0] = LowPassMul(LineAnt[0], PixelAnt, Vertical);
@@ -105,61 +138,78 @@ static void deNoiseSpacial(
             PixelDst = LineAnt[X] = LowPassMul(LineAnt[X], PixelAnt, Vertical);
             FrameDest[dLineOffs+X]= ((PixelDst+0x10007FFF)>>16);
         }
+        sLineOffs += sStride, dLineOffs += dStride;
+    }
+}
+
+/* Allocates the previous frame from the first one */
+static unsigned short *deNoiseFrameAnt(unsigned char *Frame,
+                                       int W, int H, int sStride)
+{
+    long X, Y;
+    unsigned short* FrameAnt=malloc(W*H*sizeof(unsigned short));
+
+    if(!FrameAnt)
+        return NULL;
+    for (Y = 0; Y < H; Y++){
+        unsigned short* dst=&FrameAnt[Y*W];
+        unsigned char* src=Frame+Y*sStride;
+        for (X = 0; X < W; X++) dst[X]=src[X]<<8;
     }
+    return FrameAnt;
 }
 
+/* Denoises the lines [First, End[ of a plane, the vertical low pass being
+ * primed from the line Start. */
 static void deNoise(unsigned char *Frame,        // mpi->planes[x]
                     unsigned char *FrameDest,    // dmpi->planes[x]
                     unsigned int *LineAnt,      // vf->priv->Line (width bytes)
-                    unsigned short **FrameAntPtr,
-                    int W, int H, int sStride, int dStride,
+                    unsigned short *FrameAnt,
+                    int W, int Start, int First, int End,
+                    int sStride, int dStride,
                     int *Horizontal, int *Vertical, int *Temporal)
 {
-    long X, Y;
-    long sLineOffs = 0, dLineOffs = 0;
+    long X, Y = First;
+    long sLineOffs = First*sStride, dLineOffs = First*dStride;
     unsigned int PixelAnt;
     unsigned int PixelDst;
-    unsigned short* FrameAnt=(*FrameAntPtr);
-
-    if(!FrameAnt){
-        (*FrameAntPtr)=FrameAnt=malloc(W*H*sizeof(unsigned short));
-        for (Y = 0; Y < H; Y++){
-            unsigned short* dst=&FrameAnt[Y*W];
-            unsigned char* src=Frame+Y*sStride;
-            for (X = 0; X < W; X++) dst[X]=src[X]<<8;
-        }
-    }
 
     if(!Horizontal[0] && !Vertical[0]){
         deNoiseTemporal(Frame, FrameDest, FrameAnt,
-                        W, H, sStride, dStride, Temporal);
+                        W, First, End, sStride, dStride, Temporal);
         return;
     }
+    if (First > 0)
+        deNoisePrime(Frame, LineAnt, W, __MIN(Start, First-1), First,
+                     sStride, Horizontal, Vertical);
     if(!Temporal[0]){
         deNoiseSpacial(Frame, FrameDest, LineAnt,
-                       W, H, sStride, dStride, Horizontal, Vertical);
+                       W, First, End, sStride, dStride, Horizontal, Vertical);
         return;
     }
 
-    /* First pixel has no left nor top neighbor. Only previous frame */
-    LineAnt[0] = PixelAnt = Frame[0]<<16;
-    PixelDst = LowPassMul(FrameAnt[0]<<8, PixelAnt, Temporal);
-    FrameAnt[0] = ((PixelDst+0x1000007F)>>8);
-    FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
-
-    /* First line has no top neighbor. Only left one for each pixel and
-     * last frame */
-    for (X = 1; X < W; X++){
-        LineAnt[X] = PixelAnt = LowPassMul(PixelAnt, Frame[X]<<16, Horizontal);
-        PixelDst = LowPassMul(FrameAnt[X]<<8, PixelAnt, Temporal);
-        FrameAnt[X] = ((PixelDst+0x1000007F)>>8);
-        FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
+    if (Y == 0){
+        /* First pixel has no left nor top neighbor. Only previous frame */
+        LineAnt[0] = PixelAnt = Frame[0]<<16;
+        PixelDst = LowPassMul(FrameAnt[0]<<8, PixelAnt, Temporal);
+        FrameAnt[0] = ((PixelDst+0x1000007F)>>8);
+        FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
+
+        /* First line has no top neighbor. Only left one for each pixel and
+         * last frame */
+        for (X = 1; X < W; X++){
+            LineAnt[X] = PixelAnt = LowPassMul(PixelAnt, Frame[X]<<16, Horizontal);
+            PixelDst = LowPassMul(FrameAnt[X]<<8, PixelAnt, Temporal);
+            FrameAnt[X] = ((PixelDst+0x1000007F)>>8);
+            FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
+        }
+        Y++;
+        sLineOffs += sStride, dLineOffs += dStride;
     }
 
-    for (Y = 1; Y < H; Y++){
+    for (; Y < End; Y++){
         unsigned int PixelAnt;
         unsigned short* LinePrev=&FrameAnt[Y*W];
-        sLineOffs += sStride, dLineOffs += dStride;
         /* First pixel on each line doesn't have previous pixel */
         PixelAnt = Frame[sLineOffs]<<16;
         LineAnt[0] = LowPassMul(LineAnt[0], PixelAnt, Vertical);
@@ -176,6 +226,7 @@ static void deNoise(unsigned char *Frame,        // mpi->planes[x]
             LinePrev[X] = ((PixelDst+0x1000007F)>>8);
             FrameDest[dLineOffs+X]= ((PixelDst+0x10007FFF)>>16);
         }
+        sLineOffs += sStride, dLineOffs += dStride;
     }
 }
 
@@ -0,0 +1,301 @@
+/*****************************************************************************
+ * scaler.c : bilinear and bicubic video scaling filter
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <limits.h>
+#include <math.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_filter.h>
+#include <vlc_cpu.h>
+
+#include "scaler_kernels.h"
+
+/****************************************************************************
+ * Local prototypes
+ ****************************************************************************/
+static int  OpenFilter ( vlc_object_t * );
+static void CloseFilter( vlc_object_t * );
+static picture_t *Filter( filter_t *, picture_t * );
+
+/*****************************************************************************
+ * Module descriptor
+ *****************************************************************************/
+#define MODE_TEXT N_("Scaling mode")
+#define MODE_LONGTEXT N_("Interpolation used to scale the pictures.")
+
+static const int pi_mode_values[] = { 0, 1 };
+static const char *const ppsz_mode_descriptions[] = {
+    N_("Bilinear"), N_("Bicubic") };
+
+#define CFG_PREFIX "scaler-"
+
+/* Above swscale: it only takes same chroma scaling, which it does with
+ * no setup cost, and it can spread the lines over the slice threads */
+vlc_module_begin ()
+    set_description( N_("Bilinear and bicubic video scaling filter") )
+    set_shortname( N_("Scaler") )
+    set_category( CAT_VIDEO )
+    set_subcategory( SUBCAT_VIDEO_VFILTER )
+    set_capability( "video filter2", 160 )
+    add_integer( CFG_PREFIX "mode", 1, MODE_TEXT, MODE_LONGTEXT, true )
+        change_integer_list( pi_mode_values, ppsz_mode_descriptions )
+    set_callbacks( OpenFilter, CloseFilter )
+vlc_module_end ()
+
+/*****************************************************************************
+ * filter_sys_t
+ *****************************************************************************/
+struct filter_sys_t
+{
+    int i_mode;
+    bool b_packed;
+    scaler_table_t h[PICTURE_PLANE_MAX];
+    scaler_table_t v[PICTURE_PLANE_MAX];
+
+    scaler_hscale_t pf_hscale;
+    scaler_vscale_t pf_vscale;
+};
+
+static bool IsSupported( vlc_fourcc_t i_chroma, bool *pb_packed )
+{
+    static const vlc_fourcc_t p_planar[] = {
+        VLC_CODEC_I420, VLC_CODEC_J420, VLC_CODEC_YV12,
+        VLC_CODEC_I422, VLC_CODEC_J422, VLC_CODEC_I444, VLC_CODEC_J444,
+        VLC_CODEC_I411, VLC_CODEC_I410, VLC_CODEC_YUVA, VLC_CODEC_GREY,
+    };
+    static const vlc_fourcc_t p_packed[] = {
+        VLC_CODEC_RGB32, VLC_CODEC_RGBA, VLC_CODEC_ARGB,
+    };
+
+    for( size_t i = 0; i < ARRAY_SIZE(p_planar); i++ )
+        if( p_planar[i] == i_chroma )
+        {
+            *pb_packed = false;
+            return true;
+        }
+    for( size_t i = 0; i < ARRAY_SIZE(p_packed); i++ )
+        if( p_packed[i] == i_chroma )
+        {
+            *pb_packed = true;
+            return true;
+        }
+    return false;
+}
+
+/*****************************************************************************
+ * OpenFilter: probe the filter and return score
+ *****************************************************************************/
+static int OpenFilter( vlc_object_t *p_this )
+{
+    filter_t *p_filter = (filter_t*)p_this;
+    filter_sys_t *p_sys;
+    bool b_packed;
+
+    if( !IsSupported( p_filter->fmt_in.video.i_chroma, &b_packed ) ||
+        p_filter->fmt_in.video.i_chroma != p_filter->fmt_out.video.i_chroma )
+        return VLC_EGENERIC;
+
+    if( p_filter->fmt_in.video.orientation != p_filter->fmt_out.video.orientation )
+        return VLC_EGENERIC;
+
+    p_sys = calloc( 1, sizeof(*p_sys) );
+    if( unlikely(p_sys == NULL) )
+        return VLC_ENOMEM;
+
+    p_sys->i_mode = var_InheritInteger( p_filter, CFG_PREFIX "mode" )
+                  ? SCALER_BICUBIC : SCALER_BILINEAR;
+    p_sys->b_packed = b_packed;
+    p_sys->pf_hscale = b_packed ? HScalePackedC : HScalePlanarC;
+    p_sys->pf_vscale = VScaleC;
+#if defined(SCALER_SSE2)
+    if( vlc_CPU_SSE2() )
+    {
+        p_sys->pf_hscale = b_packed ? HScalePackedSSE2 : HScalePlanarSSE2;
+        p_sys->pf_vscale = VScaleSSE2;
+    }
+#elif defined(SCALER_NEON)
+    p_sys->pf_hscale = b_packed ? HScalePackedNEON : HScalePlanarNEON;
+    p_sys->pf_vscale = VScaleNEON;
+#endif
+
+    video_format_ScaleCropAr( &p_filter->fmt_out.video, &p_filter->fmt_in.video );
+    p_filter->pf_video_filter = Filter;
+    p_filter->p_sys = p_sys;
+
+    msg_Dbg( p_filter, "%ix%i -> %ix%i (%s)", p_filter->fmt_in.video.i_width,
+             p_filter->fmt_in.video.i_height, p_filter->fmt_out.video.i_width,
+             p_filter->fmt_out.video.i_height,
+             p_sys->i_mode == SCALER_BICUBIC ? "bicubic" : "bilinear" );
+
+    return VLC_SUCCESS;
+}
+
+static void CloseFilter( vlc_object_t *p_this )
+{
+    filter_t *p_filter = (filter_t*)p_this;
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    for( unsigned i = 0; i < PICTURE_PLANE_MAX; i++ )
+    {
+        TableClean( &p_sys->h[i] );
+        TableClean( &p_sys->v[i] );
+    }
+    free( p_sys );
+}
+
+/****************************************************************************
+ * Filter: the whole thing
+ ****************************************************************************/
+typedef struct
+{
+    picture_t *p_src;
+    picture_t *p_dst;
+    unsigned   i_lines; /**< Destination lines of the first plane */
+} scaler_slice_t;
+
+/* Scales the destination lines [i_first, i_end[ of a plane, keeping the
+ * horizontally scaled source lines in a ring of the vertical taps size */
+static void ScalePlane( filter_sys_t *p_sys, const plane_t *p_src,
+                        plane_t *p_dst, const scaler_table_t *p_h,
+                        const scaler_table_t *p_v,
+                        unsigned i_first, unsigned i_end )
+{
+    const unsigned i_taps = p_v->i_taps;
+    const unsigned i_width = p_h->i_dst * (p_sys->b_packed ? 4 : 1);
+    const size_t i_stride = (i_width + 15) & ~15;
+    int16_t *p_ring = vlc_memalign( 16, i_taps * i_stride * sizeof(*p_ring) );
+    unsigned pi_row[i_taps];
+    const int16_t *pp_lines[i_taps];
+
+    if( unlikely(p_ring == NULL) )
+        return;
+    for( unsigned k = 0; k < i_taps; k++ )
+        pi_row[k] = UINT_MAX;
+
+    for( unsigned y = i_first; y < i_end; y++ )
+    {
+        for( unsigned k = 0; k < i_taps; k++ )
+        {
+            const unsigned i_row = p_v->pi_pos[y] + k;
+            int16_t *p_line = &p_ring[(i_row % i_taps) * i_stride];
+
+            if( pi_row[i_row % i_taps] != i_row )
+            {
+                p_sys->pf_hscale( p_line,
+                                  &p_src->p_pixels[i_row * p_src->i_pitch],
+                                  p_h );
+                pi_row[i_row % i_taps] = i_row;
+            }
+            pp_lines[k] = p_line;
+        }
+        p_sys->pf_vscale( &p_dst->p_pixels[y * p_dst->i_pitch], pp_lines,
+                          &p_v->pi_coefs[y * i_taps], i_taps, i_width );
+    }
+    vlc_free( p_ring );
+}
+
+static void FilterSlice( filter_t *p_filter, void *opaque,
+                         const filter_slice_t *p_slice )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    scaler_slice_t *p_ctx = opaque;
+
+    for( int i = 0; i < p_ctx->p_dst->i_planes; i++ )
+    {
+        const scaler_table_t *p_v = &p_sys->v[i];
+
+        ScalePlane( p_sys, &p_ctx->p_src->p[i], &p_ctx->p_dst->p[i],
+                    &p_sys->h[i], p_v,
+                    filter_SliceLine( p_slice->i_first, p_ctx->i_lines,
+                                      p_v->i_dst ),
+                    filter_SliceLine( p_slice->i_end, p_ctx->i_lines,
+                                      p_v->i_dst ) );
+    }
+}
+
+static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    picture_t *p_pic_dst;
+
+    if( !p_pic ) return NULL;
+
+    const video_format_t *p_fmt_in = &p_filter->fmt_in.video;
+    const video_format_t *p_fmt_out = &p_filter->fmt_out.video;
+    if( p_fmt_in->i_width == 0 || p_fmt_in->i_height == 0 ||
+        p_fmt_out->i_width == 0 || p_fmt_out->i_height == 0 )
+    {
+        picture_Release( p_pic );
+        return NULL;
+    }
+
+    video_format_ScaleCropAr( &p_filter->fmt_out.video, &p_filter->fmt_in.video );
+
+    /* The sizes can change from a picture to the next, for the subpictures */
+    const vlc_chroma_description_t *p_dsc =
+        vlc_fourcc_GetChromaDescription( p_fmt_in->i_chroma );
+    assert( p_dsc != NULL );
+    for( unsigned i = 0; i < p_dsc->plane_count; i++ )
+    {
+        const unsigned i_src_w = __MAX( p_fmt_in->i_width * p_dsc->p[i].w.num
+                                        / p_dsc->p[i].w.den, 1 );
+        const unsigned i_src_h = __MAX( p_fmt_in->i_height * p_dsc->p[i].h.num
+                                        / p_dsc->p[i].h.den, 1 );
+        const unsigned i_dst_w = __MAX( p_fmt_out->i_width * p_dsc->p[i].w.num
+                                        / p_dsc->p[i].w.den, 1 );
+        const unsigned i_dst_h = __MAX( p_fmt_out->i_height * p_dsc->p[i].h.num
+                                        / p_dsc->p[i].h.den, 1 );
+
+        if( TableInit( &p_sys->h[i], p_sys->i_mode, i_src_w, i_dst_w ) ||
+            TableInit( &p_sys->v[i], p_sys->i_mode, i_src_h, i_dst_h ) )
+        {
+            picture_Release( p_pic );
+            return NULL;
+        }
+    }
+
+    /* Request output picture */
+    p_pic_dst = filter_NewPicture( p_filter );
+    if( !p_pic_dst )
+    {
+        picture_Release( p_pic );
+        return NULL;
+    }
+
+    scaler_slice_t ctx = {
+        .p_src = p_pic,
+        .p_dst = p_pic_dst,
+        .i_lines = p_sys->v[0].i_dst,
+    };
+    filter_Slice( p_filter, ctx.i_lines, 0, FilterSlice, &ctx );
+
+    picture_CopyProperties( p_pic_dst, p_pic );
+    picture_Release( p_pic );
+    return p_pic_dst;
+}
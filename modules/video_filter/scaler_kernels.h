@@ -0,0 +1,487 @@
+/*****************************************************************************
+ * scaler_kernels.h: coefficient tables and line kernels of the scaler
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_SCALER_KERNELS_H_
+#define VLC_SCALER_KERNELS_H_
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#if defined(HAVE_SSE2_INTRINSICS) && (defined(__i386__) || defined(__x86_64__))
+# include <emmintrin.h>
+# define SCALER_SSE2
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+# include <arm_neon.h>
+# define SCALER_NEON
+#endif
+
+/*****************************************************************************
+ * Coefficient tables
+ *****************************************************************************/
+#define COEF_BITS  14 /* Coefficients precision */
+#define INTER_BITS 6  /* Fractional bits of the horizontally scaled lines */
+
+enum { SCALER_BILINEAR, SCALER_BICUBIC };
+
+/**
+ * Each destination sample is the weighted sum of i_taps consecutive source
+ * samples, starting at pi_pos. The windows never go past the source edges:
+ * the weights of the samples beyond are folded onto the edge samples.
+ */
+typedef struct
+{
+    unsigned i_src, i_dst; /**< Sizes the table was computed for */
+    unsigned i_taps;       /**< Multiple of 4, unless the source is smaller */
+    unsigned *pi_pos;
+    int16_t  *pi_coefs;    /**< i_taps per destination sample, summing to
+                                1 << COEF_BITS */
+} scaler_table_t;
+
+static double Kernel( int i_mode, double x )
+{
+    x = fabs( x );
+    if( i_mode == SCALER_BILINEAR )
+        return x < 1. ? 1. - x : 0.;
+
+    /* Catmull-Rom spline */
+    if( x < 1. )
+        return (1.5 * x - 2.5) * x * x + 1.;
+    if( x < 2. )
+        return ((-0.5 * x + 2.5) * x - 4.) * x + 2.;
+    return 0.;
+}
+
+static void TableClean( scaler_table_t *p_table )
+{
+    free( p_table->pi_pos );
+    free( p_table->pi_coefs );
+    p_table->pi_pos = NULL;
+    p_table->pi_coefs = NULL;
+    p_table->i_src = p_table->i_dst = 0;
+}
+
+static int TableInit( scaler_table_t *p_table, int i_mode,
+                      unsigned i_src, unsigned i_dst )
+{
+    if( p_table->i_src == i_src && p_table->i_dst == i_dst )
+        return VLC_SUCCESS;
+    TableClean( p_table );
+
+    /* When downscaling, the kernel is stretched over the source samples */
+    const double f_scale = (double)i_src / i_dst;
+    const double f_stretch = f_scale > 1. ? f_scale : 1.;
+    const double f_radius = (i_mode == SCALER_BICUBIC ? 2. : 1.) * f_stretch;
+    const unsigned i_reach = ceil( f_radius );
+    unsigned i_taps = (2 * i_reach + 3) & ~3;
+
+    if( i_taps > i_src )
+        i_taps = i_src;
+
+    p_table->pi_pos = malloc( i_dst * sizeof(*p_table->pi_pos) );
+    p_table->pi_coefs = malloc( i_dst * i_taps * sizeof(*p_table->pi_coefs) );
+    if( unlikely(p_table->pi_pos == NULL || p_table->pi_coefs == NULL) )
+    {
+        TableClean( p_table );
+        return VLC_ENOMEM;
+    }
+
+    for( unsigned i = 0; i < i_dst; i++ )
+    {
+        const double f_center = (i + .5) * f_scale - .5;
+        const int i_first = floor( f_center - f_radius ) + 1;
+        const int i_last = floor( f_center + f_radius );
+        const int i_pos = VLC_CLIP( i_first, 0, (int)(i_src - i_taps) );
+        int16_t *pi_coefs = &p_table->pi_coefs[i * i_taps];
+        double pf_weights[i_taps];
+        double f_sum = 0.;
+
+        for( unsigned k = 0; k < i_taps; k++ )
+            pf_weights[k] = 0.;
+        for( int j = i_first; j <= i_last; j++ )
+        {
+            double f_weight = Kernel( i_mode, (j - f_center) / f_stretch );
+
+            pf_weights[VLC_CLIP( j, 0, (int)i_src - 1 ) - i_pos] += f_weight;
+            f_sum += f_weight;
+        }
+
+        /* Normalize exactly, so that flat areas stay flat */
+        int i_sum = 0;
+        unsigned i_max = 0;
+        for( unsigned k = 0; k < i_taps; k++ )
+        {
+            pi_coefs[k] = lrint( pf_weights[k] / f_sum * (1 << COEF_BITS) );
+            i_sum += pi_coefs[k];
+            if( pi_coefs[k] > pi_coefs[i_max] )
+                i_max = k;
+        }
+        pi_coefs[i_max] += (1 << COEF_BITS) - i_sum;
+        p_table->pi_pos[i] = i_pos;
+    }
+
+    p_table->i_src = i_src;
+    p_table->i_dst = i_dst;
+    p_table->i_taps = i_taps;
+    return VLC_SUCCESS;
+}
+
+/*****************************************************************************
+ * Line kernels
+ *****************************************************************************
+ * The horizontal pass scales a source line to 16 bits samples with
+ * INTER_BITS fractional bits, and the vertical pass sums the scaled lines
+ * into the destination. The vector versions give the same results.
+ *****************************************************************************/
+typedef void (*scaler_hscale_t)( int16_t *, const uint8_t *,
+                                 const scaler_table_t * );
+typedef void (*scaler_vscale_t)( uint8_t *, const int16_t *const *,
+                                 const int16_t *, unsigned, unsigned );
+
+#define HSCALE_ROUND (1 << (COEF_BITS - INTER_BITS - 1))
+#define VSCALE_SHIFT (COEF_BITS + INTER_BITS)
+#define VSCALE_ROUND (1 << (VSCALE_SHIFT - 1))
+
+static void HScalePlanarC( int16_t *p_dst, const uint8_t *p_src,
+                           const scaler_table_t *p_table )
+{
+    const unsigned i_taps = p_table->i_taps;
+
+    for( unsigned i = 0; i < p_table->i_dst; i++ )
+    {
+        const uint8_t *p = &p_src[p_table->pi_pos[i]];
+        const int16_t *pi_coefs = &p_table->pi_coefs[i * i_taps];
+        int i_sum = HSCALE_ROUND;
+
+        for( unsigned k = 0; k < i_taps; k++ )
+            i_sum += pi_coefs[k] * p[k];
+        p_dst[i] = i_sum >> (COEF_BITS - INTER_BITS);
+    }
+}
+
+/* 4 bytes per pixel, each byte being scaled on its own */
+static void HScalePackedC( int16_t *p_dst, const uint8_t *p_src,
+                           const scaler_table_t *p_table )
+{
+    const unsigned i_taps = p_table->i_taps;
+
+    for( unsigned i = 0; i < p_table->i_dst; i++ )
+    {
+        const uint8_t *p = &p_src[4 * p_table->pi_pos[i]];
+        const int16_t *pi_coefs = &p_table->pi_coefs[i * i_taps];
+
+        for( unsigned c = 0; c < 4; c++ )
+        {
+            int i_sum = HSCALE_ROUND;
+
+            for( unsigned k = 0; k < i_taps; k++ )
+                i_sum += pi_coefs[k] * p[4 * k + c];
+            p_dst[4 * i + c] = i_sum >> (COEF_BITS - INTER_BITS);
+        }
+    }
+}
+
+static void VScaleC( uint8_t *p_dst, const int16_t *const *pp_lines,
+                     const int16_t *pi_coefs, unsigned i_taps,
+                     unsigned i_width )
+{
+    for( unsigned i = 0; i < i_width; i++ )
+    {
+        int i_sum = VSCALE_ROUND;
+
+        for( unsigned k = 0; k < i_taps; k++ )
+            i_sum += pi_coefs[k] * pp_lines[k][i];
+        p_dst[i] = VLC_CLIP( i_sum >> VSCALE_SHIFT, 0, 255 );
+    }
+}
+
+#ifdef SCALER_SSE2
+/* Sums the 2 halves of each 64 bits of a and b: a0+a1, a2+a3, b0+b1, b2+b3 */
+VLC_SSE2
+static inline __m128i HAdd32SSE2( __m128i a, __m128i b )
+{
+    __m128 fa = _mm_castsi128_ps( a ), fb = _mm_castsi128_ps( b );
+
+    return _mm_add_epi32(
+        _mm_castps_si128( _mm_shuffle_ps( fa, fb, _MM_SHUFFLE(2, 0, 2, 0) ) ),
+        _mm_castps_si128( _mm_shuffle_ps( fa, fb, _MM_SHUFFLE(3, 1, 3, 1) ) ) );
+}
+
+VLC_SSE2
+static inline __m128i Load4SSE2( const uint8_t *p )
+{
+    uint32_t i_value;
+
+    memcpy( &i_value, p, 4 );
+    return _mm_cvtsi32_si128( i_value );
+}
+
+/* 4 destination samples at a time, 4 taps at a time, with pmaddwd */
+VLC_SSE2
+static void HScalePlanarSSE2( int16_t *p_dst, const uint8_t *p_src,
+                              const scaler_table_t *p_table )
+{
+    const unsigned i_taps = p_table->i_taps;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32( HSCALE_ROUND );
+    unsigned i = 0;
+
+    if( i_taps % 4 )
+    {
+        HScalePlanarC( p_dst, p_src, p_table );
+        return;
+    }
+
+    for( ; i + 4 <= p_table->i_dst; i += 4 )
+    {
+        const unsigned *pi_pos = &p_table->pi_pos[i];
+        const int16_t *pi_coefs = &p_table->pi_coefs[i * i_taps];
+        __m128i sum01 = zero, sum23 = zero;
+
+        for( unsigned k = 0; k < i_taps; k += 4 )
+        {
+#define TAPS(a, b) \
+            _mm_madd_epi16( \
+                _mm_unpacklo_epi8( _mm_unpacklo_epi32( \
+                    Load4SSE2( &p_src[pi_pos[a] + k] ), \
+                    Load4SSE2( &p_src[pi_pos[b] + k] ) ), zero ), \
+                _mm_unpacklo_epi64( \
+                    _mm_loadl_epi64( (const __m128i *)&pi_coefs[a * i_taps + k] ), \
+                    _mm_loadl_epi64( (const __m128i *)&pi_coefs[b * i_taps + k] ) ) )
+            sum01 = _mm_add_epi32( sum01, TAPS(0, 1) );
+            sum23 = _mm_add_epi32( sum23, TAPS(2, 3) );
+#undef TAPS
+        }
+
+        __m128i sum = _mm_add_epi32( HAdd32SSE2( sum01, sum23 ), round );
+        sum = _mm_srai_epi32( sum, COEF_BITS - INTER_BITS );
+        _mm_storel_epi64( (__m128i *)&p_dst[i], _mm_packs_epi32( sum, sum ) );
+    }
+
+    for( ; i < p_table->i_dst; i++ )
+    {
+        const uint8_t *p = &p_src[p_table->pi_pos[i]];
+        const int16_t *pi_coefs = &p_table->pi_coefs[i * i_taps];
+        int i_sum = HSCALE_ROUND;
+
+        for( unsigned k = 0; k < i_taps; k++ )
+            i_sum += pi_coefs[k] * p[k];
+        p_dst[i] = i_sum >> (COEF_BITS - INTER_BITS);
+    }
+}
+
+/* 1 destination pixel at a time, 2 taps at a time: the bytes of 2 source
+ * pixels are interleaved so that pmaddwd gives the 4 partial sums */
+VLC_SSE2
+static void HScalePackedSSE2( int16_t *p_dst, const uint8_t *p_src,
+                              const scaler_table_t *p_table )
+{
+    const unsigned i_taps = p_table->i_taps;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32( HSCALE_ROUND );
+
+    if( i_taps % 2 )
+    {
+        HScalePackedC( p_dst, p_src, p_table );
+        return;
+    }
+
+    for( unsigned i = 0; i < p_table->i_dst; i++ )
+    {
+        const uint8_t *p = &p_src[4 * p_table->pi_pos[i]];
+        const int16_t *pi_coefs = &p_table->pi_coefs[i * i_taps];
+        __m128i sum = round;
+
+        for( unsigned k = 0; k < i_taps; k += 2 )
+        {
+            __m128i px = _mm_unpacklo_epi8(
+                _mm_loadl_epi64( (const __m128i *)&p[4 * k] ), zero );
+            px = _mm_unpacklo_epi16( px, _mm_srli_si128( px, 8 ) );
+            __m128i coefs = _mm_set1_epi32( (uint16_t)pi_coefs[k]
+                                          | ((uint32_t)pi_coefs[k + 1] << 16) );
+            sum = _mm_add_epi32( sum, _mm_madd_epi16( px, coefs ) );
+        }
+        sum = _mm_srai_epi32( sum, COEF_BITS - INTER_BITS );
+        _mm_storel_epi64( (__m128i *)&p_dst[4 * i],
+                          _mm_packs_epi32( sum, sum ) );
+    }
+}
+
+/* 8 destination samples at a time, 2 lines at a time with pmaddwd */
+VLC_SSE2
+static void VScaleSSE2( uint8_t *p_dst, const int16_t *const *pp_lines,
+                        const int16_t *pi_coefs, unsigned i_taps,
+                        unsigned i_width )
+{
+    const __m128i round = _mm_set1_epi32( VSCALE_ROUND );
+    unsigned i = 0;
+
+    for( ; i + 8 <= i_width; i += 8 )
+    {
+        __m128i lo = round, hi = round;
+
+        for( unsigned k = 0; k < i_taps; k += 2 )
+        {
+            /* An odd last line is paired with a null coefficient */
+            const unsigned k1 = k + 1 < i_taps ? k + 1 : k;
+            const int16_t i_coef1 = k + 1 < i_taps ? pi_coefs[k + 1] : 0;
+            __m128i a = _mm_loadu_si128( (const __m128i *)&pp_lines[k][i] );
+            __m128i b = _mm_loadu_si128( (const __m128i *)&pp_lines[k1][i] );
+            __m128i coefs = _mm_set1_epi32( (uint16_t)pi_coefs[k]
+                                          | ((uint32_t)i_coef1 << 16) );
+
+            lo = _mm_add_epi32( lo, _mm_madd_epi16( _mm_unpacklo_epi16( a, b ),
+                                                    coefs ) );
+            hi = _mm_add_epi32( hi, _mm_madd_epi16( _mm_unpackhi_epi16( a, b ),
+                                                    coefs ) );
+        }
+        lo = _mm_srai_epi32( lo, VSCALE_SHIFT );
+        hi = _mm_srai_epi32( hi, VSCALE_SHIFT );
+        __m128i v = _mm_packs_epi32( lo, hi );
+        _mm_storel_epi64( (__m128i *)&p_dst[i], _mm_packus_epi16( v, v ) );
+    }
+
+    if( i < i_width )
+    {
+        const int16_t *pp_tail[i_taps];
+
+        for( unsigned k = 0; k < i_taps; k++ )
+            pp_tail[k] = &pp_lines[k][i];
+        VScaleC( &p_dst[i], pp_tail, pi_coefs, i_taps, i_width - i );
+    }
+}
+#endif
+
+#ifdef SCALER_NEON
+static inline int32x2_t HAdd32NEON( int32x4_t a, int32x4_t b )
+{
+    return vpadd_s32( vpadd_s32( vget_low_s32( a ), vget_high_s32( a ) ),
+                      vpadd_s32( vget_low_s32( b ), vget_high_s32( b ) ) );
+}
+
+static inline int16x4_t Load4NEON( const uint8_t *p )
+{
+    uint32_t i_value;
+
+    memcpy( &i_value, p, 4 );
+    return vget_low_s16( vreinterpretq_s16_u16(
+                vmovl_u8( vreinterpret_u8_u32( vdup_n_u32( i_value ) ) ) ) );
+}
+
+static void HScalePlanarNEON( int16_t *p_dst, const uint8_t *p_src,
+                              const scaler_table_t *p_table )
+{
+    const unsigned i_taps = p_table->i_taps;
+    unsigned i = 0;
+
+    if( i_taps % 4 )
+    {
+        HScalePlanarC( p_dst, p_src, p_table );
+        return;
+    }
+
+    for( ; i + 4 <= p_table->i_dst; i += 4 )
+    {
+        const unsigned *pi_pos = &p_table->pi_pos[i];
+        const int16_t *pi_coefs = &p_table->pi_coefs[i * i_taps];
+        int32x4_t sum[4];
+
+        for( unsigned j = 0; j < 4; j++ )
+        {
+            sum[j] = vdupq_n_s32( 0 );
+            for( unsigned k = 0; k < i_taps; k += 4 )
+                sum[j] = vmlal_s16( sum[j], Load4NEON( &p_src[pi_pos[j] + k] ),
+                                    vld1_s16( &pi_coefs[j * i_taps + k] ) );
+        }
+
+        int32x4_t v = vcombine_s32( HAdd32NEON( sum[0], sum[1] ),
+                                    HAdd32NEON( sum[2], sum[3] ) );
+        vst1_s16( &p_dst[i], vmovn_s32( vrshrq_n_s32( v, COEF_BITS - INTER_BITS ) ) );
+    }
+
+    for( ; i < p_table->i_dst; i++ )
+    {
+        const uint8_t *p = &p_src[p_table->pi_pos[i]];
+        const int16_t *pi_coefs = &p_table->pi_coefs[i * i_taps];
+        int i_sum = HSCALE_ROUND;
+
+        for( unsigned k = 0; k < i_taps; k++ )
+            i_sum += pi_coefs[k] * p[k];
+        p_dst[i] = i_sum >> (COEF_BITS - INTER_BITS);
+    }
+}
+
+static void HScalePackedNEON( int16_t *p_dst, const uint8_t *p_src,
+                              const scaler_table_t *p_table )
+{
+    const unsigned i_taps = p_table->i_taps;
+
+    for( unsigned i = 0; i < p_table->i_dst; i++ )
+    {
+        const uint8_t *p = &p_src[4 * p_table->pi_pos[i]];
+        const int16_t *pi_coefs = &p_table->pi_coefs[i * i_taps];
+        int32x4_t sum = vdupq_n_s32( 0 );
+
+        for( unsigned k = 0; k < i_taps; k++ )
+            sum = vmlal_n_s16( sum, Load4NEON( &p[4 * k] ), pi_coefs[k] );
+        vst1_s16( &p_dst[4 * i],
+                  vmovn_s32( vrshrq_n_s32( sum, COEF_BITS - INTER_BITS ) ) );
+    }
+}
+
+static void VScaleNEON( uint8_t *p_dst, const int16_t *const *pp_lines,
+                        const int16_t *pi_coefs, unsigned i_taps,
+                        unsigned i_width )
+{
+    unsigned i = 0;
+
+    for( ; i + 8 <= i_width; i += 8 )
+    {
+        int32x4_t lo = vdupq_n_s32( 0 ), hi = vdupq_n_s32( 0 );
+
+        for( unsigned k = 0; k < i_taps; k++ )
+        {
+            int16x8_t v = vld1q_s16( &pp_lines[k][i] );
+
+            lo = vmlal_n_s16( lo, vget_low_s16( v ), pi_coefs[k] );
+            hi = vmlal_n_s16( hi, vget_high_s16( v ), pi_coefs[k] );
+        }
+        int16x8_t v = vcombine_s16( vqmovn_s32( vrshrq_n_s32( lo, VSCALE_SHIFT ) ),
+                                    vqmovn_s32( vrshrq_n_s32( hi, VSCALE_SHIFT ) ) );
+        vst1_u8( &p_dst[i], vqmovun_s16( v ) );
+    }
+
+    if( i < i_width )
+    {
+        const int16_t *pp_tail[i_taps];
+
+        for( unsigned k = 0; k < i_taps; k++ )
+            pp_tail[k] = &pp_lines[k][i];
+        VScaleC( &p_dst[i], pp_tail, pi_coefs, i_taps, i_width - i );
+    }
+}
+#endif
+
+#endif
@@ -161,42 +161,25 @@ static void Destroy( vlc_object_t *p_this )
 }
 
 /*****************************************************************************
- * Render: displays previously rendered output
- *****************************************************************************
- * This function send the currently rendered image to Invert image, waits
- * until it is displayed and switch the two rendering buffers, preparing next
- * frame.
+ * SharpenSlice: sharpens a band of the Y plane
  *****************************************************************************/
-static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+static void SharpenSlice( filter_t *p_filter, void *opaque,
+                          const filter_slice_t *p_slice )
 {
-    picture_t *p_outpic;
+    picture_t **pp_pics = opaque;
+    const picture_t *p_pic = pp_pics[0];
+    picture_t *p_outpic = pp_pics[1];
     int i, j;
-    uint8_t *p_src = NULL;
-    uint8_t *p_out = NULL;
-    int i_src_pitch;
-    int i_out_pitch;
+    const uint8_t *p_src = p_pic->p[Y_PLANE].p_pixels;
+    uint8_t *p_out = p_outpic->p[Y_PLANE].p_pixels;
+    const int i_src_pitch = p_pic->p[Y_PLANE].i_pitch;
+    const int i_out_pitch = p_outpic->p[Y_PLANE].i_pitch;
     int pix;
     const int v1 = -1;
     const int v2 = 3; /* 2^3 = 8 */
 
-    if( !p_pic ) return NULL;
-
-    p_outpic = filter_NewPicture( p_filter );
-    if( !p_outpic )
-    {
-        picture_Release( p_pic );
-        return NULL;
-    }
-
-    /* process the Y plane */
-    p_src = p_pic->p[Y_PLANE].p_pixels;
-    p_out = p_outpic->p[Y_PLANE].p_pixels;
-    i_src_pitch = p_pic->p[Y_PLANE].i_pitch;
-    i_out_pitch = p_outpic->p[Y_PLANE].i_pitch;
-
     /* perform convolution only on Y plane. Avoid border line. */
-    vlc_mutex_lock( &p_filter->p_sys->lock );
-    for( i = 0; i < p_pic->p[Y_PLANE].i_visible_lines; i++ )
+    for( i = p_slice->i_first; i < (int)p_slice->i_end; i++ )
     {
         if( (i == 0) || (i == p_pic->p[Y_PLANE].i_visible_lines - 1) )
         {
@@ -227,6 +210,34 @@ static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
                p_filter->p_sys->tab_precalc[pix + 256] );
         }
     }
+}
+
+/*****************************************************************************
+ * Render: displays previously rendered output
+ *****************************************************************************
+ * This function send the currently rendered image to Invert image, waits
+ * until it is displayed and switch the two rendering buffers, preparing next
+ * frame.
+ *****************************************************************************/
+static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+{
+    picture_t *p_outpic;
+
+    if( !p_pic ) return NULL;
+
+    p_outpic = filter_NewPicture( p_filter );
+    if( !p_outpic )
+    {
+        picture_Release( p_pic );
+        return NULL;
+    }
+
+    /* process the Y plane */
+    picture_t *pp_pics[2] = { p_pic, p_outpic };
+
+    vlc_mutex_lock( &p_filter->p_sys->lock );
+    filter_Slice( p_filter, p_pic->p[Y_PLANE].i_visible_lines, 0,
+                  SharpenSlice, pp_pics );
     vlc_mutex_unlock( &p_filter->p_sys->lock );
 
     plane_CopyPixels( &p_outpic->p[U_PLANE], &p_pic->p[U_PLANE] );
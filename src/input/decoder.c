@@ -42,6 +42,7 @@
 #include <vlc_meta.h>
 #include <vlc_dialog.h>
 #include <vlc_modules.h>
+#include <vlc_atomic.h>
 
 #include "audio_output/aout_internal.h"
 #include "stream_output/stream_output.h"
@@ -109,6 +110,7 @@ struct decoder_owner_sys_t
 
     /* fifo */
     block_fifo_t *p_fifo;
+    atomic_size_t i_chained; /* payload bytes of the queued PES chains */
 
     /* Lock for communication with decoder thread */
     vlc_mutex_t lock;
@@ -358,6 +360,65 @@ void input_DecoderDelete( decoder_t *p_dec )
     DeleteDecoder( p_dec );
 }
 
+/* The block of a PES may come as a chain of TS payloads. The chain is
+ * queued as a single empty entry, so that the fifo depth counts the PES.
+ * Its payload size is accounted by the owner, as the fifo only sees the
+ * wrapper. */
+typedef struct
+{
+    block_t  self;
+    block_t *p_chain;
+    size_t   i_size;
+    atomic_size_t *p_chained;
+} decoder_chain_t;
+
+static void DecoderChainRelease( block_t *p_block )
+{
+    decoder_chain_t *p_wrap = (decoder_chain_t *)p_block;
+
+    atomic_fetch_sub( p_wrap->p_chained, p_wrap->i_size );
+    block_ChainRelease( p_wrap->p_chain );
+    free( p_wrap );
+}
+
+static block_t *DecoderChainWrap( decoder_owner_sys_t *p_owner,
+                                  block_t *p_chain )
+{
+    if( p_chain->p_next == NULL )
+        return p_chain;
+
+    decoder_chain_t *p_wrap = malloc( sizeof(*p_wrap) );
+    if( unlikely(p_wrap == NULL) )
+        return block_ChainGather( p_chain );
+
+    block_Init( &p_wrap->self, NULL, 0 );
+    p_wrap->self.pf_release = DecoderChainRelease;
+    p_wrap->p_chain = p_chain;
+    block_ChainProperties( p_chain, NULL, &p_wrap->i_size, NULL );
+    p_wrap->p_chained = &p_owner->i_chained;
+    atomic_fetch_add( p_wrap->p_chained, p_wrap->i_size );
+    return &p_wrap->self;
+}
+
+static block_t *DecoderChainUnwrap( block_t *p_block )
+{
+    if( p_block->pf_release != DecoderChainRelease )
+        return p_block;
+
+    decoder_chain_t *p_wrap = (decoder_chain_t *)p_block;
+    block_t *p_chain = p_wrap->p_chain;
+
+    atomic_fetch_sub( p_wrap->p_chained, p_wrap->i_size );
+    free( p_wrap );
+    return p_chain;
+}
+
+static size_t DecoderFifoSize( decoder_owner_sys_t *p_owner )
+{
+    return block_FifoSize( p_owner->p_fifo )
+         + atomic_load( &p_owner->i_chained );
+}
+
 /**
  * Put a block_t in the decoder's fifo.
  * Thread-safe w.r.t. the decoder. May be a cancellation point.
@@ -379,9 +440,9 @@ void input_DecoderDecode( decoder_t *p_dec, block_t *p_block, bool b_do_pace )
             block_FifoPace( p_owner->p_fifo, 10, SIZE_MAX );
     }
 #ifdef __arm__
-    else if( block_FifoSize( p_owner->p_fifo ) > 50*1024*1024 /* 50 MiB */ )
+    else if( DecoderFifoSize( p_owner ) > 50*1024*1024 /* 50 MiB */ )
 #else
-    else if( block_FifoSize( p_owner->p_fifo ) > 400*1024*1024 /* 400 MiB, ie ~ 50mb/s for 60s */ )
+    else if( DecoderFifoSize( p_owner ) > 400*1024*1024 /* 400 MiB, ie ~ 50mb/s for 60s */ )
 #endif
     {
         /* FIXME: ideally we would check the time amount of data
@@ -391,7 +452,7 @@ void input_DecoderDecode( decoder_t *p_dec, block_t *p_block, bool b_do_pace )
         block_FifoEmpty( p_owner->p_fifo );
     }
 
-    block_FifoPut( p_owner->p_fifo, p_block );
+    block_FifoPut( p_owner->p_fifo, DecoderChainWrap( p_owner, p_block ) );
 }
 
 bool input_DecoderIsEmpty( decoder_t * p_dec )
@@ -624,7 +685,7 @@ size_t input_DecoderGetFifoSize( decoder_t *p_dec )
 {
     decoder_owner_sys_t *p_owner = p_dec->p_owner;
 
-    return block_FifoSize( p_owner->p_fifo );
+    return DecoderFifoSize( p_owner );
 }
 
 void input_DecoderGetObjects( decoder_t *p_dec,
@@ -759,14 +820,21 @@ static decoder_t * CreateDecoder( vlc_object_t *p_parent,
     p_owner->p_packetizer = NULL;
     p_owner->b_packetizer = b_packetizer;
 
-    /* decoder fifo */
-    p_owner->p_fifo = block_FifoNew();
+    /* decoder fifo: the input thread is the only producer, except for
+     * closed captions decoders which are fed by their parent decoder */
+    bool b_cc = fmt->i_cat == SPU_ES
+             && ( fmt->i_codec == VLC_FOURCC('c', 'c', '1', ' ')
+               || fmt->i_codec == VLC_FOURCC('c', 'c', '2', ' ')
+               || fmt->i_codec == VLC_FOURCC('c', 'c', '3', ' ')
+               || fmt->i_codec == VLC_FOURCC('c', 'c', '4', ' ') );
+    p_owner->p_fifo = block_FifoNewExt( b_cc ? 0 : BLOCK_FIFO_SPSC );
     if( unlikely(p_owner->p_fifo == NULL) )
     {
         free( p_owner );
         vlc_object_release( p_dec );
         return NULL;
     }
+    atomic_init( &p_owner->i_chained, 0 );
 
     /* Set buffers allocation callbacks for the decoders */
     p_dec->pf_aout_format_update = aout_update_format;
@@ -903,10 +971,21 @@ static void *DecoderThread( void *p_data )
                 /* calling DecoderProcess() with NULL block will make
                  * decoders/packetizers flush their buffers */
                 block_Release( p_block );
-                p_block = NULL;
+                DecoderProcess( p_dec, NULL );
+            }
+            else
+            {
+                p_block = DecoderChainUnwrap( p_block );
+                do
+                {
+                    block_t *p_next = p_block->p_next;
+
+                    p_block->p_next = NULL;
+                    DecoderProcess( p_dec, p_block );
+                    p_block = p_next;
+                }
+                while( p_block != NULL );
             }
-
-            DecoderProcess( p_dec, p_block );
 
             vlc_restorecancel( canc );
         }
@@ -34,6 +34,7 @@
 
 static bool SkipID3Tag( demux_t * );
 static bool SkipAPETag( demux_t *p_demux );
+static const char *ProbeSignature( demux_t *p_demux );
 
 /* Decode URL (which has had its scheme stripped earlier) to a file path. */
 /* XXX: evil code duplication from access.c */
@@ -179,6 +180,20 @@ demux_t *demux_New( vlc_object_t *p_obj, input_thread_t *p_parent_input,
           ;
         SkipAPETag( p_demux );
 
+        /* Try first the demux recognized from the stream signature, rather
+         * than every demux by priority, as each probe may read or seek */
+        if( !strcmp( psz_module, "any" ) )
+        {
+            const char *psz_probed = ProbeSignature( p_demux );
+            if( psz_probed != NULL )
+            {
+                if( !b_quick )
+                    msg_Dbg( p_demux, "stream signature matches demux '%s'",
+                             psz_probed );
+                psz_module = psz_probed;
+            }
+        }
+
         p_demux->p_module =
             module_need( p_demux, "demux", psz_module,
                          !strcmp( psz_module, p_demux->psz_demux ) );
@@ -319,6 +334,7 @@ int demux_vaControlHelper( stream_t *s,
         case DEMUX_CAN_RECORD:
         case DEMUX_SET_RECORD_STATE:
         case DEMUX_GET_SIGNAL:
+        case DEMUX_GET_INDEX_PROGRESS:
             return VLC_EGENERIC;
 
         default:
@@ -372,6 +388,75 @@ void demux_PacketizerDestroy( decoder_t *p_packetizer )
     vlc_object_release( p_packetizer );
 }
 
+/* Enough for all the signatures, and the probes of most demuxers */
+#define DEMUX_PROBE_SIZE 2048
+
+/**
+ * Looks for a strong signature at the start of the stream.
+ *
+ * The probe window is filled with a single read, so that the demuxer
+ * probes that follow, including the fallback to all demuxers, mostly peek
+ * buffered data. Only signatures that no other demuxer can claim belong
+ * here, the demuxer priorities must not be overridden otherwise.
+ */
+static const char *ProbeSignature( demux_t *p_demux )
+{
+    static const struct
+    {
+        uint8_t i_offset;
+        uint8_t i_size;
+        char    sig[16];
+        char    demux[6];
+    } signatures[] =
+    {
+        { 0, 4, "\x1A\x45\xDF\xA3", "mkv" },
+        { 4, 4, "ftyp", "mp4" }, { 4, 4, "moov", "mp4" },
+        { 0, 4, "OggS", "ogg" },
+        { 0, 16, "\x30\x26\xB2\x75\x8E\x66\xCF\x11"
+                 "\xA6\xD9\x00\xAA\x00\x62\xCE\x6C", "asf" },
+        { 0, 4, "fLaC", "flac" },
+        { 0, 4, ".snd", "au" },
+        { 0, 8, "MThd\x00\x00\x00\x06", "smf" },
+        { 0, 4, "NSVf", "nsv" }, { 0, 4, "NSVs", "nsv" },
+        { 0, 4, "BBCD", "dirac" },
+        { 0, 4, "\x00\x00\x01\xBA", "ps" },
+        { 0, 0, "", "" },
+    };
+    const uint8_t *p_peek;
+    int i_peek = stream_Peek( p_demux->s, &p_peek, DEMUX_PROBE_SIZE );
+
+    if( i_peek < 16 )
+        return NULL;
+
+    for( unsigned i = 0; signatures[i].i_size; i++ )
+        if( !memcmp( &p_peek[signatures[i].i_offset], signatures[i].sig,
+                     signatures[i].i_size ) )
+            return signatures[i].demux;
+
+    if( !memcmp( p_peek, "RIFF", 4 ) && !memcmp( &p_peek[8], "AVI ", 4 ) )
+        return "avi";
+    if( !memcmp( p_peek, "FORM", 4 ) && !memcmp( &p_peek[8], "AIFF", 4 ) )
+        return "aiff";
+
+    /* MPEG-TS, with 188, 192 or 204 bytes packets */
+    static const int pi_ts_size[] = { 188, 192, 204 };
+    for( unsigned i = 0; i < ARRAY_SIZE(pi_ts_size); i++ )
+    {
+        const int i_size = pi_ts_size[i];
+        const int i_sync = i_size == 192 ? 4 : 0;
+        int j;
+
+        if( i_peek < i_sync + 4 * i_size )
+            break;
+        for( j = 0; j < 4; j++ )
+            if( p_peek[i_sync + j * i_size] != 0x47 )
+                break;
+        if( j == 4 )
+            return "ts";
+    }
+    return NULL;
+}
+
 static bool SkipID3Tag( demux_t *p_demux )
 {
     const uint8_t *p_peek;
@@ -0,0 +1,558 @@
+/*****************************************************************************
+ * demux_index.c: persistent seek index for demuxers
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_fs.h>
+#include <vlc_md5.h>
+#include "../config/configuration.h"
+
+/*
+ * The index files live in the "seekindex" cache sub-directory, named after
+ * a hash of the demuxer name and of the location. They are only ever used
+ * on the machine that wrote them, so everything is stored in host order:
+ *
+ *  header:  magic, file size, file modification time, value, track and
+ *           data counts
+ *  values:  name, value
+ *  tracks:  track, point count, then the points (time, offset)
+ *  data:    name, size, then the bytes
+ */
+#define INDEX_MAGIC      "VLCSIDX2"
+#define INDEX_MAX_POINTS 65536 /* per track */
+#define INDEX_MAX_DATA   (256 << 20)
+
+typedef struct
+{
+    char     magic[8];
+    uint64_t i_size;
+    int64_t  i_mtime;
+    uint32_t i_values;
+    uint32_t i_tracks;
+    uint32_t i_data;
+    uint32_t i_reserved;
+} index_header_t;
+
+typedef struct
+{
+    char     psz_name[24];
+    int64_t  i_value;
+} index_value_t;
+
+typedef struct
+{
+    uint32_t i_track;
+    uint32_t i_count;
+} index_track_header_t;
+
+typedef struct
+{
+    char     psz_name[24];
+    uint64_t i_size;
+} index_data_header_t;
+
+typedef struct
+{
+    index_data_header_t hdr;
+    void    *p_data;
+} index_data_t;
+
+typedef struct
+{
+    unsigned i_track;
+    size_t   i_count;
+    size_t   i_alloc;
+    demux_seek_point_t *p_points;
+} index_track_t;
+
+struct demux_seek_index_t
+{
+    vlc_object_t  *p_obj;
+    char          *psz_path;
+    uint64_t      i_size;
+    int64_t       i_mtime;
+    int64_t       i_interval;
+    bool          b_changed;
+
+    int           i_values;
+    index_value_t *p_values;
+
+    int           i_tracks;
+    index_track_t *p_tracks;
+
+    int           i_data;
+    index_data_t  *p_data;
+};
+
+static char *IndexPath( demux_t *p_demux, const char *psz_name )
+{
+    struct md5_s md5;
+    char *psz_cache, *psz_hash, *psz_path;
+
+    InitMD5( &md5 );
+    AddMD5( &md5, psz_name, strlen( psz_name ) + 1 );
+    if( p_demux->psz_access )
+        AddMD5( &md5, p_demux->psz_access, strlen( p_demux->psz_access ) + 1 );
+    AddMD5( &md5, p_demux->psz_location, strlen( p_demux->psz_location ) );
+    EndMD5( &md5 );
+
+    psz_hash = psz_md5_hash( &md5 );
+    psz_cache = config_GetUserDir( VLC_CACHE_DIR );
+    if( !psz_hash || !psz_cache
+     || asprintf( &psz_path, "%s"DIR_SEP"seekindex"DIR_SEP"%s.idx",
+                  psz_cache, psz_hash ) < 0 )
+        psz_path = NULL;
+    free( psz_cache );
+    free( psz_hash );
+    return psz_path;
+}
+
+static index_track_t *TrackGet( demux_seek_index_t *p_index, unsigned i_track,
+                                bool b_create )
+{
+    for( int i = 0; i < p_index->i_tracks; i++ )
+        if( p_index->p_tracks[i].i_track == i_track )
+            return &p_index->p_tracks[i];
+    if( !b_create )
+        return NULL;
+
+    index_track_t *p_tracks = realloc( p_index->p_tracks,
+                            (p_index->i_tracks + 1) * sizeof(*p_tracks) );
+    if( !p_tracks )
+        return NULL;
+    p_index->p_tracks = p_tracks;
+
+    index_track_t *p_track = &p_tracks[p_index->i_tracks++];
+    p_track->i_track = i_track;
+    p_track->i_count = 0;
+    p_track->i_alloc = 0;
+    p_track->p_points = NULL;
+    return p_track;
+}
+
+static void Load( demux_seek_index_t *p_index )
+{
+    FILE *file = vlc_fopen( p_index->psz_path, "rb" );
+    if( !file )
+        return;
+
+    index_header_t hdr;
+    if( fread( &hdr, sizeof(hdr), 1, file ) != 1
+     || memcmp( hdr.magic, INDEX_MAGIC, sizeof(hdr.magic) )
+     || hdr.i_size != p_index->i_size || hdr.i_mtime != p_index->i_mtime
+     || hdr.i_values > 1024 || hdr.i_tracks > 1024 || hdr.i_data > 1024 )
+        goto error;
+
+    p_index->p_values = malloc( hdr.i_values * sizeof(index_value_t) );
+    if( hdr.i_values > 0 && ( !p_index->p_values
+     || fread( p_index->p_values, sizeof(index_value_t), hdr.i_values, file )
+            != hdr.i_values ) )
+        goto error;
+    p_index->i_values = hdr.i_values;
+    for( int i = 0; i < p_index->i_values; i++ )
+        p_index->p_values[i].psz_name[sizeof(p_index->p_values[i].psz_name) - 1] = '\0';
+
+    for( uint32_t i = 0; i < hdr.i_tracks; i++ )
+    {
+        index_track_header_t th;
+        if( fread( &th, sizeof(th), 1, file ) != 1
+         || th.i_count > INDEX_MAX_POINTS )
+            goto error;
+
+        index_track_t *p_track = TrackGet( p_index, th.i_track, true );
+        if( !p_track || p_track->i_count > 0 )
+            goto error;
+        p_track->p_points = malloc( th.i_count * sizeof(demux_seek_point_t) );
+        if( th.i_count > 0 && ( !p_track->p_points
+         || fread( p_track->p_points, sizeof(demux_seek_point_t), th.i_count,
+                   file ) != th.i_count ) )
+            goto error;
+        p_track->i_count = p_track->i_alloc = th.i_count;
+    }
+
+    if( hdr.i_data > 0 )
+    {
+        p_index->p_data = calloc( hdr.i_data, sizeof(index_data_t) );
+        if( !p_index->p_data )
+            goto error;
+    }
+    for( uint32_t i = 0; i < hdr.i_data; i++ )
+    {
+        index_data_t *p_data = &p_index->p_data[p_index->i_data++];
+
+        if( fread( &p_data->hdr, sizeof(p_data->hdr), 1, file ) != 1
+         || p_data->hdr.i_size > INDEX_MAX_DATA )
+            goto error;
+        p_data->hdr.psz_name[sizeof(p_data->hdr.psz_name) - 1] = '\0';
+        p_data->p_data = malloc( p_data->hdr.i_size );
+        if( p_data->hdr.i_size > 0 && ( !p_data->p_data
+         || fread( p_data->p_data, p_data->hdr.i_size, 1, file ) != 1 ) )
+            goto error;
+    }
+    fclose( file );
+    msg_Dbg( p_index->p_obj, "loaded seek index %s", p_index->psz_path );
+    return;
+
+error:
+    msg_Warn( p_index->p_obj, "ignoring seek index %s", p_index->psz_path );
+    fclose( file );
+    for( int i = 0; i < p_index->i_tracks; i++ )
+        free( p_index->p_tracks[i].p_points );
+    free( p_index->p_tracks );
+    p_index->p_tracks = NULL;
+    p_index->i_tracks = 0;
+    free( p_index->p_values );
+    p_index->p_values = NULL;
+    p_index->i_values = 0;
+    for( int i = 0; i < p_index->i_data; i++ )
+        free( p_index->p_data[i].p_data );
+    free( p_index->p_data );
+    p_index->p_data = NULL;
+    p_index->i_data = 0;
+}
+
+static int Save( demux_seek_index_t *p_index )
+{
+    char *psz_dir = strdup( p_index->psz_path );
+    if( !psz_dir )
+        return VLC_ENOMEM;
+    *strrchr( psz_dir, DIR_SEP_CHAR ) = '\0';
+    int i_ret = config_CreateDir( p_index->p_obj, psz_dir );
+    free( psz_dir );
+    if( i_ret )
+        return VLC_EGENERIC;
+
+    /* Write a temporary file and rename it, so that concurrent readers and
+     * writers of the same index never see a partial file */
+    char *psz_tmp;
+    if( asprintf( &psz_tmp, "%s.XXXXXX", p_index->psz_path ) < 0 )
+        return VLC_ENOMEM;
+
+    int fd = vlc_mkstemp( psz_tmp );
+    FILE *file = fd != -1 ? fdopen( fd, "wb" ) : NULL;
+    if( !file )
+    {
+        if( fd != -1 )
+        {
+            close( fd );
+            vlc_unlink( psz_tmp );
+        }
+        free( psz_tmp );
+        return VLC_EGENERIC;
+    }
+
+    index_header_t hdr;
+    memset( &hdr, 0, sizeof(hdr) );
+    memcpy( hdr.magic, INDEX_MAGIC, sizeof(hdr.magic) );
+    hdr.i_size = p_index->i_size;
+    hdr.i_mtime = p_index->i_mtime;
+    hdr.i_values = p_index->i_values;
+    hdr.i_tracks = p_index->i_tracks;
+    hdr.i_data = p_index->i_data;
+
+    bool b_ok = fwrite( &hdr, sizeof(hdr), 1, file ) == 1
+             && fwrite( p_index->p_values, sizeof(index_value_t),
+                        p_index->i_values, file ) == (size_t)p_index->i_values;
+    for( int i = 0; b_ok && i < p_index->i_tracks; i++ )
+    {
+        const index_track_t *p_track = &p_index->p_tracks[i];
+        index_track_header_t th = {
+            .i_track = p_track->i_track,
+            .i_count = p_track->i_count,
+        };
+        b_ok = fwrite( &th, sizeof(th), 1, file ) == 1
+            && fwrite( p_track->p_points, sizeof(demux_seek_point_t),
+                       p_track->i_count, file ) == p_track->i_count;
+    }
+    for( int i = 0; b_ok && i < p_index->i_data; i++ )
+    {
+        const index_data_t *p_data = &p_index->p_data[i];
+
+        b_ok = fwrite( &p_data->hdr, sizeof(p_data->hdr), 1, file ) == 1
+            && ( p_data->hdr.i_size == 0
+              || fwrite( p_data->p_data, p_data->hdr.i_size, 1, file ) == 1 );
+    }
+
+    if( fclose( file ) )
+        b_ok = false;
+    if( !b_ok || vlc_rename( psz_tmp, p_index->psz_path ) )
+    {
+        vlc_unlink( psz_tmp );
+        b_ok = false;
+    }
+    free( psz_tmp );
+    return b_ok ? VLC_SUCCESS : VLC_EGENERIC;
+}
+
+demux_seek_index_t *demux_SeekIndexOpen( demux_t *p_demux,
+                                         const char *psz_name,
+                                         int64_t i_interval )
+{
+    bool b_can_seek;
+    int64_t i_size;
+
+    if( !var_InheritBool( p_demux, "input-seek-index" )
+     || !p_demux->s || !p_demux->psz_location
+     || stream_Control( p_demux->s, STREAM_CAN_SEEK, &b_can_seek ) || !b_can_seek
+     || ( i_size = stream_Size( p_demux->s ) ) <= 0 )
+        return NULL;
+
+    demux_seek_index_t *p_index = malloc( sizeof(*p_index) );
+    if( !p_index )
+        return NULL;
+
+    p_index->p_obj = VLC_OBJECT(p_demux);
+    p_index->psz_path = IndexPath( p_demux, psz_name );
+    p_index->i_size = i_size;
+    p_index->i_mtime = 0;
+    p_index->i_interval = i_interval;
+    p_index->b_changed = false;
+    p_index->i_values = 0;
+    p_index->p_values = NULL;
+    p_index->i_tracks = 0;
+    p_index->p_tracks = NULL;
+    p_index->i_data = 0;
+    p_index->p_data = NULL;
+
+    if( !p_index->psz_path )
+    {
+        free( p_index );
+        return NULL;
+    }
+
+    /* A local file may be rewritten with the same size */
+    struct stat st;
+    if( p_demux->psz_file && !vlc_stat( p_demux->psz_file, &st ) )
+        p_index->i_mtime = st.st_mtime;
+
+    Load( p_index );
+    return p_index;
+}
+
+void demux_SeekIndexClose( demux_seek_index_t *p_index )
+{
+    if( p_index->b_changed && Save( p_index ) )
+        msg_Warn( p_index->p_obj, "cannot save seek index %s",
+                  p_index->psz_path );
+
+    for( int i = 0; i < p_index->i_tracks; i++ )
+        free( p_index->p_tracks[i].p_points );
+    free( p_index->p_tracks );
+    free( p_index->p_values );
+    for( int i = 0; i < p_index->i_data; i++ )
+        free( p_index->p_data[i].p_data );
+    free( p_index->p_data );
+    free( p_index->psz_path );
+    free( p_index );
+}
+
+void demux_SeekIndexAdd( demux_seek_index_t *p_index, unsigned i_track,
+                         int64_t i_time, uint64_t i_pos )
+{
+    index_track_t *p_track = TrackGet( p_index, i_track, true );
+    if( !p_track || p_track->i_count >= INDEX_MAX_POINTS )
+        return;
+
+    /* Find the insertion point by offset */
+    size_t i_lo = 0, i_hi = p_track->i_count;
+    while( i_lo < i_hi )
+    {
+        size_t i_mid = (i_lo + i_hi) / 2;
+        if( p_track->p_points[i_mid].i_pos < i_pos )
+            i_lo = i_mid + 1;
+        else
+            i_hi = i_mid;
+    }
+
+    /* The neighbours are the closest points in time */
+    if( i_lo > 0 &&
+        llabs( p_track->p_points[i_lo - 1].i_time - i_time ) < p_index->i_interval )
+        return;
+    if( i_lo < p_track->i_count &&
+        ( p_track->p_points[i_lo].i_pos == i_pos ||
+          llabs( p_track->p_points[i_lo].i_time - i_time ) < p_index->i_interval ) )
+        return;
+
+    if( p_track->i_count == p_track->i_alloc )
+    {
+        size_t i_alloc = p_track->i_alloc ? 2 * p_track->i_alloc : 16;
+        demux_seek_point_t *p_points = realloc( p_track->p_points,
+                                                i_alloc * sizeof(*p_points) );
+        if( !p_points )
+            return;
+        p_track->p_points = p_points;
+        p_track->i_alloc = i_alloc;
+    }
+
+    memmove( &p_track->p_points[i_lo + 1], &p_track->p_points[i_lo],
+             (p_track->i_count - i_lo) * sizeof(*p_track->p_points) );
+    p_track->p_points[i_lo].i_time = i_time;
+    p_track->p_points[i_lo].i_pos = i_pos;
+    p_track->i_count++;
+    p_index->b_changed = true;
+}
+
+bool demux_SeekIndexFind( demux_seek_index_t *p_index, unsigned i_track,
+                          int64_t i_time, demux_seek_point_t *p_before,
+                          demux_seek_point_t *p_after )
+{
+    index_track_t *p_track = TrackGet( p_index, i_track, false );
+    if( !p_track )
+        return false;
+
+    /* First point after the time */
+    size_t i_lo = 0, i_hi = p_track->i_count;
+    while( i_lo < i_hi )
+    {
+        size_t i_mid = (i_lo + i_hi) / 2;
+        if( p_track->p_points[i_mid].i_time <= i_time )
+            i_lo = i_mid + 1;
+        else
+            i_hi = i_mid;
+    }
+
+    if( i_lo < p_track->i_count && p_after )
+        *p_after = p_track->p_points[i_lo];
+    if( i_lo == 0 )
+        return false;
+    if( p_before )
+        *p_before = p_track->p_points[i_lo - 1];
+    return true;
+}
+
+const demux_seek_point_t *demux_SeekIndexGetPoints(
+                demux_seek_index_t *p_index, unsigned i_track, size_t *pi_count )
+{
+    index_track_t *p_track = TrackGet( p_index, i_track, false );
+
+    *pi_count = p_track ? p_track->i_count : 0;
+    return p_track ? p_track->p_points : NULL;
+}
+
+void demux_SeekIndexSetValue( demux_seek_index_t *p_index,
+                              const char *psz_name, int64_t i_value )
+{
+    index_value_t *p_value = NULL;
+
+    for( int i = 0; i < p_index->i_values && !p_value; i++ )
+        if( !strcmp( p_index->p_values[i].psz_name, psz_name ) )
+            p_value = &p_index->p_values[i];
+
+    if( !p_value )
+    {
+        if( strlen( psz_name ) >= sizeof(p_value->psz_name) )
+            return;
+
+        index_value_t *p_values = realloc( p_index->p_values,
+                            (p_index->i_values + 1) * sizeof(*p_values) );
+        if( !p_values )
+            return;
+        p_index->p_values = p_values;
+        p_value = &p_values[p_index->i_values++];
+        memset( p_value->psz_name, 0, sizeof(p_value->psz_name) );
+        strcpy( p_value->psz_name, psz_name );
+    }
+    else if( p_value->i_value == i_value )
+        return;
+
+    p_value->i_value = i_value;
+    p_index->b_changed = true;
+}
+
+int demux_SeekIndexGetValue( demux_seek_index_t *p_index,
+                             const char *psz_name, int64_t *pi_value )
+{
+    for( int i = 0; i < p_index->i_values; i++ )
+        if( !strcmp( p_index->p_values[i].psz_name, psz_name ) )
+        {
+            *pi_value = p_index->p_values[i].i_value;
+            return VLC_SUCCESS;
+        }
+    return VLC_EGENERIC;
+}
+
+int demux_SeekIndexSetData( demux_seek_index_t *p_index, const char *psz_name,
+                            const void *p_buf, size_t i_size )
+{
+    index_data_t *p_data = NULL;
+
+    if( i_size > INDEX_MAX_DATA )
+        return VLC_EGENERIC;
+
+    for( int i = 0; i < p_index->i_data && !p_data; i++ )
+        if( !strcmp( p_index->p_data[i].hdr.psz_name, psz_name ) )
+            p_data = &p_index->p_data[i];
+
+    void *p_copy = malloc( i_size );
+    if( i_size > 0 && !p_copy )
+        return VLC_ENOMEM;
+    if( i_size > 0 )
+        memcpy( p_copy, p_buf, i_size );
+
+    if( !p_data )
+    {
+        if( strlen( psz_name ) >= sizeof(p_data->hdr.psz_name) )
+        {
+            free( p_copy );
+            return VLC_EGENERIC;
+        }
+
+        index_data_t *p_datas = realloc( p_index->p_data,
+                            (p_index->i_data + 1) * sizeof(*p_datas) );
+        if( !p_datas )
+        {
+            free( p_copy );
+            return VLC_ENOMEM;
+        }
+        p_index->p_data = p_datas;
+        p_data = &p_datas[p_index->i_data++];
+        memset( p_data->hdr.psz_name, 0, sizeof(p_data->hdr.psz_name) );
+        strcpy( p_data->hdr.psz_name, psz_name );
+    }
+    else
+        free( p_data->p_data );
+
+    p_data->hdr.i_size = i_size;
+    p_data->p_data = p_copy;
+    p_index->b_changed = true;
+    return VLC_SUCCESS;
+}
+
+const void *demux_SeekIndexGetData( demux_seek_index_t *p_index,
+                                    const char *psz_name, size_t *pi_size )
+{
+    for( int i = 0; i < p_index->i_data; i++ )
+        if( !strcmp( p_index->p_data[i].hdr.psz_name, psz_name ) )
+        {
+            *pi_size = p_index->p_data[i].hdr.i_size;
+            return p_index->p_data[i].p_data;
+        }
+    return NULL;
+}
@@ -1916,9 +1916,14 @@ static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
     {
         uint64_t i_total;
 
+        size_t i_size;
+
+        /* The block may be a chain, when the ES is not packetized yet */
+        block_ChainProperties( p_block, NULL, &i_size, NULL );
+
         vlc_mutex_lock( &p_input->p->counters.counters_lock );
         stats_Update( p_input->p->counters.p_demux_read,
-                      p_block->i_buffer, &i_total );
+                      i_size, &i_total );
         stats_Update( p_input->p->counters.p_demux_bitrate, i_total, NULL );
 
         /* Update number of corrupted data packats */
@@ -1949,7 +1954,7 @@ static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
 
     if( !es->p_dec )
     {
-        block_Release( p_block );
+        block_ChainRelease( p_block );
         vlc_mutex_unlock( &p_sys->lock );
         return VLC_SUCCESS;
     }
@@ -1975,7 +1980,21 @@ static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
     /* Decode */
     if( es->p_dec_record )
     {
-        block_t *p_dup = block_Duplicate( p_block );
+        block_t *p_dup;
+        if( p_block->p_next == NULL )
+            p_dup = block_Duplicate( p_block );
+        else
+        {
+            size_t i_size;
+
+            block_ChainProperties( p_block, NULL, &i_size, NULL );
+            p_dup = block_Alloc( i_size );
+            if( p_dup )
+            {
+                block_CopyProperties( p_dup, p_block );
+                block_ChainExtract( p_block, p_dup->p_buffer, i_size );
+            }
+        }
         if( p_dup )
             input_DecoderDecode( es->p_dec_record, p_dup,
                                  p_input->p->b_out_pace_control );
@@ -36,6 +36,9 @@
 #endif
 #include <sys/stat.h>
 #include <unistd.h>
+#ifdef HAVE_MMAP
+#  include <sys/mman.h>
+#endif
 
 #include <vlc_common.h>
 #include <vlc_fs.h>
@@ -62,6 +65,7 @@
 
 enum
 {
+    C_NONE, /* Already executed and not replayable */
     C_ADD,
     C_SEND,
     C_DEL,
@@ -150,6 +154,20 @@ typedef struct attribute_packed
     } u;
 } ts_cmd_t;
 
+/* Serialized block header, followed in the file by the block payload */
+typedef struct
+{
+    mtime_t  i_dts;
+    mtime_t  i_pts;
+    mtime_t  i_length;
+    uint32_t i_flags;
+    unsigned i_nb_samples;
+    size_t   i_buffer;
+} ts_block_header_t;
+
+/* Records are aligned in the files so that headers can be read in place */
+#define TS_RECORD_ALIGN(i) (((i) + 7) & ~(size_t)7)
+
 typedef struct ts_storage_t ts_storage_t;
 struct ts_storage_t
 {
@@ -159,8 +177,9 @@ struct ts_storage_t
     char    *psz_file;  /* Filename */
     size_t  i_file_max; /* Max size in bytes */
     int64_t i_file_size;/* Current size in bytes */
-    FILE    *p_filew;   /* FILE handle for data writing */
-    FILE    *p_filer;   /* FILE handle for data reading */
+    uint8_t *p_map;     /* Shared mapping of the whole file (or NULL) */
+    FILE    *p_filew;   /* FILE handle for data writing (without mapping) */
+    FILE    *p_filer;   /* FILE handle for data reading (without mapping) */
 
     /* */
     int      i_cmd_r;
@@ -176,6 +195,9 @@ typedef struct
     es_out_t       *p_out;
     int64_t        i_tmp_size_max;
     const char     *psz_tmp_path;
+    int64_t        i_window_size;
+    mtime_t        i_window_duration;
+    bool           b_window;
 
     /* Lock for all following fields */
     vlc_mutex_t    lock;
@@ -195,11 +217,25 @@ typedef struct
     mtime_t        i_buffering_delay;
 
     /* */
+    ts_storage_t   *p_storage_first; /* Oldest segment kept for seeking */
     ts_storage_t   *p_storage_r;
     ts_storage_t   *p_storage_w;
+    int64_t        i_storage_size;   /* Size of all the segments */
 
     mtime_t        i_cmd_delay;
 
+    /* Last stream time received and its date, to map seek requests */
+    mtime_t        i_time;
+    mtime_t        i_time_date;
+
+    /* Incremented on each seek to drop the data popped before it */
+    unsigned       i_seek;
+    mtime_t        i_seek_date;      /* Data before this date is skipped */
+
+    /* ES deleted while commands of the window may still refer to them */
+    int            i_es_dead;
+    es_out_id_t    **pp_es_dead;
+
 } ts_thread_t;
 
 struct es_out_id_t
@@ -215,12 +251,15 @@ struct es_out_sys_t
     /* Configuration */
     int64_t        i_tmp_size_max;    /* Maximal temporary file size in byte */
     char           *psz_tmp_path;     /* Path for temporary files */
+    int64_t        i_window_size;     /* Maximal size kept for seeking back */
+    mtime_t        i_window_duration; /* Maximal duration kept for seeking back */
 
     /* Lock for all following fields */
     vlc_mutex_t    lock;
 
     /* */
     bool           b_delayed;
+    bool           b_window_failed;
     ts_thread_t   *p_ts;
 
     /* */
@@ -250,10 +289,13 @@ static bool         TsHasCmd( ts_thread_t * );
 static bool         TsIsUnused( ts_thread_t * );
 static int          TsChangePause( ts_thread_t *, bool b_source_paused, bool b_paused, mtime_t i_date );
 static int          TsChangeRate( ts_thread_t *, int i_src_rate, int i_rate );
+static int          TsSeek( ts_thread_t *, mtime_t i_time );
+static void         TsExecuteCmd( ts_thread_t *, ts_cmd_t * );
 
 static void         *TsRun( void * );
 
 static ts_storage_t *TsStorageNew( const char *psz_path, int64_t i_tmp_size_max );
+static int          TsStorageFind( ts_storage_t *, mtime_t i_date );
 static void         TsStorageDelete( ts_storage_t * );
 static void         TsStoragePack( ts_storage_t *p_storage );
 static bool         TsStorageIsFull( ts_storage_t *, const ts_cmd_t *p_cmd );
@@ -261,6 +303,7 @@ static bool         TsStorageIsEmpty( ts_storage_t * );
 static void         TsStoragePushCmd( ts_storage_t *, const ts_cmd_t *p_cmd, bool b_flush );
 static void         TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_flush );
 
+static bool CmdIsReplayable( const ts_cmd_t * );
 static void CmdClean( ts_cmd_t * );
 static void cmd_cleanup_routine( void *p ) { CmdClean( p ); }
 
@@ -319,6 +362,7 @@ es_out_t *input_EsOutTimeshiftNew( input_thread_t *p_input, es_out_t *p_next_out
     vlc_mutex_init_recursive( &p_sys->lock );
 
     p_sys->b_delayed = false;
+    p_sys->b_window_failed = false;
     p_sys->p_ts = NULL;
 
     TAB_INIT( p_sys->i_es, p_sys->pp_es );
@@ -336,6 +380,15 @@ es_out_t *input_EsOutTimeshiftNew( input_thread_t *p_input, es_out_t *p_next_out
     msg_Dbg( p_input, "using timeshift granularity of %d MiB, in path '%s'",
              (int)p_sys->i_tmp_size_max/(1024*1024), p_sys->psz_tmp_path );
 
+    const int64_t i_window_size = var_CreateGetInteger( p_input, "input-timeshift-window-size" );
+    const int64_t i_window_duration = var_CreateGetInteger( p_input, "input-timeshift-window-duration" );
+    p_sys->i_window_size = __MAX( i_window_size, 0 ) * 1024 * 1024;
+    p_sys->i_window_duration = __MAX( i_window_duration, 0 ) * CLOCK_FREQ;
+
+    if( p_sys->i_window_size > 0 || p_sys->i_window_duration > 0 )
+        msg_Dbg( p_input, "keeping a timeshift window of %"PRId64" MiB and %"PRId64" s",
+                 i_window_size, i_window_duration );
+
 #if 0
 #define S(t) msg_Err( p_input, "SIZEOF("#t")=%d", sizeof(t) )
     S(ts_cmd_t);
@@ -413,6 +466,20 @@ static int Send( es_out_t *p_out, es_out_id_t *p_es, block_t *p_block )
 
     TsAutoStop( p_out );
 
+    /* Record from the start so that the whole window can be sought back */
+    if( !p_sys->b_delayed && !p_sys->b_window_failed &&
+        !p_sys->p_input->p->b_can_pace_control &&
+        ( p_sys->i_window_size > 0 || p_sys->i_window_duration > 0 ) &&
+        TsStart( p_out ) )
+    {
+        msg_Warn( p_sys->p_input, "timeshift window disabled" );
+        p_sys->b_window_failed = true;
+    }
+
+    /* The storage keeps single blocks */
+    if( p_sys->b_delayed && p_block->p_next )
+        p_block = block_ChainGather( p_block );
+
     CmdInitSend( &cmd, p_es, p_block );
     if( p_sys->b_delayed )
         TsPushCmd( p_sys->p_ts, &cmd );
@@ -556,8 +623,12 @@ static int ControlLockedSetTime( es_out_t *p_out, mtime_t i_date )
 {
     es_out_sys_t *p_sys = p_out->p_sys;
 
+    /* A positive date is a stream time to seek to inside the window */
     if( !p_sys->b_delayed )
-        return es_out_SetTime( p_sys->p_out, i_date );
+        return i_date < 0 ? es_out_SetTime( p_sys->p_out, i_date ) : VLC_EGENERIC;
+
+    if( i_date >= 0 )
+        return TsSeek( p_sys->p_ts, i_date );
 
     /* TODO */
     msg_Err( p_sys->p_input, "EsOutTimeshift does not yet support time change" );
@@ -725,6 +796,9 @@ static int Control( es_out_t *p_out, int i_query, va_list args )
  *****************************************************************************/
 static void TsDestroy( ts_thread_t *p_ts )
 {
+    for( int i = 0; i < p_ts->i_es_dead; i++ )
+        free( p_ts->pp_es_dead[i] );
+    TAB_CLEAN( p_ts->i_es_dead, p_ts->pp_es_dead );
     vlc_cond_destroy( &p_ts->wait );
     vlc_mutex_destroy( &p_ts->lock );
     free( p_ts );
@@ -742,6 +816,9 @@ static int TsStart( es_out_t *p_out )
 
     p_ts->i_tmp_size_max = p_sys->i_tmp_size_max;
     p_ts->psz_tmp_path = p_sys->psz_tmp_path;
+    p_ts->i_window_size = p_sys->i_window_size;
+    p_ts->i_window_duration = p_sys->i_window_duration;
+    p_ts->b_window = p_ts->i_window_size > 0 || p_ts->i_window_duration > 0;
     p_ts->p_input = p_sys->p_input;
     p_ts->p_out = p_sys->p_out;
     vlc_mutex_init( &p_ts->lock );
@@ -754,8 +831,15 @@ static int TsStart( es_out_t *p_out )
     p_ts->i_rate_delay = 0;
     p_ts->i_buffering_delay = 0;
     p_ts->i_cmd_delay = 0;
+    p_ts->p_storage_first = NULL;
     p_ts->p_storage_r = NULL;
     p_ts->p_storage_w = NULL;
+    p_ts->i_storage_size = 0;
+    p_ts->i_time = -1;
+    p_ts->i_time_date = -1;
+    p_ts->i_seek = 0;
+    p_ts->i_seek_date = -1;
+    TAB_INIT( p_ts->i_es_dead, p_ts->pp_es_dead );
 
     p_sys->b_delayed = true;
     if( vlc_clone( &p_ts->thread, TsRun, p_ts, VLC_THREAD_PRIORITY_INPUT ) )
@@ -798,19 +882,66 @@ static void TsStop( ts_thread_t *p_ts )
         CmdClean( &cmd );
     }
     assert( !p_ts->p_storage_r || !p_ts->p_storage_r->p_next );
-    if( p_ts->p_storage_r )
-        TsStorageDelete( p_ts->p_storage_r );
+    while( p_ts->p_storage_first )
+    {
+        ts_storage_t *p_next = p_ts->p_storage_first->p_next;
+
+        TsStorageDelete( p_ts->p_storage_first );
+        p_ts->p_storage_first = p_next;
+    }
     vlc_mutex_unlock( &p_ts->lock );
 
     TsDestroy( p_ts );
 }
+static void TsTrimLocked( ts_thread_t *p_ts )
+{
+    vlc_assert_locked( &p_ts->lock );
+
+    /* Only the segments entirely played can be dropped */
+    while( p_ts->p_storage_first && p_ts->p_storage_first != p_ts->p_storage_r )
+    {
+        ts_storage_t *p_storage = p_ts->p_storage_first;
+        const ts_storage_t *p_last = p_ts->p_storage_w;
+
+        bool b_drop = !p_ts->b_window;
+        if( p_ts->i_window_size > 0 &&
+            p_ts->i_storage_size > p_ts->i_window_size )
+            b_drop = true;
+        if( p_ts->i_window_duration > 0 &&
+            p_storage->i_cmd_w > 0 && p_last->i_cmd_w > 0 &&
+            p_last->p_cmd[p_last->i_cmd_w - 1].i_date -
+            p_storage->p_cmd[p_storage->i_cmd_w - 1].i_date > p_ts->i_window_duration )
+            b_drop = true;
+        if( !b_drop )
+            break;
+
+        p_ts->p_storage_first = p_storage->p_next;
+        p_ts->i_storage_size -= p_storage->i_file_size;
+        TsStorageDelete( p_storage );
+    }
+}
 static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
 {
     vlc_mutex_lock( &p_ts->lock );
 
+    if( p_cmd->i_type == C_CONTROL &&
+        p_cmd->u.control.i_query == ES_OUT_SET_TIMES )
+    {
+        p_ts->i_time = p_cmd->u.control.u.times.i_time;
+        p_ts->i_time_date = p_cmd->i_date;
+    }
+
     if( !p_ts->p_storage_w || TsStorageIsFull( p_ts->p_storage_w, p_cmd ) )
     {
-        ts_storage_t *p_storage = TsStorageNew( p_ts->psz_tmp_path, p_ts->i_tmp_size_max );
+        int64_t i_size_max = p_ts->i_tmp_size_max;
+
+        /* The whole block must fit in a mapped file */
+        if( p_cmd->i_type == C_SEND )
+            i_size_max = __MAX( i_size_max,
+                                (int64_t)TS_RECORD_ALIGN( sizeof(ts_block_header_t) +
+                                                          p_cmd->u.send.p_block->i_buffer ) );
+
+        ts_storage_t *p_storage = TsStorageNew( p_ts->psz_tmp_path, i_size_max );
 
         if( !p_storage )
         {
@@ -822,6 +953,7 @@ static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
 
         if( !p_ts->p_storage_w )
         {
+            p_ts->p_storage_first = p_storage;
             p_ts->p_storage_r = p_ts->p_storage_w = p_storage;
         }
         else
@@ -830,10 +962,13 @@ static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
             p_ts->p_storage_w->p_next = p_storage;
             p_ts->p_storage_w = p_storage;
         }
+        TsTrimLocked( p_ts );
     }
 
     /* TODO return error and warn the user (but only once) */
+    const int64_t i_file_size = p_ts->p_storage_w->i_file_size;
     TsStoragePushCmd( p_ts->p_storage_w, p_cmd, p_ts->p_storage_r == p_ts->p_storage_w );
+    p_ts->i_storage_size += p_ts->p_storage_w->i_file_size - i_file_size;
 
     vlc_cond_signal( &p_ts->wait );
 
@@ -843,22 +978,27 @@ static int TsPopCmdLocked( ts_thread_t *p_ts, ts_cmd_t *p_cmd, bool b_flush )
 {
     vlc_assert_locked( &p_ts->lock );
 
-    if( TsStorageIsEmpty( p_ts->p_storage_r ) )
-        return VLC_EGENERIC;
+    for( ;; )
+    {
+        if( TsStorageIsEmpty( p_ts->p_storage_r ) )
+            return VLC_EGENERIC;
 
-    TsStoragePopCmd( p_ts->p_storage_r, p_cmd, b_flush );
+        TsStoragePopCmd( p_ts->p_storage_r, p_cmd, b_flush );
 
-    while( p_ts->p_storage_r && TsStorageIsEmpty( p_ts->p_storage_r ) )
-    {
-        ts_storage_t *p_next = p_ts->p_storage_r->p_next;
-        if( !p_next )
-            break;
+        while( p_ts->p_storage_r && TsStorageIsEmpty( p_ts->p_storage_r ) )
+        {
+            ts_storage_t *p_next = p_ts->p_storage_r->p_next;
+            if( !p_next )
+                break;
 
-        TsStorageDelete( p_ts->p_storage_r );
-        p_ts->p_storage_r = p_next;
-    }
+            p_ts->p_storage_r = p_next;
+            TsTrimLocked( p_ts );
+        }
 
-    return VLC_SUCCESS;
+        /* Commands already executed once are kept only if replayable */
+        if( p_cmd->i_type != C_NONE )
+            return VLC_SUCCESS;
+    }
 }
 static bool TsHasCmd( ts_thread_t *p_ts )
 {
@@ -875,7 +1015,8 @@ static bool TsIsUnused( ts_thread_t *p_ts )
     bool b_unused;
 
     vlc_mutex_lock( &p_ts->lock );
-    b_unused = !p_ts->b_paused &&
+    b_unused = !p_ts->b_window &&
+               !p_ts->b_paused &&
                p_ts->i_rate == p_ts->i_rate_source &&
                TsStorageIsEmpty( p_ts->p_storage_r );
     vlc_mutex_unlock( &p_ts->lock );
@@ -931,6 +1072,116 @@ static int TsChangeRate( ts_thread_t *p_ts, int i_src_rate, int i_rate )
 
     return i_ret;
 }
+static int TsSeekLocked( ts_thread_t *p_ts, mtime_t i_date )
+{
+    vlc_assert_locked( &p_ts->lock );
+
+    /* Find the segment holding the date, then the command inside it */
+    bool b_backward = true;
+    ts_storage_t *p_storage;
+    for( p_storage = p_ts->p_storage_first; p_storage; p_storage = p_storage->p_next )
+    {
+        if( p_storage->i_cmd_w > 0 &&
+            p_storage->p_cmd[p_storage->i_cmd_w - 1].i_date >= i_date )
+            break;
+        if( p_storage == p_ts->p_storage_r )
+            b_backward = false;
+    }
+    if( !p_storage )
+        return VLC_EGENERIC;
+
+    const int i_cmd = TsStorageFind( p_storage, i_date );
+    if( p_storage == p_ts->p_storage_r )
+        b_backward = i_cmd < p_storage->i_cmd_r;
+
+    if( b_backward )
+    {
+        if( !p_ts->b_window )
+            return VLC_EGENERIC;
+
+        /* Replay from the found command up to the current position */
+        for( ts_storage_t *p = p_storage->p_next; p; p = p->p_next )
+        {
+            p->i_cmd_r = 0;
+            if( p == p_ts->p_storage_r )
+                break;
+        }
+        p_storage->i_cmd_r = i_cmd;
+        p_ts->p_storage_r = p_storage;
+    }
+    /* Forward, the data up to the date is skipped by TsRun, while the other
+     * commands are still executed */
+    p_ts->i_seek_date = p_storage->p_cmd[i_cmd].i_date;
+    return VLC_SUCCESS;
+}
+static int TsSeek( ts_thread_t *p_ts, mtime_t i_time )
+{
+    int i_ret = VLC_EGENERIC;
+
+    vlc_mutex_lock( &p_ts->lock );
+    if( p_ts->i_time_date >= 0 )
+    {
+        /* The stream time went along the dates when it was recorded */
+        const mtime_t i_date = p_ts->i_time_date - ( p_ts->i_time - i_time );
+
+        i_ret = TsSeekLocked( p_ts, i_date );
+    }
+    if( !i_ret )
+    {
+        es_out_SetTime( p_ts->p_out, -1 );
+
+        p_ts->i_seek++;
+        p_ts->i_cmd_delay = mdate() - p_ts->i_seek_date;
+        p_ts->i_rate_date = -1;
+        p_ts->i_rate_delay = 0;
+        p_ts->i_buffering_delay = 0;
+        if( p_ts->b_paused )
+            p_ts->i_pause_date = mdate();
+
+        vlc_cond_signal( &p_ts->wait );
+    }
+    vlc_mutex_unlock( &p_ts->lock );
+
+    if( i_ret )
+        msg_Warn( p_ts->p_input, "es out timeshift: cannot seek to %"PRId64
+                  " outside of the window", i_time );
+    return i_ret;
+}
+static void TsExecuteCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
+{
+    switch( p_cmd->i_type )
+    {
+    case C_ADD:
+        CmdExecuteAdd( p_ts->p_out, p_cmd );
+        CmdCleanAdd( p_cmd );
+        break;
+    case C_SEND:
+        CmdExecuteSend( p_ts->p_out, p_cmd );
+        CmdCleanSend( p_cmd );
+        break;
+    case C_CONTROL:
+        CmdExecuteControl( p_ts->p_out, p_cmd );
+        CmdCleanControl( p_cmd );
+        break;
+    case C_DEL:
+        if( p_ts->b_window )
+        {
+            /* Commands kept for seeking back may still refer to the ES */
+            es_out_id_t *p_es = p_cmd->u.del.p_es;
+
+            if( p_es->p_es )
+                es_out_Del( p_ts->p_out, p_es->p_es );
+            p_es->p_es = NULL;
+            TAB_APPEND( p_ts->i_es_dead, p_ts->pp_es_dead, p_es );
+        }
+        else
+            CmdExecuteDel( p_ts->p_out, p_cmd );
+        break;
+    default:
+        assert(0);
+        break;
+    }
+}
 
 static void *TsRun( void *p_data )
 {
@@ -942,6 +1193,8 @@ static void *TsRun( void *p_data )
         ts_cmd_t cmd;
         mtime_t  i_deadline;
         bool b_buffering;
+        bool b_skip;
+        unsigned i_seek;
 
         /* Pop a command to execute */
         vlc_mutex_lock( &p_ts->lock );
@@ -1011,6 +1264,12 @@ static void *TsRun( void *p_data )
         }
         i_deadline = cmd.i_date + p_ts->i_cmd_delay + p_ts->i_rate_delay + p_ts->i_buffering_delay;
 
+        /* Data skipped by a forward seek, the other commands still apply */
+        i_seek = p_ts->i_seek;
+        b_skip = cmd.i_date < p_ts->i_seek_date;
+        if( b_skip )
+            i_deadline = 0;
+
         vlc_cleanup_run();
 
         /* Regulate the speed of command processing to the same one than
@@ -1021,29 +1280,17 @@ static void *TsRun( void *p_data )
 
         vlc_cleanup_pop();
 
+        /* Data popped before a seek is no longer wanted */
+        vlc_mutex_lock( &p_ts->lock );
+        b_skip = b_skip || i_seek != p_ts->i_seek;
+        vlc_mutex_unlock( &p_ts->lock );
+
         /* Execute the command  */
         const int canc = vlc_savecancel();
-        switch( cmd.i_type )
-        {
-        case C_ADD:
-            CmdExecuteAdd( p_ts->p_out, &cmd );
-            CmdCleanAdd( &cmd );
-            break;
-        case C_SEND:
-            CmdExecuteSend( p_ts->p_out, &cmd );
+        if( b_skip && cmd.i_type == C_SEND )
             CmdCleanSend( &cmd );
-            break;
-        case C_CONTROL:
-            CmdExecuteControl( p_ts->p_out, &cmd );
-            CmdCleanControl( &cmd );
-            break;
-        case C_DEL:
-            CmdExecuteDel( p_ts->p_out, &cmd );
-            break;
-        default:
-            assert(0);
-            break;
-        }
+        else
+            TsExecuteCmd( p_ts, &cmd );
         vlc_restorecancel( canc );
     }
 
@@ -1065,8 +1312,25 @@ static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_
     /* */
     p_storage->i_file_max = i_tmp_size_max;
     p_storage->i_file_size = 0;
+    p_storage->p_map = NULL;
     p_storage->p_filew = GetTmpFile( &p_storage->psz_file, psz_tmp_path );
-    if( p_storage->psz_file )
+#ifdef HAVE_MMAP
+    /* Map the whole (sparse) file: no stdio buffering nor seeking is needed
+     * and reading back a command is a single copy */
+    if( p_storage->p_filew &&
+        ftruncate( fileno( p_storage->p_filew ), p_storage->i_file_max ) == 0 )
+    {
+        void *p_map = mmap( NULL, p_storage->i_file_max, PROT_READ|PROT_WRITE,
+                            MAP_SHARED, fileno( p_storage->p_filew ), 0 );
+        if( p_map != MAP_FAILED )
+        {
+            p_storage->p_map = p_map;
+            fclose( p_storage->p_filew );
+            p_storage->p_filew = NULL;
+        }
+    }
+#endif
+    if( p_storage->psz_file && !p_storage->p_map )
         p_storage->p_filer = vlc_fopen( p_storage->psz_file, "rb" );
 
     /* */
@@ -1076,7 +1340,8 @@ static ts_storage_t *TsStorageNew( const char *psz_tmp_path, int64_t i_tmp_size_
     p_storage->p_cmd = malloc( p_storage->i_cmd_max * sizeof(*p_storage->p_cmd) );
     //fprintf( stderr, "\nSTORAGE name=%s size=%d KiB\n", p_storage->psz_file, p_storage->i_cmd_max * sizeof(*p_storage->p_cmd) /1024 );
 
-    if( !p_storage->p_cmd || !p_storage->p_filew || !p_storage->p_filer )
+    if( !p_storage->p_cmd ||
+        ( !p_storage->p_map && ( !p_storage->p_filew || !p_storage->p_filer ) ) )
     {
         TsStorageDelete( p_storage );
         return NULL;
@@ -1095,6 +1360,10 @@ static void TsStorageDelete( ts_storage_t *p_storage )
     }
     free( p_storage->p_cmd );
 
+#ifdef HAVE_MMAP
+    if( p_storage->p_map )
+        munmap( p_storage->p_map, p_storage->i_file_max );
+#endif
     if( p_storage->p_filer )
         fclose( p_storage->p_filer );
     if( p_storage->p_filew )
@@ -1124,9 +1393,10 @@ static bool TsStorageIsFull( ts_storage_t *p_storage, const ts_cmd_t *p_cmd )
 {
     if( p_cmd && p_cmd->i_type == C_SEND && p_storage->i_cmd_w > 0 )
     {
-        size_t i_size = sizeof(*p_cmd->u.send.p_block) + p_cmd->u.send.p_block->i_buffer;
+        size_t i_size = TS_RECORD_ALIGN( sizeof(ts_block_header_t) +
+                                         p_cmd->u.send.p_block->i_buffer );
 
-        if( p_storage->i_file_size + i_size >= p_storage->i_file_max )
+        if( p_storage->i_file_size + i_size > p_storage->i_file_max )
             return true;
     }
     return p_storage->i_cmd_w >= p_storage->i_cmd_max;
@@ -1144,29 +1414,45 @@ static void TsStoragePushCmd( ts_storage_t *p_storage, const ts_cmd_t *p_cmd, bo
     if( cmd.i_type == C_SEND )
     {
         block_t *p_block = cmd.u.send.p_block;
+        const ts_block_header_t header = {
+            .i_dts = p_block->i_dts,
+            .i_pts = p_block->i_pts,
+            .i_length = p_block->i_length,
+            .i_flags = p_block->i_flags,
+            .i_nb_samples = p_block->i_nb_samples,
+            .i_buffer = p_block->i_buffer,
+        };
+        const size_t i_size = TS_RECORD_ALIGN( sizeof(header) + p_block->i_buffer );
 
         cmd.u.send.p_block = NULL;
-        cmd.u.send.i_offset = ftell( p_storage->p_filew );
+        cmd.u.send.i_offset = p_storage->i_file_size;
 
-        if( fwrite( p_block, sizeof(*p_block), 1, p_storage->p_filew ) != 1 )
+        if( p_storage->p_map )
         {
-            block_Release( p_block );
-            return;
+            uint8_t *p = &p_storage->p_map[p_storage->i_file_size];
+
+            memcpy( p, &header, sizeof(header) );
+            if( p_block->i_buffer > 0 )
+                memcpy( &p[sizeof(header)], p_block->p_buffer, p_block->i_buffer );
         }
-        p_storage->i_file_size += sizeof(*p_block);
-        if( p_block->i_buffer > 0 )
+        else
         {
-            if( fwrite( p_block->p_buffer, p_block->i_buffer, 1, p_storage->p_filew ) != 1 )
+            static const uint8_t padding[8];
+
+            if( fwrite( &header, sizeof(header), 1, p_storage->p_filew ) != 1 ||
+                ( p_block->i_buffer > 0 &&
+                  fwrite( p_block->p_buffer, p_block->i_buffer, 1, p_storage->p_filew ) != 1 ) ||
+                fwrite( padding, 1, i_size - sizeof(header) - p_block->i_buffer,
+                        p_storage->p_filew ) != i_size - sizeof(header) - p_block->i_buffer )
             {
                 block_Release( p_block );
                 return;
             }
+            if( b_flush )
+                fflush( p_storage->p_filew );
         }
-        p_storage->i_file_size += p_block->i_buffer;
+        p_storage->i_file_size += i_size;
         block_Release( p_block );
-
-        if( b_flush )
-            fflush( p_storage->p_filew );
     }
     p_storage->p_cmd[p_storage->i_cmd_w++] = cmd;
 }
@@ -1174,24 +1460,46 @@ static void TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_fl
 {
     assert( !TsStorageIsEmpty( p_storage ) );
 
-    *p_cmd = p_storage->p_cmd[p_storage->i_cmd_r++];
+    ts_cmd_t *p_stored = &p_storage->p_cmd[p_storage->i_cmd_r++];
+
+    *p_cmd = *p_stored;
+    /* The stored copy does not own anything anymore */
+    if( !CmdIsReplayable( p_stored ) )
+        p_stored->i_type = C_NONE;
+
     if( p_cmd->i_type == C_SEND )
     {
-        block_t block;
+        ts_block_header_t header;
+        const uint8_t *p_data = NULL;
+
+        if( b_flush )
+            ;
+        else if( p_storage->p_map )
+        {
+            p_data = &p_storage->p_map[p_cmd->u.send.i_offset];
+            memcpy( &header, p_data, sizeof(header) );
+            p_data += sizeof(header);
+        }
+        else if( fseek( p_storage->p_filer, p_cmd->u.send.i_offset, SEEK_SET ) ||
+                 fread( &header, sizeof(header), 1, p_storage->p_filer ) != 1 )
+            b_flush = true;
 
-        if( !b_flush &&
-            !fseek( p_storage->p_filer, p_cmd->u.send.i_offset, SEEK_SET ) &&
-            fread( &block, sizeof(block), 1, p_storage->p_filer ) == 1 )
+        if( !b_flush )
         {
-            block_t *p_block = block_Alloc( block.i_buffer );
+            /* The data is copied: decoders may write into the blocks, while
+             * the window must remain intact to be replayed */
+            block_t *p_block = block_Alloc( header.i_buffer );
             if( p_block )
             {
-                p_block->i_dts      = block.i_dts;
-                p_block->i_pts      = block.i_pts;
-                p_block->i_flags    = block.i_flags;
-                p_block->i_length   = block.i_length;
-                p_block->i_nb_samples = block.i_nb_samples;
-                p_block->i_buffer = fread( p_block->p_buffer, 1, block.i_buffer, p_storage->p_filer );
+                p_block->i_dts      = header.i_dts;
+                p_block->i_pts      = header.i_pts;
+                p_block->i_flags    = header.i_flags;
+                p_block->i_length   = header.i_length;
+                p_block->i_nb_samples = header.i_nb_samples;
+                if( p_data )
+                    memcpy( p_block->p_buffer, p_data, header.i_buffer );
+                else
+                    p_block->i_buffer = fread( p_block->p_buffer, 1, header.i_buffer, p_storage->p_filer );
             }
             p_cmd->u.send.p_block = p_block;
         }
@@ -1203,9 +1511,52 @@ static void TsStoragePopCmd( ts_storage_t *p_storage, ts_cmd_t *p_cmd, bool b_fl
     }
 }
 
+static int TsStorageFind( ts_storage_t *p_storage, mtime_t i_date )
+{
+    /* The commands are sorted by date: find the first one at or after it */
+    int i_low = 0;
+    int i_high = p_storage->i_cmd_w;
+
+    while( i_low < i_high )
+    {
+        const int i_mid = i_low + ( i_high - i_low ) / 2;
+
+        if( p_storage->p_cmd[i_mid].i_date < i_date )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    return i_low;
+}
+
 /*****************************************************************************
  *
  *****************************************************************************/
+static bool CmdIsReplayable( const ts_cmd_t *p_cmd )
+{
+    /* Only what neither owns memory nor changes the ES setup is replayed
+     * after seeking back inside the timeshift window */
+    switch( p_cmd->i_type )
+    {
+    case C_SEND:
+        return true;
+    case C_CONTROL:
+        switch( p_cmd->u.control.i_query )
+        {
+        case ES_OUT_SET_PCR:
+        case ES_OUT_SET_GROUP_PCR:
+        case ES_OUT_RESET_PCR:
+        case ES_OUT_SET_TIMES:
+        case ES_OUT_SET_JITTER:
+            return true;
+        default:
+            return false;
+        }
+    default:
+        return false;
+    }
+}
+
 static void CmdClean( ts_cmd_t *p_cmd )
 {
     switch( p_cmd->i_type )
@@ -1219,6 +1570,7 @@ static void CmdClean( ts_cmd_t *p_cmd )
     case C_CONTROL:
         CmdCleanControl( p_cmd );
         break;
+    case C_NONE:
     case C_DEL:
         break;
     default:
@@ -195,6 +195,20 @@ void input_SendEventCache( input_thread_t *p_input, double f_level )
     Trigger( p_input, INPUT_EVENT_CACHE );
 }
 
+void input_SendEventIndexProgress( input_thread_t *p_input, double f_progress )
+{
+    vlc_value_t val;
+
+    /* The demuxer is polled much more often than it progresses */
+    if( var_GetFloat( p_input, "index-progress" ) == (float)f_progress )
+        return;
+
+    val.f_float = f_progress;
+    var_Change( p_input, "index-progress", VLC_VAR_SETVALUE, &val, NULL );
+
+    Trigger( p_input, INPUT_EVENT_INDEX );
+}
+
 /* FIXME: review them because vlc_event_send might be
  * moved inside input_item* functions.
  */
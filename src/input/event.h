@@ -43,6 +43,7 @@ void input_SendEventSeekpoint( input_thread_t *p_input, int i_title, int i_seekp
 void input_SendEventSignal( input_thread_t *p_input, double f_quality, double f_strength );
 void input_SendEventState( input_thread_t *p_input, int i_state );
 void input_SendEventCache( input_thread_t *p_input, double f_level );
+void input_SendEventIndexProgress( input_thread_t *p_input, double f_progress );
 
 /* TODO rename Item* */
 void input_SendEventMeta( input_thread_t *p_input );
@@ -697,6 +697,9 @@ static void MainLoop( input_thread_t *p_input, bool b_interactive )
     mtime_t i_last_seek_mdate = 0;
     bool b_pause_after_eof = b_interactive &&
                              var_CreateGetBool( p_input, "play-and-pause" );
+    const bool b_timeshift_window =
+        var_InheritInteger( p_input, "input-timeshift-window-size" ) > 0 ||
+        var_InheritInteger( p_input, "input-timeshift-window-duration" ) > 0;
 
     while( vlc_object_alive( p_input ) && !p_input->b_error )
     {
@@ -761,9 +764,12 @@ static void MainLoop( input_thread_t *p_input, bool b_interactive )
 
                 /* We will postpone the execution of a seek until we have
                  * finished the ES bufferisation (postpone is limited to
-                 * 125ms) */
+                 * 125ms). Live streams are always buffering while delayed by
+                 * a timeshift window, which seeks inside it. */
                 bool b_buffering = es_out_GetBuffering( p_input->p->p_es_out ) &&
-                                   !p_input->p->input.b_eof;
+                                   !p_input->p->input.b_eof &&
+                                   ( p_input->p->b_can_pace_control ||
+                                     !b_timeshift_window );
                 if( b_buffering )
                 {
                     /* When postpone is in order, check the ES level every 20ms */
@@ -829,6 +835,10 @@ static void InitStatistics( input_thread_t * p_input )
         INIT_COUNTER( read_packets, COUNTER );
         INIT_COUNTER( demux_read, COUNTER );
         INIT_COUNTER( input_bitrate, DERIVATIVE );
+        INIT_COUNTER( stream_cache_hits, COUNTER );
+        INIT_COUNTER( stream_cache_misses, COUNTER );
+        INIT_COUNTER( recv_packets, DERIVATIVE );
+        INIT_COUNTER( recv_syscalls, DERIVATIVE );
         INIT_COUNTER( demux_bitrate, DERIVATIVE );
         INIT_COUNTER( demux_corrupted, COUNTER );
         INIT_COUNTER( demux_discontinuity, COUNTER );
@@ -1308,6 +1318,10 @@ error:
         EXIT_COUNTER( read_packets );
         EXIT_COUNTER( demux_read );
         EXIT_COUNTER( input_bitrate );
+        EXIT_COUNTER( stream_cache_hits );
+        EXIT_COUNTER( stream_cache_misses );
+        EXIT_COUNTER( recv_packets );
+        EXIT_COUNTER( recv_syscalls );
         EXIT_COUNTER( demux_bitrate );
         EXIT_COUNTER( demux_corrupted );
         EXIT_COUNTER( demux_discontinuity );
@@ -1379,6 +1393,10 @@ static void End( input_thread_t * p_input )
             CL_CO( read_packets );
             CL_CO( demux_read );
             CL_CO( input_bitrate );
+            CL_CO( stream_cache_hits );
+            CL_CO( stream_cache_misses );
+            CL_CO( recv_packets );
+            CL_CO( recv_syscalls );
             CL_CO( demux_bitrate );
             CL_CO( demux_corrupted );
             CL_CO( demux_discontinuity );
@@ -1706,6 +1724,14 @@ static bool Control( input_thread_t *p_input,
             if( i_time < 0 )
                 i_time = 0;
 
+            /* Live streams are sought inside the timeshift window first */
+            if( !p_input->p->b_can_pace_control &&
+                !es_out_SetTime( p_input->p->p_es_out, i_time ) )
+            {
+                b_force_update = true;
+                break;
+            }
+
             /* Reset the decoders states and clock sync (before calling the demuxer */
             es_out_SetTime( p_input->p->p_es_out, -1 );
 
@@ -2163,6 +2189,14 @@ static void UpdateGenericFromDemux( input_thread_t *p_input )
         if( !demux_Control( p_demux, DEMUX_GET_SIGNAL, &quality, &strength ) )
             input_SendEventSignal( p_input, quality, strength );
     }
+    if( p_demux->info.i_update & INPUT_UPDATE_INDEX )
+    {
+        double progress;
+
+        if( !demux_Control( p_demux, DEMUX_GET_INDEX_PROGRESS, &progress ) )
+            input_SendEventIndexProgress( p_input, progress );
+        p_demux->info.i_update &= ~INPUT_UPDATE_INDEX;
+    }
 }
 
 static void UpdateTitleListfromDemux( input_thread_t *p_input )
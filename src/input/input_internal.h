@@ -137,6 +137,10 @@ struct input_thread_private_t
         counter_t *p_read_packets;
         counter_t *p_read_bytes;
         counter_t *p_input_bitrate;
+        counter_t *p_stream_cache_hits;
+        counter_t *p_stream_cache_misses;
+        counter_t *p_recv_packets;
+        counter_t *p_recv_syscalls;
         counter_t *p_demux_read;
         counter_t *p_demux_bitrate;
         counter_t *p_demux_corrupted;
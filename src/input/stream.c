@@ -61,14 +61,16 @@
 /* How many tracks we have, currently only used for stream mode */
 #ifdef OPTIMIZE_MEMORY
 #   define STREAM_CACHE_TRACK 1
-    /* Max size of our cache 128Ko per track */
-#   define STREAM_CACHE_SIZE  (STREAM_CACHE_TRACK*1024*128)
 #else
 #   define STREAM_CACHE_TRACK 3
-    /* Max size of our cache 4Mo per track */
-#   define STREAM_CACHE_SIZE  (4*STREAM_CACHE_TRACK*1024*1024)
 #endif
 
+/* The total size of the cache is set by the "stream-cache" option (in KiB),
+ * or at run time with STREAM_SET_CACHE_SIZE.
+ * A track never gets smaller than STREAM_CACHE_TRACK_MIN, so that demuxers
+ * can still peek large enough headers. */
+#define STREAM_CACHE_TRACK_MIN (64*1024)
+
 /* How many data we try to prebuffer
  * XXX it should be small to avoid useless latency but big enough for
  * efficient demux probing */
@@ -93,7 +95,14 @@
  *        - ?
  */
 #define STREAM_READ_ATONCE 1024
-#define STREAM_CACHE_TRACK_SIZE (STREAM_CACHE_SIZE/STREAM_CACHE_TRACK)
+
+/* The read-ahead starts at STREAM_READ_ATONCE * 10. It doubles each time
+ * STREAM_READAHEAD_GROW times its size has been read sequentially, up to a
+ * quarter of a track, and it halves on every seek that leaves the current
+ * track, down to STREAM_READ_ATONCE. Demuxers reading linearly thus get
+ * large access reads, while random access ones (mp4, mkv...) do not waste
+ * bandwidth on data they will never read. */
+#define STREAM_READAHEAD_GROW 4
 
 typedef struct
 {
@@ -146,16 +155,20 @@ struct stream_sys_t
         unsigned i_offset;   /* Buffer offset in the current track */
         int      i_tk;       /* Current track */
         stream_track_t tk[STREAM_CACHE_TRACK];
-
-        /* Global buffer */
-        uint8_t *p_buffer;
+        unsigned i_tk_size;  /* Size of a track buffer */
+        bool     b_whole;    /* The whole input fits in the first track */
 
         /* */
         unsigned i_used; /* Used since last read */
         unsigned i_read_size;
+        unsigned i_readahead;  /* Current read-ahead size */
+        uint64_t i_sequential; /* Read sequentially since last adaptation */
 
     } stream;
 
+    /* Cache size (both methods) */
+    uint64_t i_cache_size;
+
     /* Peek temporary buffer */
     unsigned int i_peek;
     uint8_t *p_peek;
@@ -174,6 +187,13 @@ struct stream_sys_t
         unsigned i_seek_count;
         uint64_t i_seek_time;
 
+        /* Stat about the cache, not yet reported to the input */
+        uint64_t i_cache_hits;
+        uint64_t i_cache_misses;
+
+        /* Whether the access reports its receive statistics */
+        bool b_recv_stats;
+
     } stat;
 
     /* Streams list */
@@ -187,6 +207,7 @@ struct stream_sys_t
 static int  AStreamReadBlock( stream_t *s, void *p_read, unsigned int i_read );
 static int  AStreamPeekBlock( stream_t *s, const uint8_t **p_peek, unsigned int i_read );
 static int  AStreamSeekBlock( stream_t *s, uint64_t i_pos );
+static block_t *AStreamSplitBlock( stream_t *s, unsigned int i_size );
 static void AStreamPrebufferBlock( stream_t *s );
 static block_t *AReadBlock( stream_t *s, bool *pb_eof );
 
@@ -196,6 +217,8 @@ static int  AStreamPeekStream( stream_t *s, const uint8_t **pp_peek, unsigned in
 static int  AStreamSeekStream( stream_t *s, uint64_t i_pos );
 static void AStreamPrebufferStream( stream_t *s );
 static int  AReadStream( stream_t *s, void *p_read, unsigned int i_read );
+static int  AStreamSetupStream( stream_t *s, uint64_t i_cache_size );
+static void AStreamCleanStream( stream_t *s );
 
 /* Common */
 static int AStreamControl( stream_t *s, int i_query, va_list );
@@ -306,6 +329,9 @@ stream_t *stream_AccessNew( access_t *p_access, char **ppsz_list )
     p_sys->stat.i_read_count = 0;
     p_sys->stat.i_seek_count = 0;
     p_sys->stat.i_seek_time = 0;
+    p_sys->stat.i_cache_hits = 0;
+    p_sys->stat.i_cache_misses = 0;
+    p_sys->stat.b_recv_stats = true;
 
     TAB_INIT( p_sys->i_list, p_sys->list );
     p_sys->i_list_index = 0;
@@ -362,6 +388,8 @@ stream_t *stream_AccessNew( access_t *p_access, char **ppsz_list )
     p_sys->i_peek = 0;
     p_sys->p_peek = NULL;
 
+    p_sys->i_cache_size = 1024 * (uint64_t)var_InheritInteger( s, "stream-cache" );
+
     if( p_sys->method == STREAM_METHOD_BLOCK )
     {
         msg_Dbg( s, "Using block method for AStream*" );
@@ -387,8 +415,6 @@ stream_t *stream_AccessNew( access_t *p_access, char **ppsz_list )
     }
     else
     {
-        int i;
-
         assert( p_sys->method == STREAM_METHOD_STREAM );
 
         msg_Dbg( s, "Using stream method for AStream*" );
@@ -397,25 +423,14 @@ stream_t *stream_AccessNew( access_t *p_access, char **ppsz_list )
         s->pf_peek = AStreamPeekStream;
 
         /* Allocate/Setup our tracks */
-        p_sys->stream.i_offset = 0;
-        p_sys->stream.i_tk     = 0;
-        p_sys->stream.p_buffer = malloc( STREAM_CACHE_SIZE );
-        if( p_sys->stream.p_buffer == NULL )
-            goto error;
-        p_sys->stream.i_used   = 0;
+        for( int i = 0; i < STREAM_CACHE_TRACK; i++ )
+            p_sys->stream.tk[i].p_buffer = NULL;
         p_sys->stream.i_read_size = STREAM_READ_ATONCE;
 #if STREAM_READ_ATONCE < 256
 #   error "Invalid STREAM_READ_ATONCE value"
 #endif
-
-        for( i = 0; i < STREAM_CACHE_TRACK; i++ )
-        {
-            p_sys->stream.tk[i].i_date  = 0;
-            p_sys->stream.tk[i].i_start = p_sys->i_pos;
-            p_sys->stream.tk[i].i_end   = p_sys->i_pos;
-            p_sys->stream.tk[i].p_buffer=
-                &p_sys->stream.p_buffer[i * STREAM_CACHE_TRACK_SIZE];
-        }
+        if( AStreamSetupStream( s, p_sys->i_cache_size ) )
+            goto error;
 
         /* Do the prebuffering */
         AStreamPrebufferStream( s );
@@ -436,7 +451,7 @@ error:
     }
     else
     {
-        free( p_sys->stream.p_buffer );
+        AStreamCleanStream( s );
     }
     while( p_sys->i_list > 0 )
         free( p_sys->list[--(p_sys->i_list)] );
@@ -457,7 +472,7 @@ static void AStreamDestroy( stream_t *s )
     if( p_sys->method == STREAM_METHOD_BLOCK )
         block_ChainRelease( p_sys->block.p_first );
     else
-        free( p_sys->stream.p_buffer );
+        AStreamCleanStream( s );
 
     free( p_sys->p_peek );
 
@@ -510,6 +525,7 @@ static void AStreamControlReset( stream_t *s )
         p_sys->stream.i_offset = 0;
         p_sys->stream.i_tk     = 0;
         p_sys->stream.i_used   = 0;
+        p_sys->stream.i_sequential = 0;
 
         for( i = 0; i < STREAM_CACHE_TRACK; i++ )
         {
@@ -542,6 +558,40 @@ static void AStreamControlUpdate( stream_t *s )
     }
 }
 
+/****************************************************************************
+ * AStreamControlSetCacheSize:
+ ****************************************************************************/
+static int AStreamControlSetCacheSize( stream_t *s, uint64_t i_size )
+{
+    stream_sys_t *p_sys = s->p_sys;
+
+    if( p_sys->method == STREAM_METHOD_BLOCK )
+    {
+        /* Only bounds the list of blocks, applied on the next refill */
+        p_sys->i_cache_size = i_size;
+        return VLC_SUCCESS;
+    }
+
+    /* The cached data are lost, we need to read them again */
+    bool b_aseek;
+    access_Control( p_sys->p_access, ACCESS_CAN_SEEK, &b_aseek );
+    if( !b_aseek )
+    {
+        msg_Warn( s, "cannot resize the cache (access not seekable)" );
+        return VLC_EGENERIC;
+    }
+
+    /* The current tracks are kept if the new ones cannot be allocated */
+    if( AStreamSetupStream( s, i_size ) )
+        return VLC_ENOMEM;
+    p_sys->i_cache_size = i_size;
+
+    if( ASeek( s, p_sys->i_pos ) )
+        return VLC_EGENERIC;
+    AStreamPrebufferStream( s );
+    return VLC_SUCCESS;
+}
+
 #define static_control_match(foo) \
     static_assert((unsigned) STREAM_##foo == ACCESS_##foo, "Mismatch")
 
@@ -628,6 +678,13 @@ static int AStreamControl( stream_t *s, int i_query, va_list args )
             AStreamControlUpdate( s );
             return VLC_SUCCESS;
 
+        case STREAM_GET_CACHE_SIZE:
+            *va_arg( args, uint64_t * ) = p_sys->i_cache_size;
+            break;
+
+        case STREAM_SET_CACHE_SIZE:
+            return AStreamControlSetCacheSize( s, va_arg( args, uint64_t ) );
+
         case STREAM_SET_TITLE:
         case STREAM_SET_SEEKPOINT:
         {
@@ -719,6 +776,7 @@ static int AStreamReadBlock( stream_t *s, void *p_read, unsigned int i_read )
 
     uint8_t *p_data = p_read;
     unsigned int i_data = 0;
+    bool b_miss = false;
 
     /* It means EOF */
     if( p_sys->block.p_current == NULL )
@@ -761,13 +819,19 @@ static int AStreamReadBlock( stream_t *s, void *p_read, unsigned int i_read )
                 p_sys->block.p_current = p_sys->block.p_current->p_next;
             }
             /*Get a new block if needed */
-            if( !p_sys->block.p_current && AStreamRefillBlock( s ) )
+            if( !p_sys->block.p_current )
             {
-                break;
+                b_miss = true;
+                if( AStreamRefillBlock( s ) )
+                    break;
             }
         }
     }
 
+    if( b_miss )
+        p_sys->stat.i_cache_misses++;
+    else
+        p_sys->stat.i_cache_hits++;
     p_sys->i_pos += i_data;
     return i_data;
 }
@@ -786,6 +850,7 @@ static int AStreamPeekBlock( stream_t *s, const uint8_t **pp_peek, unsigned int
     if( i_read <= p_sys->block.p_current->i_buffer - p_sys->block.i_offset )
     {
         *pp_peek = &p_sys->block.p_current->p_buffer[p_sys->block.i_offset];
+        p_sys->stat.i_cache_hits++;
         return i_read;
     }
 
@@ -802,6 +867,10 @@ static int AStreamPeekBlock( stream_t *s, const uint8_t **pp_peek, unsigned int
     }
 
     /* Fill enough data */
+    if( p_sys->block.i_size - (p_sys->i_pos - p_sys->block.i_start) < i_read )
+        p_sys->stat.i_cache_misses++;
+    else
+        p_sys->stat.i_cache_hits++;
     while( p_sys->block.i_size - (p_sys->i_pos - p_sys->block.i_start)
            < i_read )
     {
@@ -862,11 +931,13 @@ static int AStreamSeekBlock( stream_t *s, uint64_t i_pos )
         p_sys->block.i_offset = i_offset - i_current;
 
         p_sys->i_pos = i_pos;
+        p_sys->stat.i_cache_hits++;
 
         return VLC_SUCCESS;
     }
 
     /* We may need to seek or to read data */
+    p_sys->stat.i_cache_misses++;
     if( i_offset < 0 )
     {
         bool b_aseek;
@@ -904,7 +975,7 @@ static int AStreamSeekBlock( stream_t *s, uint64_t i_pos )
             int i_th = b_aseekfast ? 1 : 5;
 
             if( i_skip <= i_th * i_avg &&
-                i_skip < STREAM_CACHE_SIZE )
+                (uint64_t)i_skip < p_sys->i_cache_size )
                 b_seek = false;
             else
                 b_seek = true;
@@ -970,13 +1041,49 @@ static int AStreamSeekBlock( stream_t *s, uint64_t i_pos )
     return VLC_EGENERIC;
 }
 
+/* Gives the next bytes away without any copy, if they are all in the current
+ * memory mapped block. The cache then forgets about them and the data before
+ * them, so that the new block does not share any data with the cache. */
+static block_t *AStreamSplitBlock( stream_t *s, unsigned int i_size )
+{
+    stream_sys_t *p_sys = s->p_sys;
+    block_t *b = p_sys->block.p_current;
+
+    /* Keep the current block non-empty */
+    if( b == NULL || p_sys->block.i_offset + i_size >= b->i_buffer )
+        return NULL;
+
+    block_t *p_bk = block_mmap_Split( b, p_sys->block.i_offset + i_size );
+    if( p_bk == NULL )
+        return NULL;
+    p_bk->p_buffer += p_sys->block.i_offset;
+    p_bk->i_buffer -= p_sys->block.i_offset;
+
+    while( p_sys->block.p_first != b )
+    {
+        block_t *p_first = p_sys->block.p_first;
+
+        p_sys->block.i_start += p_first->i_buffer;
+        p_sys->block.i_size  -= p_first->i_buffer;
+        p_sys->block.p_first  = p_first->p_next;
+        block_Release( p_first );
+    }
+    p_sys->block.i_start += p_sys->block.i_offset + i_size;
+    p_sys->block.i_size  -= p_sys->block.i_offset + i_size;
+    p_sys->block.i_offset = 0;
+
+    p_sys->i_pos += i_size;
+    p_sys->stat.i_cache_hits++;
+    return p_bk;
+}
+
 static int AStreamRefillBlock( stream_t *s )
 {
     stream_sys_t *p_sys = s->p_sys;
     block_t      *b;
 
     /* Release data */
-    while( p_sys->block.i_size >= STREAM_CACHE_SIZE &&
+    while( p_sys->block.i_size >= p_sys->i_cache_size &&
            p_sys->block.p_first != p_sys->block.p_current )
     {
         block_t *b = p_sys->block.p_first;
@@ -987,7 +1094,10 @@ static int AStreamRefillBlock( stream_t *s )
 
         block_Release( b );
     }
-    if( p_sys->block.i_size >= STREAM_CACHE_SIZE &&
+    /* The whole list may have been released, if p_current was NULL */
+    if( p_sys->block.p_first == NULL )
+        p_sys->block.pp_last = &p_sys->block.p_first;
+    if( p_sys->block.i_size >= p_sys->i_cache_size &&
         p_sys->block.p_current == p_sys->block.p_first &&
         p_sys->block.p_current->p_next )    /* At least 2 packets */
     {
@@ -1039,6 +1149,74 @@ static int AStreamRefillBlock( stream_t *s )
 static int AStreamRefillStream( stream_t *s );
 static int AStreamReadNoSeekStream( stream_t *s, void *p_read, unsigned int i_read );
 
+/* Sizes the tracks for the given cache size and allocates the first one,
+ * the others are allocated on their first use. The previous tracks, if any,
+ * are only freed once the first new one is allocated. */
+static int AStreamSetupStream( stream_t *s, uint64_t i_cache_size )
+{
+    stream_sys_t *p_sys = s->p_sys;
+    uint64_t i_tk_size = i_cache_size / STREAM_CACHE_TRACK;
+
+    /* An input that fits in the cache is kept in a single track of its own
+     * size, so that the cache is never larger than the input itself. */
+    const uint64_t i_size = access_GetSize( p_sys->p_access );
+    const bool b_whole = i_size > 0 && p_sys->i_list == 0 &&
+                         i_size <= __MIN( i_cache_size, 1 << 30 );
+    if( b_whole )
+        i_tk_size = i_size;
+
+    i_tk_size = VLC_CLIP( i_tk_size, STREAM_CACHE_TRACK_MIN, 1 << 30 );
+
+    uint8_t *p_buffer = malloc( i_tk_size );
+    if( p_buffer == NULL )
+        return VLC_ENOMEM;
+    AStreamCleanStream( s );
+
+    p_sys->stream.i_tk_size = i_tk_size;
+    p_sys->stream.b_whole = b_whole;
+
+    p_sys->stream.i_offset = 0;
+    p_sys->stream.i_tk     = 0;
+    p_sys->stream.i_used   = 0;
+    p_sys->stream.i_readahead = __MIN( STREAM_READ_ATONCE * 10, i_tk_size / 4 );
+    p_sys->stream.i_sequential = 0;
+
+    for( int i = 0; i < STREAM_CACHE_TRACK; i++ )
+    {
+        p_sys->stream.tk[i].i_date  = 0;
+        p_sys->stream.tk[i].i_start = p_sys->i_pos;
+        p_sys->stream.tk[i].i_end   = p_sys->i_pos;
+        p_sys->stream.tk[i].p_buffer= NULL;
+    }
+    p_sys->stream.tk[0].p_buffer = p_buffer;
+
+    msg_Dbg( s, "using %d tracks of %u KiB",
+             p_sys->stream.b_whole ? 1 : STREAM_CACHE_TRACK,
+             p_sys->stream.i_tk_size / 1024 );
+    return VLC_SUCCESS;
+}
+
+static void AStreamCleanStream( stream_t *s )
+{
+    stream_sys_t *p_sys = s->p_sys;
+
+    for( int i = 0; i < STREAM_CACHE_TRACK; i++ )
+    {
+        free( p_sys->stream.tk[i].p_buffer );
+        p_sys->stream.tk[i].p_buffer = NULL;
+    }
+}
+
+/* Called when the demuxer jumps out of the current track */
+static void AStreamShrinkReadAhead( stream_t *s )
+{
+    stream_sys_t *p_sys = s->p_sys;
+
+    p_sys->stream.i_readahead = __MAX( p_sys->stream.i_readahead / 2,
+                                       STREAM_READ_ATONCE );
+    p_sys->stream.i_sequential = 0;
+}
+
 static int AStreamReadStream( stream_t *s, void *p_read, unsigned int i_read )
 {
     stream_sys_t *p_sys = s->p_sys;
@@ -1072,9 +1250,18 @@ static int AStreamPeekStream( stream_t *s, const uint8_t **pp_peek, unsigned int
              tk->i_start, p_sys->stream.i_offset, tk->i_end );
 #endif
 
-    /* Avoid problem, but that should *never* happen */
-    if( i_read > STREAM_CACHE_TRACK_SIZE / 2 )
-        i_read = STREAM_CACHE_TRACK_SIZE / 2;
+    /* Avoid problem, but that should *never* happen. A whole input never
+     * slides out of its track, which can then be peeked up to its end. */
+    const unsigned i_peek_max = p_sys->stream.b_whole
+        ? p_sys->stream.i_tk_size - p_sys->stream.i_offset
+        : p_sys->stream.i_tk_size / 2;
+    if( i_read > i_peek_max )
+        i_read = i_peek_max;
+
+    if( tk->i_end >= tk->i_start + p_sys->stream.i_offset + i_read )
+        p_sys->stat.i_cache_hits++;
+    else
+        p_sys->stat.i_cache_misses++;
 
     while( tk->i_end < tk->i_start + p_sys->stream.i_offset + i_read )
     {
@@ -1093,8 +1280,8 @@ static int AStreamPeekStream( stream_t *s, const uint8_t **pp_peek, unsigned int
 
 
     /* Now, direct pointer or a copy ? */
-    i_off = (tk->i_start + p_sys->stream.i_offset) % STREAM_CACHE_TRACK_SIZE;
-    if( i_off + i_read <= STREAM_CACHE_TRACK_SIZE )
+    i_off = (tk->i_start + p_sys->stream.i_offset) % p_sys->stream.i_tk_size;
+    if( i_off + i_read <= p_sys->stream.i_tk_size )
     {
         *pp_peek = &tk->p_buffer[i_off];
         return i_read;
@@ -1112,9 +1299,9 @@ static int AStreamPeekStream( stream_t *s, const uint8_t **pp_peek, unsigned int
     }
 
     memcpy( p_sys->p_peek, &tk->p_buffer[i_off],
-            STREAM_CACHE_TRACK_SIZE - i_off );
-    memcpy( &p_sys->p_peek[STREAM_CACHE_TRACK_SIZE - i_off],
-            &tk->p_buffer[0], i_read - (STREAM_CACHE_TRACK_SIZE - i_off) );
+            p_sys->stream.i_tk_size - i_off );
+    memcpy( &p_sys->p_peek[p_sys->stream.i_tk_size - i_off],
+            &tk->p_buffer[0], i_read - (p_sys->stream.i_tk_size - i_off) );
 
     *pp_peek = p_sys->p_peek;
     return i_read;
@@ -1170,6 +1357,12 @@ static int AStreamSeekStream( stream_t *s, uint64_t i_pos )
         tk = p_current;
         i_tk_idx = p_sys->stream.i_tk;
     }
+    /* A whole input only uses its first track */
+    if( !tk && p_sys->stream.b_whole )
+    {
+        tk = p_current;
+        i_tk_idx = p_sys->stream.i_tk;
+    }
     if( !tk )
     {
         /* Try to maximize already read data */
@@ -1203,6 +1396,14 @@ static int AStreamSeekStream( stream_t *s, uint64_t i_pos )
     }
     assert( i_tk_idx >= 0 && i_tk_idx < STREAM_CACHE_TRACK );
 
+    /* Tracks are only allocated once they are needed */
+    if( tk->p_buffer == NULL )
+    {
+        tk->p_buffer = malloc( p_sys->stream.i_tk_size );
+        if( tk->p_buffer == NULL )
+            return VLC_ENOMEM;
+    }
+
     if( tk != p_current )
         i_skip_threshold = 0;
     if( tk->i_start <= i_pos && i_pos <= tk->i_end + i_skip_threshold )
@@ -1216,6 +1417,7 @@ static int AStreamSeekStream( stream_t *s, uint64_t i_pos )
         if( tk != p_current )
         {
             assert( b_aseek );
+            AStreamShrinkReadAhead( s );
 
             /* Seek at the end of the buffer
              * TODO it is stupid to seek now, it would be better to delay it
@@ -1243,6 +1445,8 @@ static int AStreamSeekStream( stream_t *s, uint64_t i_pos )
         /* Nothing good, seek and choose oldest segment */
         if( ASeek( s, i_pos ) )
             return VLC_EGENERIC;
+        AStreamShrinkReadAhead( s );
+        p_sys->stat.i_cache_misses++;
 
         tk->i_start = i_pos;
         tk->i_end   = i_pos;
@@ -1250,6 +1454,8 @@ static int AStreamSeekStream( stream_t *s, uint64_t i_pos )
     p_sys->stream.i_offset = i_pos - tk->i_start;
     p_sys->stream.i_tk = i_tk_idx;
     p_sys->i_pos = i_pos;
+    if( tk->i_end > i_pos )
+        p_sys->stat.i_cache_hits++;
 
     /* If there is not enough data left in the track, refill  */
     /* TODO How to get a correct value for
@@ -1274,6 +1480,7 @@ static int AStreamReadNoSeekStream( stream_t *s, void *p_read, unsigned int i_re
 
     uint8_t *p_data = (uint8_t *)p_read;
     unsigned int i_data = 0;
+    bool b_miss = false;
 
     if( tk->i_start >= tk->i_end )
         return 0; /* EOF */
@@ -1287,10 +1494,10 @@ static int AStreamReadNoSeekStream( stream_t *s, void *p_read, unsigned int i_re
 
     while( i_data < i_read )
     {
-        unsigned i_off = (tk->i_start + p_sys->stream.i_offset) % STREAM_CACHE_TRACK_SIZE;
+        unsigned i_off = (tk->i_start + p_sys->stream.i_offset) % p_sys->stream.i_tk_size;
         unsigned int i_current =
             __MIN( tk->i_end - tk->i_start - p_sys->stream.i_offset,
-                   STREAM_CACHE_TRACK_SIZE - i_off );
+                   p_sys->stream.i_tk_size - i_off );
         int i_copy = __MIN( i_current, i_read - i_data );
 
         if( i_copy <= 0 ) break; /* EOF */
@@ -1315,11 +1522,12 @@ static int AStreamReadNoSeekStream( stream_t *s, void *p_read, unsigned int i_re
         {
             const unsigned i_read_requested = VLC_CLIP( i_read - i_data,
                                                     STREAM_READ_ATONCE / 2,
-                                                    STREAM_READ_ATONCE * 10 );
+                                                    p_sys->stream.i_readahead );
 
             if( p_sys->stream.i_used < i_read_requested )
                 p_sys->stream.i_used = i_read_requested;
 
+            b_miss = true;
             if( AStreamRefillStream( s ) )
             {
                 /* EOF */
@@ -1328,6 +1536,10 @@ static int AStreamReadNoSeekStream( stream_t *s, void *p_read, unsigned int i_re
         }
     }
 
+    if( b_miss )
+        p_sys->stat.i_cache_misses++;
+    else
+        p_sys->stat.i_cache_hits++;
     return i_data;
 }
 
@@ -1339,7 +1551,7 @@ static int AStreamRefillStream( stream_t *s )
 
     /* We read but won't increase i_start after initial start + offset */
     int i_toread =
-        __MIN( p_sys->stream.i_used, STREAM_CACHE_TRACK_SIZE -
+        __MIN( p_sys->stream.i_used, p_sys->stream.i_tk_size -
                (tk->i_end - tk->i_start - p_sys->stream.i_offset) );
     bool b_read = false;
     int64_t i_start, i_stop;
@@ -1354,13 +1566,13 @@ static int AStreamRefillStream( stream_t *s )
     i_start = mdate();
     while( i_toread > 0 )
     {
-        int i_off = tk->i_end % STREAM_CACHE_TRACK_SIZE;
+        int i_off = tk->i_end % p_sys->stream.i_tk_size;
         int i_read;
 
         if( !vlc_object_alive(s) )
             return VLC_EGENERIC;
 
-        i_read = __MIN( i_toread, STREAM_CACHE_TRACK_SIZE - i_off );
+        i_read = __MIN( i_toread, p_sys->stream.i_tk_size - i_off );
         i_read = AReadStream( s, &tk->p_buffer[i_off], i_read );
 
         /* msg_Dbg( s, "AStreamRefillStream: read=%d", i_read ); */
@@ -1379,10 +1591,10 @@ static int AStreamRefillStream( stream_t *s )
         /* Update end */
         tk->i_end += i_read;
 
-        /* Windows of STREAM_CACHE_TRACK_SIZE */
-        if( tk->i_start + STREAM_CACHE_TRACK_SIZE < tk->i_end )
+        /* Windows of p_sys->stream.i_tk_size */
+        if( tk->i_start + p_sys->stream.i_tk_size < tk->i_end )
         {
-            unsigned i_invalid = tk->i_end - tk->i_start - STREAM_CACHE_TRACK_SIZE;
+            unsigned i_invalid = tk->i_end - tk->i_start - p_sys->stream.i_tk_size;
 
             tk->i_start += i_invalid;
             p_sys->stream.i_offset -= i_invalid;
@@ -1393,11 +1605,25 @@ static int AStreamRefillStream( stream_t *s )
 
         p_sys->stat.i_bytes += i_read;
         p_sys->stat.i_read_count++;
+        p_sys->stream.i_sequential += i_read;
     }
     i_stop = mdate();
 
     p_sys->stat.i_read_time += i_stop - i_start;
 
+    /* Sustained sequential reading: read more at once */
+    if( p_sys->stream.i_sequential >=
+            STREAM_READAHEAD_GROW * (uint64_t)p_sys->stream.i_readahead &&
+        p_sys->stream.i_readahead < p_sys->stream.i_tk_size / 4 )
+    {
+        p_sys->stream.i_readahead = __MIN( 2 * p_sys->stream.i_readahead,
+                                           p_sys->stream.i_tk_size / 4 );
+        p_sys->stream.i_sequential = 0;
+#ifdef STREAM_DEBUG
+        msg_Dbg( s, "read-ahead increased to %u", p_sys->stream.i_readahead );
+#endif
+    }
+
     return VLC_SUCCESS;
 }
 
@@ -1437,9 +1663,10 @@ static void AStreamPrebufferStream( stream_t *s )
         }
 
         /* */
-        i_read = STREAM_CACHE_TRACK_SIZE - i_buffered;
+        const unsigned i_off = tk->i_end % p_sys->stream.i_tk_size;
+        i_read = p_sys->stream.i_tk_size - i_off;
         i_read = __MIN( (int)p_sys->stream.i_read_size, i_read );
-        i_read = AReadStream( s, &tk->p_buffer[i_buffered], i_read );
+        i_read = AReadStream( s, &tk->p_buffer[i_off], i_read );
         if( i_read <  0 )
             continue;
         else if( i_read == 0 )
@@ -1652,6 +1879,39 @@ error:
 /****************************************************************************
  * Access reading/seeking wrappers to handle concatenated streams.
  ****************************************************************************/
+/* Reports the cache statistics, counters_lock must be held */
+static void AStreamUpdateCacheStats( stream_t *s )
+{
+    stream_sys_t *p_sys = s->p_sys;
+    input_thread_t *p_input = s->p_input;
+
+    stats_Update( p_input->p->counters.p_stream_cache_hits,
+                  p_sys->stat.i_cache_hits, NULL );
+    stats_Update( p_input->p->counters.p_stream_cache_misses,
+                  p_sys->stat.i_cache_misses, NULL );
+    p_sys->stat.i_cache_hits = 0;
+    p_sys->stat.i_cache_misses = 0;
+}
+
+/* Reports the receive statistics of the access, counters_lock must be held */
+static void AStreamUpdateRecvStats( stream_t *s, access_t *p_access )
+{
+    stream_sys_t *p_sys = s->p_sys;
+    input_thread_t *p_input = s->p_input;
+    uint64_t i_packets, i_syscalls;
+
+    if( !p_sys->stat.b_recv_stats )
+        return;
+    if( access_Control( p_access, ACCESS_GET_RECV_STATS,
+                        &i_packets, &i_syscalls ) )
+    {
+        p_sys->stat.b_recv_stats = false;
+        return;
+    }
+    stats_Update( p_input->p->counters.p_recv_packets, i_packets, NULL );
+    stats_Update( p_input->p->counters.p_recv_syscalls, i_syscalls, NULL );
+}
+
 static int AReadStream( stream_t *s, void *p_read, unsigned int i_read )
 {
     stream_sys_t *p_sys = s->p_sys;
@@ -1670,6 +1930,7 @@ static int AReadStream( stream_t *s, void *p_read, unsigned int i_read )
             stats_Update( p_input->p->counters.p_read_bytes, i_read, &total );
             stats_Update( p_input->p->counters.p_input_bitrate, total, NULL );
             stats_Update( p_input->p->counters.p_read_packets, 1, NULL );
+            AStreamUpdateCacheStats( s );
             vlc_mutex_unlock( &p_input->p->counters.counters_lock );
         }
         return i_read;
@@ -1708,6 +1969,7 @@ static int AReadStream( stream_t *s, void *p_read, unsigned int i_read )
         stats_Update( p_input->p->counters.p_read_bytes, i_read, &total );
         stats_Update( p_input->p->counters.p_input_bitrate, total, NULL );
         stats_Update( p_input->p->counters.p_read_packets, 1, NULL );
+        AStreamUpdateCacheStats( s );
         vlc_mutex_unlock( &p_input->p->counters.counters_lock );
     }
     return i_read;
@@ -1735,6 +1997,8 @@ static block_t *AReadBlock( stream_t *s, bool *pb_eof )
             stats_Update( p_input->p->counters.p_input_bitrate,
                           total, NULL );
             stats_Update( p_input->p->counters.p_read_packets, 1, NULL );
+            AStreamUpdateCacheStats( s );
+            AStreamUpdateRecvStats( s, p_access );
             vlc_mutex_unlock( &p_input->p->counters.counters_lock );
         }
         return p_block;
@@ -1775,6 +2039,8 @@ static block_t *AReadBlock( stream_t *s, bool *pb_eof )
                           p_block->i_buffer, &total );
             stats_Update( p_input->p->counters.p_input_bitrate, total, NULL );
             stats_Update( p_input->p->counters.p_read_packets, 1 , NULL);
+            AStreamUpdateCacheStats( s );
+            AStreamUpdateRecvStats( s, p_sys->p_list_access );
             vlc_mutex_unlock( &p_input->p->counters.counters_lock );
         }
     }
@@ -1903,6 +2169,13 @@ block_t *stream_Block( stream_t *s, int i_size )
 {
     if( i_size <= 0 ) return NULL;
 
+    if( s->pf_read == AStreamReadBlock )
+    {
+        block_t *p_bk = AStreamSplitBlock( s, i_size );
+        if( p_bk != NULL )
+            return p_bk;
+    }
+
     /* emulate block read */
     block_t *p_bk = block_Alloc( i_size );
     if( p_bk )
@@ -384,6 +384,19 @@ static const char *const ppsz_pos_descriptions[] =
     "picture quality, for instance deinterlacing, or distort " \
     "the video.")
 
+#define VIDEO_FILTER_THREADS_TEXT N_("Video filter threads")
+#define VIDEO_FILTER_THREADS_LONGTEXT N_( \
+    "Number of threads running the video filters, so that a chain of " \
+    "filters is spread over several processors. Interactive filters are " \
+    "then only updated with new pictures, not while paused. " \
+    "0 runs the filters on the video output thread.")
+
+#define VIDEO_FILTER_SLICE_THREADS_TEXT N_("Video filter slice threads")
+#define VIDEO_FILTER_SLICE_THREADS_LONGTEXT N_( \
+    "Number of threads sharing each picture in the video filters that " \
+    "support it, such as the denoisers and the deinterlacers. " \
+    "0 uses one thread per processor, 1 disables slicing.")
+
 #define SNAP_PATH_TEXT N_("Video snapshot directory (or filename)")
 #define SNAP_PATH_LONGTEXT N_( \
     "Directory where the video snapshots will be stored.")
@@ -512,6 +525,17 @@ static const char *const ppsz_pos_descriptions[] =
 #define NETWORK_CACHING_LONGTEXT N_( \
     "Caching value for network resources, in milliseconds." )
 
+#define STREAM_CACHE_TEXT N_("Stream cache size (KiB)")
+#define STREAM_CACHE_LONGTEXT N_( \
+    "Amount of memory used to cache the data read from an input, in " \
+    "kibibytes. It is shared between the read-ahead and the data kept for " \
+    "backward seeks, and is never larger than the input itself." )
+#ifdef OPTIMIZE_MEMORY
+# define STREAM_CACHE_DEFAULT 128
+#else
+# define STREAM_CACHE_DEFAULT 12288
+#endif
+
 #define CR_AVERAGE_TEXT N_("Clock reference average counter")
 #define CR_AVERAGE_LONGTEXT N_( \
     "When using the PVR input (or a very irregular source), you should " \
@@ -641,6 +665,12 @@ static const char *const ppsz_prefres[] = {
 #define INPUT_FAST_SEEK_LONGTEXT N_( \
     "Favor speed over precision while seeking" )
 
+#define INPUT_SEEK_INDEX_TEXT N_("Keep seek indexes")
+#define INPUT_SEEK_INDEX_LONGTEXT N_( \
+    "Keep the seek index built while playing a file in the cache " \
+    "directory, so that opening and seeking the same file again do not " \
+    "need to search through it. Only some demuxers use it." )
+
 #define INPUT_RATE_TEXT N_("Playback speed")
 #define INPUT_RATE_LONGTEXT N_( \
     "This defines the playback speed (nominal speed is 1.0)." )
@@ -680,6 +710,16 @@ static const char *const ppsz_prefres[] = {
     "This is the maximum size in bytes of the temporary files " \
     "that will be used to store the timeshifted streams." )
 
+#define INPUT_TIMESHIFT_WINDOW_SIZE_TEXT N_("Timeshift window size (MiB)")
+#define INPUT_TIMESHIFT_WINDOW_SIZE_LONGTEXT N_( \
+    "Amount of already played data kept on disk, so that live streams " \
+    "can be sought back. 0 keeps no data unless a window duration is set." )
+
+#define INPUT_TIMESHIFT_WINDOW_DURATION_TEXT N_("Timeshift window duration (seconds)")
+#define INPUT_TIMESHIFT_WINDOW_DURATION_LONGTEXT N_( \
+    "Duration of already played data kept on disk, so that live streams " \
+    "can be sought back. 0 keeps no data unless a window size is set." )
+
 #define INPUT_TITLE_FORMAT_TEXT N_( "Change title according to current media" )
 #define INPUT_TITLE_FORMAT_LONGTEXT N_( "This option allows you to set the title according to what's being played<br>"  \
     "$a: Artist<br>$b: Album<br>$c: Copyright<br>$t: Title<br>$g: Genre<br>"  \
@@ -1038,6 +1078,11 @@ static const char *const ppsz_prefres[] = {
 #define PLUGINS_CACHE_LONGTEXT N_( \
     "Use a plugins cache which will greatly improve the startup time of VLC.")
 
+#define PLUGINS_CACHE_MMAP_TEXT N_("Memory-map the plugins cache")
+#define PLUGINS_CACHE_MMAP_LONGTEXT N_( \
+    "Write the plugins cache in a format that is mapped in memory as is, " \
+    "rather than parsed, when VLC starts.")
+
 #define STATS_TEXT N_("Locally collect statistics")
 #define STATS_LONGTEXT N_( \
      "Collect miscellaneous local statistics about the playing media.")
@@ -1607,6 +1652,13 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_VIDEO_VFILTER )
     add_module_list_cat( "video-filter", SUBCAT_VIDEO_VFILTER, NULL,
                 VIDEO_FILTER_TEXT, VIDEO_FILTER_LONGTEXT, false )
+    add_integer( "video-filter-threads", 0, VIDEO_FILTER_THREADS_TEXT,
+                 VIDEO_FILTER_THREADS_LONGTEXT, true )
+        change_integer_range( 0, 16 )
+    add_integer( "video-filter-slice-threads", 0,
+                 VIDEO_FILTER_SLICE_THREADS_TEXT,
+                 VIDEO_FILTER_SLICE_THREADS_LONGTEXT, true )
+        change_integer_range( 0, 16 )
     add_module_list( "video-splitter", "video splitter", NULL,
                      VIDEO_SPLITTER_TEXT, VIDEO_SPLITTER_LONGTEXT, false )
     add_obsolete_string( "vout-filter" ) /* since 2.0.0 */
@@ -1704,6 +1756,8 @@ vlc_module_begin ()
     add_bool( "input-fast-seek", false,
               INPUT_FAST_SEEK_TEXT, INPUT_FAST_SEEK_LONGTEXT, false )
         change_safe ()
+    add_bool( "input-seek-index", false,
+              INPUT_SEEK_INDEX_TEXT, INPUT_SEEK_INDEX_LONGTEXT, true )
     add_float( "rate", 1.,
                INPUT_RATE_TEXT, INPUT_RATE_LONGTEXT, false )
 
@@ -1832,6 +1886,10 @@ vlc_module_begin ()
     add_obsolete_integer( "smb-caching" ) /* 2.0.0 */
     add_obsolete_integer( "tcp-caching" ) /* 2.0.0 */
     add_obsolete_integer( "udp-caching" ) /* 2.0.0 */
+    add_integer( "stream-cache", STREAM_CACHE_DEFAULT,
+                 STREAM_CACHE_TEXT, STREAM_CACHE_LONGTEXT, true )
+        change_integer_range( 64, 1024 * 1024 )
+        change_safe()
 
     add_integer( "cr-average", 40, CR_AVERAGE_TEXT,
                  CR_AVERAGE_LONGTEXT, true )
@@ -1854,6 +1912,10 @@ vlc_module_begin ()
                 INPUT_TIMESHIFT_PATH_LONGTEXT, true )
     add_integer( "input-timeshift-granularity", -1, INPUT_TIMESHIFT_GRANULARITY_TEXT,
                  INPUT_TIMESHIFT_GRANULARITY_LONGTEXT, true )
+    add_integer( "input-timeshift-window-size", 0, INPUT_TIMESHIFT_WINDOW_SIZE_TEXT,
+                 INPUT_TIMESHIFT_WINDOW_SIZE_LONGTEXT, true )
+    add_integer( "input-timeshift-window-duration", 0, INPUT_TIMESHIFT_WINDOW_DURATION_TEXT,
+                 INPUT_TIMESHIFT_WINDOW_DURATION_LONGTEXT, true )
 
     add_string( "input-title-format", "$Z", INPUT_TITLE_FORMAT_TEXT, INPUT_TITLE_FORMAT_LONGTEXT, false );
 
@@ -1956,6 +2018,8 @@ vlc_module_begin ()
     set_section( N_("Plugins" ), NULL )
     add_bool( "plugins-cache", true, PLUGINS_CACHE_TEXT,
               PLUGINS_CACHE_LONGTEXT, true )
+    add_bool( "plugins-cache-mmap", true, PLUGINS_CACHE_MMAP_TEXT,
+              PLUGINS_CACHE_MMAP_LONGTEXT, true )
     add_obsolete_string( "plugin-path" ) /* since 2.0.0 */
     add_obsolete_string( "data-path" ) /* since 2.1.0 */
 
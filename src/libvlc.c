@@ -59,6 +59,7 @@
 
 #include <vlc_playlist.h>
 #include <vlc_interface.h>
+#include <vlc_picture.h>
 
 #include <vlc_charset.h>
 #include <vlc_fs.h>
@@ -102,6 +103,7 @@ libvlc_int_t * libvlc_InternalCreate( void )
     priv->playlist = NULL;
     priv->p_dialog_provider = NULL;
     priv->p_vlm = NULL;
+    priv->slicer = NULL;
 
     vlc_ExitInit( &priv->exit );
 
@@ -551,9 +553,14 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
     if( !var_InheritBool( p_libvlc, "ignore-config" ) )
         config_AutoSaveConfigFile( VLC_OBJECT(p_libvlc) );
 
+    filter_SlicerDestroy( p_libvlc );
+
     /* Free module bank. It is refcounted, so we call this each time  */
     module_EndBank (true);
     vlc_LogDeinit (p_libvlc);
+
+    /* Free the picture buffers kept for reuse */
+    picture_CacheTrim (0);
 #if defined(_WIN32) || defined(__OS2__)
     system_End( );
 #endif
@@ -126,6 +126,11 @@ void vlc_object_set_destructor (vlc_object_t *, vlc_destructor_t);
 #define vlc_object_set_destructor(a,b) \
         vlc_object_set_destructor (VLC_OBJECT(a), b)
 
+/*
+ * Blocks
+ */
+block_t *block_mmap_Split (block_t *, size_t);
+
 /*
  * To be cleaned-up module stuff:
  */
@@ -165,6 +170,7 @@ typedef struct libvlc_priv_t
     struct playlist_t *playlist; ///< Playlist for interfaces
     struct playlist_preparser_t *parser; ///< Input item meta data handler
     struct vlc_actions *actions; ///< Hotkeys handler
+    struct filter_slicer_t *slicer; ///< Video filter slice threads (or NULL)
 
     /* Objects tree */
     vlc_mutex_t        structure_lock;
@@ -178,6 +184,11 @@ static inline libvlc_priv_t *libvlc_priv (libvlc_int_t *libvlc)
     return (libvlc_priv_t *)libvlc;
 }
 
+/*
+ * Video filter slices
+ */
+void filter_SlicerDestroy( libvlc_int_t * );
+
 void intf_InsertItem(libvlc_int_t *, const char *mrl, unsigned optc,
                      const char * const *optv, unsigned flags);
 void intf_DestroyAll( libvlc_int_t * );
@@ -37,6 +37,8 @@
 #include <vlc_common.h>
 #include <vlc_block.h>
 #include <vlc_fs.h>
+#include <vlc_atomic.h>
+#include "../libvlc.h"
 
 /**
  * @section Block handling functions.
@@ -126,17 +128,293 @@ static void BlockMetaCopy( block_t *restrict out, const block_t *in )
 /* Maximum size of reserved footer before shrinking with realloc(). */
 #define BLOCK_WASTE_SIZE   2048
 
+/**
+ * @section Block memory cache
+ *
+ * Most blocks are allocated with one of a handful of sizes (TS cells, UDP
+ * datagrams, audio buffers...), and released shortly afterwards, often by
+ * another thread. Such blocks are recycled through a small per-thread cache
+ * backed by a shared depot, rather than going back to the heap allocator.
+ */
+
+/** Payload size classes. Larger blocks always go to the heap. */
+static const size_t block_classes[] = {
+    188, 1316, 4096, 16384, 65536,
+};
+#define BLOCK_CLASSES (sizeof (block_classes) / sizeof (block_classes[0]))
+
+/** Maximum number of cached blocks per class in each thread. */
+#define BLOCK_CACHE_DEPTH  32
+/** Number of blocks moved at once between a thread cache and the depot. */
+#define BLOCK_CACHE_BATCH  (BLOCK_CACHE_DEPTH / 2)
+/** Maximum number of bytes held by the shared depot per class. */
+#define BLOCK_DEPOT_SIZE   (4 << 20)
+/** Number of allocations between two statistics updates of a thread. */
+#define BLOCK_CACHE_SYNC   1024
+
+/** Buffer bytes reserved on top of the payload capacity of a block. */
+#define BLOCK_OVERHEAD     (BLOCK_ALIGN + (2 * BLOCK_PADDING))
+
+typedef struct
+{
+    block_t *list[BLOCK_CLASSES]; /**< Cached blocks (linked by p_next) */
+    unsigned count[BLOCK_CLASSES];
+    /* Statistics not yet published to block_depot. Resident bytes cover
+     * both the thread caches and the depot, so moving blocks from one to
+     * the other does not affect them. */
+    unsigned hits;
+    unsigned misses;
+    ssize_t resident;
+} block_cache_t;
+
+static struct
+{
+    vlc_mutex_t lock;
+    block_t *list[BLOCK_CLASSES];
+    unsigned count[BLOCK_CLASSES];
+    vlc_threadvar_t key;
+    atomic_bool key_ready;
+    atomic_uint_least64_t hits;
+    atomic_uint_least64_t misses;
+    atomic_size_t resident;
+} block_depot = { .lock = VLC_STATIC_MUTEX };
+
+static unsigned block_class_Find (size_t size)
+{
+    unsigned i = 0;
+
+    while (i < BLOCK_CLASSES && block_classes[i] < size)
+        i++;
+    return i;
+}
+
+/** Returns the buffer size that block_Alloc() would use for a payload. */
+static size_t block_class_BufferSize (size_t size)
+{
+    unsigned i = block_class_Find (size);
+
+    if (i < BLOCK_CLASSES)
+        size = block_classes[i];
+    return size + BLOCK_OVERHEAD;
+}
+
+/** Publishes the thread statistics to the depot. */
+static void block_cache_Sync (block_cache_t *cache)
+{
+    atomic_fetch_add (&block_depot.hits, cache->hits);
+    atomic_fetch_add (&block_depot.misses, cache->misses);
+    if (cache->resident >= 0)
+        atomic_fetch_add (&block_depot.resident, cache->resident);
+    else
+        atomic_fetch_sub (&block_depot.resident, -cache->resident);
+    cache->hits = cache->misses = 0;
+    cache->resident = 0;
+}
+
+/** Moves the given chain of blocks to the depot, freeing the excess. */
+static void block_depot_Put (unsigned i, block_t *list)
+{
+    const unsigned max = BLOCK_DEPOT_SIZE / block_classes[i];
+    size_t freed = 0;
+
+    vlc_mutex_lock (&block_depot.lock);
+    while (list != NULL && block_depot.count[i] < max)
+    {
+        block_t *b = list;
+
+        list = b->p_next;
+        b->p_next = block_depot.list[i];
+        block_depot.list[i] = b;
+        block_depot.count[i]++;
+    }
+    vlc_mutex_unlock (&block_depot.lock);
+
+    while (list != NULL)
+    {
+        block_t *b = list;
+
+        list = b->p_next;
+        freed += sizeof (*b) + b->i_size;
+        free (b);
+    }
+    if (freed > 0)
+        atomic_fetch_sub (&block_depot.resident, freed);
+}
+
+static void block_cache_Destroy (void *data)
+{
+    block_cache_t *cache = data;
+
+    for (unsigned i = 0; i < BLOCK_CLASSES; i++)
+        if (cache->list[i] != NULL)
+            block_depot_Put (i, cache->list[i]);
+    block_cache_Sync (cache);
+    free (cache);
+}
+
+/** Gets the cache of the calling thread, creating it if needed. */
+static block_cache_t *block_cache_Get (void)
+{
+    if (unlikely(!atomic_load_explicit (&block_depot.key_ready,
+                                        memory_order_acquire)))
+    {
+        vlc_mutex_lock (&block_depot.lock);
+        if (!atomic_load_explicit (&block_depot.key_ready,
+                                   memory_order_relaxed))
+        {
+            if (vlc_threadvar_create (&block_depot.key, block_cache_Destroy))
+            {
+                vlc_mutex_unlock (&block_depot.lock);
+                return NULL;
+            }
+            atomic_store_explicit (&block_depot.key_ready, true,
+                                   memory_order_release);
+        }
+        vlc_mutex_unlock (&block_depot.lock);
+    }
+
+    block_cache_t *cache = vlc_threadvar_get (block_depot.key);
+    if (likely(cache != NULL))
+        return cache;
+
+    cache = calloc (1, sizeof (*cache));
+    if (unlikely(cache == NULL))
+        return NULL;
+    if (vlc_threadvar_set (block_depot.key, cache))
+    {
+        free (cache);
+        return NULL;
+    }
+    return cache;
+}
+
+static void block_cache_Release (block_t *block)
+{
+    unsigned i = block_class_Find (block->i_size - BLOCK_OVERHEAD);
+
+    assert (block->p_start == (unsigned char *)(block + 1));
+    assert (i < BLOCK_CLASSES);
+    assert (block->i_size == block_classes[i] + BLOCK_OVERHEAD);
+    block_Invalidate (block);
+
+    block_cache_t *cache = block_cache_Get ();
+    if (unlikely(cache == NULL))
+    {
+        free (block);
+        return;
+    }
+
+    block->p_next = cache->list[i];
+    cache->list[i] = block;
+    cache->resident += sizeof (*block) + block->i_size;
+
+    if (++cache->count[i] > BLOCK_CACHE_DEPTH)
+    {   /* Hand the oldest half of the cache over to the depot */
+        block_t **pp = &cache->list[i];
+
+        for (unsigned n = 0; n < BLOCK_CACHE_DEPTH - BLOCK_CACHE_BATCH; n++)
+            pp = &(*pp)->p_next;
+
+        block_t *list = *pp;
+
+        *pp = NULL;
+        cache->count[i] = BLOCK_CACHE_DEPTH - BLOCK_CACHE_BATCH;
+        block_cache_Sync (cache);
+        block_depot_Put (i, list);
+    }
+}
+
+/** Allocates a block of the given class from the cache, if possible. */
+static block_t *block_cache_Alloc (unsigned i)
+{
+    block_cache_t *cache = block_cache_Get ();
+    if (unlikely(cache == NULL))
+        return NULL;
+
+    const size_t size = sizeof (block_t) + BLOCK_OVERHEAD + block_classes[i];
+
+    if (cache->list[i] == NULL)
+    {   /* Refill the thread cache from the depot */
+        block_t *list = NULL;
+        unsigned count = 0;
+
+        vlc_mutex_lock (&block_depot.lock);
+        while (count < BLOCK_CACHE_BATCH && block_depot.list[i] != NULL)
+        {
+            block_t *b = block_depot.list[i];
+
+            block_depot.list[i] = b->p_next;
+            b->p_next = list;
+            list = b;
+            count++;
+        }
+        block_depot.count[i] -= count;
+        vlc_mutex_unlock (&block_depot.lock);
+
+        cache->list[i] = list;
+        cache->count[i] = count;
+        block_cache_Sync (cache);
+    }
+
+    block_t *b = cache->list[i];
+    if (b != NULL)
+    {
+        cache->list[i] = b->p_next;
+        cache->count[i]--;
+        cache->resident -= size;
+        cache->hits++;
+    }
+    else
+        cache->misses++;
+
+    if (cache->hits + cache->misses >= BLOCK_CACHE_SYNC)
+        block_cache_Sync (cache);
+    return b;
+}
+
+/**
+ * Retrieves statistics about the block allocator cache.
+ *
+ * Thread caches publish their counters lazily, so the values are only
+ * approximate while other threads are allocating or releasing blocks.
+ */
+void block_CacheGetStats (block_cache_stats_t *stats)
+{
+    block_cache_t *cache = NULL;
+
+    if (atomic_load_explicit (&block_depot.key_ready, memory_order_acquire))
+        cache = vlc_threadvar_get (block_depot.key);
+    if (cache != NULL)
+        block_cache_Sync (cache);
+
+    stats->i_hits = atomic_load (&block_depot.hits);
+    stats->i_misses = atomic_load (&block_depot.misses);
+    stats->i_resident = atomic_load (&block_depot.resident);
+}
+
 block_t *block_Alloc (size_t size)
 {
+    unsigned i = block_class_Find (size);
+    size_t capacity = size;
+    block_t *b = NULL;
+
+    if (i < BLOCK_CLASSES)
+    {
+        capacity = block_classes[i];
+        b = block_cache_Alloc (i);
+    }
+
     /* 2 * BLOCK_PADDING: pre + post padding */
-    const size_t alloc = sizeof (block_t) + BLOCK_ALIGN + (2 * BLOCK_PADDING)
-                       + size;
-    if (unlikely(alloc <= size))
+    const size_t alloc = sizeof (block_t) + BLOCK_OVERHEAD + capacity;
+    if (unlikely(alloc <= capacity))
         return NULL;
 
-    block_t *b = malloc (alloc);
-    if (unlikely(b == NULL))
-        return NULL;
+    if (b == NULL)
+    {
+        b = malloc (alloc);
+        if (unlikely(b == NULL))
+            return NULL;
+    }
 
     block_Init (b, b + 1, alloc - sizeof (*b));
     static_assert ((BLOCK_PADDING % BLOCK_ALIGN) == 0,
@@ -144,7 +422,8 @@ block_t *block_Alloc (size_t size)
     b->p_buffer += BLOCK_PADDING + BLOCK_ALIGN - 1;
     b->p_buffer = (void *)(((uintptr_t)b->p_buffer) & ~(BLOCK_ALIGN - 1));
     b->i_buffer = size;
-    b->pf_release = block_generic_Release;
+    b->pf_release = (i < BLOCK_CLASSES) ? block_cache_Release
+                                        : block_generic_Release;
     return b;
 }
 
@@ -227,7 +506,8 @@ block_t *block_Realloc( block_t *p_block, ssize_t i_prebody, size_t i_body )
     else
     /* We have a very large reserved footer now? Release some of it.
      * XXX it might not preserve the alignment of p_buffer */
-    if( p_end - (p_block->p_buffer + i_body) > BLOCK_WASTE_SIZE )
+    if( p_end - (p_block->p_buffer + i_body) > BLOCK_WASTE_SIZE
+     && block_class_BufferSize( requested ) < p_block->i_size )
     {
         block_t *p_rea = block_Alloc( requested );
         if( p_rea )
@@ -297,10 +577,27 @@ block_t *block_heap_Alloc (void *addr, size_t length)
 #ifdef HAVE_MMAP
 # include <sys/mman.h>
 
+typedef struct
+{
+    block_t     self;
+    struct block_mmap_map
+    {
+        void       *addr;
+        size_t      length;
+        atomic_uint refs;
+    }          *map; /**< mapping shared by split blocks */
+} block_mmap_t;
+
 static void block_mmap_Release (block_t *block)
 {
+    struct block_mmap_map *map = ((block_mmap_t *)block)->map;
+
     block_Invalidate (block);
-    munmap (block->p_start, block->i_size);
+    if (atomic_fetch_sub (&map->refs, 1) == 1)
+    {
+        munmap (map->addr, map->length);
+        free (map);
+    }
     free (block);
 }
 
@@ -319,22 +616,67 @@ block_t *block_mmap_Alloc (void *addr, size_t length)
     if (addr == MAP_FAILED)
         return NULL;
 
-    block_t *block = malloc (sizeof (*block));
-    if (block == NULL)
+    block_mmap_t *block = malloc (sizeof (*block));
+    struct block_mmap_map *map = malloc (sizeof (*map));
+    if (unlikely(block == NULL || map == NULL))
     {
+        free (map);
+        free (block);
         munmap (addr, length);
         return NULL;
     }
 
-    block_Init (block, addr, length);
-    block->pf_release = block_mmap_Release;
-    return block;
+    map->addr = addr;
+    map->length = length;
+    atomic_init (&map->refs, 1);
+    block_Init (&block->self, addr, length);
+    block->self.pf_release = block_mmap_Release;
+    block->map = map;
+    return &block->self;
+}
+
+/**
+ * Splits the first bytes off a memory mapped block, without copying them.
+ * Both blocks then share the mapping, which is unmapped with the last one.
+ *
+ * @param block block to split, which starts after the split bytes on success
+ * @param size number of bytes to split off (at most block->i_buffer)
+ * @return a block for the first size bytes, or NULL if the block was not
+ * created by block_mmap_Alloc() or on error.
+ */
+block_t *block_mmap_Split (block_t *block, size_t size)
+{
+    assert (size <= block->i_buffer);
+    if (block->pf_release != block_mmap_Release)
+        return NULL;
+
+    block_mmap_t *head = malloc (sizeof (*head));
+    if (unlikely(head == NULL))
+        return NULL;
+
+    block_Init (&head->self, block->p_buffer, size);
+    block_CopyProperties (&head->self, block);
+    head->self.pf_release = block_mmap_Release;
+    head->map = ((block_mmap_t *)block)->map;
+    atomic_fetch_add (&head->map->refs, 1);
+
+    /* The bytes before the split now belong to the head block */
+    block->i_size -= block->p_buffer + size - block->p_start;
+    block->p_buffer += size;
+    block->i_buffer -= size;
+    block->p_start = block->p_buffer;
+    return &head->self;
 }
 #else
 block_t *block_mmap_Alloc (void *addr, size_t length)
 {
     (void)addr; (void)length; return NULL;
 }
+
+block_t *block_mmap_Split (block_t *block, size_t size)
+{
+    (void)block; (void)size; return NULL;
+}
 #endif
 
 #ifdef HAVE_SYS_SHM_H
@@ -387,6 +729,118 @@ block_t *block_shm_Alloc (void *addr, size_t length)
 #endif
 
 
+/*
+ * Shared blocks and views
+ */
+typedef struct
+{
+    atomic_uint refs;
+    block_t    *parent; /**< Owner of the buffer */
+} block_shared_t;
+
+typedef struct
+{
+    block_t         self;
+    block_shared_t *shared;
+} block_view_t;
+
+static void block_view_Release (block_t *block)
+{
+    block_shared_t *shared = ((block_view_t *)block)->shared;
+
+    block_Invalidate (block);
+    free (block);
+
+    if (atomic_fetch_sub (&shared->refs, 1) == 1)
+    {
+        block_Release (shared->parent);
+        free (shared);
+    }
+}
+
+static block_t *block_view_New (block_shared_t *shared, uint8_t *buf,
+                                size_t length)
+{
+    block_view_t *view = malloc (sizeof (*view));
+    if (unlikely(view == NULL))
+        return NULL;
+
+    /* The view has no room around its payload, so that block_Realloc()
+     * never writes outside of it */
+    block_Init (&view->self, buf, length);
+    view->self.pf_release = block_view_Release;
+    view->shared = shared;
+    return &view->self;
+}
+
+/**
+ * Turns a block into a shared one, from which views can be taken without
+ * copying the data.
+ *
+ * The returned block replaces the given one, which must not be used anymore.
+ * Its buffer is released once the returned block and all its views are.
+ *
+ * @param block a single block (not a chain)
+ * @return the shared block, or NULL on error (the block is then released)
+ */
+block_t *block_Share (block_t *block)
+{
+    if (block->pf_release == block_view_Release)
+        return block; /* Already shared */
+
+    block_shared_t *shared = malloc (sizeof (*shared));
+    if (unlikely(shared == NULL))
+    {
+        block_Release (block);
+        return NULL;
+    }
+    atomic_init (&shared->refs, 1);
+    shared->parent = block;
+
+    block_t *view = block_view_New (shared, block->p_buffer, block->i_buffer);
+    if (unlikely(view == NULL))
+    {
+        free (shared);
+        block_Release (block);
+        return NULL;
+    }
+    BlockMetaCopy (view, block);
+    view->p_next = NULL;
+    return view;
+}
+
+/**
+ * Creates a block referring to a part of the payload of another block.
+ *
+ * If the block is shared (see block_Share()), the view shares its buffer
+ * and holds a reference on it: writing to the view writes to the block,
+ * and views must not overlap if they are to be modified. Otherwise, the data
+ * is copied. The view does not inherit the block properties.
+ *
+ * @param block block to take the view of, which is left unchanged
+ * @param offset offset of the view in the block payload
+ * @param length length of the view
+ * @return the view, or NULL on error
+ */
+block_t *block_View (block_t *block, size_t offset, size_t length)
+{
+    assert (offset <= block->i_buffer && length <= block->i_buffer - offset);
+
+    if (block->pf_release != block_view_Release)
+    {
+        block_t *copy = block_Alloc (length);
+        if (likely(copy != NULL))
+            memcpy (copy->p_buffer, block->p_buffer + offset, length);
+        return copy;
+    }
+
+    block_shared_t *shared = ((block_view_t *)block)->shared;
+    block_t *view = block_view_New (shared, block->p_buffer + offset, length);
+    if (likely(view != NULL))
+        atomic_fetch_add (&shared->refs, 1);
+    return view;
+}
+
 #ifdef _WIN32
 # include <io.h>
 
@@ -506,8 +960,16 @@ block_t *block_FilePath (const char *path)
  * @section Thread-safe block queue functions
  */
 
+/** Number of slots of the lock-less ring (must be a power of two). */
+#define BLOCK_FIFO_RING 1024
+
 /**
  * Internal state for block queues
+ *
+ * In single producer mode (BLOCK_FIFO_SPSC), blocks are passed through a
+ * lock-less ring buffer. The linked list is only used, under the lock, when
+ * the ring is full. The lock and condition variables are then only needed
+ * when the consumer waits for data or the producer waits for room.
  */
 struct block_fifo_t
 {
@@ -517,24 +979,66 @@ struct block_fifo_t
 
     block_t             *p_first;
     block_t             **pp_last;
-    size_t              i_depth;
-    size_t              i_size;
+    atomic_size_t       i_depth;
+    atomic_size_t       i_size;
     bool          b_force_wake;
+
+    /* Single producer mode */
+    atomic_uintptr_t    *p_ring;   /**< Ring slots, NULL in locked mode */
+    atomic_size_t       i_head;    /**< Next slot to dequeue */
+    atomic_size_t       i_tail;    /**< Next slot to enqueue */
+    atomic_bool         b_overflow; /**< Blocks queued in p_first */
+    atomic_bool         b_waiting; /**< Consumer waits for data */
+    atomic_bool         b_pacing;  /**< Producer waits for room */
+    atomic_bool         b_woken;   /**< Forced wake up in single producer mode */
 };
 
 block_fifo_t *block_FifoNew( void )
+{
+    return block_FifoNewExt( 0 );
+}
+
+/**
+ * Creates a block queue.
+ *
+ * @param i_flags BLOCK_FIFO_SPSC selects the lock-less single producer mode:
+ * block_FifoPut() must then always be called from the same thread (at a
+ * time), and only one thread may dequeue blocks at a time.
+ * block_FifoEmpty() and block_FifoWake() may still be called from any thread.
+ */
+block_fifo_t *block_FifoNewExt( unsigned i_flags )
 {
     block_fifo_t *p_fifo = malloc( sizeof( block_fifo_t ) );
     if( !p_fifo )
         return NULL;
 
+    p_fifo->p_ring = NULL;
+    if( i_flags & BLOCK_FIFO_SPSC )
+    {
+        p_fifo->p_ring = malloc( BLOCK_FIFO_RING * sizeof( *p_fifo->p_ring ) );
+        if( unlikely(p_fifo->p_ring == NULL) )
+        {
+            free( p_fifo );
+            return NULL;
+        }
+        for( unsigned i = 0; i < BLOCK_FIFO_RING; i++ )
+            atomic_init( &p_fifo->p_ring[i], 0 );
+    }
+
     vlc_mutex_init( &p_fifo->lock );
     vlc_cond_init( &p_fifo->wait );
     vlc_cond_init( &p_fifo->wait_room );
     p_fifo->p_first = NULL;
     p_fifo->pp_last = &p_fifo->p_first;
-    p_fifo->i_depth = p_fifo->i_size = 0;
+    atomic_init( &p_fifo->i_depth, 0 );
+    atomic_init( &p_fifo->i_size, 0 );
     p_fifo->b_force_wake = false;
+    atomic_init( &p_fifo->i_head, 0 );
+    atomic_init( &p_fifo->i_tail, 0 );
+    atomic_init( &p_fifo->b_overflow, false );
+    atomic_init( &p_fifo->b_waiting, false );
+    atomic_init( &p_fifo->b_pacing, false );
+    atomic_init( &p_fifo->b_woken, false );
 
     return p_fifo;
 }
@@ -545,21 +1049,122 @@ void block_FifoRelease( block_fifo_t *p_fifo )
     vlc_cond_destroy( &p_fifo->wait_room );
     vlc_cond_destroy( &p_fifo->wait );
     vlc_mutex_destroy( &p_fifo->lock );
+    free( p_fifo->p_ring );
     free( p_fifo );
 }
 
+/**
+ * Dequeues one block from the ring of a single producer queue.
+ * Slots are claimed with a compare-and-swap, so that block_FifoEmpty() can
+ * safely race with the consumer.
+ */
+static block_t *block_RingGet( block_fifo_t *p_fifo )
+{
+    size_t i_head = atomic_load( &p_fifo->i_head );
+
+    for( ;; )
+    {
+        if( i_head == atomic_load( &p_fifo->i_tail ) )
+            return NULL; /* ring is empty */
+
+        block_t *b = (block_t *)atomic_load( &p_fifo->p_ring[i_head
+                                                 & (BLOCK_FIFO_RING - 1)] );
+        if( atomic_compare_exchange_weak( &p_fifo->i_head, &i_head,
+                                          i_head + 1 ) )
+            return b;
+    }
+}
+
+/**
+ * Dequeues the first block of a single producer queue, or returns NULL if
+ * the queue is empty (does not wait).
+ */
+static block_t *block_SPSCGet( block_fifo_t *p_fifo )
+{
+    block_t *b = block_RingGet( p_fifo );
+
+    if( b == NULL && atomic_load( &p_fifo->b_overflow ) )
+    {
+        vlc_mutex_lock( &p_fifo->lock );
+        /* The producer does not touch the ring while overflowing, and all
+         * blocks in the ring are older than the overflowed ones. */
+        b = block_RingGet( p_fifo );
+        if( b == NULL && (b = p_fifo->p_first) != NULL )
+        {
+            p_fifo->p_first = b->p_next;
+            if( p_fifo->p_first == NULL )
+            {
+                p_fifo->pp_last = &p_fifo->p_first;
+                atomic_store( &p_fifo->b_overflow, false );
+            }
+        }
+        vlc_mutex_unlock( &p_fifo->lock );
+    }
+
+    if( b == NULL )
+        return NULL;
+
+    atomic_fetch_sub( &p_fifo->i_depth, 1 );
+    atomic_fetch_sub( &p_fifo->i_size, b->i_buffer );
+    if( atomic_load( &p_fifo->b_pacing ) )
+    {
+        vlc_mutex_lock( &p_fifo->lock );
+        vlc_cond_broadcast( &p_fifo->wait_room );
+        vlc_mutex_unlock( &p_fifo->lock );
+    }
+    b->p_next = NULL;
+    return b;
+}
+
+/** Checks if a single producer queue has data (or was forcefully woken). */
+static bool block_SPSCReady( block_fifo_t *p_fifo, bool b_wake )
+{
+    return atomic_load( &p_fifo->i_head ) != atomic_load( &p_fifo->i_tail )
+        || atomic_load( &p_fifo->b_overflow )
+        || (b_wake && atomic_load( &p_fifo->b_woken ));
+}
+
+/** Waits until a single producer queue has data. */
+static void block_SPSCWait( block_fifo_t *p_fifo, bool b_wake )
+{
+    vlc_mutex_lock( &p_fifo->lock );
+    mutex_cleanup_push( &p_fifo->lock );
+    atomic_store( &p_fifo->b_waiting, true );
+    while( !block_SPSCReady( p_fifo, b_wake ) )
+        vlc_cond_wait( &p_fifo->wait, &p_fifo->lock );
+    atomic_store( &p_fifo->b_waiting, false );
+    vlc_cleanup_pop();
+    vlc_mutex_unlock( &p_fifo->lock );
+}
+
 void block_FifoEmpty( block_fifo_t *p_fifo )
 {
-    block_t *block;
+    block_t *block, **pp_last = &block;
+    size_t i_depth = 0, i_size = 0;
 
     vlc_mutex_lock( &p_fifo->lock );
-    block = p_fifo->p_first;
-    if (block != NULL)
+    if( p_fifo->p_ring != NULL )
+    {   /* Claim the ring first: overflowed blocks are more recent */
+        block_t *b;
+
+        while( (b = block_RingGet( p_fifo )) != NULL )
+        {
+            *pp_last = b;
+            pp_last = &b->p_next;
+        }
+        atomic_store( &p_fifo->b_overflow, false );
+    }
+    *pp_last = p_fifo->p_first;
+    p_fifo->p_first = NULL;
+    p_fifo->pp_last = &p_fifo->p_first;
+
+    for( block_t *b = block; b != NULL; b = b->p_next )
     {
-        p_fifo->i_depth = p_fifo->i_size = 0;
-        p_fifo->p_first = NULL;
-        p_fifo->pp_last = &p_fifo->p_first;
+        i_depth++;
+        i_size += b->i_buffer;
     }
+    atomic_fetch_sub( &p_fifo->i_depth, i_depth );
+    atomic_fetch_sub( &p_fifo->i_size, i_size );
     vlc_cond_broadcast( &p_fifo->wait_room );
     vlc_mutex_unlock( &p_fifo->lock );
 
@@ -594,16 +1199,58 @@ void block_FifoPace (block_fifo_t *fifo, size_t max_depth, size_t max_size)
 {
     vlc_testcancel ();
 
+    if (fifo->p_ring != NULL
+     && atomic_load (&fifo->i_depth) <= max_depth
+     && atomic_load (&fifo->i_size) <= max_size)
+        return; /* fast path: no need to wait */
+
     vlc_mutex_lock (&fifo->lock);
-    while ((fifo->i_depth > max_depth) || (fifo->i_size > max_size))
+    atomic_store (&fifo->b_pacing, true);
+    while ((atomic_load (&fifo->i_depth) > max_depth)
+        || (atomic_load (&fifo->i_size) > max_size))
     {
          mutex_cleanup_push (&fifo->lock);
          vlc_cond_wait (&fifo->wait_room, &fifo->lock);
          vlc_cleanup_pop ();
     }
+    atomic_store (&fifo->b_pacing, false);
     vlc_mutex_unlock (&fifo->lock);
 }
 
+/** Queues one block into a single producer queue. */
+static void block_SPSCPut( block_fifo_t *p_fifo, block_t *p_block )
+{
+    size_t i_tail = atomic_load_explicit( &p_fifo->i_tail,
+                                          memory_order_relaxed );
+
+    /* Only the producer sets the overflow flag, and only the producer
+     * enqueues into the ring, so neither can change behind our back. */
+    if( !atomic_load( &p_fifo->b_overflow )
+     && i_tail - atomic_load( &p_fifo->i_head ) < BLOCK_FIFO_RING )
+    {
+        atomic_store( &p_fifo->p_ring[i_tail & (BLOCK_FIFO_RING - 1)],
+                      (uintptr_t)p_block );
+        atomic_store( &p_fifo->i_tail, i_tail + 1 );
+        return;
+    }
+
+    vlc_mutex_lock( &p_fifo->lock );
+    if( !atomic_load( &p_fifo->b_overflow )
+     && i_tail - atomic_load( &p_fifo->i_head ) < BLOCK_FIFO_RING )
+    {   /* The consumer drained the overflow list in the mean time */
+        atomic_store( &p_fifo->p_ring[i_tail & (BLOCK_FIFO_RING - 1)],
+                      (uintptr_t)p_block );
+        atomic_store( &p_fifo->i_tail, i_tail + 1 );
+    }
+    else
+    {
+        *p_fifo->pp_last = p_block;
+        p_fifo->pp_last = &p_block->p_next;
+        atomic_store( &p_fifo->b_overflow, true );
+    }
+    vlc_mutex_unlock( &p_fifo->lock );
+}
+
 /**
  * Immediately queue one block at the end of a FIFO.
  * @param fifo queue
@@ -617,6 +1264,32 @@ size_t block_FifoPut( block_fifo_t *p_fifo, block_t *p_block )
 
     if (p_block == NULL)
         return 0;
+
+    if( p_fifo->p_ring != NULL )
+    {
+        while( p_block != NULL )
+        {
+            block_t *p_next = p_block->p_next;
+
+            p_block->p_next = NULL;
+            /* Account before publishing, so the consumer never underflows */
+            atomic_fetch_add( &p_fifo->i_depth, 1 );
+            atomic_fetch_add( &p_fifo->i_size, p_block->i_buffer );
+            i_size += p_block->i_buffer;
+            block_SPSCPut( p_fifo, p_block );
+            p_block = p_next;
+        }
+
+        /* Only wake the consumer up if it ran out of data */
+        if( atomic_load( &p_fifo->b_waiting ) )
+        {
+            vlc_mutex_lock( &p_fifo->lock );
+            vlc_cond_signal( &p_fifo->wait );
+            vlc_mutex_unlock( &p_fifo->lock );
+        }
+        return i_size;
+    }
+
     for (p_last = p_block; ; p_last = p_last->p_next)
     {
         i_size += p_last->i_buffer;
@@ -628,8 +1301,8 @@ size_t block_FifoPut( block_fifo_t *p_fifo, block_t *p_block )
     vlc_mutex_lock (&p_fifo->lock);
     *p_fifo->pp_last = p_block;
     p_fifo->pp_last = &p_last->p_next;
-    p_fifo->i_depth += i_depth;
-    p_fifo->i_size += i_size;
+    atomic_fetch_add (&p_fifo->i_depth, i_depth);
+    atomic_fetch_add (&p_fifo->i_size, i_size);
     /* We queued at least one block: wake up one read-waiting thread */
     vlc_cond_signal( &p_fifo->wait );
     vlc_mutex_unlock( &p_fifo->lock );
@@ -640,6 +1313,12 @@ size_t block_FifoPut( block_fifo_t *p_fifo, block_t *p_block )
 void block_FifoWake( block_fifo_t *p_fifo )
 {
     vlc_mutex_lock( &p_fifo->lock );
+    if( p_fifo->p_ring != NULL )
+    {
+        if( !block_SPSCReady( p_fifo, false ) )
+            atomic_store( &p_fifo->b_woken, true );
+    }
+    else
     if( p_fifo->p_first == NULL )
         p_fifo->b_force_wake = true;
     vlc_cond_broadcast( &p_fifo->wait );
@@ -658,6 +1337,22 @@ block_t *block_FifoGet( block_fifo_t *p_fifo )
 
     vlc_testcancel( );
 
+    if( p_fifo->p_ring != NULL )
+    {
+        for( ;; )
+        {
+            b = block_SPSCGet( p_fifo );
+            if( b != NULL )
+            {
+                atomic_store( &p_fifo->b_woken, false );
+                return b;
+            }
+            if( atomic_exchange( &p_fifo->b_woken, false ) )
+                return NULL; /* Forced wakeup */
+            block_SPSCWait( p_fifo, true );
+        }
+    }
+
     vlc_mutex_lock( &p_fifo->lock );
     mutex_cleanup_push( &p_fifo->lock );
 
@@ -678,8 +1373,8 @@ block_t *block_FifoGet( block_fifo_t *p_fifo )
     }
 
     p_fifo->p_first = b->p_next;
-    p_fifo->i_depth--;
-    p_fifo->i_size -= b->i_buffer;
+    atomic_fetch_sub( &p_fifo->i_depth, 1 );
+    atomic_fetch_sub( &p_fifo->i_size, b->i_buffer );
 
     if( p_fifo->p_first == NULL )
     {
@@ -711,6 +1406,33 @@ block_t *block_FifoShow( block_fifo_t *p_fifo )
 
     vlc_testcancel( );
 
+    if( p_fifo->p_ring != NULL )
+    {
+        for( ;; )
+        {
+            size_t i_head = atomic_load( &p_fifo->i_head );
+
+            if( i_head != atomic_load( &p_fifo->i_tail ) )
+                return (block_t *)atomic_load( &p_fifo->p_ring[i_head
+                                                 & (BLOCK_FIFO_RING - 1)] );
+
+            if( atomic_load( &p_fifo->b_overflow ) )
+            {
+                vlc_mutex_lock( &p_fifo->lock );
+                i_head = atomic_load( &p_fifo->i_head );
+                if( i_head != atomic_load( &p_fifo->i_tail ) )
+                    b = (block_t *)atomic_load( &p_fifo->p_ring[i_head
+                                                 & (BLOCK_FIFO_RING - 1)] );
+                else
+                    b = p_fifo->p_first;
+                vlc_mutex_unlock( &p_fifo->lock );
+                if( b != NULL )
+                    return b;
+            }
+            block_SPSCWait( p_fifo, false );
+        }
+    }
+
     vlc_mutex_lock( &p_fifo->lock );
     mutex_cleanup_push( &p_fifo->lock );
 
@@ -723,14 +1445,12 @@ block_t *block_FifoShow( block_fifo_t *p_fifo )
     return b;
 }
 
-/* FIXME: not thread-safe */
 size_t block_FifoSize( const block_fifo_t *p_fifo )
 {
-    return p_fifo->i_size;
+    return atomic_load( &((block_fifo_t *)p_fifo)->i_size );
 }
 
-/* FIXME: not thread-safe */
 size_t block_FifoCount( const block_fifo_t *p_fifo )
 {
-    return p_fifo->i_depth;
+    return atomic_load( &((block_fifo_t *)p_fifo)->i_depth );
 }
@@ -39,6 +39,8 @@ typedef struct
 
 } filter_chain_allocator_t;
 
+typedef struct pipeline_stage_t pipeline_stage_t;
+
 typedef struct chained_filter_t
 {
     /* Public part of the filter structure */
@@ -47,6 +49,7 @@ typedef struct chained_filter_t
     struct chained_filter_t *prev, *next;
     vlc_mouse_t *mouse;
     picture_t *pending;
+    pipeline_stage_t *stage; /**< Thread running the filter, if any */
 } chained_filter_t;
 
 /* Only use this with filter objects from _this_ C module */
@@ -71,6 +74,41 @@ static const filter_chain_allocator_t internal_video_allocator = {
     .p_data = NULL,
 };
 
+/* Pipelined video filtering */
+typedef struct filter_chain_pipeline_t filter_chain_pipeline_t;
+
+#define PIPELINE_DEPTH 2 /* Pictures per queue */
+
+typedef struct
+{
+    picture_t  *first;
+    picture_t **last;
+    unsigned    count;
+} picture_queue_t;
+
+struct pipeline_stage_t
+{
+    filter_chain_pipeline_t *pipeline;
+    chained_filter_t *first, *end; /**< Filters run by the stage */
+    picture_queue_t   in; /**< Input of the stage */
+    picture_queue_t  *out; /**< Input of the next stage */
+    bool              busy; /**< A picture is being filtered */
+    vlc_mutex_t       lock; /**< Held while the filters run */
+    vlc_thread_t      thread;
+};
+
+struct filter_chain_pipeline_t
+{
+    vlc_mutex_t       lock;
+    vlc_cond_t        wait;
+    bool              b_exit;
+    unsigned          i_generation; /**< Incremented on flush */
+    chained_filter_t *tail; /**< First filter run by the caller */
+    picture_queue_t   out; /**< Output of the last stage */
+    unsigned          i_stages;
+    pipeline_stage_t  stages[];
+};
+
 /* */
 struct filter_chain_t
 {
@@ -83,6 +121,8 @@ struct filter_chain_t
     es_format_t fmt_out; /**< Chain current output format */
     unsigned length; /**< Number of filters */
     bool b_allow_fmt_out_change; /**< Can the output format be changed? */
+    unsigned i_threads; /**< Number of video filtering threads */
+    filter_chain_pipeline_t *pipeline; /**< Running video filter threads */
     char psz_capability[1]; /**< Module capability for all chained filters */
 };
 
@@ -101,6 +141,13 @@ static int UpdateBufferFunctions( filter_chain_t * );
 
 static void FilterDeletePictures( filter_t *, picture_t * );
 
+static filter_chain_pipeline_t *PipelineGet( filter_chain_t * );
+static void PipelinePush( filter_chain_pipeline_t *, picture_t * );
+static picture_t *PipelinePop( filter_chain_pipeline_t * );
+static void PipelineFlush( filter_chain_pipeline_t * );
+static bool PipelineWait( filter_chain_pipeline_t * );
+static void PipelineStop( filter_chain_t * );
+
 #undef filter_chain_New
 /**
  * Filter chain initialisation
@@ -123,6 +170,8 @@ filter_chain_t *filter_chain_New( vlc_object_t *p_this,
     p_chain->p_this = p_this;
     p_chain->last = p_chain->first = NULL;
     p_chain->length = 0;
+    p_chain->i_threads = 0;
+    p_chain->pipeline = NULL;
     strcpy( p_chain->psz_capability, psz_capability );
 
     es_format_Init( &p_chain->fmt_in, UNKNOWN_ES, 0 );
@@ -154,6 +203,7 @@ void filter_chain_Delete( filter_chain_t *p_chain )
 void filter_chain_Reset( filter_chain_t *p_chain, const es_format_t *p_fmt_in,
                          const es_format_t *p_fmt_out )
 {
+    PipelineStop( p_chain );
     while( p_chain->first != NULL )
         filter_chain_DeleteFilterInternal( p_chain, &p_chain->first->filter );
 
@@ -241,17 +291,13 @@ static picture_t *FilterChainVideoFilter( chained_filter_t *f, picture_t *p_pic
     return p_pic;
 }
 
-picture_t *filter_chain_VideoFilter( filter_chain_t *p_chain, picture_t *p_pic )
+/* Returns the next picture left by the filters from first to last */
+static picture_t *FilterChainVideoDrain( chained_filter_t *first,
+                                         chained_filter_t *last )
 {
-    if( p_pic )
-    {
-        p_pic = FilterChainVideoFilter( p_chain->first, p_pic );
-        if( p_pic )
-            return p_pic;
-    }
-    for( chained_filter_t *b = p_chain->last; b != NULL; b = b->prev )
+    for( chained_filter_t *b = last; b != first->prev; b = b->prev )
     {
-        p_pic = b->pending;
+        picture_t *p_pic = b->pending;
         if( !p_pic )
             continue;
         b->pending = p_pic->p_next;
@@ -264,8 +310,60 @@ picture_t *filter_chain_VideoFilter( filter_chain_t *p_chain, picture_t *p_pic )
     return NULL;
 }
 
+picture_t *filter_chain_VideoFilter( filter_chain_t *p_chain, picture_t *p_pic )
+{
+    filter_chain_pipeline_t *p_pipeline = PipelineGet( p_chain );
+
+    if( p_pipeline == NULL )
+    {
+        if( p_pic )
+        {
+            p_pic = FilterChainVideoFilter( p_chain->first, p_pic );
+            if( p_pic )
+                return p_pic;
+        }
+        if( p_chain->first == NULL )
+            return NULL;
+        return FilterChainVideoDrain( p_chain->first, p_chain->last );
+    }
+
+    /* The last filters run here, on the pictures out of the threads */
+    chained_filter_t *tail = p_pipeline->tail;
+
+    if( p_pic )
+        PipelinePush( p_pipeline, p_pic );
+    for( ;; )
+    {
+        p_pic = FilterChainVideoDrain( tail, p_chain->last );
+        if( p_pic )
+            return p_pic;
+
+        p_pic = PipelinePop( p_pipeline );
+        if( !p_pic )
+            return NULL;
+        p_pic = FilterChainVideoFilter( tail, p_pic );
+        if( p_pic )
+            return p_pic;
+    }
+}
+
+picture_t *filter_chain_VideoDrain( filter_chain_t *p_chain )
+{
+    for( ;; )
+    {
+        picture_t *p_pic = filter_chain_VideoFilter( p_chain, NULL );
+        if( p_pic )
+            return p_pic;
+        if( p_chain->pipeline == NULL || !PipelineWait( p_chain->pipeline ) )
+            return NULL;
+    }
+}
+
 void filter_chain_VideoFlush( filter_chain_t *p_chain )
 {
+    if( p_chain->pipeline != NULL )
+        PipelineFlush( p_chain->pipeline );
+
     for( chained_filter_t *f = p_chain->first; f != NULL; f = f->next )
     {
         filter_t *p_filter = &f->filter;
@@ -277,6 +375,12 @@ void filter_chain_VideoFlush( filter_chain_t *p_chain )
     }
 }
 
+void filter_chain_SetThreads( filter_chain_t *p_chain, unsigned i_threads )
+{
+    PipelineStop( p_chain );
+    p_chain->i_threads = i_threads;
+}
+
 
 block_t *filter_chain_AudioFilter( filter_chain_t *p_chain, block_t *p_block )
 {
@@ -331,9 +435,17 @@ int filter_chain_MouseFilter( filter_chain_t *p_chain, vlc_mouse_t *p_dst, const
         {
             vlc_mouse_t old = *p_mouse;
             vlc_mouse_t filtered;
+            int i_ret;
 
             *p_mouse = current;
-            if( p_filter->pf_video_mouse( p_filter, &filtered, &old, &current ) )
+            /* Do not race with the thread running the filter */
+            if( f->stage != NULL )
+                vlc_mutex_lock( &f->stage->lock );
+            i_ret = p_filter->pf_video_mouse( p_filter, &filtered, &old,
+                                              &current );
+            if( f->stage != NULL )
+                vlc_mutex_unlock( &f->stage->lock );
+            if( i_ret )
                 return VLC_EGENERIC;
             current = filtered;
         }
@@ -370,6 +482,8 @@ static filter_t *filter_chain_AppendFilterInternal( filter_chain_t *p_chain,
                                                     const es_format_t *p_fmt_in,
                                                     const es_format_t *p_fmt_out )
 {
+    PipelineStop( p_chain );
+
     chained_filter_t *p_chained =
         vlc_custom_create( p_chain->p_this, sizeof(*p_chained), "filter" );
     filter_t *p_filter = &p_chained->filter;
@@ -426,6 +540,7 @@ static filter_t *filter_chain_AppendFilterInternal( filter_chain_t *p_chain,
         vlc_mouse_Init( p_mouse );
     p_chained->mouse = p_mouse;
     p_chained->pending = NULL;
+    p_chained->stage = NULL;
 
     msg_Dbg( p_chain->p_this, "Filter '%s' (%p) appended to chain",
              psz_name ? psz_name : module_get_name(p_filter->p_module, false),
@@ -489,6 +604,8 @@ static int filter_chain_DeleteFilterInternal( filter_chain_t *p_chain,
 {
     chained_filter_t *p_chained = chained( p_filter );
 
+    PipelineStop( p_chain );
+
     /* Remove it from the chain */
     if( p_chained->prev != NULL )
         p_chained->prev->next = p_chained->next;
@@ -638,3 +755,277 @@ static void AllocatorClean( const filter_chain_allocator_t *p_alloc,
         p_alloc->pf_clean( &p_filter->filter );
 }
 
+
+/**
+ * Pipelined video filtering
+ *
+ * The filters but the last one are split in groups, each running on its
+ * own thread, and linked by short picture queues. The last filter stays on
+ * the calling thread, as it uses the owner allocation callbacks. The other
+ * filters only allocate pictures with the internal allocator. The mouse
+ * callbacks of a filter run with the lock of its thread held.
+ */
+static void QueueInit( picture_queue_t *q )
+{
+    q->first = NULL;
+    q->last = &q->first;
+    q->count = 0;
+}
+
+static void QueuePush( picture_queue_t *q, picture_t *p_pic )
+{
+    while( p_pic )
+    {
+        picture_t *p_next = p_pic->p_next;
+
+        p_pic->p_next = NULL;
+        *q->last = p_pic;
+        q->last = &p_pic->p_next;
+        q->count++;
+        p_pic = p_next;
+    }
+}
+
+static picture_t *QueuePop( picture_queue_t *q )
+{
+    picture_t *p_pic = q->first;
+
+    if( p_pic )
+    {
+        q->first = p_pic->p_next;
+        if( !q->first )
+            q->last = &q->first;
+        q->count--;
+        p_pic->p_next = NULL;
+    }
+    return p_pic;
+}
+
+static void QueueClean( picture_queue_t *q )
+{
+    picture_t *p_pic;
+
+    while( (p_pic = QueuePop( q )) != NULL )
+        picture_Release( p_pic );
+}
+
+/* Runs the filters from f to end, and returns all the output pictures */
+static picture_t *FilterRange( chained_filter_t *f, chained_filter_t *end,
+                               picture_t *p_pic )
+{
+    if( f == end )
+        return p_pic;
+
+    picture_t *p_out = NULL, **pp_last = &p_out;
+    while( p_pic )
+    {
+        picture_t *p_next = p_pic->p_next;
+        filter_t *p_filter = &f->filter;
+
+        p_pic->p_next = NULL;
+        *pp_last = FilterRange( f->next, end,
+                                p_filter->pf_video_filter( p_filter, p_pic ) );
+        while( *pp_last )
+            pp_last = &(*pp_last)->p_next;
+        p_pic = p_next;
+    }
+    return p_out;
+}
+
+static void *PipelineThread( void *data )
+{
+    pipeline_stage_t *p_stage = data;
+    filter_chain_pipeline_t *p = p_stage->pipeline;
+    int canc = vlc_savecancel();
+
+    vlc_mutex_lock( &p->lock );
+    for( ;; )
+    {
+        while( !p->b_exit && ( p_stage->in.first == NULL ||
+                               p_stage->out->count >= PIPELINE_DEPTH ) )
+            vlc_cond_wait( &p->wait, &p->lock );
+        if( p->b_exit )
+            break;
+
+        picture_t *p_pic = QueuePop( &p_stage->in );
+        unsigned i_generation = p->i_generation;
+
+        p_stage->busy = true;
+        vlc_cond_broadcast( &p->wait );
+        vlc_mutex_unlock( &p->lock );
+
+        vlc_mutex_lock( &p_stage->lock );
+        p_pic = FilterRange( p_stage->first, p_stage->end, p_pic );
+        vlc_mutex_unlock( &p_stage->lock );
+
+        vlc_mutex_lock( &p->lock );
+        p_stage->busy = false;
+        if( i_generation == p->i_generation )
+            QueuePush( p_stage->out, p_pic );
+        else
+            FilterDeletePictures( &p_stage->end->prev->filter, p_pic );
+        vlc_cond_broadcast( &p->wait );
+    }
+    vlc_mutex_unlock( &p->lock );
+    vlc_restorecancel( canc );
+    return NULL;
+}
+
+/* Returns the pipeline of the chain, starting it if needed */
+static filter_chain_pipeline_t *PipelineGet( filter_chain_t *p_chain )
+{
+    if( p_chain->pipeline != NULL || p_chain->i_threads == 0 )
+        return p_chain->pipeline;
+
+    /* The last filter runs on the calling thread */
+    if( p_chain->length < 2 )
+        return NULL;
+    unsigned i_filters = p_chain->length - 1;
+
+    unsigned i_stages = __MIN( p_chain->i_threads, i_filters );
+    filter_chain_pipeline_t *p = malloc( sizeof(*p) +
+                                         i_stages * sizeof(*p->stages) );
+    if( unlikely(p == NULL) )
+        return NULL;
+
+    vlc_mutex_init( &p->lock );
+    vlc_cond_init( &p->wait );
+    p->b_exit = false;
+    p->i_generation = 0;
+    p->tail = p_chain->last;
+    QueueInit( &p->out );
+    p->i_stages = 0;
+
+    /* Split the filters evenly between the stages */
+    chained_filter_t *f = p_chain->first;
+    for( unsigned i = 0; i < i_stages; i++ )
+    {
+        pipeline_stage_t *p_stage = &p->stages[i];
+
+        p_stage->pipeline = p;
+        p_stage->first = f;
+        for( unsigned j = i * i_filters / i_stages;
+             j < (i + 1) * i_filters / i_stages; j++ )
+            f = f->next;
+        p_stage->end = f;
+        QueueInit( &p_stage->in );
+        p_stage->out = i + 1 < i_stages ? &p->stages[i + 1].in : &p->out;
+        p_stage->busy = false;
+        vlc_mutex_init( &p_stage->lock );
+
+        if( vlc_clone( &p_stage->thread, PipelineThread, p_stage,
+                       VLC_THREAD_PRIORITY_VIDEO ) )
+        {
+            vlc_mutex_destroy( &p_stage->lock );
+            break;
+        }
+        p->i_stages++;
+        for( chained_filter_t *g = p_stage->first; g != p_stage->end;
+             g = g->next )
+            g->stage = p_stage;
+    }
+
+    p_chain->pipeline = p;
+    if( p->i_stages < i_stages )
+    {
+        msg_Err( p_chain->p_this, "cannot start video filter threads" );
+        PipelineStop( p_chain );
+        p_chain->i_threads = 0;
+        return NULL;
+    }
+    msg_Dbg( p_chain->p_this, "running %u video filters on %u threads",
+             i_filters, i_stages );
+    return p;
+}
+
+static void PipelineStop( filter_chain_t *p_chain )
+{
+    filter_chain_pipeline_t *p = p_chain->pipeline;
+    if( p == NULL )
+        return;
+
+    vlc_mutex_lock( &p->lock );
+    p->b_exit = true;
+    vlc_cond_broadcast( &p->wait );
+    vlc_mutex_unlock( &p->lock );
+
+    for( unsigned i = 0; i < p->i_stages; i++ )
+        vlc_join( p->stages[i].thread, NULL );
+    for( unsigned i = 0; i < p->i_stages; i++ )
+    {
+        pipeline_stage_t *p_stage = &p->stages[i];
+
+        QueueClean( &p_stage->in );
+        for( chained_filter_t *f = p_stage->first; f != p_stage->end;
+             f = f->next )
+            f->stage = NULL;
+        vlc_mutex_destroy( &p_stage->lock );
+    }
+    QueueClean( &p->out );
+
+    vlc_cond_destroy( &p->wait );
+    vlc_mutex_destroy( &p->lock );
+    free( p );
+    p_chain->pipeline = NULL;
+}
+
+static void PipelinePush( filter_chain_pipeline_t *p, picture_t *p_pic )
+{
+    picture_queue_t *q = &p->stages[0].in;
+
+    /* Wait for room, unless filtered pictures are waiting for the caller:
+     * the stages may be blocked until it takes them */
+    vlc_mutex_lock( &p->lock );
+    while( q->count >= PIPELINE_DEPTH && p->out.first == NULL )
+        vlc_cond_wait( &p->wait, &p->lock );
+    QueuePush( q, p_pic );
+    vlc_cond_broadcast( &p->wait );
+    vlc_mutex_unlock( &p->lock );
+}
+
+static picture_t *PipelinePop( filter_chain_pipeline_t *p )
+{
+    vlc_mutex_lock( &p->lock );
+    picture_t *p_pic = QueuePop( &p->out );
+    if( p_pic )
+        vlc_cond_broadcast( &p->wait );
+    vlc_mutex_unlock( &p->lock );
+    return p_pic;
+}
+
+static void PipelineFlush( filter_chain_pipeline_t *p )
+{
+    vlc_mutex_lock( &p->lock );
+    p->i_generation++;
+    for( unsigned i = 0; i < p->i_stages; i++ )
+        QueueClean( &p->stages[i].in );
+    QueueClean( &p->out );
+
+    /* The pictures being filtered are dropped by the stages */
+    for( unsigned i = 0; i < p->i_stages; i++ )
+        while( p->stages[i].busy )
+            vlc_cond_wait( &p->wait, &p->lock );
+    vlc_cond_broadcast( &p->wait );
+    vlc_mutex_unlock( &p->lock );
+}
+
+/* Waits for an output picture, returns false if none can come anymore */
+static bool PipelineWait( filter_chain_pipeline_t *p )
+{
+    bool b_pending;
+
+    vlc_mutex_lock( &p->lock );
+    for( ;; )
+    {
+        b_pending = p->out.first != NULL;
+        if( b_pending )
+            break;
+        for( unsigned i = 0; i < p->i_stages && !b_pending; i++ )
+            b_pending = p->stages[i].in.first != NULL || p->stages[i].busy;
+        if( !b_pending )
+            break;
+        vlc_cond_wait( &p->wait, &p->lock );
+    }
+    vlc_mutex_unlock( &p->lock );
+    return b_pending;
+}
@@ -0,0 +1,246 @@
+/*****************************************************************************
+ * filter_slice.c : slice-parallel video filtering
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include "../libvlc.h"
+
+/*
+ * The slicer is a set of worker threads shared by all the filters of a
+ * libvlc instance. A filter submits a job, made of the bands of a picture;
+ * the workers and the submitting thread then take the bands one by one, so
+ * that a job always completes, even when the workers are busy elsewhere.
+ */
+#define SLICE_ALIGN      16 /* Lines, so that the chroma limits are exact */
+#define SLICE_MAX_THREAD 16
+
+typedef struct filter_slice_job_t filter_slice_job_t;
+typedef struct filter_slicer_t filter_slicer_t;
+
+struct filter_slice_job_t
+{
+    filter_slice_job_t *next;
+    filter_t           *filter;
+    filter_slice_cb_t   pf_slice;
+    void               *opaque;
+    unsigned            i_lines;
+    unsigned            i_overlap;
+    unsigned            i_slices;
+    unsigned            i_next; /**< Next band to process */
+    unsigned            i_done; /**< Processed bands */
+};
+
+struct filter_slicer_t
+{
+    vlc_mutex_t         lock;
+    vlc_cond_t          wait; /**< Jobs were submitted */
+    vlc_cond_t          done; /**< Bands were processed */
+    filter_slice_job_t *first, **last; /**< Jobs with bands left */
+    bool                b_exit;
+    unsigned            i_threads;
+    vlc_thread_t        threads[];
+};
+
+static vlc_mutex_t slicer_lock = VLC_STATIC_MUTEX;
+
+static void JobRun( filter_slice_job_t *p_job, unsigned i )
+{
+    /* Split evenly, on aligned limits */
+    unsigned i_units = (p_job->i_lines + SLICE_ALIGN - 1) / SLICE_ALIGN;
+    filter_slice_t slice;
+
+    slice.i_first = __MIN( i * i_units / p_job->i_slices * SLICE_ALIGN,
+                           p_job->i_lines );
+    slice.i_end = __MIN( (i + 1) * i_units / p_job->i_slices * SLICE_ALIGN,
+                         p_job->i_lines );
+    slice.i_start = slice.i_first > p_job->i_overlap
+                  ? slice.i_first - p_job->i_overlap : 0;
+    if( slice.i_first < slice.i_end )
+        p_job->pf_slice( p_job->filter, p_job->opaque, &slice );
+}
+
+/* Takes the next band of the job linked at pp, with the lock held */
+static void JobTake( filter_slicer_t *p_slicer, filter_slice_job_t **pp,
+                     unsigned *pi )
+{
+    filter_slice_job_t *p_job = *pp;
+
+    *pi = p_job->i_next++;
+    if( p_job->i_next == p_job->i_slices )
+    {
+        *pp = p_job->next;
+        if( *pp == NULL )
+            p_slicer->last = pp;
+    }
+}
+
+static void *Thread( void *data )
+{
+    filter_slicer_t *p_slicer = data;
+
+    vlc_mutex_lock( &p_slicer->lock );
+    for( ;; )
+    {
+        while( !p_slicer->b_exit && p_slicer->first == NULL )
+            vlc_cond_wait( &p_slicer->wait, &p_slicer->lock );
+        if( p_slicer->b_exit )
+            break;
+
+        filter_slice_job_t *p_job = p_slicer->first;
+        unsigned i;
+
+        JobTake( p_slicer, &p_slicer->first, &i );
+
+        vlc_mutex_unlock( &p_slicer->lock );
+        int canc = vlc_savecancel();
+        JobRun( p_job, i );
+        vlc_restorecancel( canc );
+        vlc_mutex_lock( &p_slicer->lock );
+
+        if( ++p_job->i_done == p_job->i_slices )
+            vlc_cond_broadcast( &p_slicer->done );
+    }
+    vlc_mutex_unlock( &p_slicer->lock );
+    return NULL;
+}
+
+static filter_slicer_t *SlicerGet( filter_t *p_filter )
+{
+    libvlc_priv_t *priv = libvlc_priv( p_filter->p_libvlc );
+    filter_slicer_t *p_slicer;
+
+    vlc_mutex_lock( &slicer_lock );
+    p_slicer = priv->slicer;
+    if( p_slicer != NULL )
+        goto out;
+
+    int i_threads = var_InheritInteger( p_filter->p_libvlc,
+                                        "video-filter-slice-threads" );
+    if( i_threads <= 0 )
+        i_threads = vlc_GetCPUCount();
+    /* The calling thread takes part in the jobs */
+    i_threads = VLC_CLIP( i_threads - 1, 0, SLICE_MAX_THREAD );
+
+    p_slicer = malloc( sizeof(*p_slicer) + i_threads * sizeof(vlc_thread_t) );
+    if( unlikely(p_slicer == NULL) )
+        goto out;
+    vlc_mutex_init( &p_slicer->lock );
+    vlc_cond_init( &p_slicer->wait );
+    vlc_cond_init( &p_slicer->done );
+    p_slicer->first = NULL;
+    p_slicer->last = &p_slicer->first;
+    p_slicer->b_exit = false;
+
+    for( p_slicer->i_threads = 0; p_slicer->i_threads < (unsigned)i_threads;
+         p_slicer->i_threads++ )
+        if( vlc_clone( &p_slicer->threads[p_slicer->i_threads], Thread,
+                       p_slicer, VLC_THREAD_PRIORITY_VIDEO ) )
+            break;
+
+    msg_Dbg( p_filter->p_libvlc, "slicing video filters on %u threads",
+             p_slicer->i_threads + 1 );
+    priv->slicer = p_slicer;
+out:
+    vlc_mutex_unlock( &slicer_lock );
+    return p_slicer;
+}
+
+/**
+ * Destroys the slicer of a libvlc instance, once no filter is left.
+ */
+void filter_SlicerDestroy( libvlc_int_t *p_libvlc )
+{
+    libvlc_priv_t *priv = libvlc_priv( p_libvlc );
+    filter_slicer_t *p_slicer = priv->slicer;
+
+    if( p_slicer == NULL )
+        return;
+
+    vlc_mutex_lock( &p_slicer->lock );
+    assert( p_slicer->first == NULL );
+    p_slicer->b_exit = true;
+    vlc_cond_broadcast( &p_slicer->wait );
+    vlc_mutex_unlock( &p_slicer->lock );
+
+    for( unsigned i = 0; i < p_slicer->i_threads; i++ )
+        vlc_join( p_slicer->threads[i], NULL );
+
+    vlc_cond_destroy( &p_slicer->done );
+    vlc_cond_destroy( &p_slicer->wait );
+    vlc_mutex_destroy( &p_slicer->lock );
+    free( p_slicer );
+    priv->slicer = NULL;
+}
+
+void filter_Slice( filter_t *p_filter, unsigned i_lines, unsigned i_overlap,
+                   filter_slice_cb_t pf_slice, void *opaque )
+{
+    filter_slicer_t *p_slicer = SlicerGet( p_filter );
+    filter_slice_job_t job = {
+        .next = NULL,
+        .filter = p_filter,
+        .pf_slice = pf_slice,
+        .opaque = opaque,
+        .i_lines = i_lines,
+        .i_overlap = i_overlap,
+        .i_slices = 1,
+        .i_next = 0,
+        .i_done = 0,
+    };
+
+    if( p_slicer != NULL )
+        job.i_slices = VLC_CLIP( (i_lines + SLICE_ALIGN - 1) / SLICE_ALIGN,
+                                 1, p_slicer->i_threads + 1 );
+    if( job.i_slices <= 1 )
+    {
+        JobRun( &job, 0 );
+        return;
+    }
+
+    vlc_mutex_lock( &p_slicer->lock );
+    *p_slicer->last = &job;
+    p_slicer->last = &job.next;
+    vlc_cond_broadcast( &p_slicer->wait );
+
+    /* Take part until all the bands are taken, then wait for the others */
+    while( job.i_next < job.i_slices )
+    {
+        filter_slice_job_t **pp = &p_slicer->first;
+        unsigned i;
+
+        while( *pp != &job )
+            pp = &(*pp)->next;
+        JobTake( p_slicer, pp, &i );
+
+        vlc_mutex_unlock( &p_slicer->lock );
+        JobRun( &job, i );
+        vlc_mutex_lock( &p_slicer->lock );
+        job.i_done++;
+    }
+    while( job.i_done < job.i_slices )
+        vlc_cond_wait( &p_slicer->done, &p_slicer->lock );
+    vlc_mutex_unlock( &p_slicer->lock );
+}
@@ -864,6 +864,8 @@ static const staticentry_t p_list_video[] = {
         A("NV24"),
     B(VLC_CODEC_NV42, "Biplanar 4:4:4 Y/VU"),
         A("NV42"),
+    B(VLC_CODEC_P010, "Biplanar 4:2:0 Y/UV 10-bit"),
+        A("P010"),
 
     B(VLC_CODEC_I420_9L, "Planar 4:2:0 YUV 9-bit LE"),
         A("I09L"),
@@ -1695,6 +1697,9 @@ const char *vlc_fourcc_GetDescription( int i_cat, vlc_fourcc_t i_fourcc )
 #define VLC_CODEC_YUV_PLANAR_420_16 \
     VLC_CODEC_I420_10L, VLC_CODEC_I420_10B, VLC_CODEC_I420_9L, VLC_CODEC_I420_9B
 
+#define VLC_CODEC_YUV_SEMIPLANAR_420_16 \
+    VLC_CODEC_P010
+
 #define VLC_CODEC_YUV_PLANAR_422 \
     VLC_CODEC_I422, VLC_CODEC_J422
 
@@ -1901,6 +1906,7 @@ static const vlc_fourcc_t p_list_YUV[] = {
     VLC_CODEC_YUV_PACKED,
     VLC_CODEC_I411, VLC_CODEC_YUV_PLANAR_410, VLC_CODEC_Y211,
     VLC_CODEC_YUV_PLANAR_420_16,
+    VLC_CODEC_YUV_SEMIPLANAR_420_16,
     VLC_CODEC_YUV_PLANAR_422_16,
     VLC_CODEC_YUV_PLANAR_444_16,
     VLC_CODEC_VDPAU_VIDEO_420,
@@ -2067,6 +2073,7 @@ static const struct
         VLC_CODEC_I420_10B, 0 },               PLANAR_16(3, 2, 2, 10) },
     { { VLC_CODEC_I420_9L,
         VLC_CODEC_I420_9B, 0 },                PLANAR_16(3, 2, 2,  9) },
+    { { VLC_CODEC_P010, 0 },                   PLANAR_16(2, 1, 2, 10) },
     { { VLC_CODEC_I422_10L,
         VLC_CODEC_I422_10B, 0 },               PLANAR_16(3, 2, 1, 10) },
     { { VLC_CODEC_I422_9L,
@@ -38,6 +38,170 @@
 #include <vlc_image.h>
 #include <vlc_block.h>
 
+/*****************************************************************************
+ * Picture memory cache
+ *****************************************************************************
+ * Pools and filters are torn down and recreated whenever the video output
+ * or a filter chain is reconfigured, typically with pictures of the same
+ * format. Released picture buffers are kept in a process-wide cache, so that
+ * the new pictures can reuse them instead of hitting the heap (and the page
+ * faults of fresh memory, which are significant for large pictures).
+ *
+ * Buffers are looked up by size and plane layout (pitches and lines), so
+ * that a buffer is only reused by a picture of the same geometry. The cache
+ * is bounded, and buffers unused for PICTURE_CACHE_AGE are freed whenever a
+ * buffer is taken from or returned to the cache.
+ *****************************************************************************/
+#ifdef OPTIMIZE_MEMORY
+# define PICTURE_CACHE_SIZE (8 << 20)
+#else
+# define PICTURE_CACHE_SIZE (64 << 20)
+#endif
+#define PICTURE_CACHE_AGE (CLOCK_FREQ)
+
+/* Header stored in front of the pixels of each allocated picture */
+typedef struct picture_buffer_t
+{
+    struct picture_buffer_t *p_next; /* in the cache */
+    size_t   i_size;
+    uint64_t i_layout;               /* hash of the plane geometry */
+    mtime_t  i_date;                 /* of the last release */
+} picture_buffer_t;
+
+#define PICTURE_BUFFER_HEADER 32
+static_assert( sizeof (picture_buffer_t) <= PICTURE_BUFFER_HEADER &&
+               PICTURE_BUFFER_HEADER % 16 == 0, "Invalid picture header" );
+
+static struct
+{
+    vlc_mutex_t       lock;
+    picture_buffer_t *p_first; /* most recently released first */
+    size_t            i_resident;
+    unsigned          i_count;
+    uint64_t          i_hits;
+    uint64_t          i_misses;
+} picture_cache = { VLC_STATIC_MUTEX, NULL, 0, 0, 0, 0 };
+
+/* Frees the cached buffers released before i_date, or beyond i_max bytes.
+ * The cache lock must be held. */
+static void picture_cache_Evict( mtime_t i_date, size_t i_max )
+{
+    picture_buffer_t **pp = &picture_cache.p_first;
+    size_t i_kept = 0;
+
+    while( *pp != NULL )
+    {
+        picture_buffer_t *p_buffer = *pp;
+
+        if( p_buffer->i_date >= i_date && i_kept + p_buffer->i_size <= i_max )
+        {
+            i_kept += p_buffer->i_size;
+            pp = &p_buffer->p_next;
+            continue;
+        }
+        *pp = p_buffer->p_next;
+        picture_cache.i_resident -= p_buffer->i_size;
+        picture_cache.i_count--;
+        vlc_free( p_buffer );
+    }
+}
+
+/* FNV-1a hash of the plane geometry of a picture */
+static uint64_t picture_cache_Layout( const picture_t *p_pic )
+{
+    uint64_t i_hash = UINT64_C(0xcbf29ce484222325);
+
+    for( int i = 0; i < p_pic->i_planes; i++ )
+    {
+        const uint32_t p_values[2] = { p_pic->p[i].i_pitch,
+                                       p_pic->p[i].i_lines };
+        const uint8_t *p_byte = (const uint8_t *)p_values;
+
+        for( size_t j = 0; j < sizeof (p_values); j++ )
+        {
+            i_hash ^= p_byte[j];
+            i_hash *= UINT64_C(0x100000001b3);
+        }
+    }
+    return i_hash;
+}
+
+static picture_buffer_t *picture_cache_Get( size_t i_size, uint64_t i_layout )
+{
+    picture_buffer_t *p_buffer = NULL;
+
+    vlc_mutex_lock( &picture_cache.lock );
+    picture_cache_Evict( mdate() - PICTURE_CACHE_AGE, PICTURE_CACHE_SIZE );
+    for( picture_buffer_t **pp = &picture_cache.p_first; *pp != NULL;
+         pp = &(*pp)->p_next )
+    {
+        if( (*pp)->i_size == i_size && (*pp)->i_layout == i_layout )
+        {
+            p_buffer = *pp;
+            *pp = p_buffer->p_next;
+            picture_cache.i_resident -= i_size;
+            picture_cache.i_count--;
+            break;
+        }
+    }
+    if( p_buffer != NULL )
+        picture_cache.i_hits++;
+    else
+        picture_cache.i_misses++;
+    vlc_mutex_unlock( &picture_cache.lock );
+
+    if( p_buffer == NULL )
+    {
+        p_buffer = vlc_memalign( 16, PICTURE_BUFFER_HEADER + i_size );
+        if( unlikely(p_buffer == NULL) )
+            return NULL;
+        p_buffer->i_size = i_size;
+        p_buffer->i_layout = i_layout;
+    }
+    return p_buffer;
+}
+
+static void picture_cache_Put( picture_buffer_t *p_buffer )
+{
+    const mtime_t now = mdate();
+
+    vlc_mutex_lock( &picture_cache.lock );
+    picture_cache_Evict( now - PICTURE_CACHE_AGE, PICTURE_CACHE_SIZE );
+    if( p_buffer->i_size > PICTURE_CACHE_SIZE )
+    {
+        vlc_mutex_unlock( &picture_cache.lock );
+        vlc_free( p_buffer );
+        return;
+    }
+    p_buffer->i_date = now;
+    p_buffer->p_next = picture_cache.p_first;
+    picture_cache.p_first = p_buffer;
+    picture_cache.i_resident += p_buffer->i_size;
+    picture_cache.i_count++;
+    picture_cache_Evict( INT64_MIN, PICTURE_CACHE_SIZE );
+    vlc_mutex_unlock( &picture_cache.lock );
+}
+
+/**
+ * Frees the cached picture buffers until at most i_max bytes remain.
+ */
+void picture_CacheTrim( size_t i_max )
+{
+    vlc_mutex_lock( &picture_cache.lock );
+    picture_cache_Evict( INT64_MIN, i_max );
+    vlc_mutex_unlock( &picture_cache.lock );
+}
+
+void picture_CacheGetStats( picture_cache_stats_t *p_stats )
+{
+    vlc_mutex_lock( &picture_cache.lock );
+    p_stats->i_hits = picture_cache.i_hits;
+    p_stats->i_misses = picture_cache.i_misses;
+    p_stats->i_resident = picture_cache.i_resident;
+    p_stats->i_count = picture_cache.i_count;
+    vlc_mutex_unlock( &picture_cache.lock );
+}
+
 /**
  * Allocate a new picture in the heap.
  *
@@ -62,13 +226,16 @@ static int AllocatePicture( picture_t *p_pic )
         i_bytes += p->i_pitch * p->i_lines;
     }
 
-    uint8_t *p_data = vlc_memalign( 16, i_bytes );
-    if( i_bytes > 0 && p_data == NULL )
+    picture_buffer_t *p_buffer = picture_cache_Get( i_bytes,
+                                        picture_cache_Layout( p_pic ) );
+    if( p_buffer == NULL )
     {
         p_pic->i_planes = 0;
         return VLC_EGENERIC;
     }
-    p_pic->gc.p_sys = (void *)p_data;
+    p_pic->gc.p_sys = (void *)p_buffer;
+
+    uint8_t *p_data = (uint8_t *)p_buffer + PICTURE_BUFFER_HEADER;
 
     /* Fill the p_pixels field for each plane */
     p_pic->p[0].p_pixels = p_data;
@@ -101,7 +268,7 @@ static void PictureDestroy( picture_t *p_picture )
     assert( p_picture &&
             atomic_load( &p_picture->gc.refcount ) == 0 );
 
-    vlc_free( p_picture->gc.p_sys );
+    picture_cache_Put( (picture_buffer_t *)p_picture->gc.p_sys );
     free( p_picture->p_sys );
     free( p_picture );
 }
@@ -28,9 +28,6 @@
 # include "config.h"
 #endif
 
-#ifdef HAVE_SEARCH_H
-# include <search.h>
-#endif
 #include <assert.h>
 #include <math.h>
 #include <limits.h>
@@ -136,23 +133,179 @@ static void     CheckValue  ( variable_t *, vlc_value_t * );
 static int      TriggerCallback( vlc_object_t *, variable_t *, const char *,
                                  vlc_value_t );
 
-static int varcmp( const void *a, const void *b )
+/*****************************************************************************
+ * Variable names
+ *****************************************************************************
+ * Names are interned: the variables of a given name share a single copy of it
+ * across all objects, with a precomputed hash.
+ *****************************************************************************/
+typedef struct var_name_t
+{
+    struct var_name_t *p_next;
+    uint32_t           i_hash;
+    unsigned           i_refs;
+    char               psz_name[];
+} var_name_t;
+
+static struct
+{
+    vlc_mutex_t  lock;
+    var_name_t **pp_table;
+    unsigned     i_size; /* power of two */
+    unsigned     i_count;
+} names = { VLC_STATIC_MUTEX, NULL, 0, 0 };
+
+/* FNV-1a */
+static uint32_t VarHash( const char *psz_name )
+{
+    uint32_t i_hash = 2166136261u;
+
+    while( *psz_name )
+    {
+        i_hash ^= (unsigned char)*(psz_name++);
+        i_hash *= 16777619u;
+    }
+    return i_hash;
+}
+
+/* Doubles the number of buckets of a chained hash table */
+#define VAR_TABLE_GROW( type, table, size ) \
+    do { \
+        unsigned i_newsize = (size) ? 2 * (size) : 16; \
+        type **pp_new = calloc( i_newsize, sizeof( *pp_new ) ); \
+        if( unlikely(pp_new == NULL) ) \
+            break; /* keep using the smaller table */ \
+        for( unsigned i = 0; i < (size); i++ ) \
+            for( type *p_cur = (table)[i], *p_next; p_cur != NULL; \
+                 p_cur = p_next ) \
+            { \
+                type **pp_head = &pp_new[p_cur->i_hash & (i_newsize - 1)]; \
+                p_next = p_cur->p_next; \
+                p_cur->p_next = *pp_head; \
+                *pp_head = p_cur; \
+            } \
+        free( table ); \
+        (table) = pp_new; \
+        (size) = i_newsize; \
+    } while( 0 )
+
+/**
+ * Returns the interned copy of a variable name, creating it if needed.
+ */
+static char *NameHold( const char *psz_name, uint32_t i_hash )
+{
+    var_name_t *p_name;
+
+    vlc_mutex_lock( &names.lock );
+    if( names.i_size > 0 )
+        for( p_name = names.pp_table[i_hash & (names.i_size - 1)];
+             p_name != NULL; p_name = p_name->p_next )
+            if( p_name->i_hash == i_hash
+             && !strcmp( p_name->psz_name, psz_name ) )
+            {
+                p_name->i_refs++;
+                goto out;
+            }
+
+    if( names.i_count >= names.i_size )
+        VAR_TABLE_GROW( var_name_t, names.pp_table, names.i_size );
+    if( unlikely(names.i_size == 0) )
+        goto error;
+
+    size_t i_len = strlen( psz_name ) + 1;
+    p_name = malloc( sizeof( *p_name ) + i_len );
+    if( unlikely(p_name == NULL) )
+        goto error;
+
+    var_name_t **pp_head = &names.pp_table[i_hash & (names.i_size - 1)];
+
+    p_name->i_hash = i_hash;
+    p_name->i_refs = 1;
+    memcpy( p_name->psz_name, psz_name, i_len );
+    p_name->p_next = *pp_head;
+    *pp_head = p_name;
+    names.i_count++;
+out:
+    vlc_mutex_unlock( &names.lock );
+    return p_name->psz_name;
+error:
+    vlc_mutex_unlock( &names.lock );
+    return NULL;
+}
+
+static void NameRelease( char *psz_name )
 {
-    const variable_t *va = a, *vb = b;
+    var_name_t *p_name = (var_name_t *)(psz_name
+                                        - offsetof( var_name_t, psz_name ));
 
-    /* psz_name must be first */
-    assert( va == (const void *)&va->psz_name );
-    return strcmp( va->psz_name, vb->psz_name );
+    vlc_mutex_lock( &names.lock );
+    if( --p_name->i_refs == 0 )
+    {
+        var_name_t **pp = &names.pp_table[p_name->i_hash
+                                          & (names.i_size - 1)];
+        while( *pp != p_name )
+            pp = &(*pp)->p_next;
+        *pp = p_name->p_next;
+        free( p_name );
+
+        if( --names.i_count == 0 )
+        {   /* Do not leave anything behind at exit */
+            free( names.pp_table );
+            names.pp_table = NULL;
+            names.i_size = 0;
+        }
+    }
+    vlc_mutex_unlock( &names.lock );
+}
+
+/*****************************************************************************
+ * Per-object hash table of variables
+ *****************************************************************************/
+static variable_t *LookupHash( vlc_object_internals_t *priv,
+                               const char *psz_name, uint32_t i_hash )
+{
+    vlc_assert_locked( &priv->var_lock );
+    if( priv->var_size == 0 )
+        return NULL;
+
+    for( variable_t *p_var = priv->var_table[i_hash & (priv->var_size - 1)];
+         p_var != NULL; p_var = p_var->p_next )
+        if( p_var->i_hash == i_hash && !strcmp( p_var->psz_name, psz_name ) )
+            return p_var;
+    return NULL;
 }
 
 static variable_t *Lookup( vlc_object_t *obj, const char *psz_name )
 {
-    vlc_object_internals_t *priv = vlc_internals( obj );
-    variable_t **pp_var;
+    return LookupHash( vlc_internals( obj ), psz_name, VarHash( psz_name ) );
+}
 
+static int Insert( vlc_object_internals_t *priv, variable_t *p_var )
+{
     vlc_assert_locked( &priv->var_lock );
-    pp_var = tfind( &psz_name, &priv->var_root, varcmp );
-    return (pp_var != NULL) ? *pp_var : NULL;
+    if( priv->var_count >= priv->var_size )
+        VAR_TABLE_GROW( variable_t, priv->var_table, priv->var_size );
+    if( unlikely(priv->var_size == 0) )
+        return VLC_ENOMEM;
+
+    variable_t **pp_head =
+        &priv->var_table[p_var->i_hash & (priv->var_size - 1)];
+
+    p_var->p_next = *pp_head;
+    *pp_head = p_var;
+    priv->var_count++;
+    return VLC_SUCCESS;
+}
+
+static void Remove( vlc_object_internals_t *priv, variable_t *p_var )
+{
+    variable_t **pp = &priv->var_table[p_var->i_hash & (priv->var_size - 1)];
+
+    vlc_assert_locked( &priv->var_lock );
+    while( *pp != p_var )
+        pp = &(*pp)->p_next;
+    *pp = p_var->p_next;
+    priv->var_count--;
 }
 
 static void Destroy( variable_t *p_var )
@@ -187,7 +340,7 @@ static void Destroy( variable_t *p_var )
     }
 #endif
 
-    free( p_var->psz_name );
+    NameRelease( p_var->psz_name );
     free( p_var->psz_text );
     free( p_var->p_entries );
     free( p_var );
@@ -197,9 +350,8 @@ static void Destroy( variable_t *p_var )
 /**
  * Initialize a vlc variable
  *
- * We hash the given string and insert it into the sorted list. The insertion
- * may require slow memory copies, but think about what we gain in the log(n)
- * lookup phase when setting/getting the variable value!
+ * We intern the given name with its hash, and insert the variable into the
+ * hash table of the object.
  *
  * \param p_this The object in which to create the variable
  * \param psz_name The name of the variable
@@ -214,7 +366,13 @@ int var_Create( vlc_object_t *p_this, const char *psz_name, int i_type )
     if( p_var == NULL )
         return VLC_ENOMEM;
 
-    p_var->psz_name = strdup( psz_name );
+    p_var->i_hash = VarHash( psz_name );
+    p_var->psz_name = NameHold( psz_name, p_var->i_hash );
+    if( unlikely(p_var->psz_name == NULL) )
+    {
+        free( p_var );
+        return VLC_ENOMEM;
+    }
     p_var->psz_text = NULL;
 
     p_var->i_type = i_type & ~VLC_VAR_DOINHERIT;
@@ -289,16 +447,18 @@ int var_Create( vlc_object_t *p_this, const char *psz_name, int i_type )
     }
 
     vlc_object_internals_t *p_priv = vlc_internals( p_this );
-    variable_t **pp_var, *p_oldvar;
+    variable_t *p_oldvar;
     int ret = VLC_SUCCESS;
 
     vlc_mutex_lock( &p_priv->var_lock );
 
-    pp_var = tsearch( p_var, &p_priv->var_root, varcmp );
-    if( unlikely(pp_var == NULL) )
-        ret = VLC_ENOMEM;
-    else if( (p_oldvar = *pp_var) == p_var ) /* Variable create */
-        p_var = NULL; /* Variable created */
+    p_oldvar = LookupHash( p_priv, p_var->psz_name, p_var->i_hash );
+    if( p_oldvar == NULL ) /* Variable create */
+    {
+        ret = Insert( p_priv, p_var );
+        if( likely(ret == VLC_SUCCESS) )
+            p_var = NULL; /* Variable created */
+    }
     else /* Variable already exists */
     {
         assert (((i_type ^ p_oldvar->i_type) & VLC_VAR_CLASS) == 0);
@@ -313,6 +473,20 @@ int var_Create( vlc_object_t *p_this, const char *psz_name, int i_type )
     return ret;
 }
 
+/**
+ * Drops a reference to a variable, with the variable lock held.
+ * \return the variable if it must be destroyed (after unlocking), or NULL
+ */
+static variable_t *Unref( vlc_object_t *p_this, variable_t *p_var )
+{
+    WaitUnused( p_this, p_var );
+
+    if( --p_var->i_usage > 0 )
+        return NULL;
+    Remove( vlc_internals( p_this ), p_var );
+    return p_var;
+}
+
 #undef var_Destroy
 /**
  * Destroy a vlc variable
@@ -340,12 +514,7 @@ int var_Destroy( vlc_object_t *p_this, const char *psz_name )
         return VLC_ENOVAR;
     }
 
-    WaitUnused( p_this, p_var );
-
-    if( --p_var->i_usage == 0 )
-        tdelete( p_var, &p_priv->var_root, varcmp );
-    else
-        p_var = NULL;
+    p_var = Unref( p_this, p_var );
     vlc_mutex_unlock( &p_priv->var_lock );
 
     if( p_var != NULL )
@@ -353,17 +522,55 @@ int var_Destroy( vlc_object_t *p_this, const char *psz_name )
     return VLC_SUCCESS;
 }
 
-static void CleanupVar( void *var )
+void var_DestroyAll( vlc_object_t *obj )
 {
-    Destroy( var );
+    vlc_object_internals_t *priv = vlc_internals( obj );
+
+    for( unsigned i = 0; i < priv->var_size; i++ )
+        for( variable_t *p_var = priv->var_table[i], *p_next;
+             p_var != NULL; p_var = p_next )
+        {
+            p_next = p_var->p_next;
+            Destroy( p_var );
+        }
+    free( priv->var_table );
+    priv->var_table = NULL;
+    priv->var_size = 0;
+    priv->var_count = 0;
 }
 
-void var_DestroyAll( vlc_object_t *obj )
+static int VarNameCmp( const void *a, const void *b )
+{
+    const variable_t *const *pa = a, *const *pb = b;
+
+    return strcmp( (*pa)->psz_name, (*pb)->psz_name );
+}
+
+/**
+ * Calls a function for each variable of an object, in alphabetical order.
+ * The variable lock of the object must be held.
+ */
+void var_Walk( vlc_object_t *obj, void (*pf_walk)( const variable_t * ) )
 {
     vlc_object_internals_t *priv = vlc_internals( obj );
 
-    tdestroy( priv->var_root, CleanupVar );
-    priv->var_root = NULL;
+    vlc_assert_locked( &priv->var_lock );
+
+    const variable_t **pp_vars = malloc( priv->var_count * sizeof( *pp_vars ) );
+    unsigned n = 0;
+
+    if( pp_vars == NULL )
+        return;
+    for( unsigned i = 0; i < priv->var_size; i++ )
+        for( const variable_t *p_var = priv->var_table[i]; p_var != NULL;
+             p_var = p_var->p_next )
+            pp_vars[n++] = p_var;
+    assert( n == priv->var_count );
+
+    qsort( pp_vars, n, sizeof( *pp_vars ), VarNameCmp );
+    for( unsigned i = 0; i < n; i++ )
+        pf_walk( pp_vars[i] );
+    free( pp_vars );
 }
 
 #undef var_Change
@@ -695,26 +902,13 @@ int var_Type( vlc_object_t *p_this, const char *psz_name )
     return i_type;
 }
 
-#undef var_SetChecked
-int var_SetChecked( vlc_object_t *p_this, const char *psz_name,
-                    int expected_type, vlc_value_t val )
+/* Sets the value of a variable, with the variable lock held */
+static int SetLocked( vlc_object_t *p_this, variable_t *p_var,
+                      const char *psz_name, int expected_type,
+                      vlc_value_t val )
 {
-    int i_ret = VLC_SUCCESS;
-    variable_t *p_var;
     vlc_value_t oldval;
-
-    assert( p_this );
-
-    vlc_object_internals_t *p_priv = vlc_internals( p_this );
-
-    vlc_mutex_lock( &p_priv->var_lock );
-
-    p_var = Lookup( p_this, psz_name );
-    if( p_var == NULL )
-    {
-        vlc_mutex_unlock( &p_priv->var_lock );
-        return VLC_ENOVAR;
-    }
+    int i_ret;
 
     assert( expected_type == 0 ||
             (p_var->i_type & VLC_VAR_CLASS) == expected_type );
@@ -740,6 +934,43 @@ int var_SetChecked( vlc_object_t *p_this, const char *psz_name,
     /* Free data if needed */
     p_var->ops->pf_free( &oldval );
 
+    return i_ret;
+}
+
+/* Gets the value of a variable, with the variable lock held */
+static void GetLocked( variable_t *p_var, int expected_type,
+                       vlc_value_t *p_val )
+{
+    assert( expected_type == 0 ||
+            (p_var->i_type & VLC_VAR_CLASS) == expected_type );
+    assert ((p_var->i_type & VLC_VAR_CLASS) != VLC_VAR_VOID);
+
+    /* Really get the variable */
+    *p_val = p_var->val;
+
+    /* Duplicate value if needed */
+    p_var->ops->pf_dup( p_val );
+}
+
+#undef var_SetChecked
+int var_SetChecked( vlc_object_t *p_this, const char *psz_name,
+                    int expected_type, vlc_value_t val )
+{
+    int i_ret;
+    variable_t *p_var;
+
+    assert( p_this );
+
+    vlc_object_internals_t *p_priv = vlc_internals( p_this );
+
+    vlc_mutex_lock( &p_priv->var_lock );
+
+    p_var = Lookup( p_this, psz_name );
+    if( p_var != NULL )
+        i_ret = SetLocked( p_this, p_var, psz_name, expected_type, val );
+    else
+        i_ret = VLC_ENOVAR;
+
     vlc_mutex_unlock( &p_priv->var_lock );
 
     return i_ret;
@@ -772,17 +1003,7 @@ int var_GetChecked( vlc_object_t *p_this, const char *psz_name,
 
     p_var = Lookup( p_this, psz_name );
     if( p_var != NULL )
-    {
-        assert( expected_type == 0 ||
-                (p_var->i_type & VLC_VAR_CLASS) == expected_type );
-        assert ((p_var->i_type & VLC_VAR_CLASS) != VLC_VAR_VOID);
-
-        /* Really get the variable */
-        *p_val = p_var->val;
-
-        /* Duplicate value if needed */
-        p_var->ops->pf_dup( p_val );
-    }
+        GetLocked( p_var, expected_type, p_val );
     else
         err = VLC_ENOVAR;
 
@@ -804,6 +1025,84 @@ int var_Get( vlc_object_t *p_this, const char *psz_name, vlc_value_t *p_val )
     return var_GetChecked( p_this, psz_name, 0, p_val );
 }
 
+#undef var_Hold
+/**
+ * Finds a variable and returns a handle to it
+ *
+ * The handle avoids looking the variable up by name in var_HandleGet() and
+ * var_HandleSet(), for variables that are accessed often. Like var_Create(),
+ * it holds a reference to the variable, which remains valid until
+ * var_Release(). It must be released before the object is destroyed.
+ *
+ * \param p_this The object that holds the variable
+ * \param psz_name The name of the variable
+ * \return a variable handle, or NULL if the variable does not exist
+ */
+vlc_var_t *var_Hold( vlc_object_t *p_this, const char *psz_name )
+{
+    vlc_object_internals_t *p_priv = vlc_internals( p_this );
+    variable_t *p_var;
+
+    vlc_mutex_lock( &p_priv->var_lock );
+    p_var = Lookup( p_this, psz_name );
+    if( p_var != NULL )
+        p_var->i_usage++;
+    vlc_mutex_unlock( &p_priv->var_lock );
+    return p_var;
+}
+
+#undef var_Release
+/**
+ * Releases a variable handle obtained from var_Hold()
+ *
+ * This is equivalent to var_Destroy() on the variable name.
+ */
+void var_Release( vlc_object_t *p_this, vlc_var_t *p_var )
+{
+    vlc_object_internals_t *p_priv = vlc_internals( p_this );
+
+    vlc_mutex_lock( &p_priv->var_lock );
+    p_var = Unref( p_this, p_var );
+    vlc_mutex_unlock( &p_priv->var_lock );
+
+    if( p_var != NULL )
+        Destroy( p_var );
+}
+
+#undef var_HandleSet
+/**
+ * Sets the value of a variable from its handle
+ *
+ * \see var_SetChecked()
+ */
+int var_HandleSet( vlc_object_t *p_this, vlc_var_t *p_var,
+                   int expected_type, vlc_value_t val )
+{
+    vlc_object_internals_t *p_priv = vlc_internals( p_this );
+    int i_ret;
+
+    vlc_mutex_lock( &p_priv->var_lock );
+    i_ret = SetLocked( p_this, p_var, p_var->psz_name, expected_type, val );
+    vlc_mutex_unlock( &p_priv->var_lock );
+    return i_ret;
+}
+
+#undef var_HandleGet
+/**
+ * Gets the value of a variable from its handle
+ *
+ * \see var_GetChecked()
+ */
+void var_HandleGet( vlc_object_t *p_this, vlc_var_t *p_var,
+                    int expected_type, vlc_value_t *p_val )
+{
+    vlc_object_internals_t *p_priv = vlc_internals( p_this );
+
+    vlc_mutex_lock( &p_priv->var_lock );
+    GetLocked( p_var, expected_type, p_val );
+    vlc_mutex_unlock( &p_priv->var_lock );
+}
+
 #undef var_AddCallback
 /**
  * Register a callback in a variable
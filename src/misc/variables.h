@@ -35,7 +35,9 @@ struct vlc_object_internals
     char           *psz_name; /* given name */
 
     /* Object variables */
-    void           *var_root;
+    struct variable_t **var_table; /* hash table, see variables.c */
+    unsigned        var_size; /* number of buckets (power of two) */
+    unsigned        var_count;
     vlc_mutex_t     var_lock;
     vlc_cond_t      var_wait;
 
@@ -72,7 +74,9 @@ typedef struct variable_ops_t
  */
 struct variable_t
 {
-    char *       psz_name; /**< The variable unique name (must be first) */
+    char *       psz_name; /**< The variable unique name (interned) */
+    uint32_t     i_hash;   /**< Hash of the name */
+    struct variable_t *p_next; /**< Next variable in the same hash bucket */
 
     /** The variable's exported value */
     vlc_value_t  val;
@@ -106,5 +110,6 @@ struct variable_t
 };
 
 extern void var_DestroyAll( vlc_object_t * );
+void var_Walk( vlc_object_t *, void (*)( const variable_t * ) );
 
 #endif
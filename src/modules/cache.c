@@ -34,7 +34,11 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <assert.h>
+#ifdef HAVE_MMAP
+# include <sys/mman.h>
+#endif
 
 #include <vlc_common.h>
 #include "libvlc.h"
@@ -45,6 +49,8 @@
 #include "config/configuration.h"
 
 #include <vlc_fs.h>
+#include <vlc_block.h>
+#include <vlc_arrays.h>
 
 #include "modules/modules.h"
 
@@ -61,6 +67,8 @@
 #define CACHE_NAME "plugins.dat"
 /* Magic for the cache filename */
 #define CACHE_STRING "cache "PACKAGE_NAME" "PACKAGE_VERSION
+/* Magic for the memory-mappable cache format */
+#define CACHE_MAP_STRING "cachemap "PACKAGE_NAME" "PACKAGE_VERSION
 
 
 void CacheDelete( vlc_object_t *obj, const char *dir )
@@ -215,6 +223,370 @@ error:
 }
 
 
+/*****************************************************************************
+ * Memory-mapped cache format
+ *****************************************************************************
+ * The file holds a header, the module records, then two tables of
+ * NUL-terminated strings. Each distinct string is stored once, and records
+ * refer to it by offset: the loaded modules point straight into the read-only
+ * mapping of the file rather than to heap copies. Names, capabilities and
+ * shortcuts are stored in the first table. Descriptions and help texts are
+ * stored in the second one, at the end of the file, so that they are only
+ * paged in if an interface displays them.
+ *****************************************************************************/
+#define CACHE_MAP_NULL UINT32_C(0xFFFFFFFF)
+#define CACHE_MAP_COLD UINT32_C(0x80000000)
+
+typedef struct
+{
+    const uint8_t *p_record;
+    const uint8_t *p_end;
+    const char    *strings[2];
+    uint32_t       i_strings[2];
+} cache_map_t;
+
+static int CacheMapRead (cache_map_t *map, void *p, size_t size)
+{
+    if ((size_t)(map->p_end - map->p_record) < size)
+        return -1;
+    memcpy (p, map->p_record, size);
+    map->p_record += size;
+    return 0;
+}
+
+static int CacheMapString (cache_map_t *map, char **p)
+{
+    uint32_t ref;
+
+    if (CacheMapRead (map, &ref, sizeof (ref)))
+        return -1;
+    if (ref == CACHE_MAP_NULL)
+    {
+        *p = NULL;
+        return 0;
+    }
+
+    unsigned table = (ref & CACHE_MAP_COLD) != 0;
+
+    ref &= ~CACHE_MAP_COLD;
+    if (ref >= map->i_strings[table])
+        return -1;
+    /* Tables are NUL-terminated, see CacheLoadMap() */
+    *p = (char *)map->strings[table] + ref;
+    return 0;
+}
+
+#define MAP_LOAD_IMMEDIATE(a) \
+    if (CacheMapRead (map, &(a), sizeof (a))) \
+        goto error
+#define MAP_LOAD_FLAG(a) \
+    do { \
+        unsigned char b; \
+        MAP_LOAD_IMMEDIATE(b); \
+        if (b > 1) \
+            goto error; \
+        (a) = b; \
+    } while (0)
+#define MAP_LOAD_STRING(a) \
+    if (CacheMapString (map, &(a))) \
+        goto error
+
+/* Unlike CacheLoadConfig(), this function leaves the item in a state that
+ * config_Free() can release, even on error. */
+static int CacheMapConfig (module_config_t *cfg, cache_map_t *map)
+{
+    MAP_LOAD_IMMEDIATE (cfg->i_type);
+    MAP_LOAD_IMMEDIATE (cfg->i_short);
+    MAP_LOAD_FLAG (cfg->b_advanced);
+    MAP_LOAD_FLAG (cfg->b_internal);
+    MAP_LOAD_FLAG (cfg->b_unsaveable);
+    MAP_LOAD_FLAG (cfg->b_safe);
+    MAP_LOAD_FLAG (cfg->b_removed);
+    MAP_LOAD_STRING (cfg->psz_type);
+    MAP_LOAD_STRING (cfg->psz_name);
+    MAP_LOAD_STRING (cfg->psz_text);
+    MAP_LOAD_STRING (cfg->psz_longtext);
+    MAP_LOAD_IMMEDIATE (cfg->list_count);
+
+    if (IsConfigStringType (cfg->i_type))
+    {
+        MAP_LOAD_STRING (cfg->orig.psz);
+        if (cfg->orig.psz != NULL)
+        {
+            cfg->value.psz = strdup (cfg->orig.psz);
+            if (unlikely(cfg->value.psz == NULL))
+                goto error;
+        }
+
+        if (cfg->list_count)
+        {
+            cfg->list.psz = calloc (cfg->list_count, sizeof (char *));
+            if (unlikely(cfg->list.psz == NULL))
+                goto error;
+        }
+        else /* see CacheLoadConfig() */
+            MAP_LOAD_IMMEDIATE (cfg->list.psz_cb);
+        for (unsigned i = 0; i < cfg->list_count; i++)
+        {
+            MAP_LOAD_STRING (cfg->list.psz[i]);
+            if (cfg->list.psz[i] == NULL) /* NULL -> empty string */
+                cfg->list.psz[i] = (char *)"";
+        }
+    }
+    else
+    {
+        MAP_LOAD_IMMEDIATE (cfg->orig);
+        MAP_LOAD_IMMEDIATE (cfg->min);
+        MAP_LOAD_IMMEDIATE (cfg->max);
+        cfg->value = cfg->orig;
+
+        if (cfg->list_count)
+        {
+            cfg->list.i = malloc (cfg->list_count * sizeof (int));
+            if (unlikely(cfg->list.i == NULL)
+             || CacheMapRead (map, cfg->list.i, cfg->list_count * sizeof (int)))
+                goto error;
+        }
+        else /* see CacheLoadConfig() */
+            MAP_LOAD_IMMEDIATE (cfg->list.i_cb);
+    }
+
+    if (cfg->list_count)
+    {
+        cfg->list_text = calloc (cfg->list_count, sizeof (char *));
+        if (unlikely(cfg->list_text == NULL))
+            goto error;
+    }
+    for (unsigned i = 0; i < cfg->list_count; i++)
+    {
+        MAP_LOAD_STRING (cfg->list_text[i]);
+        if (cfg->list_text[i] == NULL) /* NULL -> empty string */
+            cfg->list_text[i] = (char *)"";
+    }
+    return 0;
+error:
+    return -1;
+}
+
+static int CacheMapModuleConfig (module_t *module, cache_map_t *map)
+{
+    uint16_t lines;
+
+    MAP_LOAD_IMMEDIATE (module->i_config_items);
+    MAP_LOAD_IMMEDIATE (module->i_bool_items);
+    MAP_LOAD_IMMEDIATE (lines);
+
+    if (lines)
+    {
+        module->p_config = calloc (lines, sizeof (module_config_t));
+        if (unlikely(module->p_config == NULL))
+            goto error;
+        module->confsize = lines;
+    }
+
+    for (size_t i = 0; i < lines; i++)
+        if (CacheMapConfig (module->p_config + i, map))
+            goto error;
+    return 0;
+error:
+    return -1;
+}
+
+static int CacheMapShortcuts (module_t *module, cache_map_t *map)
+{
+    unsigned count;
+
+    MAP_LOAD_IMMEDIATE (count);
+    if (count > MODULE_SHORTCUT_MAX)
+        goto error;
+    if (count)
+    {
+        module->pp_shortcuts = malloc (count * sizeof (char *));
+        if (unlikely(module->pp_shortcuts == NULL))
+            goto error;
+    }
+    for (unsigned j = 0; j < count; j++)
+        MAP_LOAD_STRING (module->pp_shortcuts[j]);
+    module->i_shortcuts = count;
+    return 0;
+error:
+    return -1;
+}
+
+static module_t *CacheMapModule (cache_map_t *map)
+{
+    module_t *module = vlc_module_create (NULL);
+    uint32_t i_submodules;
+
+    if (unlikely(module == NULL))
+        return NULL;
+    module->b_mapped = true;
+
+    MAP_LOAD_STRING (module->psz_shortname);
+    MAP_LOAD_STRING (module->psz_longname);
+    MAP_LOAD_STRING (module->psz_help);
+    if (CacheMapShortcuts (module, map))
+        goto error;
+    MAP_LOAD_STRING (module->psz_capability);
+    MAP_LOAD_IMMEDIATE (module->i_score);
+    MAP_LOAD_IMMEDIATE (module->b_unloadable);
+
+    if (CacheMapModuleConfig (module, map))
+        goto error;
+
+    MAP_LOAD_STRING (module->domain);
+    if (module->domain != NULL)
+        vlc_bindtextdomain (module->domain);
+
+    MAP_LOAD_IMMEDIATE (i_submodules);
+    while (i_submodules--)
+    {
+        module_t *submodule = vlc_module_create (module);
+
+        if (unlikely(submodule == NULL))
+            goto error;
+        submodule->b_mapped = true;
+
+        MAP_LOAD_STRING (submodule->psz_shortname);
+        MAP_LOAD_STRING (submodule->psz_longname);
+        if (CacheMapShortcuts (submodule, map))
+            goto error;
+        MAP_LOAD_STRING (submodule->psz_capability);
+        MAP_LOAD_IMMEDIATE (submodule->i_score);
+    }
+    return module;
+
+error:
+    vlc_module_destroy (module);
+    return NULL;
+}
+
+static int CacheMapEntry (module_cache_t **cachep, size_t *countp,
+                          cache_map_t *map)
+{
+    module_t *module = CacheMapModule (map);
+    char *path;
+    struct stat st;
+
+    if (module == NULL)
+        return -1;
+
+    MAP_LOAD_STRING (path);
+    if (path == NULL)
+        goto error;
+    MAP_LOAD_IMMEDIATE (st.st_mtime);
+    MAP_LOAD_IMMEDIATE (st.st_size);
+
+    if (CacheAdd (cachep, countp, path, &st, module))
+        goto error;
+    return 0;
+
+error:
+    vlc_module_destroy (module);
+    return -1;
+}
+
+/**
+ * Loads a plugins cache in the memory-mapped format.
+ *
+ * The returned modules refer to the content of the mapping: it must not be
+ * released until they have all been destroyed.
+ */
+static size_t CacheLoadMap (vlc_object_t *obj, block_t *block,
+                            module_cache_t **r)
+{
+    cache_map_t m, *map = &m;
+    uint32_t i_marker, i_records, i_cache;
+
+    map->p_record = block->p_buffer + strlen (CACHE_MAP_STRING);
+    map->p_end = block->p_buffer + block->i_buffer;
+
+#ifdef DISTRO_VERSION
+    /* Check for distribution specific version */
+    if ((size_t)(map->p_end - map->p_record) < strlen (DISTRO_VERSION)
+     || memcmp (map->p_record, DISTRO_VERSION, strlen (DISTRO_VERSION)))
+    {
+        msg_Warn (obj, "This doesn't look like a valid plugins cache");
+        return 0;
+    }
+    map->p_record += strlen (DISTRO_VERSION);
+#endif
+
+    if (CacheMapRead (map, &i_marker, sizeof (i_marker))
+     || i_marker != CACHE_SUBVERSION_NUM
+     || CacheMapRead (map, &i_records, sizeof (i_records))
+     || CacheMapRead (map, &map->i_strings[0], sizeof (map->i_strings[0]))
+     || CacheMapRead (map, &map->i_strings[1], sizeof (map->i_strings[1]))
+     || CacheMapRead (map, &i_cache, sizeof (i_cache)))
+    {
+        msg_Warn (obj, "This doesn't look like a valid plugins cache "
+                  "(corrupted header)");
+        return 0;
+    }
+
+    if ((uint64_t)(map->p_end - map->p_record)
+        != (uint64_t)i_records + map->i_strings[0] + map->i_strings[1])
+    {
+        msg_Warn (obj, "This doesn't look like a valid plugins cache "
+                  "(file too short)");
+        return 0;
+    }
+
+    map->strings[0] = (const char *)map->p_record + i_records;
+    map->strings[1] = map->strings[0] + map->i_strings[0];
+    map->p_end = map->p_record + i_records;
+    for (unsigned i = 0; i < 2; i++)
+        if (map->i_strings[i] > 0
+         && map->strings[i][map->i_strings[i] - 1] != '\0')
+        {
+            msg_Warn (obj, "plugins cache not loaded (corrupted)");
+            return 0;
+        }
+
+    module_cache_t *cache = NULL;
+    size_t count = 0;
+
+    while (count < i_cache)
+        if (CacheMapEntry (&cache, &count, map))
+        {
+            msg_Warn (obj, "plugins cache not loaded (corrupted)");
+            for (size_t i = 0; i < count; i++)
+            {
+                vlc_module_destroy (cache[i].p_module);
+                free (cache[i].path);
+            }
+            free (cache);
+            return 0;
+        }
+
+    *r = cache;
+    return count;
+}
+
+/**
+ * Maps a plugins cache file in memory, read-only if supported.
+ */
+static block_t *CacheMapFile (const char *path)
+{
+    int fd = vlc_open (path, O_RDONLY);
+    if (fd == -1)
+        return NULL;
+
+    block_t *block = NULL;
+#ifdef HAVE_MMAP
+    struct stat st;
+
+    if (fstat (fd, &st) == 0 && st.st_size > 0
+     && (uintmax_t)st.st_size <= SIZE_MAX)
+        block = block_mmap_Alloc (mmap (NULL, st.st_size, PROT_READ,
+                                        MAP_PRIVATE, fd, 0), st.st_size);
+    if (block == NULL)
+#endif
+        block = block_File (fd);
+    close (fd);
+    return block;
+}
+
 /**
  * Loads a plugins cache file.
  *
@@ -223,7 +595,8 @@ error:
  * actually load the dynamically loadable module.
  * This allows us to only fully load plugins when they are actually used.
  */
-size_t CacheLoad( vlc_object_t *p_this, const char *dir, module_cache_t **r )
+size_t CacheLoad( vlc_object_t *p_this, const char *dir, module_cache_t **r,
+                  block_t **mapp )
 {
     char *psz_filename;
     FILE *file;
@@ -235,11 +608,31 @@ size_t CacheLoad( vlc_object_t *p_this, const char *dir, module_cache_t **r )
     assert( dir != NULL );
 
     *r = NULL;
+    *mapp = NULL;
     if( asprintf( &psz_filename, "%s"DIR_SEP CACHE_NAME, dir ) == -1 )
         return 0;
 
     msg_Dbg( p_this, "loading plugins cache file %s", psz_filename );
 
+    block_t *map = CacheMapFile( psz_filename );
+    if( map != NULL )
+    {
+        if( map->i_buffer >= strlen( CACHE_MAP_STRING )
+         && !memcmp( map->p_buffer, CACHE_MAP_STRING,
+                     strlen( CACHE_MAP_STRING ) ) )
+        {
+            free( psz_filename );
+            i_cache = CacheLoadMap( p_this, map, r );
+            if( i_cache > 0 )
+                *mapp = map;
+            else
+                block_Release( map );
+            return i_cache;
+        }
+        /* Older format, parse it below */
+        block_Release( map );
+    }
+
     file = vlc_fopen( psz_filename, "rb" );
     if( !file )
     {
@@ -476,6 +869,233 @@ error:
     return -1;
 }
 
+typedef struct
+{
+    uint8_t *p_data;
+    size_t   i_length;
+    size_t   i_size;
+} cache_buf_t;
+
+typedef struct
+{
+    cache_buf_t      records;
+    cache_buf_t      strings[2];
+    vlc_dictionary_t index[2]; /* string -> reference, for each table */
+    bool             b_error;
+} cache_map_writer_t;
+
+static void CacheBufAppend (cache_map_writer_t *w, cache_buf_t *buf,
+                            const void *data, size_t len)
+{
+    if (buf->i_size - buf->i_length < len)
+    {
+        size_t size = __MAX(2 * buf->i_size, buf->i_length + len);
+        uint8_t *p = realloc (buf->p_data, size);
+
+        if (unlikely(p == NULL))
+        {
+            w->b_error = true;
+            return;
+        }
+        buf->p_data = p;
+        buf->i_size = size;
+    }
+    memcpy (buf->p_data + buf->i_length, data, len);
+    buf->i_length += len;
+}
+
+/**
+ * Returns the reference of a string in one of the tables, adding it
+ * to the table if it is not there yet.
+ */
+static uint32_t CacheIntern (cache_map_writer_t *w, unsigned table,
+                             const char *str)
+{
+    if (str == NULL)
+        return CACHE_MAP_NULL;
+
+    void *ref = vlc_dictionary_value_for_key (&w->index[table], str);
+    if (ref != kVLCDictionaryNotFound)
+        return (uintptr_t)ref;
+
+    cache_buf_t *buf = &w->strings[table];
+    if (buf->i_length >= CACHE_MAP_COLD)
+    {
+        w->b_error = true;
+        return CACHE_MAP_NULL;
+    }
+
+    ref = (void *)(uintptr_t)(buf->i_length | (table ? CACHE_MAP_COLD : 0));
+    CacheBufAppend (w, buf, str, strlen (str) + 1);
+    vlc_dictionary_insert (&w->index[table], str, ref);
+    return (uintptr_t)ref;
+}
+
+#define MAP_SAVE_IMMEDIATE(a) \
+    CacheBufAppend (w, &w->records, &(a), sizeof (a))
+#define MAP_SAVE_FLAG(a) \
+    do { \
+        unsigned char b = (a); \
+        MAP_SAVE_IMMEDIATE(b); \
+    } while (0)
+#define MAP_SAVE_REF(table, a) \
+    do { \
+        uint32_t ref = CacheIntern (w, table, (a)); \
+        MAP_SAVE_IMMEDIATE(ref); \
+    } while (0)
+/* Strings used to look modules and options up */
+#define MAP_SAVE_STRING(a) MAP_SAVE_REF(0, a)
+/* Strings only shown to the user */
+#define MAP_SAVE_TEXT(a) MAP_SAVE_REF(1, a)
+
+static void CacheSaveMapConfig (cache_map_writer_t *w,
+                                const module_config_t *cfg)
+{
+    MAP_SAVE_IMMEDIATE (cfg->i_type);
+    MAP_SAVE_IMMEDIATE (cfg->i_short);
+    MAP_SAVE_FLAG (cfg->b_advanced);
+    MAP_SAVE_FLAG (cfg->b_internal);
+    MAP_SAVE_FLAG (cfg->b_unsaveable);
+    MAP_SAVE_FLAG (cfg->b_safe);
+    MAP_SAVE_FLAG (cfg->b_removed);
+    MAP_SAVE_TEXT (cfg->psz_type);
+    MAP_SAVE_STRING (cfg->psz_name);
+    MAP_SAVE_TEXT (cfg->psz_text);
+    MAP_SAVE_TEXT (cfg->psz_longtext);
+    MAP_SAVE_IMMEDIATE (cfg->list_count);
+
+    if (IsConfigStringType (cfg->i_type))
+    {
+        MAP_SAVE_STRING (cfg->orig.psz);
+        if (cfg->list_count == 0)
+            MAP_SAVE_IMMEDIATE (cfg->list.psz_cb); /* XXX: see CacheLoadConfig() */
+        for (unsigned i = 0; i < cfg->list_count; i++)
+            MAP_SAVE_STRING (cfg->list.psz[i]);
+    }
+    else
+    {
+        MAP_SAVE_IMMEDIATE (cfg->orig);
+        MAP_SAVE_IMMEDIATE (cfg->min);
+        MAP_SAVE_IMMEDIATE (cfg->max);
+        if (cfg->list_count == 0)
+            MAP_SAVE_IMMEDIATE (cfg->list.i_cb); /* XXX: see CacheLoadConfig() */
+        else
+            CacheBufAppend (w, &w->records, cfg->list.i,
+                            cfg->list_count * sizeof (int));
+    }
+    for (unsigned i = 0; i < cfg->list_count; i++)
+        MAP_SAVE_TEXT (cfg->list_text[i]);
+}
+
+static void CacheSaveMapShortcuts (cache_map_writer_t *w,
+                                   const module_t *module)
+{
+    MAP_SAVE_IMMEDIATE (module->i_shortcuts);
+    for (unsigned j = 0; j < module->i_shortcuts; j++)
+        MAP_SAVE_STRING (module->pp_shortcuts[j]);
+}
+
+static void CacheSaveMapSubmodule (cache_map_writer_t *w,
+                                   const module_t *module)
+{
+    if (module == NULL)
+        return;
+    /* Reverse order, as the loader prepends submodules */
+    CacheSaveMapSubmodule (w, module->next);
+
+    MAP_SAVE_STRING (module->psz_shortname);
+    MAP_SAVE_TEXT (module->psz_longname);
+    CacheSaveMapShortcuts (w, module);
+    MAP_SAVE_STRING (module->psz_capability);
+    MAP_SAVE_IMMEDIATE (module->i_score);
+}
+
+static void CacheSaveMapEntry (cache_map_writer_t *w,
+                               const module_cache_t *entry)
+{
+    const module_t *module = entry->p_module;
+    uint16_t lines = module->confsize;
+    uint32_t i_submodules = module->submodule_count;
+
+    MAP_SAVE_STRING (module->psz_shortname);
+    MAP_SAVE_TEXT (module->psz_longname);
+    MAP_SAVE_TEXT (module->psz_help);
+    CacheSaveMapShortcuts (w, module);
+    MAP_SAVE_STRING (module->psz_capability);
+    MAP_SAVE_IMMEDIATE (module->i_score);
+    MAP_SAVE_IMMEDIATE (module->b_unloadable);
+
+    MAP_SAVE_IMMEDIATE (module->i_config_items);
+    MAP_SAVE_IMMEDIATE (module->i_bool_items);
+    MAP_SAVE_IMMEDIATE (lines);
+    for (size_t i = 0; i < lines; i++)
+        CacheSaveMapConfig (w, module->p_config + i);
+
+    MAP_SAVE_STRING (module->domain);
+    MAP_SAVE_IMMEDIATE (i_submodules);
+    CacheSaveMapSubmodule (w, module->submodule);
+
+    MAP_SAVE_STRING (entry->path);
+    MAP_SAVE_IMMEDIATE (entry->mtime);
+    MAP_SAVE_IMMEDIATE (entry->size);
+}
+
+/**
+ * Writes a module cache in the memory-mapped format.
+ */
+static int CacheSaveMap (FILE *file, const module_cache_t *cache,
+                         size_t i_cache)
+{
+    cache_map_writer_t writer, *w = &writer;
+    int ret = -1;
+
+    memset (w, 0, sizeof (*w));
+    vlc_dictionary_init (&w->index[0], 4096);
+    vlc_dictionary_init (&w->index[1], 4096);
+
+    for (size_t i = 0; i < i_cache; i++)
+        CacheSaveMapEntry (w, cache + i);
+
+    if (w->b_error || w->records.i_length > UINT32_MAX || i_cache > UINT32_MAX)
+        goto error;
+
+    uint32_t header[5] = {
+        CACHE_SUBVERSION_NUM,
+        w->records.i_length,
+        w->strings[0].i_length,
+        w->strings[1].i_length,
+        i_cache,
+    };
+
+    if (fputs (CACHE_MAP_STRING, file) == EOF)
+        goto error;
+#ifdef DISTRO_VERSION
+    if (fputs (DISTRO_VERSION, file) == EOF)
+        goto error;
+#endif
+    if (fwrite (header, sizeof (header), 1, file) != 1)
+        goto error;
+    if (w->records.i_length > 0
+     && fwrite (w->records.p_data, w->records.i_length, 1, file) != 1)
+        goto error;
+    for (unsigned i = 0; i < 2; i++)
+        if (w->strings[i].i_length > 0
+         && fwrite (w->strings[i].p_data, w->strings[i].i_length, 1,
+                    file) != 1)
+            goto error;
+
+    if (fflush (file) == 0) /* flush libc buffers */
+        ret = 0;
+error:
+    for (unsigned i = 0; i < 2; i++)
+    {
+        vlc_dictionary_clear (&w->index[i], NULL, NULL);
+        free (w->strings[i].p_data);
+    }
+    free (w->records.p_data);
+    return ret;
+}
+
 static int CacheSaveBank( FILE *file, const module_cache_t *, size_t );
 
 /**
@@ -502,7 +1122,12 @@ void CacheSave (vlc_object_t *p_this, const char *dir,
         goto out;
     }
 
-    if (CacheSaveBank (file, entries, n))
+    int val;
+    if (var_InheritBool (p_this, "plugins-cache-mmap"))
+        val = CacheSaveMap (file, entries, n);
+    else
+        val = CacheSaveBank (file, entries, n);
+    if (val)
     {
         msg_Warn (p_this, "cannot write %s: %s", tmpname,
                   vlc_strerror_c(errno));
@@ -0,0 +1,139 @@
+/*****************************************************************************
+ * block_bench.c: Micro-benchmark for block_t allocation and queues
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+
+#define ITERATIONS 2000000
+#define BURST      64
+
+static const size_t sizes[] = { 188, 1316, 4096, 65536, 200000 };
+
+static void report (const char *name, size_t size, mtime_t start, unsigned n)
+{
+    mtime_t duration = mdate () - start;
+
+    printf ("%-10s %7zu bytes: %7.1f ns/op, %10.0f ops/s\n", name, size,
+            duration * 1000. / n, n * (double)CLOCK_FREQ / duration);
+}
+
+/* Reference: the plain heap allocator, with the same allocation pattern */
+static void bench_heap (size_t size)
+{
+    void *ptrs[BURST];
+    mtime_t start = mdate ();
+
+    for (unsigned i = 0; i < ITERATIONS; i += BURST)
+    {
+        for (unsigned j = 0; j < BURST; j++)
+        {
+            ptrs[j] = malloc (sizeof (block_t) + 96 + size);
+            assert (ptrs[j] != NULL);
+        }
+        for (unsigned j = 0; j < BURST; j++)
+            free (ptrs[j]);
+    }
+    report ("heap", size, start, ITERATIONS);
+}
+
+static void bench_block (size_t size)
+{
+    block_t *blocks[BURST];
+    mtime_t start = mdate ();
+
+    for (unsigned i = 0; i < ITERATIONS; i += BURST)
+    {
+        for (unsigned j = 0; j < BURST; j++)
+        {
+            blocks[j] = block_Alloc (size);
+            assert (blocks[j] != NULL);
+        }
+        for (unsigned j = 0; j < BURST; j++)
+            block_Release (blocks[j]);
+    }
+    report ("block", size, start, ITERATIONS);
+}
+
+/* Blocks allocated by one thread and released by another, as with
+ * demuxer and decoder threads. */
+static void *consumer (void *data)
+{
+    block_fifo_t *fifo = data;
+    block_t *block;
+
+    while ((block = block_FifoGet (fifo)) != NULL)
+        block_Release (block);
+    return NULL;
+}
+
+static void bench_fifo (const char *name, unsigned flags, size_t size)
+{
+    block_fifo_t *fifo = block_FifoNewExt (flags);
+    vlc_thread_t th;
+
+    assert (fifo != NULL);
+    if (vlc_clone (&th, consumer, fifo, VLC_THREAD_PRIORITY_LOW))
+        abort ();
+
+    mtime_t start = mdate ();
+
+    for (unsigned i = 0; i < ITERATIONS; i++)
+    {
+        block_t *block = block_Alloc (size);
+        assert (block != NULL);
+        block_FifoPace (fifo, 256, SIZE_MAX);
+        block_FifoPut (fifo, block);
+    }
+    block_FifoPace (fifo, 0, SIZE_MAX);
+    report (name, size, start, ITERATIONS);
+
+    block_FifoWake (fifo);
+    vlc_join (th, NULL);
+    block_FifoRelease (fifo);
+}
+
+int main (void)
+{
+    for (unsigned i = 0; i < sizeof (sizes) / sizeof (sizes[0]); i++)
+    {
+        bench_heap (sizes[i]);
+        bench_block (sizes[i]);
+        bench_fifo ("fifo", 0, sizes[i]);
+        bench_fifo ("fifo-spsc", BLOCK_FIFO_SPSC, sizes[i]);
+    }
+
+    block_cache_stats_t stats;
+
+    block_CacheGetStats (&stats);
+    printf ("cache: %"PRIu64" hits, %"PRIu64" misses (%.2f%% hit rate), "
+            "%zu bytes resident\n", stats.i_hits, stats.i_misses,
+            100. * stats.i_hits / (stats.i_hits + stats.i_misses),
+            stats.i_resident);
+    return 0;
+}
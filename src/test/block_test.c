@@ -84,10 +84,222 @@ static void test_block (void)
     //assert (block == NULL);
 }
 
+static void test_block_Cache (void)
+{
+    static const size_t sizes[] = { 1, 188, 189, 1316, 4096, 65536, 65537 };
+    block_cache_stats_t before, after;
+
+    block_CacheGetStats (&before);
+
+    for (unsigned i = 0; i < sizeof (sizes) / sizeof (sizes[0]); i++)
+    {
+        block_t *chain = NULL, **pp = &chain;
+
+        for (unsigned j = 0; j < 100; j++)
+        {
+            block_t *block = block_Alloc (sizes[i]);
+            assert (block != NULL);
+            assert (block->i_buffer == sizes[i]);
+            assert (((uintptr_t)block->p_buffer % 32) == 0);
+            memset (block->p_buffer, j, block->i_buffer);
+            block_ChainLastAppend (&pp, block);
+        }
+        block_ChainRelease (chain);
+    }
+
+    /* Recycled blocks must come back as fresh blocks */
+    block_t *block = block_Alloc (188);
+    assert (block != NULL);
+    assert (block->i_buffer == 188);
+    assert (block->i_flags == 0);
+    assert (block->i_pts == VLC_TS_INVALID);
+
+    /* Shrinking within a size class must not reallocate */
+    block = block_Realloc (block, 0, 100);
+    assert (block != NULL);
+    assert (block->i_buffer == 100);
+
+    /* Growing across size classes must preserve the payload */
+    memcpy (block->p_buffer, text, sizeof (text));
+    block = block_Realloc (block, 1000, 4000);
+    assert (block != NULL);
+    assert (!memcmp (block->p_buffer + 1000, text, sizeof (text)));
+    block_Release (block);
+
+    block_CacheGetStats (&after);
+    assert (after.i_hits > before.i_hits);
+    assert (after.i_hits + after.i_misses > before.i_hits + before.i_misses);
+    assert (after.i_resident > 0);
+}
+
+static void test_block_View (void)
+{
+    block_t *block = block_Alloc (sizeof (text));
+    assert (block != NULL);
+    memcpy (block->p_buffer, text, sizeof (text));
+    block->i_pts = VLC_TS_0;
+
+    /* Views of a block that is not shared are copies */
+    block_t *copy = block_View (block, 4, 10);
+    assert (copy != NULL);
+    assert (copy->i_buffer == 10);
+    assert (copy->p_buffer != block->p_buffer + 4);
+    assert (!memcmp (copy->p_buffer, text + 4, 10));
+    block_Release (copy);
+
+    block = block_Share (block);
+    assert (block != NULL);
+    assert (block->i_pts == VLC_TS_0);
+    assert (block_Share (block) == block);
+
+    block_t *view1 = block_View (block, 0, 4);
+    block_t *view2 = block_View (block, 4, sizeof (text) - 4);
+    assert (view1 != NULL && view2 != NULL);
+    assert (view1->p_buffer == block->p_buffer);
+    assert (view2->p_buffer == block->p_buffer + 4);
+    assert (view2->i_pts == VLC_TS_INVALID);
+
+    /* The buffer lives as long as any view of it */
+    block_Release (block);
+    block_t *view3 = block_View (view2, 1, 2);
+    assert (view3 != NULL);
+    block_Release (view2);
+    assert (!memcmp (view1->p_buffer, text, 4));
+    assert (!memcmp (view3->p_buffer, text + 5, 2));
+    block_Release (view1);
+
+    /* Growing a view must not overwrite its neighbours */
+    view3 = block_Realloc (view3, 0, 100);
+    assert (view3 != NULL);
+    assert (view3->i_buffer == 100);
+    assert (!memcmp (view3->p_buffer, text + 5, 2));
+    block_Release (view3);
+}
+
+static block_t *test_chain (unsigned count)
+{
+    block_t *chain = NULL, **pp_last = &chain;
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        block_t *block = block_Alloc (4);
+        assert (block != NULL);
+        SetDWBE (block->p_buffer, i);
+        block->i_length = 10;
+        block_ChainLastAppend (&pp_last, block);
+    }
+    chain->i_pts = VLC_TS_0;
+    return chain;
+}
+
+static void test_block_ChainGatherExt (void)
+{
+    /* Scattered chains keep their blocks, and properties on the first */
+    block_t *chain = block_ChainGatherExt (test_chain (3), true);
+    assert (chain->p_next != NULL && chain->p_next->p_next != NULL);
+    assert (chain->i_pts == VLC_TS_0);
+    assert (chain->i_length == 30);
+    assert (chain->p_next->i_pts == VLC_TS_INVALID);
+    assert (chain->p_next->i_length == 0);
+    block_ChainRelease (chain);
+
+    /* but corrupted chains are gathered, to be dropped as a whole */
+    chain = test_chain (3);
+    chain->i_flags |= BLOCK_FLAG_CORRUPTED;
+    chain = block_ChainGatherExt (chain, true);
+    assert (chain->p_next == NULL);
+    assert (chain->i_buffer == 12);
+    assert (chain->i_flags & BLOCK_FLAG_CORRUPTED);
+    block_Release (chain);
+}
+
+static void *test_fifo_Consumer (void *data)
+{
+    block_fifo_t *fifo = data;
+    unsigned expected = 0;
+    block_t *block;
+
+    while ((block = block_FifoGet (fifo)) != NULL)
+    {
+        assert (block->i_buffer == 4);
+        assert (GetDWBE (block->p_buffer) == expected);
+        expected++;
+        block_Release (block);
+    }
+    assert (expected == 20000);
+    return NULL;
+}
+
+static void test_fifo (unsigned flags)
+{
+    block_fifo_t *fifo = block_FifoNewExt (flags);
+    assert (fifo != NULL);
+
+    /* Accounting, chains and ordering, including ring overflow */
+    for (unsigned i = 0; i < 5000; i++)
+    {
+        block_t *block = block_Alloc (4);
+        assert (block != NULL);
+        SetDWBE (block->p_buffer, i);
+        if ((i & 1) && i + 1 < 5000)
+        {   /* queue a chain of two blocks */
+            block_t *next = block_Alloc (4);
+            assert (next != NULL);
+            SetDWBE (next->p_buffer, ++i);
+            block->p_next = next;
+        }
+        block_FifoPut (fifo, block);
+    }
+    assert (block_FifoCount (fifo) == 5000);
+
+    for (unsigned i = 0; i < 3000; i++)
+    {
+        block_t *block = block_FifoShow (fifo);
+        assert (GetDWBE (block->p_buffer) == i);
+        block = block_FifoGet (fifo);
+        assert (block->p_next == NULL);
+        assert (GetDWBE (block->p_buffer) == i);
+        block_Release (block);
+    }
+    assert (block_FifoCount (fifo) == 2000);
+
+    block_FifoEmpty (fifo);
+    assert (block_FifoCount (fifo) == 0);
+
+    /* Forced wake up */
+    block_FifoWake (fifo);
+    assert (block_FifoGet (fifo) == NULL);
+
+    /* Concurrent producer and consumer */
+    vlc_thread_t th;
+    if (vlc_clone (&th, test_fifo_Consumer, fifo, VLC_THREAD_PRIORITY_LOW))
+        abort ();
+
+    for (unsigned i = 0; i < 20000; i++)
+    {
+        block_t *block = block_Alloc (4);
+        assert (block != NULL);
+        SetDWBE (block->p_buffer, i);
+        block_FifoPut (fifo, block);
+        if ((i % 1000) == 0)
+            block_FifoPace (fifo, 10, SIZE_MAX);
+    }
+    block_FifoPace (fifo, 0, SIZE_MAX);
+    assert (block_FifoCount (fifo) == 0);
+    block_FifoWake (fifo);
+    vlc_join (th, NULL);
+    block_FifoRelease (fifo);
+}
+
 int main (void)
 {
     test_block_File ();
     test_block ();
+    test_block_Cache ();
+    test_block_View ();
+    test_block_ChainGatherExt ();
+    test_fifo (0);
+    test_fifo (BLOCK_FIFO_SPSC);
     return 0;
 }
 
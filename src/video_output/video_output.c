@@ -721,6 +721,7 @@ static void ThreadFilterFlush(vout_thread_t *vout, bool is_locked)
         vlc_mutex_lock(&vout->p->filter.lock);
     filter_chain_VideoFlush(vout->p->filter.chain_static);
     filter_chain_VideoFlush(vout->p->filter.chain_interactive);
+    picture_fifo_Flush(vout->p->filter.in_flight, INT64_MAX, true);
     if (!is_locked)
         vlc_mutex_unlock(&vout->p->filter.lock);
 }
@@ -752,7 +753,10 @@ static void ThreadChangeFilters(vout_thread_t *vout,
             vout_filter_t *e = xmalloc(sizeof(*e));
             e->name = name;
             e->cfg  = cfg;
-            if (!strcmp(e->name, "deinterlace") ||
+            /* Only the static chain runs on threads, so that all filters
+             * go there. They are then applied once per decoded picture. */
+            if (vout->p->filter.threads > 0 ||
+                !strcmp(e->name, "deinterlace") ||
                 !strcmp(e->name, "postproc")) {
                 vlc_array_append(&array_static, e);
             } else {
@@ -821,14 +825,50 @@ static void ThreadChangeFilters(vout_thread_t *vout,
 
 
 /* */
+static void ThreadDisplaySetDecoded(vout_thread_t *vout, picture_t *decoded)
+{
+    if (vout->p->displayed.decoded)
+        picture_Release(vout->p->displayed.decoded);
+
+    vout->p->displayed.decoded       = decoded;
+    vout->p->displayed.timestamp     = decoded->date;
+    vout->p->displayed.is_interlaced = !decoded->b_progressive;
+}
+
+/* With filter threads, the static chain returns pictures decoded earlier:
+ * finds the decoded picture matching a filtered one */
+static void ThreadDisplayFiltered(vout_thread_t *vout, const picture_t *filtered)
+{
+    picture_t *decoded = NULL;
+
+    for (;;) {
+        picture_t *next = picture_fifo_Peek(vout->p->filter.in_flight);
+        if (!next)
+            break;
+        const bool is_before = next->date <= filtered->date;
+        picture_Release(next);
+        if (!is_before)
+            break;
+
+        if (decoded)
+            picture_Release(decoded);
+        decoded = picture_fifo_Pop(vout->p->filter.in_flight);
+    }
+    if (decoded)
+        ThreadDisplaySetDecoded(vout, decoded);
+}
+
 static int ThreadDisplayPreparePicture(vout_thread_t *vout, bool reuse, bool frame_by_frame)
 {
     bool is_late_dropped = vout->p->is_late_dropped && !vout->p->pause.is_on && !frame_by_frame;
+    const bool is_threaded = vout->p->filter.threads > 0;
 
     vlc_mutex_lock(&vout->p->filter.lock);
 
+    /* With filter threads, pictures pushed by the previous calls may be
+     * ready, even if a reuse is requested */
     picture_t *picture = filter_chain_VideoFilter(vout->p->filter.chain_static, NULL);
-    assert(!reuse || !picture);
+    assert(!reuse || !picture || is_threaded);
 
     while (!picture) {
         picture_t *decoded;
@@ -854,19 +894,24 @@ static int ThreadDisplayPreparePicture(vout_thread_t *vout, bool reuse, bool fra
             }
         }
 
-        if (!decoded)
+        if (!decoded) {
+            /* Nothing new to filter: wait for the pictures being filtered
+             * rather than pushing the same picture again on reuse */
+            if (is_threaded)
+                picture = filter_chain_VideoDrain(vout->p->filter.chain_static);
             break;
+        }
         reuse = false;
 
-        if (vout->p->displayed.decoded)
-            picture_Release(vout->p->displayed.decoded);
-
-        vout->p->displayed.decoded       = picture_Hold(decoded);
-        vout->p->displayed.timestamp     = decoded->date;
-        vout->p->displayed.is_interlaced = !decoded->b_progressive;
+        if (is_threaded)
+            picture_fifo_Push(vout->p->filter.in_flight, picture_Hold(decoded));
+        else
+            ThreadDisplaySetDecoded(vout, picture_Hold(decoded));
 
         picture = filter_chain_VideoFilter(vout->p->filter.chain_static, decoded);
     }
+    if (picture && is_threaded)
+        ThreadDisplayFiltered(vout, picture);
 
     vlc_mutex_unlock(&vout->p->filter.lock);
 
@@ -1328,9 +1373,15 @@ static int ThreadStart(vout_thread_t *vout, const vout_display_state_t *state)
     vout->p->filter.chain_static =
         filter_chain_New( vout, "video filter2", true,
                           VoutVideoFilterStaticAllocationSetup, NULL, vout);
+    vout->p->filter.threads = var_InheritInteger(vout, "video-filter-threads");
+    vout->p->filter.in_flight = picture_fifo_New();
+    filter_chain_SetThreads(vout->p->filter.chain_static,
+                            vout->p->filter.threads);
     vout->p->filter.chain_interactive =
         filter_chain_New( vout, "video filter2", true,
                           VoutVideoFilterInteractiveAllocationSetup, NULL, vout);
+    if (!vout->p->filter.in_flight)
+        return VLC_ENOMEM;
 
     vout_display_state_t state_default;
     if (!state) {
@@ -1389,6 +1440,8 @@ static void ThreadStop(vout_thread_t *vout, vout_display_state_t *state)
     /* Destroy the video filters2 */
     filter_chain_Delete(vout->p->filter.chain_interactive);
     filter_chain_Delete(vout->p->filter.chain_static);
+    if (vout->p->filter.in_flight)
+        picture_fifo_Delete(vout->p->filter.in_flight);
     video_format_Clean(&vout->p->filter.format);
     free(vout->p->filter.configuration);
 
@@ -124,6 +124,8 @@ struct vout_thread_sys_t
         video_format_t  format;
         filter_chain_t  *chain_static;
         filter_chain_t  *chain_interactive;
+        unsigned        threads;
+        picture_fifo_t  *in_flight; /**< Decoded pictures in the threads */
     } filter;
 
     /* */
@@ -0,0 +1,91 @@
+/*****************************************************************************
+ * video.h: common definitions of the video filter tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef TEST_VIDEO_H
+#define TEST_VIDEO_H
+
+#include "test.h"
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+
+/* Initial value of test_PictureHash() */
+#define TEST_HASH_INIT 2166136261u
+
+static inline picture_t *test_BufferNew( filter_t *p_filter )
+{
+    return picture_NewFromFormat( &p_filter->fmt_out.video );
+}
+
+static inline void test_BufferDel( filter_t *p_filter, picture_t *p_pic )
+{
+    VLC_UNUSED(p_filter);
+    picture_Release( p_pic );
+}
+
+/* Allocation callback of filter_chain_New(): the filters of the chain
+ * allocate their output pictures in the heap */
+static inline int test_AllocationInit( filter_t *p_filter, void *p_data )
+{
+    VLC_UNUSED(p_data);
+    p_filter->pf_video_buffer_new = test_BufferNew;
+    p_filter->pf_video_buffer_del = test_BufferDel;
+    return VLC_SUCCESS;
+}
+
+/* Returns a picture filled with i_value plus the plane index, or with
+ * rand() noise if i_value is negative */
+static inline picture_t *test_PictureNew( const video_format_t *p_fmt,
+                                          int i_value )
+{
+    picture_t *p_pic = picture_NewFromFormat( p_fmt );
+
+    assert( p_pic != NULL );
+    for( int j = 0; j < p_pic->i_planes; j++ )
+    {
+        plane_t *p = &p_pic->p[j];
+
+        for( int y = 0; y < p->i_lines; y++ )
+            for( int x = 0; x < p->i_pitch; x++ )
+                p->p_pixels[y * p->i_pitch + x] =
+                    i_value >= 0 ? i_value + j : rand();
+    }
+    return p_pic;
+}
+
+/* Continues the FNV-1a hash of the visible pixels, i_edge pixels away
+ * from the borders */
+static inline uint32_t test_PictureHash( uint32_t i_hash,
+                                         const picture_t *p_pic, int i_edge )
+{
+    for( int j = 0; j < p_pic->i_planes; j++ )
+    {
+        const plane_t *p = &p_pic->p[j];
+
+        for( int y = i_edge; y < p->i_visible_lines - i_edge; y++ )
+            for( int x = i_edge; x < p->i_visible_pitch - i_edge; x++ )
+                i_hash = (i_hash ^ p->p_pixels[y * p->i_pitch + x])
+                       * 16777619;
+    }
+    return i_hash;
+}
+
+#endif /* TEST_VIDEO_H */
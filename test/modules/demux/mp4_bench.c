@@ -0,0 +1,360 @@
+/*****************************************************************************
+ * mp4_bench.c: MP4 demuxer open time and memory use with long files
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define ITERATIONS 5
+
+/* A synthetic movie with one sample per chunk, as most muxers interleave
+ * video, and a composition offset per sample, as with B-frames. */
+#define VIDEO_RATE   25
+#define AUDIO_RATE   48000
+#define AUDIO_FRAME  1024
+#define AUDIO_TRACKS 2
+#define SAMPLE_SIZE  16
+
+/*****************************************************************************
+ * Minimal MP4 writer
+ *****************************************************************************/
+static uint8_t *buf;
+static size_t buf_size, buf_alloc;
+static size_t box_stack[16];
+static unsigned box_depth;
+
+static void put (const void *data, size_t size)
+{
+    if (buf_size + size > buf_alloc)
+    {
+        buf_alloc = (buf_size + size) * 2;
+        buf = realloc (buf, buf_alloc);
+        assert (buf != NULL);
+    }
+    memcpy (buf + buf_size, data, size);
+    buf_size += size;
+}
+
+static void put32 (uint32_t v)
+{
+    uint8_t b[4] = { v >> 24, v >> 16, v >> 8, v };
+    put (b, 4);
+}
+
+static void put16 (uint16_t v)
+{
+    uint8_t b[2] = { v >> 8, v };
+    put (b, 2);
+}
+
+static void put_zero (size_t size)
+{
+    while (size-- > 0)
+        put ("", 1);
+}
+
+static void box_start (const char *type)
+{
+    box_stack[box_depth++] = buf_size;
+    put32 (0);
+    put (type, 4);
+}
+
+static void fullbox_start (const char *type)
+{
+    box_start (type);
+    put32 (0);
+}
+
+static void box_end (void)
+{
+    size_t start = box_stack[--box_depth];
+    uint32_t size = buf_size - start;
+
+    buf[start] = size >> 24;
+    buf[start + 1] = size >> 16;
+    buf[start + 2] = size >> 8;
+    buf[start + 3] = size;
+}
+
+static void put_matrix (void)
+{
+    static const uint32_t matrix[9] = {
+        0x10000, 0, 0, 0, 0x10000, 0, 0, 0, 0x40000000 };
+    for (unsigned i = 0; i < 9; i++)
+        put32 (matrix[i]);
+}
+
+static void put_track (unsigned id, bool video, uint32_t samples,
+                       uint64_t *offset)
+{
+    uint32_t timescale = video ? VIDEO_RATE : AUDIO_RATE;
+    uint32_t delta = video ? 1 : AUDIO_FRAME;
+
+    box_start ("trak");
+    fullbox_start ("tkhd");
+    buf[buf_size - 1] = 3; /* enabled, in movie */
+    put32 (0); put32 (0); put32 (id); put32 (0);
+    put32 ((uint64_t)samples * delta * 1000 / timescale);
+    put_zero (8); put16 (0); put16 (video ? 0 : 1); put16 (video ? 0 : 0x100);
+    put16 (0); put_matrix ();
+    put32 (video ? 320 << 16 : 0); put32 (video ? 240 << 16 : 0);
+    box_end ();
+
+    box_start ("mdia");
+    fullbox_start ("mdhd");
+    put32 (0); put32 (0); put32 (timescale); put32 (samples * delta);
+    put16 (0x55c4); put16 (0);
+    box_end ();
+    fullbox_start ("hdlr");
+    put32 (0); put (video ? "vide" : "soun", 4); put_zero (12); put ("", 1);
+    box_end ();
+
+    box_start ("minf");
+    if (video)
+    {
+        fullbox_start ("vmhd");
+        put_zero (8);
+    }
+    else
+    {
+        fullbox_start ("smhd");
+        put_zero (4);
+    }
+    box_end ();
+    box_start ("stbl");
+
+    fullbox_start ("stsd");
+    put32 (1);
+    if (video)
+    {
+        box_start ("mp4v");
+        put_zero (6); put16 (1);
+        put_zero (16); put16 (320); put16 (240);
+        put32 (0x480000); put32 (0x480000); put32 (0); put16 (1);
+        put_zero (32); put16 (0x18); put16 (0xffff);
+        box_end ();
+    }
+    else
+    {
+        box_start ("mp4a");
+        put_zero (6); put16 (1);
+        put_zero (8); put16 (2); put16 (16); put16 (0); put16 (0);
+        put32 (AUDIO_RATE << 16);
+        box_end ();
+    }
+    box_end ();
+
+    fullbox_start ("stts");
+    put32 (1);
+    put32 (samples); put32 (delta);
+    box_end ();
+
+    if (video)
+    {
+        fullbox_start ("ctts");
+        put32 (samples);
+        for (uint32_t i = 0; i < samples; i++)
+        {
+            put32 (1);
+            put32 ((i % 3) ? 0 : 2);
+        }
+        box_end ();
+
+        fullbox_start ("stss");
+        put32 ((samples + 49) / 50);
+        for (uint32_t i = 0; i < samples; i += 50)
+            put32 (i + 1);
+        box_end ();
+    }
+
+    fullbox_start ("stsc");
+    put32 (1);
+    put32 (1); put32 (1); put32 (1);
+    box_end ();
+
+    fullbox_start ("stsz");
+    put32 (0); put32 (samples);
+    for (uint32_t i = 0; i < samples; i++)
+        put32 (SAMPLE_SIZE);
+    box_end ();
+
+    fullbox_start ("co64");
+    put32 (samples);
+    for (uint32_t i = 0; i < samples; i++)
+    {
+        put32 (*offset >> 32);
+        put32 (*offset);
+        *offset += SAMPLE_SIZE;
+    }
+    box_end ();
+
+    box_end (); /* stbl */
+    box_end (); /* minf */
+    box_end (); /* mdia */
+    box_end (); /* trak */
+}
+
+static void write_movie (const char *path, unsigned hours)
+{
+    uint32_t video = hours * 3600 * VIDEO_RATE;
+    uint32_t audio = (uint64_t)hours * 3600 * AUDIO_RATE / AUDIO_FRAME;
+    uint64_t mdat = (uint64_t)SAMPLE_SIZE * (video + AUDIO_TRACKS * audio);
+    uint64_t offset;
+    FILE *file = fopen (path, "wb");
+
+    assert (file != NULL);
+    buf_size = 0;
+
+    box_start ("ftyp");
+    put ("isom", 4); put32 (0); put ("isom", 4);
+    box_end ();
+    put32 (1); put ("mdat", 4); put32 ((mdat + 16) >> 32); put32 (mdat + 16);
+    offset = buf_size;
+    assert (fwrite (buf, 1, buf_size, file) == buf_size);
+    assert (fseek (file, mdat, SEEK_CUR) == 0);
+
+    buf_size = 0;
+    box_start ("moov");
+    fullbox_start ("mvhd");
+    put32 (0); put32 (0); put32 (1000); put32 (hours * 3600 * 1000);
+    put32 (0x10000); put16 (0x100); put_zero (10); put_matrix ();
+    put_zero (24); put32 (AUDIO_TRACKS + 2);
+    box_end ();
+    put_track (1, true, video, &offset);
+    for (unsigned i = 0; i < AUDIO_TRACKS; i++)
+        put_track (2 + i, false, audio, &offset);
+    box_end ();
+    assert (fwrite (buf, 1, buf_size, file) == buf_size);
+    assert (fclose (file) == 0);
+}
+
+/*****************************************************************************
+ * Benchmark
+ *****************************************************************************/
+static libvlc_instance_t *create (void)
+{
+    const char *argv[] = {
+        "--quiet", "--ignore-config", "--no-media-library", "--demux=mp4",
+    };
+
+    return libvlc_new (sizeof (argv) / sizeof (argv[0]), argv);
+}
+
+static void parse (libvlc_instance_t *vlc, const char *path)
+{
+    libvlc_media_t *media = libvlc_media_new_path (vlc, path);
+    assert (media != NULL);
+    libvlc_media_parse (media);
+    libvlc_media_release (media);
+}
+
+static long status_kb (const char *field)
+{
+    FILE *file = fopen ("/proc/self/status", "r");
+    char line[256];
+    long kb = -1;
+
+    if (file == NULL)
+        return -1;
+    while (fgets (line, sizeof (line), file) != NULL)
+        if (!strncmp (line, field, strlen (field)))
+            kb = strtol (line + strlen (field) + 1, NULL, 10);
+    fclose (file);
+    return kb;
+}
+
+/* Peak memory use while opening, in a separate process */
+static void bench_memory (const char *path)
+{
+    pid_t pid = fork ();
+    assert (pid >= 0);
+
+    if (pid == 0)
+    {
+        libvlc_instance_t *vlc = create ();
+        assert (vlc != NULL);
+        /* Load the plugins first */
+        parse (vlc, "/dev/null");
+
+        long before = status_kb ("VmRSS:");
+        parse (vlc, path);
+        long peak = status_kb ("VmHWM:");
+        libvlc_release (vlc);
+
+        if (before < 0 || peak < 0)
+            printf ("%12s\n", "n/a");
+        else
+            printf ("%9ld KiB\n", peak - before);
+        exit (0);
+    }
+
+    int status;
+    assert (waitpid (pid, &status, 0) == pid);
+    assert (WIFEXITED (status) && WEXITSTATUS (status) == 0);
+}
+
+static void bench (libvlc_instance_t *vlc, unsigned hours)
+{
+    char path[] = "/tmp/vlc-bench-mp4XXXXXX";
+    int fd = mkstemp (path);
+
+    assert (fd >= 0);
+    close (fd);
+    write_movie (path, hours);
+
+    parse (vlc, path);
+    int64_t start = libvlc_clock ();
+    for (unsigned i = 0; i < ITERATIONS; i++)
+        parse (vlc, path);
+    int64_t duration = libvlc_clock () - start;
+
+    printf ("%2u hours: %8.2f ms/open, peak memory ", hours,
+            duration / (1000. * ITERATIONS));
+    fflush (stdout);
+    bench_memory (path);
+    unlink (path);
+}
+
+int main (void)
+{
+    /* Defaults to the build tree, as in the tests */
+    setenv ("VLC_PLUGIN_PATH", "../modules", 0);
+
+    libvlc_instance_t *vlc = create ();
+    assert (vlc != NULL);
+    bench (vlc, 1);
+    bench (vlc, 4);
+    bench (vlc, 12);
+    libvlc_release (vlc);
+    free (buf);
+    return 0;
+}
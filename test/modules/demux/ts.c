@@ -0,0 +1,297 @@
+/*****************************************************************************
+ * ts.c: test for the TS demux
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_stream.h>
+#include <vlc_modules.h>
+
+/* Two programs share the PCR carried by the ES of the first one */
+#define FRAMES      400
+#define PCR_PID     0x101
+#define PCR_STEP    3600 /* 40 ms in 90 kHz units */
+
+static const uint16_t pmt_pids[2] = { 0x100, 0x200 };
+static const uint16_t es_pids[2]  = { 0x101, 0x201 };
+
+/*****************************************************************************
+ * TS writer
+ *****************************************************************************/
+typedef struct
+{
+    uint8_t *p_buffer;
+    size_t   i_buffer;
+    uint8_t  cc[0x2000];
+} ts_writer_t;
+
+static uint32_t Crc32( const uint8_t *p, size_t i_size )
+{
+    uint32_t i_crc = 0xffffffff;
+
+    while( i_size-- )
+    {
+        i_crc ^= (uint32_t)*p++ << 24;
+        for( int i = 0; i < 8; i++ )
+            i_crc = (i_crc << 1) ^ ((i_crc & 0x80000000) ? 0x04c11db7 : 0);
+    }
+    return i_crc;
+}
+
+static uint8_t *Packet( ts_writer_t *w, uint16_t i_pid, bool b_start,
+                        bool b_adaptation )
+{
+    uint8_t *p = realloc( w->p_buffer, w->i_buffer + 188 );
+    assert( p != NULL );
+    w->p_buffer = p;
+    p += w->i_buffer;
+    w->i_buffer += 188;
+
+    memset( p, 0xff, 188 );
+    p[0] = 0x47;
+    p[1] = (b_start ? 0x40 : 0x00) | (i_pid >> 8);
+    p[2] = i_pid & 0xff;
+    p[3] = (b_adaptation ? 0x30 : 0x10) | (w->cc[i_pid]++ & 0x0f);
+    return p;
+}
+
+static void Section( ts_writer_t *w, uint16_t i_pid, uint8_t *p_section,
+                     size_t i_size )
+{
+    /* section_length covers the header extension and the CRC */
+    p_section[1] = 0xb0 | ((i_size + 4 - 3) >> 8);
+    p_section[2] = (i_size + 4 - 3) & 0xff;
+
+    uint32_t i_crc = Crc32( p_section, i_size );
+    uint8_t *p = Packet( w, i_pid, true, false );
+
+    p[4] = 0; /* pointer_field */
+    memcpy( &p[5], p_section, i_size );
+    SetDWBE( &p[5 + i_size], i_crc );
+}
+
+static void WritePSI( ts_writer_t *w )
+{
+    uint8_t pat[8 + 4 * 2] = {
+        0x00, 0, 0, 0x00, 0x01, 0xc1, 0x00, 0x00,
+    };
+    for( unsigned i = 0; i < 2; i++ )
+    {
+        SetWBE( &pat[8 + 4 * i], i + 1 );
+        SetWBE( &pat[10 + 4 * i], 0xe000 | pmt_pids[i] );
+    }
+    Section( w, 0, pat, sizeof(pat) );
+
+    for( unsigned i = 0; i < 2; i++ )
+    {
+        uint8_t pmt[12 + 5] = {
+            0x02, 0, 0, 0x00, i + 1, 0xc1, 0x00, 0x00,
+            0xe0 | (PCR_PID >> 8), PCR_PID & 0xff, 0xf0, 0x00,
+            0x03, 0xe0 | (es_pids[i] >> 8), es_pids[i] & 0xff, 0xf0, 0x00,
+        };
+        Section( w, pmt_pids[i], pmt, sizeof(pmt) );
+    }
+}
+
+/* Writes a PES fitting in a single packet, with a PCR when i_pcr >= 0 */
+static void WritePES( ts_writer_t *w, uint16_t i_pid, int64_t i_pts,
+                      int64_t i_pcr )
+{
+    uint8_t *p = Packet( w, i_pid, true, true );
+    const size_t i_pes = 6 + 3 + 5 + 100;
+
+    p[4] = 188 - 4 - 1 - i_pes; /* adaptation_field_length */
+    p[5] = 0x00;
+    if( i_pcr >= 0 )
+    {
+        p[5] = 0x10;
+        p[6]  = i_pcr >> 25;
+        p[7]  = i_pcr >> 17;
+        p[8]  = i_pcr >> 9;
+        p[9]  = i_pcr >> 1;
+        p[10] = ((i_pcr & 1) << 7) | 0x7e;
+        p[11] = 0x00;
+    }
+
+    p += 188 - i_pes;
+    p[0] = 0x00; p[1] = 0x00; p[2] = 0x01; p[3] = 0xc0;
+    SetWBE( &p[4], i_pes - 6 );
+    p[6] = 0x80;
+    p[7] = 0x80; /* PTS only */
+    p[8] = 5;
+    p[9]  = 0x21 | ((i_pts >> 29) & 0x0e);
+    p[10] = i_pts >> 22;
+    p[11] = 0x01 | ((i_pts >> 14) & 0xfe);
+    p[12] = i_pts >> 7;
+    p[13] = 0x01 | ((i_pts << 1) & 0xfe);
+    memset( &p[14], 0, i_pes - 14 );
+}
+
+/*****************************************************************************
+ * ES output recording the group PCRs
+ *****************************************************************************/
+struct es_out_id_t
+{
+    int i_group;
+};
+
+struct es_out_sys_t
+{
+    vlc_mutex_t lock;
+    vlc_cond_t  wait;
+    es_out_id_t ids[8];
+    unsigned    i_ids;
+    unsigned    i_pcrs[2];
+    mtime_t     i_last_pcr[2];
+    unsigned    i_blocks[2];
+};
+
+static es_out_id_t *EsOutAdd( es_out_t *out, const es_format_t *p_fmt )
+{
+    es_out_sys_t *p_sys = out->p_sys;
+    es_out_id_t *id;
+
+    vlc_mutex_lock( &p_sys->lock );
+    assert( p_sys->i_ids < ARRAY_SIZE(p_sys->ids) );
+    id = &p_sys->ids[p_sys->i_ids++];
+    id->i_group = p_fmt->i_group;
+    vlc_mutex_unlock( &p_sys->lock );
+    return id;
+}
+
+static int EsOutSend( es_out_t *out, es_out_id_t *id, block_t *p_block )
+{
+    es_out_sys_t *p_sys = out->p_sys;
+
+    assert( id->i_group == 1 || id->i_group == 2 );
+    vlc_mutex_lock( &p_sys->lock );
+    p_sys->i_blocks[id->i_group - 1]++;
+    vlc_mutex_unlock( &p_sys->lock );
+    block_ChainRelease( p_block );
+    return VLC_SUCCESS;
+}
+
+static void EsOutDel( es_out_t *out, es_out_id_t *id )
+{
+    VLC_UNUSED(out); VLC_UNUSED(id);
+}
+
+static int EsOutControl( es_out_t *out, int i_query, va_list args )
+{
+    es_out_sys_t *p_sys = out->p_sys;
+
+    if( i_query != ES_OUT_SET_GROUP_PCR )
+        return VLC_EGENERIC;
+
+    int i_group = va_arg( args, int );
+    mtime_t i_pcr = va_arg( args, int64_t );
+
+    assert( i_group == 1 || i_group == 2 );
+    vlc_mutex_lock( &p_sys->lock );
+    /* Each group must get its PCR in order */
+    assert( i_pcr > p_sys->i_last_pcr[i_group - 1] );
+    p_sys->i_last_pcr[i_group - 1] = i_pcr;
+    p_sys->i_pcrs[i_group - 1]++;
+    vlc_cond_signal( &p_sys->wait );
+    vlc_mutex_unlock( &p_sys->lock );
+    return VLC_SUCCESS;
+}
+
+static void test_shared_pcr( vlc_object_t *p_obj, block_t *p_ts,
+                             bool b_threads )
+{
+    es_out_sys_t sys;
+    es_out_t out = {
+        .pf_add = EsOutAdd,
+        .pf_send = EsOutSend,
+        .pf_del = EsOutDel,
+        .pf_control = EsOutControl,
+        .p_sys = &sys,
+    };
+
+    log( "Testing a PCR PID shared by two programs %s program threads\n",
+         b_threads ? "with" : "without" );
+    memset( &sys, 0, sizeof(sys) );
+    vlc_mutex_init( &sys.lock );
+    vlc_cond_init( &sys.wait );
+
+    demux_t *p_parent = vlc_object_create( p_obj, sizeof(*p_parent) );
+    assert( p_parent != NULL );
+    var_Create( p_parent, "ts-program-threads", VLC_VAR_BOOL );
+    var_SetBool( p_parent, "ts-program-threads", b_threads );
+
+    stream_t *s = stream_DemuxNew( p_parent, "ts", &out );
+    assert( s != NULL );
+    stream_DemuxSend( s, block_Duplicate( p_ts ) );
+
+    /* The last packets may wait in the demux for more data */
+    vlc_mutex_lock( &sys.lock );
+    while( sys.i_pcrs[0] < FRAMES / 2 || sys.i_pcrs[1] < FRAMES / 2 )
+        vlc_cond_wait( &sys.wait, &sys.lock );
+    vlc_mutex_unlock( &sys.lock );
+
+    stream_Delete( s );
+    vlc_object_release( p_parent );
+
+    log( "PCRs: %u/%u, blocks: %u/%u\n", sys.i_pcrs[0], sys.i_pcrs[1],
+         sys.i_blocks[0], sys.i_blocks[1] );
+    assert( sys.i_blocks[0] > 0 && sys.i_blocks[1] > 0 );
+    vlc_cond_destroy( &sys.wait );
+    vlc_mutex_destroy( &sys.lock );
+}
+
+int main( void )
+{
+    libvlc_instance_t *p_vlc;
+    ts_writer_t w;
+
+    test_init();
+
+    p_vlc = libvlc_new( test_defaults_nargs, test_defaults_args );
+    assert( p_vlc != NULL );
+
+    if( !module_exists( "ts" ) )
+    {
+        libvlc_release( p_vlc );
+        return 77;
+    }
+
+    memset( &w, 0, sizeof(w) );
+    for( unsigned i = 0; i < FRAMES; i++ )
+    {
+        if( i % 10 == 0 )
+            WritePSI( &w );
+        WritePES( &w, es_pids[0], (i + 1) * PCR_STEP, i * PCR_STEP );
+        WritePES( &w, es_pids[1], (i + 1) * PCR_STEP, -1 );
+    }
+
+    block_t *p_ts = block_heap_Alloc( w.p_buffer, w.i_buffer );
+    assert( p_ts != NULL );
+
+    vlc_object_t *p_obj = VLC_OBJECT(p_vlc->p_libvlc_int);
+    test_shared_pcr( p_obj, p_ts, false );
+    test_shared_pcr( p_obj, p_ts, true );
+
+    block_Release( p_ts );
+    libvlc_release( p_vlc );
+    return 0;
+}
@@ -0,0 +1,254 @@
+/*****************************************************************************
+ * packetizer_bench.c: video packetizers throughput
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Usage: bench_modules_packetizer [<codec> <elementary stream file>]...
+ * where codec is h264, hevc, mpgv, mp4v or VC-1 (WVC1). Without arguments,
+ * synthetic streams are used. */
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <string.h>
+#include <vlc_demux.h>
+#include <vlc_codec.h>
+#include <vlc_block_helper.h>
+#include "../../../modules/packetizer/startcode_helper.h"
+
+#define ITERATIONS   3
+#define STREAM_SIZE  (64 << 20)
+#define INPUT_SIZE   (7 * 188) /* as many bytes as a typical TS packet */
+
+/*****************************************************************************
+ * Synthetic Annex B stream: NAL units of random sizes, with random payloads
+ * escaped as an encoder would.
+ *****************************************************************************/
+static uint8_t *synthetic( vlc_fourcc_t i_codec, size_t *pi_size )
+{
+    uint8_t *p_buf = malloc( STREAM_SIZE );
+    size_t i_pos = 0;
+    unsigned i_nal = 0;
+
+    assert( p_buf != NULL );
+    srand( 0 );
+    while( i_pos < STREAM_SIZE - 256 )
+    {
+        /* A few large slices, and small parameter sets and headers */
+        size_t i_len = (i_nal++ % 4) ? 16 + rand() % 256
+                                       : 4096 + rand() % 65536;
+        uint8_t i_header;
+
+        switch( i_codec )
+        {
+            case VLC_CODEC_H264:
+                i_header = (i_nal % 4) ? 0x09 /* AUD */ : 0x01; /* slice */
+                break;
+            case VLC_CODEC_HEVC:
+                i_header = (i_nal % 4) ? 35 << 1 /* AUD */ : 1 << 1;
+                break;
+            default:
+                i_header = 0x01 + rand() % 0xaf; /* slice */
+                break;
+        }
+
+        p_buf[i_pos++] = 0x00;
+        p_buf[i_pos++] = 0x00;
+        p_buf[i_pos++] = 0x01;
+        p_buf[i_pos++] = i_header;
+        if( i_codec == VLC_CODEC_HEVC )
+            p_buf[i_pos++] = 0x01;
+
+        unsigned i_zeroes = 0;
+        for( size_t i = 0; i < i_len && i_pos < STREAM_SIZE - 1; i++ )
+        {
+            /* Compressed data is mostly random, with some zero runs */
+            uint8_t i_byte = (rand() % 64) ? rand() : 0;
+
+            if( i_zeroes >= 2 && i_byte <= 3 )
+            {
+                p_buf[i_pos++] = 0x03;
+                i_zeroes = 0;
+            }
+            p_buf[i_pos++] = i_byte;
+            i_zeroes = i_byte ? 0 : i_zeroes + 1;
+        }
+        if( p_buf[i_pos - 1] == 0x00 )
+            p_buf[i_pos++] = 0x80; /* trailing bits */
+    }
+    *pi_size = i_pos;
+    return p_buf;
+}
+
+static uint8_t *load( const char *psz_path, size_t *pi_size )
+{
+    FILE *file = fopen( psz_path, "rb" );
+    uint8_t *p_buf;
+    long i_size;
+
+    assert( file != NULL );
+    assert( fseek( file, 0, SEEK_END ) == 0 );
+    i_size = ftell( file );
+    assert( i_size > 0 );
+    rewind( file );
+    p_buf = malloc( i_size );
+    assert( p_buf != NULL );
+    assert( fread( p_buf, 1, i_size, file ) == (size_t)i_size );
+    fclose( file );
+    *pi_size = i_size;
+    return p_buf;
+}
+
+/*****************************************************************************
+ * Benchmarks
+ *****************************************************************************/
+static void bench_scanner( const char *psz_name, block_startcode_helper_t pf,
+                           const uint8_t *p_buf, size_t i_size )
+{
+    unsigned i_count = 0;
+    int64_t i_start = libvlc_clock();
+
+    for( unsigned i = 0; i < ITERATIONS; i++ )
+    {
+        const uint8_t *p = p_buf, *end = p_buf + i_size;
+
+        while( (p = pf( p, end )) != NULL )
+        {
+            i_count++;
+            p += 3;
+        }
+    }
+
+    int64_t i_duration = libvlc_clock() - i_start;
+    printf( "  %-4s scanner: %8.1f MiB/s (%u start codes)\n", psz_name,
+            (double)ITERATIONS * i_size / (1 << 20) * 1000000 / i_duration,
+            i_count / ITERATIONS );
+}
+
+static void bench_packetizer( demux_t *p_demux, vlc_fourcc_t i_codec,
+                              const uint8_t *p_buf, size_t i_size )
+{
+    int64_t i_duration = 0;
+    unsigned i_count = 0;
+
+    for( unsigned i = 0; i < ITERATIONS; i++ )
+    {
+        es_format_t fmt;
+        decoder_t *p_pack;
+
+        es_format_Init( &fmt, VIDEO_ES, i_codec );
+        p_pack = demux_PacketizerNew( p_demux, &fmt, "bench" );
+        assert( p_pack != NULL );
+
+        int64_t i_start = libvlc_clock();
+        for( size_t i_pos = 0; i_pos < i_size; i_pos += INPUT_SIZE )
+        {
+            size_t i_len = __MIN( (size_t)INPUT_SIZE, i_size - i_pos );
+            block_t *p_block = block_Alloc( i_len );
+            block_t *p_out;
+
+            assert( p_block != NULL );
+            memcpy( p_block->p_buffer, &p_buf[i_pos], i_len );
+            p_block->i_dts = p_block->i_pts = i_pos ? VLC_TS_INVALID
+                                                    : VLC_TS_0;
+            while( (p_out = p_pack->pf_packetize( p_pack, &p_block )) )
+            {
+                while( p_out != NULL )
+                {
+                    block_t *p_next = p_out->p_next;
+
+                    i_count++;
+                    block_Release( p_out );
+                    p_out = p_next;
+                }
+            }
+        }
+        i_duration += libvlc_clock() - i_start;
+        demux_PacketizerDestroy( p_pack );
+    }
+
+    printf( "  packetizer:   %8.1f MiB/s (%u blocks out)\n",
+            (double)ITERATIONS * i_size / (1 << 20) * 1000000 / i_duration,
+            i_count / ITERATIONS );
+}
+
+static void bench( demux_t *p_demux, vlc_fourcc_t i_codec,
+                   const uint8_t *p_buf, size_t i_size )
+{
+    printf( "%4.4s, %zu MiB:\n", (const char *)&i_codec, i_size >> 20 );
+    bench_scanner( "C", startcode_FindAnnexB_C, p_buf, i_size );
+#ifdef STARTCODE_SSE2
+    if( vlc_CPU_SSE2() )
+        bench_scanner( "SSE2", startcode_FindAnnexB_SSE2, p_buf, i_size );
+#endif
+#ifdef STARTCODE_AVX2
+    if( vlc_CPU_AVX2() )
+        bench_scanner( "AVX2", startcode_FindAnnexB_AVX2, p_buf, i_size );
+#endif
+#ifdef STARTCODE_NEON
+    bench_scanner( "NEON", startcode_FindAnnexB_NEON, p_buf, i_size );
+#endif
+    bench_packetizer( p_demux, i_codec, p_buf, i_size );
+}
+
+int main( int argc, char **argv )
+{
+    static const vlc_fourcc_t pi_codecs[] = {
+        VLC_CODEC_H264, VLC_CODEC_HEVC, VLC_CODEC_MPGV, VLC_CODEC_VC1,
+    };
+    const char *ppsz_args[] = {
+        "--quiet", "--ignore-config", "--no-media-library",
+    };
+
+    /* Defaults to the build tree, as in the tests */
+    setenv( "VLC_PLUGIN_PATH", "../modules", 0 );
+
+    libvlc_instance_t *p_vlc = libvlc_new( ARRAY_SIZE(ppsz_args), ppsz_args );
+    assert( p_vlc != NULL );
+
+    demux_t *p_demux = vlc_object_create( p_vlc->p_libvlc_int,
+                                          sizeof(*p_demux) );
+    assert( p_demux != NULL );
+
+    if( argc < 3 )
+    {
+        for( size_t i = 0; i < ARRAY_SIZE(pi_codecs); i++ )
+        {
+            size_t i_size;
+            uint8_t *p_buf = synthetic( pi_codecs[i], &i_size );
+
+            bench( p_demux, pi_codecs[i], p_buf, i_size );
+            free( p_buf );
+        }
+    }
+    for( int i = 1; i + 1 < argc; i += 2 )
+    {
+        vlc_fourcc_t i_codec = vlc_fourcc_GetCodecFromString( VIDEO_ES,
+                                                              argv[i] );
+        size_t i_size;
+        uint8_t *p_buf = load( argv[i + 1], &i_size );
+
+        assert( i_codec != 0 );
+        bench( p_demux, i_codec, p_buf, i_size );
+        free( p_buf );
+    }
+
+    vlc_object_release( p_demux );
+    libvlc_release( p_vlc );
+    return 0;
+}
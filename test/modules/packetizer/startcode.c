@@ -0,0 +1,140 @@
+/*****************************************************************************
+ * startcode.c: test for the packetizer start code scanners
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_block_helper.h>
+#include "../../../modules/packetizer/startcode_helper.h"
+
+#define BUFFER_SIZE 4096
+
+static const uint8_t p_startcode[3] = { 0x00, 0x00, 0x01 };
+
+/* Mostly zeroes and ones, so that start codes and near misses abound */
+static void fill( uint8_t *p, size_t i_size )
+{
+    for( size_t i = 0; i < i_size; i++ )
+    {
+        int r = rand() % 16;
+        p[i] = r < 6 ? 0 : r < 10 ? 1 : rand();
+    }
+}
+
+static const uint8_t *reference( const uint8_t *p, const uint8_t *end )
+{
+    for( ; end - p > 2; p++ )
+        if( p[0] == 0 && p[1] == 0 && p[2] == 1 )
+            return p;
+    return NULL;
+}
+
+static void test_scanner( const char *psz_name, block_startcode_helper_t pf,
+                          const uint8_t *p_buf )
+{
+    printf( "Testing the %s scanner\n", psz_name );
+    for( size_t i_start = 0; i_start < 64; i_start++ )
+        for( size_t i_end = i_start; i_end < BUFFER_SIZE; i_end += 1 + i_end / 16 )
+            assert( pf( &p_buf[i_start], &p_buf[i_end] ) ==
+                    reference( &p_buf[i_start], &p_buf[i_end] ) );
+}
+
+/* Returns all the start code offsets found in a chain of blocks */
+static size_t find_all( const uint8_t *p_buf, size_t i_size,
+                        const size_t *pi_splits, size_t *pi_found,
+                        block_startcode_helper_t pf )
+{
+    block_bytestream_t bytestream;
+    size_t i_offset = 0, i_count = 0;
+
+    block_BytestreamInit( &bytestream );
+    for( size_t i_pos = 0, i = 0; i_pos < i_size; i_pos += pi_splits[i++] )
+    {
+        size_t i_len = __MIN( pi_splits[i], i_size - i_pos );
+        block_t *p_block = block_Alloc( i_len );
+
+        assert( p_block != NULL );
+        memcpy( p_block->p_buffer, &p_buf[i_pos], i_len );
+        block_BytestreamPush( &bytestream, p_block );
+
+        /* Search as the packetizers do, with partial data */
+        while( !block_FindStartcodeFromOffset( &bytestream, &i_offset,
+                                               p_startcode, 3, pf ) )
+            pi_found[i_count++] = i_offset++;
+    }
+    block_BytestreamRelease( &bytestream );
+    return i_count;
+}
+
+static void test_bytestream( const uint8_t *p_buf )
+{
+    static size_t pi_splits[BUFFER_SIZE];
+    static size_t pi_ref[BUFFER_SIZE], pi_found[BUFFER_SIZE];
+
+    printf( "Testing the scanner with chained blocks\n" );
+    for( int i_run = 0; i_run < 100; i_run++ )
+    {
+        size_t i_max = 1 + rand() % (i_run < 50 ? 8 : 256);
+
+        for( size_t i = 0; i < BUFFER_SIZE; i++ )
+            pi_splits[i] = 1 + rand() % i_max;
+
+        size_t i_ref = find_all( p_buf, BUFFER_SIZE, pi_splits, pi_ref, NULL );
+        size_t i_count = find_all( p_buf, BUFFER_SIZE, pi_splits, pi_found,
+                                   startcode_FindAnnexB );
+        assert( i_count == i_ref );
+        for( size_t i = 0; i < i_count; i++ )
+        {
+            assert( pi_found[i] == pi_ref[i] );
+            assert( !memcmp( &p_buf[pi_found[i]], p_startcode, 3 ) );
+        }
+    }
+}
+
+int main( void )
+{
+    static uint8_t p_buf[BUFFER_SIZE];
+
+    srand( 0 );
+    fill( p_buf, BUFFER_SIZE );
+
+    test_scanner( "C", startcode_FindAnnexB_C, p_buf );
+#ifdef STARTCODE_SSE2
+    if( vlc_CPU_SSE2() )
+        test_scanner( "SSE2", startcode_FindAnnexB_SSE2, p_buf );
+#endif
+#ifdef STARTCODE_AVX2
+    if( vlc_CPU_AVX2() )
+        test_scanner( "AVX2", startcode_FindAnnexB_AVX2, p_buf );
+#endif
+#ifdef STARTCODE_NEON
+    test_scanner( "NEON", startcode_FindAnnexB_NEON, p_buf );
+#endif
+    test_bytestream( p_buf );
+    return 0;
+}
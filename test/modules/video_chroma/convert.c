@@ -0,0 +1,324 @@
+/*****************************************************************************
+ * convert.c: test for the single pass chroma conversions
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* The YUV repacking must be exact, and the RGB conversions must stay within
+ * rounding errors of the floating point BT.601 and BT.709 formulas. */
+
+/* Before the log() macro of the tests */
+#include <math.h>
+
+#include "../../libvlc/video.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+
+static const vlc_fourcc_t chromas[] = {
+    VLC_CODEC_I420, VLC_CODEC_YV12, VLC_CODEC_J420, VLC_CODEC_NV12,
+    VLC_CODEC_NV21, VLC_CODEC_I420_10L, VLC_CODEC_P010,
+    VLC_CODEC_RGB32, VLC_CODEC_RGBA, VLC_CODEC_BGRA,
+};
+
+/* Not multiples of the SIMD widths; the HD height selects BT.709 */
+static const struct { unsigned w, h; } sizes[] = {
+    { 200, 150 }, { 66, 720 },
+};
+
+static bool IsRGB( vlc_fourcc_t i_chroma )
+{
+    return i_chroma == VLC_CODEC_RGB32 || i_chroma == VLC_CODEC_RGBA
+        || i_chroma == VLC_CODEC_BGRA;
+}
+
+static picture_t *Picture( const video_format_t *p_fmt )
+{
+    picture_t *p_pic = test_PictureNew( p_fmt, -1 );
+
+    for( int j = 0; j < p_pic->i_planes; j++ )
+    {
+        plane_t *p = &p_pic->p[j];
+
+        for( int y = 0; y < p->i_lines; y++ )
+        {
+            uint8_t *p_line = &p->p_pixels[y * p->i_pitch];
+
+            /* Samples of the significant bits only */
+            if( p_fmt->i_chroma == VLC_CODEC_I420_10L )
+                for( int x = 0; x < p->i_pitch / 2; x++ )
+                    ((uint16_t *)p_line)[x] &= 0x3ff;
+            if( p_fmt->i_chroma == VLC_CODEC_P010 )
+                for( int x = 0; x < p->i_pitch / 2; x++ )
+                    ((uint16_t *)p_line)[x] &= 0xffc0;
+        }
+    }
+    return p_pic;
+}
+
+static unsigned Sample16( const plane_t *p, unsigned x, unsigned y,
+                          unsigned i_shift )
+{
+    unsigned v = ((const uint16_t *)&p->p_pixels[y * p->i_pitch])[x];
+
+    v = (v + (1 << (i_shift - 1))) >> i_shift;
+    return __MIN(v, 255);
+}
+
+/* 8-bit YUV of the pixel (x, y) */
+static void GetYUV( const picture_t *p_pic, unsigned x, unsigned y,
+                    unsigned *Y, unsigned *U, unsigned *V )
+{
+    const plane_t *p = p_pic->p;
+    const unsigned cx = x / 2, cy = y / 2;
+
+    switch( p_pic->format.i_chroma )
+    {
+        case VLC_CODEC_I420:
+        case VLC_CODEC_J420:
+        case VLC_CODEC_YV12:
+        {
+            const bool b_swap = p_pic->format.i_chroma == VLC_CODEC_YV12;
+
+            *Y = p[0].p_pixels[y * p[0].i_pitch + x];
+            *U = p[b_swap ? 2 : 1].p_pixels[cy * p[1].i_pitch + cx];
+            *V = p[b_swap ? 1 : 2].p_pixels[cy * p[2].i_pitch + cx];
+            break;
+        }
+        case VLC_CODEC_NV12:
+        case VLC_CODEC_NV21:
+        {
+            const bool b_swap = p_pic->format.i_chroma == VLC_CODEC_NV21;
+
+            *Y = p[0].p_pixels[y * p[0].i_pitch + x];
+            *U = p[1].p_pixels[cy * p[1].i_pitch + 2 * cx + b_swap];
+            *V = p[1].p_pixels[cy * p[1].i_pitch + 2 * cx + !b_swap];
+            break;
+        }
+        case VLC_CODEC_I420_10L:
+            *Y = Sample16( &p[0], x, y, 2 );
+            *U = Sample16( &p[1], cx, cy, 2 );
+            *V = Sample16( &p[2], cx, cy, 2 );
+            break;
+        case VLC_CODEC_P010:
+            *Y = Sample16( &p[0], x, y, 8 );
+            *U = Sample16( &p[1], 2 * cx, cy, 8 );
+            *V = Sample16( &p[1], 2 * cx + 1, cy, 8 );
+            break;
+        default:
+            assert( false );
+    }
+}
+
+static void GetRGB( const picture_t *p_pic, unsigned x, unsigned y,
+                    int *R, int *G, int *B )
+{
+    const uint8_t *p = &p_pic->p[0].p_pixels[y * p_pic->p[0].i_pitch + 4 * x];
+    const bool b_swap = p_pic->format.i_chroma == VLC_CODEC_RGBA;
+
+    *R = p[b_swap ? 0 : 2];
+    *G = p[1];
+    *B = p[b_swap ? 2 : 0];
+}
+
+typedef struct
+{
+    double kr, kb, ys, cs;
+    int i_y_offset;
+} matrix_t;
+
+static matrix_t Matrix( vlc_fourcc_t i_yuv, unsigned i_height )
+{
+    const bool b_full = i_yuv == VLC_CODEC_J420;
+    const bool b_709 = i_height > 576;
+    matrix_t m = {
+        .kr = b_709 ? .2126 : .299,
+        .kb = b_709 ? .0722 : .114,
+        .ys = b_full ? 1. : 219. / 255.,
+        .cs = b_full ? 1. : 224. / 255.,
+        .i_y_offset = b_full ? 0 : 16,
+    };
+    return m;
+}
+
+static void CheckClose( double f_ref, int i_value )
+{
+    const double f = VLC_CLIP( f_ref, 0., 255. );
+
+    assert( fabs( f - i_value ) <= 1.6 );
+}
+
+static void Check( const picture_t *p_src, const picture_t *p_dst )
+{
+    const vlc_fourcc_t i_src = p_src->format.i_chroma;
+    const vlc_fourcc_t i_dst = p_dst->format.i_chroma;
+    const unsigned i_width = p_src->format.i_width;
+    const unsigned i_height = p_src->format.i_height;
+
+    for( unsigned y = 0; y < i_height; y++ )
+        for( unsigned x = 0; x < i_width; x++ )
+        {
+            unsigned Y, U, V, Yd, Ud, Vd;
+            int R, G, B;
+
+            if( IsRGB( i_dst ) )
+            {
+                const matrix_t m = Matrix( i_src, i_height );
+                const double kg = 1. - m.kr - m.kb;
+
+                GetYUV( p_src, x, y, &Y, &U, &V );
+                GetRGB( p_dst, x, y, &R, &G, &B );
+
+                const double l = ((int)Y - m.i_y_offset) / m.ys;
+                const double u = ((int)U - 128) / m.cs;
+                const double v = ((int)V - 128) / m.cs;
+                CheckClose( l + 2. * (1. - m.kr) * v, R );
+                CheckClose( l - 2. * (1. - m.kb) * m.kb / kg * u
+                              - 2. * (1. - m.kr) * m.kr / kg * v, G );
+                CheckClose( l + 2. * (1. - m.kb) * u, B );
+            }
+            else if( IsRGB( i_src ) )
+            {
+                const matrix_t m = Matrix( i_dst, i_height );
+                const double kg = 1. - m.kr - m.kb;
+                double r = 0., g = 0., b = 0.;
+
+                GetYUV( p_dst, x, y, &Y, &U, &V );
+                GetRGB( p_src, x, y, &R, &G, &B );
+                CheckClose( m.i_y_offset
+                            + m.ys * (m.kr * R + kg * G + m.kb * B), Y );
+
+                /* The chroma of the mean of the 2x2 block */
+                for( unsigned i = 0; i < 4; i++ )
+                {
+                    GetRGB( p_src, (x & ~1) + i % 2, (y & ~1) + i / 2,
+                            &R, &G, &B );
+                    r += R / 4.;
+                    g += G / 4.;
+                    b += B / 4.;
+                }
+                CheckClose( 128. + m.cs * (b - (m.kr * r + kg * g + m.kb * b))
+                                 / (2. * (1. - m.kb)), U );
+                CheckClose( 128. + m.cs * (r - (m.kr * r + kg * g + m.kb * b))
+                                 / (2. * (1. - m.kr)), V );
+            }
+            else
+            {
+                GetYUV( p_src, x, y, &Y, &U, &V );
+                GetYUV( p_dst, x, y, &Yd, &Ud, &Vd );
+                assert( Y == Yd && U == Ud && V == Vd );
+            }
+        }
+}
+
+/* Returns the converted picture, or NULL if the pair is not supported */
+static picture_t *Convert( libvlc_instance_t *p_vlc, picture_t *p_src,
+                           vlc_fourcc_t i_chroma )
+{
+    es_format_t fmt_in, fmt_out;
+
+    es_format_Init( &fmt_in, VIDEO_ES, p_src->format.i_chroma );
+    fmt_in.video = p_src->format;
+    es_format_Init( &fmt_out, VIDEO_ES, i_chroma );
+    video_format_Setup( &fmt_out.video, i_chroma, p_src->format.i_width,
+                        p_src->format.i_height, p_src->format.i_width,
+                        p_src->format.i_height, 1, 1 );
+
+    filter_chain_t *p_chain = filter_chain_New( p_vlc->p_libvlc_int,
+                                                "video filter2", false,
+                                                test_AllocationInit,
+                                                NULL, NULL );
+    assert( p_chain != NULL );
+    filter_chain_Reset( p_chain, &fmt_in, &fmt_out );
+
+    picture_t *p_pic = NULL;
+    if( filter_chain_AppendFilter( p_chain, "convert", NULL,
+                                   &fmt_in, &fmt_out ) != NULL )
+    {
+        picture_Hold( p_src );
+        p_pic = filter_chain_VideoFilter( p_chain, p_src );
+        assert( p_pic != NULL );
+        assert( p_pic->format.i_chroma == i_chroma );
+    }
+
+    filter_chain_Delete( p_chain );
+    es_format_Clean( &fmt_in );
+    es_format_Clean( &fmt_out );
+    return p_pic;
+}
+
+int main( void )
+{
+    const char *ppsz_args[test_defaults_nargs + 1];
+    libvlc_instance_t *pp_vlc[2];
+    unsigned i_pairs = 0;
+
+    test_init();
+
+    /* Without and with the slice threads */
+    memcpy( ppsz_args, test_defaults_args, sizeof(test_defaults_args) );
+    for( unsigned i = 0; i < 2; i++ )
+    {
+        ppsz_args[test_defaults_nargs] =
+            i ? "--video-filter-slice-threads=4"
+              : "--video-filter-slice-threads=1";
+        pp_vlc[i] = libvlc_new( test_defaults_nargs + 1, ppsz_args );
+        assert( pp_vlc[i] != NULL );
+    }
+
+    srand( 0 );
+    for( size_t s = 0; s < ARRAY_SIZE(sizes); s++ )
+        for( size_t i = 0; i < ARRAY_SIZE(chromas); i++ )
+        {
+            video_format_t fmt;
+
+            video_format_Init( &fmt, chromas[i] );
+            video_format_Setup( &fmt, chromas[i], sizes[s].w, sizes[s].h,
+                                sizes[s].w, sizes[s].h, 1, 1 );
+            picture_t *p_src = Picture( &fmt );
+
+            for( size_t j = 0; j < ARRAY_SIZE(chromas); j++ )
+            {
+                picture_t *p_dst = Convert( pp_vlc[0], p_src, chromas[j] );
+                if( p_dst == NULL )
+                    continue;
+
+                log( "Testing %4.4s to %4.4s at %ux%u\n",
+                     (const char *)&chromas[i], (const char *)&chromas[j],
+                     sizes[s].w, sizes[s].h );
+                Check( p_src, p_dst );
+
+                picture_t *p_sliced = Convert( pp_vlc[1], p_src, chromas[j] );
+                assert( p_sliced != NULL );
+                assert( test_PictureHash( TEST_HASH_INIT, p_sliced, 0 ) ==
+                        test_PictureHash( TEST_HASH_INIT, p_dst, 0 ) );
+                picture_Release( p_sliced );
+                picture_Release( p_dst );
+                i_pairs++;
+            }
+            picture_Release( p_src );
+        }
+
+    /* All but the RGB to RGB, the 16-bit outputs and the range changes */
+    assert( i_pairs == 2 * 56 );
+
+    for( unsigned i = 0; i < 2; i++ )
+        libvlc_release( pp_vlc[i] );
+    return 0;
+}
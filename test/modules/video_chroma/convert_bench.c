@@ -0,0 +1,135 @@
+/*****************************************************************************
+ * convert_bench.c: chroma conversions throughput
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Usage: bench_modules_video_chroma [<module>]...
+ * Every pair of chromas converted by the modules (by default the single pass
+ * "convert" one) is measured on 1080p pictures, with one thread and with as
+ * many threads as processors. Another module name, "chain" or "any", gives
+ * the figures of the previous conversions for comparison. */
+
+#include "../../libvlc/video.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+
+#define PICTURES 100
+#define WIDTH    1920
+#define HEIGHT   1080
+
+static const vlc_fourcc_t chromas[] = {
+    VLC_CODEC_I420, VLC_CODEC_YV12, VLC_CODEC_J420, VLC_CODEC_NV12,
+    VLC_CODEC_NV21, VLC_CODEC_I420_10L, VLC_CODEC_P010,
+    VLC_CODEC_RGB32, VLC_CODEC_RGBA, VLC_CODEC_BGRA,
+};
+
+static void bench( libvlc_instance_t *p_vlc, const char *psz_module,
+                   picture_t *p_src, vlc_fourcc_t i_chroma,
+                   unsigned i_threads )
+{
+    es_format_t fmt_in, fmt_out;
+
+    es_format_Init( &fmt_in, VIDEO_ES, p_src->format.i_chroma );
+    fmt_in.video = p_src->format;
+    es_format_Init( &fmt_out, VIDEO_ES, i_chroma );
+    video_format_Setup( &fmt_out.video, i_chroma, WIDTH, HEIGHT,
+                        WIDTH, HEIGHT, 1, 1 );
+
+    filter_chain_t *p_chain = filter_chain_New( p_vlc->p_libvlc_int,
+                                                "video filter2", false,
+                                                test_AllocationInit,
+                                                NULL, NULL );
+    assert( p_chain != NULL );
+    filter_chain_Reset( p_chain, &fmt_in, &fmt_out );
+    if( filter_chain_AppendFilter( p_chain, psz_module, NULL,
+                                   &fmt_in, &fmt_out ) == NULL )
+        goto out;
+
+    int64_t i_start = libvlc_clock();
+
+    for( unsigned i = 0; i < PICTURES; i++ )
+    {
+        picture_Hold( p_src );
+        picture_t *p_pic = filter_chain_VideoFilter( p_chain, p_src );
+        assert( p_pic != NULL );
+        picture_Release( p_pic );
+    }
+
+    int64_t i_duration = libvlc_clock() - i_start;
+    printf( "  %-8s %4.4s -> %4.4s %2u threads: %7.1f fps\n", psz_module,
+            (const char *)&p_src->format.i_chroma, (const char *)&i_chroma,
+            i_threads, (double)PICTURES * CLOCK_FREQ / i_duration );
+out:
+    filter_chain_Delete( p_chain );
+    es_format_Clean( &fmt_in );
+    es_format_Clean( &fmt_out );
+}
+
+int main( int argc, char **argv )
+{
+    const unsigned pi_threads[] = { 1, vlc_GetCPUCount() };
+    libvlc_instance_t *pp_vlc[2];
+
+    /* Defaults to the build tree, as in the tests */
+    setenv( "VLC_PLUGIN_PATH", "../modules", 0 );
+
+    for( unsigned i = 0; i < 2; i++ )
+    {
+        char psz_threads[40];
+        const char *ppsz_args[] = {
+            "--quiet", "--ignore-config", "--no-media-library", psz_threads,
+        };
+
+        snprintf( psz_threads, sizeof(psz_threads),
+                  "--video-filter-slice-threads=%u", pi_threads[i] );
+        pp_vlc[i] = libvlc_new( ARRAY_SIZE(ppsz_args), ppsz_args );
+        assert( pp_vlc[i] != NULL );
+    }
+
+    printf( "%ux%u, %u pictures:\n", WIDTH, HEIGHT, PICTURES );
+    srand( 0 );
+    for( size_t i = 0; i < ARRAY_SIZE(chromas); i++ )
+    {
+        video_format_t fmt;
+
+        video_format_Init( &fmt, chromas[i] );
+        video_format_Setup( &fmt, chromas[i], WIDTH, HEIGHT, WIDTH, HEIGHT,
+                            1, 1 );
+        picture_t *p_src = test_PictureNew( &fmt, -1 );
+
+        for( size_t j = 0; j < ARRAY_SIZE(chromas); j++ )
+        {
+            if( j == i )
+                continue;
+            for( int k = 1; k < (argc > 1 ? argc : 2); k++ )
+                for( unsigned t = 0; t < 2; t++ )
+                    if( t == 0 || pi_threads[t] > 1 )
+                        bench( pp_vlc[t], argc > 1 ? argv[k] : "convert",
+                               p_src, chromas[j], pi_threads[t] );
+        }
+        picture_Release( p_src );
+    }
+
+    for( unsigned i = 0; i < 2; i++ )
+        libvlc_release( pp_vlc[i] );
+    return 0;
+}
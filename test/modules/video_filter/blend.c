@@ -0,0 +1,246 @@
+/*****************************************************************************
+ * blend.c: test for the video blending module
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* The accelerated blending must give exactly the same pictures as the
+ * straightforward per pixel blending, whatever the offsets and sizes. */
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_modules.h>
+#include <vlc_picture.h>
+
+static unsigned div255( unsigned v )
+{
+    return ((v >> 8) + v + 1) >> 8;
+}
+
+static void merge( uint8_t *p, unsigned s, unsigned a )
+{
+    *p = div255( (255 - a) * *p + s * a );
+}
+
+static picture_t *Picture( video_format_t *p_fmt, vlc_fourcc_t i_chroma,
+                           unsigned i_width, unsigned i_height )
+{
+    video_format_Setup( p_fmt, i_chroma, i_width, i_height,
+                        i_width, i_height, 1, 1 );
+
+    picture_t *p_pic = picture_NewFromFormat( p_fmt );
+    assert( p_pic != NULL );
+    for( int i = 0; i < p_pic->i_planes; i++ )
+    {
+        plane_t *p = &p_pic->p[i];
+
+        for( int y = 0; y < p->i_lines; y++ )
+            for( int x = 0; x < p->i_pitch; x++ )
+            {
+                /* Some fully transparent and opaque samples too */
+                unsigned v = rand() % 300;
+                p->p_pixels[y * p->i_pitch + x] = v < 20 ? 0 : __MIN(v, 255);
+            }
+    }
+    return p_pic;
+}
+
+/* Reference blending of YUVA or YUVP onto 4:2:0 pictures */
+static void BlendYUV420( picture_t *p_dst, const picture_t *p_src,
+                         const video_format_t *p_src_fmt,
+                         unsigned dx, unsigned dy, unsigned w, unsigned h,
+                         unsigned alpha )
+{
+    const vlc_fourcc_t i_chroma = p_dst->format.i_chroma;
+    const bool b_semiplanar = i_chroma == VLC_CODEC_NV12
+                           || i_chroma == VLC_CODEC_NV21;
+    const bool b_swap = i_chroma == VLC_CODEC_YV12
+                     || i_chroma == VLC_CODEC_NV21;
+    plane_t *p = p_dst->p;
+
+    for( unsigned y = 0; y < h; y++ )
+        for( unsigned x = 0; x < w; x++ )
+        {
+            uint8_t px[4];
+
+            if( p_src->format.i_chroma == VLC_CODEC_YUVP )
+                memcpy( px, p_src_fmt->p_palette->palette[
+                        p_src->p[0].p_pixels[y * p_src->p[0].i_pitch + x]], 4 );
+            else
+                for( int i = 0; i < 4; i++ )
+                    px[i] = p_src->p[i].p_pixels[y * p_src->p[i].i_pitch + x];
+
+            unsigned a = div255( alpha * px[3] );
+            unsigned X = dx + x, Y = dy + y;
+
+            merge( &p[0].p_pixels[Y * p[0].i_pitch + X], px[0], a );
+            if( X % 2 || Y % 2 )
+                continue;
+            if( b_semiplanar )
+            {
+                uint8_t *uv = &p[1].p_pixels[Y / 2 * p[1].i_pitch + X / 2 * 2];
+                merge( &uv[b_swap], px[1], a );
+                merge( &uv[!b_swap], px[2], a );
+            }
+            else
+            {
+                merge( &p[b_swap ? 2 : 1].p_pixels[Y / 2 * p[1].i_pitch + X / 2],
+                       px[1], a );
+                merge( &p[b_swap ? 1 : 2].p_pixels[Y / 2 * p[2].i_pitch + X / 2],
+                       px[2], a );
+            }
+        }
+}
+
+/* Reference blending of RGBA onto RV32, on a little endian machine */
+static void BlendRGBA( picture_t *p_dst, const picture_t *p_src,
+                       const video_format_t *p_dst_fmt,
+                       unsigned dx, unsigned dy, unsigned w, unsigned h,
+                       unsigned alpha )
+{
+    const unsigned r = p_dst_fmt->i_lrshift / 8;
+    const unsigned g = p_dst_fmt->i_lgshift / 8;
+    const unsigned b = p_dst_fmt->i_lbshift / 8;
+
+    for( unsigned y = 0; y < h; y++ )
+        for( unsigned x = 0; x < w; x++ )
+        {
+            const uint8_t *s = &p_src->p[0].p_pixels[y * p_src->p[0].i_pitch
+                                                      + 4 * x];
+            uint8_t *d = &p_dst->p[0].p_pixels[(dy + y) * p_dst->p[0].i_pitch
+                                                + 4 * (dx + x)];
+            unsigned a = div255( alpha * s[3] );
+
+            merge( &d[r], s[0], a );
+            merge( &d[g], s[1], a );
+            merge( &d[b], s[2], a );
+        }
+}
+
+static void test_blend( vlc_object_t *p_obj, vlc_fourcc_t i_dst,
+                        vlc_fourcc_t i_src, uint32_t i_rmask )
+{
+    static const struct { unsigned w, h; } sizes[][2] = {
+        { { 100,  70 }, {   77,  41 } },
+        { {  64,  64 }, {   64,  64 } },
+        { { 1100, 20 }, { 1030,   9 } },
+    };
+    static const unsigned offsets[][2] = {
+        { 0, 0 }, { 1, 1 }, { 3, 2 }, { 2, 5 }, { 50, 40 },
+    };
+    static const int alphas[] = { 255, 128, 17 };
+    video_palette_t palette;
+
+    log( "Testing %4.4s onto %4.4s\n", (const char *)&i_src,
+         (const char *)&i_dst );
+
+    palette.i_entries = 256;
+    for( int i = 0; i < 256; i++ )
+        for( int j = 0; j < 4; j++ )
+            palette.palette[i][j] = rand();
+
+    for( size_t i = 0; i < ARRAY_SIZE(sizes); i++ )
+    {
+        filter_t *p_blend = vlc_object_create( p_obj, sizeof(*p_blend) );
+        assert( p_blend != NULL );
+
+        picture_t *p_dst = Picture( &p_blend->fmt_out.video, i_dst,
+                                    sizes[i][0].w, sizes[i][0].h );
+        picture_t *p_src = Picture( &p_blend->fmt_in.video, i_src,
+                                    sizes[i][1].w, sizes[i][1].h );
+        if( i_src == VLC_CODEC_YUVP )
+            p_blend->fmt_in.video.p_palette = &palette;
+        if( i_rmask )
+        {
+            p_blend->fmt_out.video.i_rmask = i_rmask;
+            p_blend->fmt_out.video.i_gmask = 0xff00;
+            p_blend->fmt_out.video.i_bmask = i_rmask ^ 0xff00ff;
+        }
+        video_format_FixRgb( &p_blend->fmt_out.video );
+
+        p_blend->p_module = module_need( p_blend, "video blending", NULL,
+                                         false );
+        assert( p_blend->p_module != NULL );
+
+        picture_t *p_ref = picture_NewFromFormat( &p_blend->fmt_out.video );
+        assert( p_ref != NULL );
+
+        for( size_t j = 0; j < ARRAY_SIZE(offsets); j++ )
+            for( size_t k = 0; k < ARRAY_SIZE(alphas); k++ )
+            {
+                const unsigned x = offsets[j][0], y = offsets[j][1];
+
+                picture_CopyPixels( p_ref, p_dst );
+                p_blend->pf_video_blend( p_blend, p_dst, p_src, x, y,
+                                         alphas[k] );
+
+                int w = __MIN((int)(sizes[i][0].w - x), (int)sizes[i][1].w);
+                int h = __MIN((int)(sizes[i][0].h - y), (int)sizes[i][1].h);
+                if( w <= 0 || h <= 0 )
+                    ;
+                else if( i_dst == VLC_CODEC_RGB32 )
+                    BlendRGBA( p_ref, p_src, &p_blend->fmt_out.video,
+                               x, y, w, h, alphas[k] );
+                else
+                    BlendYUV420( p_ref, p_src, &p_blend->fmt_in.video,
+                                 x, y, w, h, alphas[k] );
+
+                for( int p = 0; p < p_dst->i_planes; p++ )
+                    for( int l = 0; l < p_dst->p[p].i_visible_lines; l++ )
+                        assert( !memcmp( &p_dst->p[p].p_pixels[l * p_dst->p[p].i_pitch],
+                                         &p_ref->p[p].p_pixels[l * p_ref->p[p].i_pitch],
+                                         p_dst->p[p].i_visible_pitch ) );
+            }
+
+        module_unneed( p_blend, p_blend->p_module );
+        picture_Release( p_ref );
+        picture_Release( p_src );
+        picture_Release( p_dst );
+        vlc_object_release( p_blend );
+    }
+}
+
+int main( void )
+{
+    static const vlc_fourcc_t yuv[] = {
+        VLC_CODEC_I420, VLC_CODEC_YV12, VLC_CODEC_NV12, VLC_CODEC_NV21,
+    };
+    libvlc_instance_t *p_vlc;
+
+    test_init();
+
+    p_vlc = libvlc_new( test_defaults_nargs, test_defaults_args );
+    assert( p_vlc != NULL );
+
+    vlc_object_t *p_obj = VLC_OBJECT(p_vlc->p_libvlc_int);
+    srand( 0 );
+    for( size_t i = 0; i < ARRAY_SIZE(yuv); i++ )
+    {
+        test_blend( p_obj, yuv[i], VLC_CODEC_YUVA, 0 );
+        test_blend( p_obj, yuv[i], VLC_CODEC_YUVP, 0 );
+    }
+#ifndef WORDS_BIGENDIAN
+    test_blend( p_obj, VLC_CODEC_RGB32, VLC_CODEC_RGBA, 0xff0000 );
+    test_blend( p_obj, VLC_CODEC_RGB32, VLC_CODEC_RGBA, 0x0000ff );
+#endif
+
+    libvlc_release( p_vlc );
+    return 0;
+}
@@ -0,0 +1,152 @@
+/*****************************************************************************
+ * filter_bench.c: slice-parallel video filters throughput
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Usage: bench_modules_video_filter [<filter>]...
+ * Without arguments, all the sliced filters are measured on 1080p I420
+ * pictures, with 1, 2, 4 and as many threads as processors. */
+
+#include "../../libvlc/video.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+
+#define PICTURES 100
+#define WIDTH    1920
+#define HEIGHT   1080
+
+static const char *const ppsz_filters[] = {
+    "adjust{hue=40,saturation=2}",
+    "sharpen",
+    "gaussianblur",
+    "gradfun",
+    "hqdn3d",
+    "hqdn3d{slices}",
+    "deinterlace{mode=yadif}",
+    "deinterlace{mode=yadif2x}",
+    "deinterlace{mode=x}",
+};
+
+static void bench( const char *psz_filter, unsigned i_threads,
+                   picture_t **pp_pics )
+{
+    char psz_threads[40];
+    const char *ppsz_args[] = {
+        "--quiet", "--ignore-config", "--no-media-library", psz_threads,
+    };
+
+    snprintf( psz_threads, sizeof(psz_threads),
+              "--video-filter-slice-threads=%u", i_threads );
+    libvlc_instance_t *p_vlc = libvlc_new( ARRAY_SIZE(ppsz_args), ppsz_args );
+    assert( p_vlc != NULL );
+
+    const video_format_t *p_fmt = &pp_pics[0]->format;
+    es_format_t fmt;
+    es_format_Init( &fmt, VIDEO_ES, p_fmt->i_chroma );
+    fmt.video = *p_fmt;
+
+    filter_chain_t *p_chain = filter_chain_New( p_vlc->p_libvlc_int,
+                                                "video filter2", false,
+                                                test_AllocationInit,
+                                                NULL, NULL );
+    assert( p_chain != NULL );
+    filter_chain_Reset( p_chain, &fmt, &fmt );
+    if( filter_chain_AppendFromString( p_chain, psz_filter ) != VLC_SUCCESS )
+    {
+        printf( "  %-28s unavailable\n", psz_filter );
+        goto out;
+    }
+
+    unsigned i_count = 0;
+    int64_t i_start = libvlc_clock();
+
+    for( unsigned i = 0; i < PICTURES; i++ )
+    {
+        picture_t *p_pic = pp_pics[i % 2];
+
+        picture_Hold( p_pic );
+        p_pic->date = VLC_TS_0 + i * CLOCK_FREQ / 25;
+        p_pic = filter_chain_VideoFilter( p_chain, p_pic );
+        while( p_pic != NULL )
+        {
+            picture_t *p_next = p_pic->p_next;
+
+            p_pic->p_next = NULL;
+            picture_Release( p_pic );
+            i_count++;
+            p_pic = p_next;
+        }
+    }
+
+    int64_t i_duration = libvlc_clock() - i_start;
+    printf( "  %-28s %2u threads: %7.1f fps (%u pictures out)\n",
+            psz_filter, i_threads,
+            (double)PICTURES * CLOCK_FREQ / i_duration, i_count );
+out:
+    filter_chain_Delete( p_chain );
+    es_format_Clean( &fmt );
+    libvlc_release( p_vlc );
+}
+
+int main( int argc, char **argv )
+{
+    unsigned pi_threads[] = { 1, 2, 4, vlc_GetCPUCount() };
+    video_format_t fmt;
+    picture_t *pp_pics[2];
+
+    /* Defaults to the build tree, as in the tests */
+    setenv( "VLC_PLUGIN_PATH", "../modules", 0 );
+
+    video_format_Init( &fmt, VLC_CODEC_I420 );
+    video_format_Setup( &fmt, VLC_CODEC_I420, WIDTH, HEIGHT, WIDTH, HEIGHT,
+                        1, 1 );
+    srand( 0 );
+    for( unsigned i = 0; i < 2; i++ )
+    {
+        pp_pics[i] = picture_NewFromFormat( &fmt );
+        assert( pp_pics[i] != NULL );
+        for( int j = 0; j < pp_pics[i]->i_planes; j++ )
+        {
+            plane_t *p = &pp_pics[i]->p[j];
+
+            for( int y = 0; y < p->i_lines; y++ )
+                for( int x = 0; x < p->i_pitch; x++ )
+                    p->p_pixels[y * p->i_pitch + x] = (x + y) / 8
+                                                    + rand() % 16;
+        }
+    }
+
+    printf( "%ux%u I420, %u pictures:\n", WIDTH, HEIGHT, PICTURES );
+    for( int i = 0; i < (argc > 1 ? argc - 1 : (int)ARRAY_SIZE(ppsz_filters));
+         i++ )
+    {
+        const char *psz_filter = argc > 1 ? argv[i + 1] : ppsz_filters[i];
+
+        for( size_t j = 0; j < ARRAY_SIZE(pi_threads); j++ )
+            if( j < 3 || pi_threads[j] > 4 )
+                bench( psz_filter, pi_threads[j], pp_pics );
+    }
+
+    for( unsigned i = 0; i < 2; i++ )
+        picture_Release( pp_pics[i] );
+    return 0;
+}
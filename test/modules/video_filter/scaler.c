@@ -0,0 +1,287 @@
+/*****************************************************************************
+ * scaler.c: test for the bilinear and bicubic video scaler
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Before the log() macro of the tests */
+#include <math.h>
+
+#include "../../libvlc/video.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+#include "../../../modules/video_filter/scaler_kernels.h"
+
+#define WIDTH  200
+#define HEIGHT 150
+
+static const struct { unsigned w, h; } sizes[] = {
+    { 333, 77 }, { 64, 48 }, { 640, 480 }, { 3, 2 }, { WIDTH, HEIGHT },
+};
+
+/* Line kernels, which must all give the results of the C ones */
+static const struct
+{
+    const char *psz_name;
+    unsigned i_cpu;
+    scaler_hscale_t pf_planar;
+    scaler_hscale_t pf_packed;
+    scaler_vscale_t pf_vscale;
+} kernels[] = {
+    { "C", 0, HScalePlanarC, HScalePackedC, VScaleC },
+#ifdef SCALER_SSE2
+    { "SSE2", VLC_CPU_SSE2, HScalePlanarSSE2, HScalePackedSSE2, VScaleSSE2 },
+#endif
+#ifdef SCALER_NEON
+    { "NEON", 0, HScalePlanarNEON, HScalePackedNEON, VScaleNEON },
+#endif
+};
+
+/* Odd sizes, so that the vector loops leave a tail */
+static const unsigned widths[] = { 1, 3, 7, 13, 31, 77, 203 };
+
+/* Compares the kernels on one table, with random source lines */
+static void test_table( const scaler_table_t *p_table )
+{
+    const unsigned i_src = p_table->i_src, i_dst = p_table->i_dst;
+    uint8_t p_src[4 * i_src];
+    int16_t p_ref[4 * i_dst], p_out[4 * i_dst];
+
+    for( unsigned i = 0; i < 4 * i_src; i++ )
+        p_src[i] = rand();
+
+    for( size_t i = 1; i < ARRAY_SIZE(kernels); i++ )
+    {
+        if( (vlc_CPU() & kernels[i].i_cpu) != kernels[i].i_cpu )
+            continue;
+
+        HScalePlanarC( p_ref, p_src, p_table );
+        kernels[i].pf_planar( p_out, p_src, p_table );
+        assert( !memcmp( p_ref, p_out, i_dst * sizeof(*p_out) ) );
+
+        HScalePackedC( p_ref, p_src, p_table );
+        kernels[i].pf_packed( p_out, p_src, p_table );
+        assert( !memcmp( p_ref, p_out, 4 * i_dst * sizeof(*p_out) ) );
+    }
+}
+
+/* Random coefficients summing to 1 << COEF_BITS, with any tap count */
+static void TableRandom( scaler_table_t *p_table, unsigned i_taps,
+                         unsigned i_src, unsigned i_dst )
+{
+    p_table->i_src = i_src;
+    p_table->i_dst = i_dst;
+    p_table->i_taps = i_taps;
+    p_table->pi_pos = malloc( i_dst * sizeof(*p_table->pi_pos) );
+    p_table->pi_coefs = malloc( i_dst * i_taps * sizeof(*p_table->pi_coefs) );
+    assert( p_table->pi_pos != NULL && p_table->pi_coefs != NULL );
+
+    for( unsigned i = 0; i < i_dst; i++ )
+    {
+        int16_t *pi_coefs = &p_table->pi_coefs[i * i_taps];
+        int i_sum = 0;
+
+        for( unsigned k = 1; k < i_taps; k++ )
+        {
+            pi_coefs[k] = rand() % 513 - 256;
+            i_sum += pi_coefs[k];
+        }
+        pi_coefs[0] = (1 << COEF_BITS) - i_sum;
+        p_table->pi_pos[i] = rand() % (i_src - i_taps + 1);
+    }
+}
+
+static void test_vscale( const int16_t *pi_coefs, unsigned i_taps )
+{
+    for( size_t w = 0; w < ARRAY_SIZE(widths); w++ )
+    {
+        const unsigned i_width = widths[w];
+        int16_t pp_buffers[i_taps][i_width];
+        const int16_t *pp_lines[i_taps];
+        uint8_t p_ref[i_width], p_out[i_width];
+
+        /* The range of the horizontally scaled lines, with overshoots */
+        for( unsigned k = 0; k < i_taps; k++ )
+        {
+            for( unsigned x = 0; x < i_width; x++ )
+                pp_buffers[k][x] = rand() % (320 << INTER_BITS)
+                                 - (32 << INTER_BITS);
+            pp_lines[k] = pp_buffers[k];
+        }
+
+        VScaleC( p_ref, pp_lines, pi_coefs, i_taps, i_width );
+        for( size_t i = 1; i < ARRAY_SIZE(kernels); i++ )
+        {
+            if( (vlc_CPU() & kernels[i].i_cpu) != kernels[i].i_cpu )
+                continue;
+            kernels[i].pf_vscale( p_out, pp_lines, pi_coefs, i_taps,
+                                  i_width );
+            assert( !memcmp( p_ref, p_out, i_width ) );
+        }
+    }
+}
+
+static void test_kernels( void )
+{
+    for( size_t i = 0; i < ARRAY_SIZE(kernels); i++ )
+        if( (vlc_CPU() & kernels[i].i_cpu) == kernels[i].i_cpu )
+            log( "Testing the %s line kernels\n", kernels[i].psz_name );
+
+    srand( 0 );
+    /* The tables of the filter */
+    for( int i_mode = SCALER_BILINEAR; i_mode <= SCALER_BICUBIC; i_mode++ )
+        for( size_t s = 0; s < ARRAY_SIZE(widths); s++ )
+            for( size_t d = 0; d < ARRAY_SIZE(widths); d++ )
+            {
+                scaler_table_t table = { 0 };
+
+                assert( TableInit( &table, i_mode, widths[s],
+                                   widths[d] ) == VLC_SUCCESS );
+                test_table( &table );
+                test_vscale( table.pi_coefs, table.i_taps );
+                TableClean( &table );
+            }
+
+    /* Any tap count */
+    for( unsigned i_taps = 1; i_taps <= 12; i_taps++ )
+        for( size_t d = 0; d < ARRAY_SIZE(widths); d++ )
+        {
+            scaler_table_t table;
+
+            TableRandom( &table, i_taps, 2 * i_taps + 5, widths[d] );
+            test_table( &table );
+            test_vscale( table.pi_coefs, i_taps );
+            TableClean( &table );
+        }
+}
+
+static picture_t *Scale( libvlc_instance_t *p_vlc, vlc_fourcc_t i_chroma,
+                         unsigned i_width, unsigned i_height, int i_value )
+{
+    es_format_t fmt_in, fmt_out;
+
+    es_format_Init( &fmt_in, VIDEO_ES, i_chroma );
+    video_format_Setup( &fmt_in.video, i_chroma, WIDTH, HEIGHT,
+                        WIDTH, HEIGHT, 1, 1 );
+    es_format_Init( &fmt_out, VIDEO_ES, i_chroma );
+    video_format_Setup( &fmt_out.video, i_chroma, i_width, i_height,
+                        i_width, i_height, 1, 1 );
+
+    filter_chain_t *p_chain = filter_chain_New( p_vlc->p_libvlc_int,
+                                                "video filter2", false,
+                                                test_AllocationInit,
+                                                NULL, NULL );
+    assert( p_chain != NULL );
+    filter_chain_Reset( p_chain, &fmt_in, &fmt_out );
+    assert( filter_chain_AppendFilter( p_chain, "scaler", NULL,
+                                       &fmt_in, &fmt_out ) != NULL );
+
+    srand( 0 );
+    picture_t *p_pic = filter_chain_VideoFilter( p_chain,
+                                    test_PictureNew( &fmt_in.video, i_value ) );
+    assert( p_pic != NULL );
+    assert( p_pic->format.i_width == i_width );
+    assert( p_pic->format.i_height == i_height );
+
+    filter_chain_Delete( p_chain );
+    es_format_Clean( &fmt_in );
+    es_format_Clean( &fmt_out );
+    return p_pic;
+}
+
+static void test_scaler( const char *psz_mode, vlc_fourcc_t i_chroma )
+{
+    const char *ppsz_args[test_defaults_nargs + 2];
+    libvlc_instance_t *pp_vlc[2];
+
+    log( "Testing the %s scaling of %4.4s\n", psz_mode,
+         (const char *)&i_chroma );
+
+    /* Without and with the slice threads */
+    memcpy( ppsz_args, test_defaults_args, sizeof(test_defaults_args) );
+    ppsz_args[test_defaults_nargs] = psz_mode;
+    for( unsigned i = 0; i < 2; i++ )
+    {
+        ppsz_args[test_defaults_nargs + 1] =
+            i ? "--video-filter-slice-threads=4"
+              : "--video-filter-slice-threads=1";
+        pp_vlc[i] = libvlc_new( test_defaults_nargs + 2, ppsz_args );
+        assert( pp_vlc[i] != NULL );
+    }
+
+    for( size_t i = 0; i < ARRAY_SIZE(sizes); i++ )
+    {
+        /* Flat areas stay flat */
+        picture_t *p_pic = Scale( pp_vlc[0], i_chroma,
+                                  sizes[i].w, sizes[i].h, 100 );
+        for( int j = 0; j < p_pic->i_planes; j++ )
+        {
+            const plane_t *p = &p_pic->p[j];
+
+            for( int y = 0; y < p->i_visible_lines; y++ )
+                for( int x = 0; x < p->i_visible_pitch; x++ )
+                    assert( p->p_pixels[y * p->i_pitch + x] == 100 + j );
+        }
+        picture_Release( p_pic );
+
+        /* The slices do not change the result */
+        picture_t *p_ref = Scale( pp_vlc[0], i_chroma,
+                                  sizes[i].w, sizes[i].h, -1 );
+        p_pic = Scale( pp_vlc[1], i_chroma, sizes[i].w, sizes[i].h, -1 );
+        assert( test_PictureHash( TEST_HASH_INIT, p_pic, 0 ) ==
+                test_PictureHash( TEST_HASH_INIT, p_ref, 0 ) );
+        picture_Release( p_pic );
+
+        /* Scaling to the same size only copies */
+        if( sizes[i].w == WIDTH && sizes[i].h == HEIGHT )
+        {
+            video_format_t fmt;
+
+            video_format_Setup( &fmt, i_chroma, WIDTH, HEIGHT,
+                                WIDTH, HEIGHT, 1, 1 );
+            srand( 0 );
+            p_pic = test_PictureNew( &fmt, -1 );
+            assert( test_PictureHash( TEST_HASH_INIT, p_pic, 0 ) ==
+                    test_PictureHash( TEST_HASH_INIT, p_ref, 0 ) );
+            picture_Release( p_pic );
+        }
+        picture_Release( p_ref );
+    }
+
+    for( unsigned i = 0; i < 2; i++ )
+        libvlc_release( pp_vlc[i] );
+}
+
+int main( void )
+{
+    static const vlc_fourcc_t chromas[] = {
+        VLC_CODEC_I420, VLC_CODEC_I422, VLC_CODEC_YUVA, VLC_CODEC_RGB32,
+    };
+
+    test_init();
+
+    test_kernels();
+    for( size_t i = 0; i < ARRAY_SIZE(chromas); i++ )
+    {
+        test_scaler( "--scaler-mode=0", chromas[i] );
+        test_scaler( "--scaler-mode=1", chromas[i] );
+    }
+    return 0;
+}
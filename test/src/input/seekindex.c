@@ -0,0 +1,170 @@
+/*****************************************************************************
+ * seekindex.c: test for the persistent demux seek index
+ *****************************************************************************
+ * Copyright (C) 2026 the VideoLAN team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <string.h>
+#include <vlc_demux.h>
+
+#define FILE_SIZE 100000
+
+static demux_t *demux_Fake( libvlc_int_t *p_libvlc, char *psz_path )
+{
+    demux_t *p_demux = vlc_object_create( p_libvlc, sizeof(*p_demux) );
+    char *psz_url;
+
+    assert( p_demux != NULL );
+    int i_ret = asprintf( &psz_url, "file://%s", psz_path );
+    assert( i_ret >= 0 );
+    p_demux->s = stream_UrlNew( p_libvlc, psz_url );
+    assert( p_demux->s != NULL );
+    free( psz_url );
+    p_demux->psz_access = (char *)"file";
+    p_demux->psz_location = psz_path;
+    p_demux->psz_file = psz_path;
+    return p_demux;
+}
+
+static void demux_FakeDelete( demux_t *p_demux )
+{
+    stream_Delete( p_demux->s );
+    vlc_object_release( p_demux );
+}
+
+static void test_index( libvlc_int_t *p_libvlc, char *psz_path )
+{
+    demux_seek_point_t before, after;
+    demux_t *p_demux = demux_Fake( p_libvlc, psz_path );
+    demux_seek_index_t *p_index;
+    int64_t i_value;
+    static const char psz_data[] = "some data";
+    const void *p_data;
+    size_t i_size;
+
+    log( "Testing a new index\n" );
+    p_index = demux_SeekIndexOpen( p_demux, "test", 10 );
+    assert( p_index != NULL );
+    assert( demux_SeekIndexGetValue( p_index, "length", &i_value ) );
+    assert( !demux_SeekIndexFind( p_index, 0, 50, &before, &after ) );
+
+    /* Out of order, as after seeks */
+    for( int i = 50; i < 100; i++ )
+        demux_SeekIndexAdd( p_index, 0, i * 10, i * 1000 );
+    for( int i = 0; i < 50; i++ )
+        demux_SeekIndexAdd( p_index, 0, i * 10, i * 1000 );
+    /* Too close to existing points */
+    demux_SeekIndexAdd( p_index, 0, 125, 12500 );
+    demux_SeekIndexAdd( p_index, 0, 120, 12000 );
+    demux_SeekIndexAdd( p_index, 1, 7, 3 );
+    demux_SeekIndexSetValue( p_index, "length", 1000 );
+    assert( demux_SeekIndexGetData( p_index, "data", &i_size ) == NULL );
+    assert( !demux_SeekIndexSetData( p_index, "data", "replaced", 8 ) );
+    assert( !demux_SeekIndexSetData( p_index, "data", psz_data,
+                                     sizeof(psz_data) ) );
+    assert( !demux_SeekIndexSetData( p_index, "empty", NULL, 0 ) );
+    demux_SeekIndexClose( p_index );
+
+    log( "Testing a kept index\n" );
+    p_index = demux_SeekIndexOpen( p_demux, "test", 10 );
+    assert( p_index != NULL );
+    assert( !demux_SeekIndexGetValue( p_index, "length", &i_value ) );
+    assert( i_value == 1000 );
+
+    size_t i_count;
+    const demux_seek_point_t *p_points =
+        demux_SeekIndexGetPoints( p_index, 0, &i_count );
+    assert( i_count == 100 );
+    for( size_t i = 0; i < i_count; i++ )
+        assert( p_points[i].i_time == (int64_t)i * 10 &&
+                p_points[i].i_pos == i * 1000 );
+    demux_SeekIndexGetPoints( p_index, 1, &i_count );
+    assert( i_count == 1 );
+
+    p_data = demux_SeekIndexGetData( p_index, "data", &i_size );
+    assert( p_data != NULL && i_size == sizeof(psz_data) );
+    assert( !memcmp( p_data, psz_data, i_size ) );
+    demux_SeekIndexGetData( p_index, "empty", &i_size );
+    assert( i_size == 0 );
+
+    assert( demux_SeekIndexFind( p_index, 0, 125, &before, &after ) );
+    assert( before.i_time == 120 && before.i_pos == 12000 );
+    assert( after.i_time == 130 && after.i_pos == 13000 );
+    after.i_time = -1;
+    assert( demux_SeekIndexFind( p_index, 0, 5000, &before, &after ) );
+    assert( before.i_time == 990 && after.i_time == -1 );
+    assert( !demux_SeekIndexFind( p_index, 0, -1, &before, &after ) );
+    demux_SeekIndexClose( p_index );
+
+    log( "Testing the index of another demuxer\n" );
+    p_index = demux_SeekIndexOpen( p_demux, "other", 10 );
+    assert( p_index != NULL );
+    assert( demux_SeekIndexGetValue( p_index, "length", &i_value ) );
+    demux_SeekIndexClose( p_index );
+
+    demux_FakeDelete( p_demux );
+}
+
+int main( void )
+{
+    char psz_path[] = "/tmp/vlc-test-seekindexXXXXXX";
+    char psz_cache[] = "/tmp/vlc-test-cacheXXXXXX";
+    static char data[FILE_SIZE];
+    libvlc_instance_t *p_vlc;
+    int fd, i_ret;
+
+    test_init();
+
+    char *psz_dir = mkdtemp( psz_cache );
+    assert( psz_dir != NULL );
+    setenv( "XDG_CACHE_HOME", psz_cache, 1 );
+
+    fd = mkstemp( psz_path );
+    assert( fd >= 0 );
+    ssize_t i_written = write( fd, data, FILE_SIZE );
+    assert( i_written == FILE_SIZE );
+    close( fd );
+
+    const char *ppsz_args[test_defaults_nargs + 1];
+    memcpy( ppsz_args, test_defaults_args, sizeof(test_defaults_args) );
+    ppsz_args[test_defaults_nargs] = "--input-seek-index";
+    p_vlc = libvlc_new( test_defaults_nargs + 1, ppsz_args );
+    assert( p_vlc != NULL );
+    test_index( p_vlc->p_libvlc_int, psz_path );
+    libvlc_release( p_vlc );
+
+    log( "Testing a disabled index\n" );
+    p_vlc = libvlc_new( test_defaults_nargs, test_defaults_args );
+    assert( p_vlc != NULL );
+    demux_t *p_demux = demux_Fake( p_vlc->p_libvlc_int, psz_path );
+    assert( demux_SeekIndexOpen( p_demux, "test", 10 ) == NULL );
+    demux_FakeDelete( p_demux );
+    libvlc_release( p_vlc );
+
+    unlink( psz_path );
+
+    char *psz_cmd;
+    i_ret = asprintf( &psz_cmd, "rm -rf %s", psz_cache );
+    assert( i_ret >= 0 );
+    i_ret = system( psz_cmd );
+    assert( i_ret == 0 );
+    free( psz_cmd );
+    return 0;
+}
@@ -0,0 +1,177 @@
+/*****************************************************************************
+ * stream.c: test for the stream cache
+ *****************************************************************************
+ * Copyright (C) 2026 the VideoLAN team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <string.h>
+#include <vlc_stream.h>
+#include <vlc_block.h>
+
+#define FILE_SIZE (3 * 1024 * 1024 + 123)
+
+static uint8_t pattern( uint64_t i_pos )
+{
+    return (i_pos * 2654435761u) >> 13;
+}
+
+static void check( const uint8_t *p_data, uint64_t i_pos, int i_size )
+{
+    for( int i = 0; i < i_size; i++ )
+        assert( p_data[i] == pattern( i_pos + i ) );
+}
+
+static void test_sequential( stream_t *s )
+{
+    static uint8_t buf[100000];
+    int64_t i_pos = 0;
+    unsigned i_size = 1;
+
+    assert( stream_Seek( s, 0 ) == VLC_SUCCESS );
+    for( ;; )
+    {
+        int i_read = stream_Read( s, buf, i_size );
+        assert( i_read >= 0 );
+        check( buf, i_pos, i_read );
+        i_pos += i_read;
+        assert( stream_Tell( s ) == i_pos );
+        if( (unsigned)i_read < i_size )
+            break;
+        i_size = (i_size * 7 + 13) % sizeof(buf);
+    }
+    assert( i_pos == FILE_SIZE );
+}
+
+static void test_random( stream_t *s )
+{
+    static uint8_t buf[20000];
+
+    srand( 0 );
+    for( int i = 0; i < 2000; i++ )
+    {
+        int64_t i_pos = rand() % FILE_SIZE;
+        int i_size = rand() % sizeof(buf);
+        int i_expected = __MIN( (int64_t)i_size, FILE_SIZE - i_pos );
+        const uint8_t *p_peek;
+
+        assert( stream_Seek( s, i_pos ) == VLC_SUCCESS );
+        if( i & 1 )
+        {
+            assert( stream_Peek( s, &p_peek, i_size ) == i_expected );
+            check( p_peek, i_pos, i_expected );
+        }
+        if( (i & 2) && i_expected > 0 )
+        {
+            block_t *p_block = stream_Block( s, i_size );
+            assert( p_block != NULL );
+            assert( p_block->i_buffer == (size_t)i_expected );
+            check( p_block->p_buffer, i_pos, i_expected );
+            block_Release( p_block );
+        }
+        else
+        {
+            assert( stream_Read( s, buf, i_size ) == i_expected );
+            check( buf, i_pos, i_expected );
+        }
+        assert( stream_Tell( s ) == i_pos + i_expected );
+    }
+}
+
+static void test_stream( libvlc_int_t *p_libvlc, const char *psz_url )
+{
+    uint64_t i_cache;
+    stream_t *s = stream_UrlNew( p_libvlc, psz_url );
+
+    assert( s != NULL );
+    assert( stream_Size( s ) == FILE_SIZE );
+    assert( stream_Control( s, STREAM_GET_CACHE_SIZE, &i_cache )
+            == VLC_SUCCESS );
+    assert( i_cache == 1024 * (uint64_t)var_InheritInteger( p_libvlc,
+                                                            "stream-cache" ) );
+
+    log( "Testing the default cache\n" );
+    test_sequential( s );
+    test_random( s );
+
+    log( "Testing a cache larger than the file\n" );
+    const uint8_t *p_peek;
+    assert( stream_Control( s, STREAM_SET_CACHE_SIZE,
+                            (uint64_t)(32 << 20) ) == VLC_SUCCESS );
+    assert( stream_Seek( s, 0 ) == VLC_SUCCESS );
+    assert( stream_Peek( s, &p_peek, FILE_SIZE ) == FILE_SIZE );
+    check( p_peek, 0, FILE_SIZE );
+    test_random( s );
+
+    log( "Testing a small cache\n" );
+    assert( stream_Seek( s, 12345 ) == VLC_SUCCESS );
+    assert( stream_Control( s, STREAM_SET_CACHE_SIZE, (uint64_t)100000 )
+            == VLC_SUCCESS );
+    assert( stream_Control( s, STREAM_GET_CACHE_SIZE, &i_cache )
+            == VLC_SUCCESS );
+    assert( i_cache == 100000 );
+    assert( stream_Tell( s ) == 12345 );
+    test_random( s );
+    test_sequential( s );
+
+    stream_Delete( s );
+}
+
+int main( void )
+{
+    char psz_path[] = "/tmp/vlc-test-streamXXXXXX";
+    char *psz_url;
+    uint8_t *p_data;
+    libvlc_instance_t *p_vlc;
+    int fd;
+
+    test_init();
+
+    fd = mkstemp( psz_path );
+    assert( fd >= 0 );
+    p_data = malloc( FILE_SIZE );
+    assert( p_data != NULL );
+    for( uint64_t i = 0; i < FILE_SIZE; i++ )
+        p_data[i] = pattern( i );
+    ssize_t i_written = write( fd, p_data, FILE_SIZE );
+    assert( i_written == FILE_SIZE );
+    close( fd );
+    free( p_data );
+    int i_ret = asprintf( &psz_url, "file://%s", psz_path );
+    assert( i_ret >= 0 );
+
+    log( "Testing the stream cache with read files\n" );
+    p_vlc = libvlc_new( test_defaults_nargs, test_defaults_args );
+    assert( p_vlc != NULL );
+    test_stream( p_vlc->p_libvlc_int, psz_url );
+    libvlc_release( p_vlc );
+
+    log( "Testing the stream cache with memory mapped files\n" );
+    const char *ppsz_args[test_defaults_nargs + 1];
+    memcpy( ppsz_args, test_defaults_args, sizeof(test_defaults_args) );
+    ppsz_args[test_defaults_nargs] = "--file-mmap";
+    p_vlc = libvlc_new( test_defaults_nargs + 1, ppsz_args );
+    assert( p_vlc != NULL );
+    test_stream( p_vlc->p_libvlc_int, psz_url );
+    libvlc_release( p_vlc );
+    unlink( psz_path );
+    free( psz_url );
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+/*****************************************************************************
+ * filter_chain.c: test for the video filter chains
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/video.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+
+#define PICTURES 200
+
+static picture_t *Picture( const es_format_t *p_fmt, unsigned i )
+{
+    picture_t *p_pic = test_PictureNew( &p_fmt->video, i % 256 );
+
+    p_pic->date = VLC_TS_0 + i;
+    return p_pic;
+}
+
+/* Checks that the pictures come out in order, inverted an odd number of
+ * times, and returns the number of pictures received */
+static unsigned Check( picture_t *p_pic, unsigned *pi_next )
+{
+    if( p_pic == NULL )
+        return 0;
+
+    unsigned i = p_pic->date - VLC_TS_0;
+
+    assert( p_pic->p_next == NULL );
+    assert( i == *pi_next );
+    assert( p_pic->p[Y_PLANE].p_pixels[0] == (uint8_t)~i );
+    *pi_next = i + 1;
+    picture_Release( p_pic );
+    return 1;
+}
+
+static void Drop( picture_t *p_pic )
+{
+    if( p_pic != NULL )
+        picture_Release( p_pic );
+}
+
+static void test_chain( vlc_object_t *p_obj, unsigned i_threads )
+{
+    es_format_t fmt;
+    filter_chain_t *p_chain;
+    unsigned i_next = 0, i_count = 0;
+
+    log( "Testing a chain with %u threads\n", i_threads );
+    es_format_Init( &fmt, VIDEO_ES, VLC_CODEC_I420 );
+    video_format_Setup( &fmt.video, VLC_CODEC_I420, 64, 48, 64, 48, 1, 1 );
+
+    p_chain = filter_chain_New( p_obj, "video filter2", false,
+                                test_AllocationInit, NULL, NULL );
+    assert( p_chain != NULL );
+    filter_chain_Reset( p_chain, &fmt, &fmt );
+    filter_chain_SetThreads( p_chain, i_threads );
+    assert( filter_chain_AppendFromString( p_chain,
+                        "invert:invert:invert:invert:invert" ) == VLC_SUCCESS );
+    assert( filter_chain_GetLength( p_chain ) == 5 );
+
+    for( unsigned i = 0; i < PICTURES; i++ )
+    {
+        picture_t *p_pic = filter_chain_VideoFilter( p_chain,
+                                                     Picture( &fmt, i ) );
+        i_count += Check( p_pic, &i_next );
+        while( (p_pic = filter_chain_VideoFilter( p_chain, NULL )) != NULL )
+            i_count += Check( p_pic, &i_next );
+    }
+
+    /* Without threads, the pictures come out at once */
+    if( i_threads == 0 )
+        assert( i_count == PICTURES );
+    picture_t *p_pic;
+    while( (p_pic = filter_chain_VideoDrain( p_chain )) != NULL )
+        i_count += Check( p_pic, &i_next );
+    assert( i_count == PICTURES );
+    assert( i_next == PICTURES );
+
+    /* No picture must come out of a flushed chain */
+    for( unsigned i = 0; i < 10; i++ )
+        Drop( filter_chain_VideoFilter( p_chain,
+                                        Picture( &fmt, PICTURES + i ) ) );
+    filter_chain_VideoFlush( p_chain );
+    assert( filter_chain_VideoDrain( p_chain ) == NULL );
+
+    /* but the following ones do */
+    i_count = 0;
+    i_next = 2 * PICTURES;
+    for( unsigned i = 0; i < 10; i++ )
+        i_count += Check( filter_chain_VideoFilter( p_chain,
+                                    Picture( &fmt, 2 * PICTURES + i ) ),
+                          &i_next );
+    while( (p_pic = filter_chain_VideoDrain( p_chain )) != NULL )
+        i_count += Check( p_pic, &i_next );
+    assert( i_count == 10 );
+
+    /* Pictures left in the threads are released with the chain */
+    for( unsigned i = 0; i < 10; i++ )
+        Drop( filter_chain_VideoFilter( p_chain, Picture( &fmt, i ) ) );
+    filter_chain_Delete( p_chain );
+    es_format_Clean( &fmt );
+}
+
+int main( void )
+{
+    libvlc_instance_t *p_vlc;
+
+    test_init();
+
+    p_vlc = libvlc_new( test_defaults_nargs, test_defaults_args );
+    assert( p_vlc != NULL );
+
+    vlc_object_t *p_obj = VLC_OBJECT(p_vlc->p_libvlc_int);
+    test_chain( p_obj, 0 );
+    test_chain( p_obj, 1 );
+    test_chain( p_obj, 2 );
+    test_chain( p_obj, 8 );
+
+    libvlc_release( p_vlc );
+    return 0;
+}
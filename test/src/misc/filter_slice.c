@@ -0,0 +1,138 @@
+/*****************************************************************************
+ * filter_slice.c: test for the slice-parallel video filters
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/video.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+
+#define PICTURES 8
+/* Not a multiple of the band height, so that the last bands are partial */
+#define WIDTH    200
+#define HEIGHT   150
+
+/* Filters whose output must not depend on the slicing */
+static const char *const ppsz_filters[] = {
+    "adjust{contrast=1.5,hue=40,saturation=2}",
+    "sharpen{sigma=1.5}",
+    "gaussianblur{sigma=2}",
+    "gradfun",
+    "deinterlace{mode=yadif}",
+    "deinterlace{mode=x}",
+    "hqdn3d",
+};
+
+/* Gradients with some noise, different for each picture */
+static picture_t *Picture( const es_format_t *p_fmt, unsigned i )
+{
+    picture_t *p_pic = picture_NewFromFormat( &p_fmt->video );
+
+    assert( p_pic != NULL );
+    srand( i );
+    for( int j = 0; j < p_pic->i_planes; j++ )
+    {
+        plane_t *p = &p_pic->p[j];
+
+        for( int y = 0; y < p->i_lines; y++ )
+            for( int x = 0; x < p->i_pitch; x++ )
+                p->p_pixels[y * p->i_pitch + x] = x + 2 * y + i
+                                                + rand() % 8;
+    }
+    p_pic->date = VLC_TS_0 + i * CLOCK_FREQ / 25;
+    return p_pic;
+}
+
+/* The deinterlacers look a few pixels beyond the picture edges, into the
+ * uninitialized padding of their history copies, so the borders are skipped */
+#define EDGE 4
+
+/* Returns a hash of the pictures filtered with the given slice threads */
+static uint32_t Run( const char *psz_filter, const char *psz_threads )
+{
+    const char *ppsz_args[test_defaults_nargs + 1];
+    libvlc_instance_t *p_vlc;
+    es_format_t fmt;
+    filter_chain_t *p_chain;
+    uint32_t i_hash = TEST_HASH_INIT;
+    unsigned i_count = 0;
+
+    memcpy( ppsz_args, test_defaults_args, sizeof(test_defaults_args) );
+    ppsz_args[test_defaults_nargs] = psz_threads;
+    p_vlc = libvlc_new( test_defaults_nargs + 1, ppsz_args );
+    assert( p_vlc != NULL );
+
+    es_format_Init( &fmt, VIDEO_ES, VLC_CODEC_I420 );
+    video_format_Setup( &fmt.video, VLC_CODEC_I420, WIDTH, HEIGHT,
+                        WIDTH, HEIGHT, 1, 1 );
+
+    p_chain = filter_chain_New( p_vlc->p_libvlc_int, "video filter2", false,
+                                test_AllocationInit, NULL, NULL );
+    assert( p_chain != NULL );
+    filter_chain_Reset( p_chain, &fmt, &fmt );
+    assert( filter_chain_AppendFromString( p_chain, psz_filter )
+            == VLC_SUCCESS );
+
+    for( unsigned i = 0; i < PICTURES; i++ )
+    {
+        picture_t *p_pic = filter_chain_VideoFilter( p_chain,
+                                                     Picture( &fmt, i ) );
+        while( p_pic != NULL )
+        {
+            picture_t *p_next = p_pic->p_next;
+
+            p_pic->p_next = NULL;
+            i_hash = test_PictureHash( i_hash, p_pic, EDGE );
+            picture_Release( p_pic );
+            i_count++;
+            p_pic = p_next;
+        }
+    }
+    assert( i_count > 0 );
+
+    filter_chain_Delete( p_chain );
+    es_format_Clean( &fmt );
+    libvlc_release( p_vlc );
+    return i_hash;
+}
+
+int main( void )
+{
+    test_init();
+
+    for( size_t i = 0; i < ARRAY_SIZE(ppsz_filters); i++ )
+    {
+        log( "Testing the slices of %s\n", ppsz_filters[i] );
+
+        uint32_t i_ref = Run( ppsz_filters[i],
+                              "--video-filter-slice-threads=1" );
+        assert( Run( ppsz_filters[i],
+                     "--video-filter-slice-threads=3" ) == i_ref );
+        assert( Run( ppsz_filters[i],
+                     "--video-filter-slice-threads=8" ) == i_ref );
+    }
+
+    /* The recursive denoiser only differs at the band limits, when asked to
+     * use the slices */
+    log( "Testing the slices of hqdn3d{slices}\n" );
+    Run( "hqdn3d{slices}", "--video-filter-slice-threads=4" );
+    return 0;
+}
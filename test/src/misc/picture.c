@@ -0,0 +1,115 @@
+/*****************************************************************************
+ * picture.c: test for the picture buffer cache
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_picture.h>
+
+#define PICTURES 16
+
+static picture_t *NewPicture( vlc_fourcc_t i_chroma,
+                              unsigned i_width, unsigned i_height )
+{
+    video_format_t fmt;
+
+    video_format_Setup( &fmt, i_chroma, i_width, i_height,
+                        i_width, i_height, 1, 1 );
+    picture_t *p_pic = picture_NewFromFormat( &fmt );
+    assert( p_pic != NULL );
+    return p_pic;
+}
+
+static void test_reuse( void )
+{
+    picture_cache_stats_t before, after;
+
+    log( "Testing buffer reuse\n" );
+    picture_CacheTrim( 0 );
+
+    picture_Release( NewPicture( VLC_CODEC_I420, 320, 240 ) );
+    picture_CacheGetStats( &before );
+    assert( before.i_count == 1 && before.i_resident > 0 );
+
+    /* The same format takes the cached buffer */
+    picture_t *p_pic = NewPicture( VLC_CODEC_I420, 320, 240 );
+    picture_CacheGetStats( &after );
+    assert( after.i_hits == before.i_hits + 1 );
+    assert( after.i_count == 0 && after.i_resident == 0 );
+    picture_Release( p_pic );
+
+    /* Another geometry does not */
+    picture_CacheGetStats( &before );
+    p_pic = NewPicture( VLC_CODEC_RGB32, 320, 240 );
+    picture_CacheGetStats( &after );
+    assert( after.i_misses == before.i_misses + 1 );
+    assert( after.i_count == 1 );
+    picture_Release( p_pic );
+
+    picture_CacheTrim( 0 );
+    picture_CacheGetStats( &after );
+    assert( after.i_count == 0 && after.i_resident == 0 );
+}
+
+static void test_eviction( void )
+{
+    picture_t *pp_pics[PICTURES];
+    picture_cache_stats_t stats;
+
+    log( "Testing buffer eviction\n" );
+    picture_CacheTrim( 0 );
+
+    /* The cache is bounded */
+    size_t i_released = 0;
+    for( unsigned i = 0; i < PICTURES; i++ )
+        pp_pics[i] = NewPicture( VLC_CODEC_RGB32, 1920, 1080 );
+    for( unsigned i = 0; i < PICTURES; i++ )
+    {
+        i_released += pp_pics[i]->p[0].i_pitch * pp_pics[i]->p[0].i_lines;
+        picture_Release( pp_pics[i] );
+    }
+    picture_CacheGetStats( &stats );
+    assert( stats.i_count > 0 && stats.i_count < PICTURES );
+    assert( stats.i_resident < i_released );
+
+    /* Idle buffers are freed on the next allocation */
+    msleep( 3 * CLOCK_FREQ / 2 );
+    picture_t *p_pic = NewPicture( VLC_CODEC_I420, 320, 240 );
+    picture_CacheGetStats( &stats );
+    assert( stats.i_count == 0 && stats.i_resident == 0 );
+
+    /* and on the next release */
+    picture_Release( NewPicture( VLC_CODEC_I420, 640, 480 ) );
+    msleep( 3 * CLOCK_FREQ / 2 );
+    picture_Release( p_pic );
+    picture_CacheGetStats( &stats );
+    assert( stats.i_count == 1 );
+
+    picture_CacheTrim( 0 );
+}
+
+int main( void )
+{
+    test_init();
+
+    test_reuse();
+    test_eviction();
+    return 0;
+}
@@ -401,6 +401,45 @@ static void test_creation_and_type( libvlc_int_t *p_libvlc )
     assert( var_Get( p_libvlc, "bla", &val ) == VLC_ENOVAR );
 }
 
+static void test_handles( libvlc_int_t *p_libvlc )
+{
+    vlc_var_t *p_var[i_var_count];
+    int i;
+
+    assert( var_Hold( p_libvlc, "bla" ) == NULL );
+
+    for( i = 0; i < i_var_count; i++ )
+    {
+        var_Create( p_libvlc, psz_var_name[i], VLC_VAR_INTEGER );
+        p_var[i] = var_Hold( p_libvlc, psz_var_name[i] );
+        assert( p_var[i] != NULL );
+    }
+
+    for( i = 0; i < i_var_count; i++ )
+    {
+        var_value[i].i_int = rand();
+        var_HandleSetInteger( p_libvlc, p_var[i], var_value[i].i_int );
+        assert( var_GetInteger( p_libvlc, psz_var_name[i] ) == var_value[i].i_int );
+        var_SetInteger( p_libvlc, psz_var_name[i], var_value[i].i_int + 1 );
+        assert( var_HandleGetInteger( p_libvlc, p_var[i] ) == var_value[i].i_int + 1 );
+    }
+
+    /* Callbacks get the variable name */
+    var_AddCallback( p_libvlc, psz_var_name[0], callback, psz_var_name );
+    var_HandleSetInteger( p_libvlc, p_var[0], 42 );
+    assert( var_value[0].i_int == 42 );
+    var_DelCallback( p_libvlc, psz_var_name[0], callback, psz_var_name );
+
+    /* The handles keep the variables alive */
+    for( i = 0; i < i_var_count; i++ )
+    {
+        var_Destroy( p_libvlc, psz_var_name[i] );
+        assert( var_Type( p_libvlc, psz_var_name[i] ) == VLC_VAR_INTEGER );
+        var_Release( p_libvlc, p_var[i] );
+        assert( var_Type( p_libvlc, psz_var_name[i] ) == 0 );
+    }
+}
+
 static void test_variables( libvlc_instance_t *p_vlc )
 {
     libvlc_int_t *p_libvlc = p_vlc->p_libvlc_int;
@@ -438,6 +477,9 @@ static void test_variables( libvlc_instance_t *p_vlc )
 
     log( "Testing type at creation\n" );
     test_creation_and_type( p_libvlc );
+
+    log( "Testing handles\n" );
+    test_handles( p_libvlc );
 }
 
 
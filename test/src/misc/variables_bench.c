@@ -0,0 +1,118 @@
+/*****************************************************************************
+ * variables_bench.c: object variables lookup benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+
+#define ITERATIONS 2000000
+
+/* Variables commonly read for every block or picture */
+static const char *const names[] = {
+    "rate", "time", "position", "state", "video-es", "audio-delay",
+    "spu-delay", "deinterlace", "aspect-ratio", "zoom", "volume", "mute",
+};
+#define NAMES (sizeof (names) / sizeof (names[0]))
+
+static void report (const char *obj, const char *what, unsigned vars,
+                    mtime_t start)
+{
+    mtime_t duration = mdate () - start;
+
+    printf ("%-7s %4u vars %-7s %6.1f ns/op, %10.0f ops/s\n", obj, vars,
+            what, duration * 1000. / ITERATIONS,
+            ITERATIONS * (double)CLOCK_FREQ / duration);
+}
+
+static void bench (const char *name, vlc_object_t *obj, unsigned vars)
+{
+    unsigned i;
+    int64_t sum = 0;
+
+    for (i = 0; i < NAMES; i++)
+        var_Create (obj, names[i], VLC_VAR_INTEGER);
+
+    mtime_t start = mdate ();
+    for (i = 0; i < ITERATIONS; i++)
+        sum += var_GetInteger (obj, names[i % NAMES]);
+    report (name, "by name", vars, start);
+
+    vlc_var_t *handles[NAMES];
+    for (i = 0; i < NAMES; i++)
+        handles[i] = var_Hold (obj, names[i]);
+
+    start = mdate ();
+    for (i = 0; i < ITERATIONS; i++)
+        sum += var_HandleGetInteger (obj, handles[i % NAMES]);
+    report (name, "handle", vars, start);
+
+    for (i = 0; i < NAMES; i++)
+    {
+        var_Release (obj, handles[i]);
+        var_Destroy (obj, names[i]);
+    }
+    assert (sum == 0);
+}
+
+/* Creates an object with about as many variables as some real objects */
+static vlc_object_t *create (libvlc_int_t *libvlc, unsigned vars)
+{
+    vlc_object_t *obj = vlc_object_create (libvlc, sizeof (*obj));
+    char name[20];
+
+    assert (obj != NULL);
+    for (unsigned i = 0; i < vars; i++)
+    {
+        snprintf (name, sizeof (name), "dummy-%u", i);
+        var_Create (obj, name, VLC_VAR_STRING);
+    }
+    return obj;
+}
+
+int main (void)
+{
+    static const struct
+    {
+        const char *name;
+        unsigned vars;
+    } objects[] = {
+        { "decoder", 8 },
+        { "vout", 60 },
+        { "input", 150 },
+    };
+
+    setenv ("VLC_PLUGIN_PATH", "../modules", 1);
+
+    libvlc_instance_t *vlc = libvlc_new (test_defaults_nargs,
+                                         test_defaults_args);
+    assert (vlc != NULL);
+
+    for (unsigned i = 0; i < sizeof (objects) / sizeof (objects[0]); i++)
+    {
+        vlc_object_t *obj = create (vlc->p_libvlc_int, objects[i].vars);
+
+        bench (objects[i].name, obj, objects[i].vars + NAMES);
+        vlc_object_release (obj);
+    }
+
+    libvlc_release (vlc);
+    return 0;
+}
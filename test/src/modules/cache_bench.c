@@ -0,0 +1,74 @@
+/*****************************************************************************
+ * cache_bench.c: LibVLC start-up time with each plugins cache format
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ITERATIONS 50
+
+static libvlc_instance_t *create (const char *format, const char *extra)
+{
+    const char *argv[] = {
+        "--quiet", "--ignore-config", format, extra, NULL,
+    };
+    int argc = (extra != NULL) ? 4 : 3;
+
+    return libvlc_new (argc, argv);
+}
+
+static void bench (const char *name, const char *format, unsigned n)
+{
+    /* Write the cache in the requested format */
+    libvlc_instance_t *vlc = create (format, "--reset-plugins-cache");
+    assert (vlc != NULL);
+    libvlc_release (vlc);
+
+    int64_t start = libvlc_clock ();
+
+    for (unsigned i = 0; i < n; i++)
+    {
+        vlc = create (format, NULL);
+        assert (vlc != NULL);
+        libvlc_release (vlc);
+    }
+
+    int64_t duration = libvlc_clock () - start;
+
+    printf ("%-8s %8.2f ms/start-up\n", name, duration / (1000. * n));
+}
+
+int main (void)
+{
+    /* Defaults to the build tree, as in the tests */
+    setenv ("VLC_PLUGIN_PATH", "../modules", 0);
+
+    bench ("none", "--no-plugins-cache", 3);
+    bench ("legacy", "--no-plugins-cache-mmap", ITERATIONS);
+    bench ("mmap", "--plugins-cache-mmap", ITERATIONS);
+    return 0;
+}